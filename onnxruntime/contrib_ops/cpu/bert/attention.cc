@@ -63,7 +63,8 @@ Status AttentionBase::CheckInputs(const TensorShape& input_shape,
                                   const TensorShape& bias_shape,
                                   const Tensor*& mask_index,
                                   const Tensor* past,
-                                  const Tensor* extra_add_qk) const {
+                                  const Tensor* extra_add_qk,
+                                  const Tensor* past_seq_len) const {
   // Input shapes:
   //   input       : (batch_size, sequence_length, input_hidden_size)
   //   weights     : (input_hidden_size, 3 * hidden_size)
@@ -73,7 +74,9 @@ Status AttentionBase::CheckInputs(const TensorShape& input_shape,
   //                 or (batch_size, past_sequence_length + sequence_length)
   //                 or (batch_size, sequence_length, past_sequence_length + sequence_length)
   //   past        : (2, batch_size, num_heads, past_sequence_length, head_size)
+  //                 or (2, batch_size, num_heads, max_sequence_length, head_size) when past_present_share_buffer is set
   //   extra_add_qk: (batch_size, num_heads, sequence_length, sequence_length)
+  //   past_seq_len: scalar, only used when past_present_share_buffer is set
   //
   // Where hidden_size = num_heads * head_size.
   // When a model is pruned (like some attention heads are removed), hidden_size < input_hidden_size.
@@ -179,6 +182,23 @@ Status AttentionBase::CheckInputs(const TensorShape& input_shape,
     past_sequence_length = static_cast<int>(past_dims[3]);
   }
 
+  if (past_present_share_buffer_) {
+    if (past == nullptr || past_seq_len == nullptr) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "past_present_share_buffer requires inputs 'past' and 'past_sequence_length'");
+    }
+    if (past_seq_len->Shape().Size() != 1) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input 'past_sequence_length' shall be a scalar");
+    }
+    const int max_sequence_length = past_sequence_length;
+    past_sequence_length = *past_seq_len->Data<int32_t>();
+    if (past_sequence_length < 0 || past_sequence_length + sequence_length > max_sequence_length) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "past_sequence_length + sequence_length shall be in the range of [0, ",
+                             max_sequence_length, "], got ", past_sequence_length, " + ", sequence_length);
+    }
+  }
+
   if (mask_index != nullptr) {  // mask_index is optional
     const auto& mask_dims = mask_index->Shape().GetDims();
     if (mask_dims.size() == 1) {
@@ -231,6 +251,18 @@ Status AttentionBase::CheckInputs(const TensorShape& input_shape,
     }
   }
 
+  if (window_ > 0) {
+    // Sliding window attention does not materialize SxS* matrices, so masks and additions of that shape are not used.
+    if (mask_index != nullptr && mask_index->Shape().NumDimensions() > 2) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'mask_index' with 3D or 4D data is not supported with sliding window attention");
+    }
+    if (extra_add_qk != nullptr) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Input 'extra_add_qk' is not supported with sliding window attention");
+    }
+  }
+
   if (extra_add_qk != nullptr) {
     const auto& extra_add_qk_dims = extra_add_qk->Shape().GetDims();
 
@@ -276,6 +308,10 @@ Status AttentionBase::CheckInputs(const TensorShape& input_shape,
     return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "num_heads should be no larger than ", max_threads_per_block);
   }
 
+  if (window_ > 0) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, NOT_IMPLEMENTED, "Sliding window attention is only supported by CPU kernel");
+  }
+
   return CheckInputs(input_shape, weights_shape, bias_shape, mask_index, past, extra_add_qk);
 }
 
@@ -446,6 +482,7 @@ Status Attention<T>::Compute(OpKernelContext* context) const {
   const Tensor* mask_index = context->Input<Tensor>(3);
   const Tensor* past = context->Input<Tensor>(4);
   const Tensor* extra_add_qk = context->Input<Tensor>(5);
+  const Tensor* past_seq_len = context->Input<Tensor>(6);
 
   const TensorShape& weights_shape = (weights ? weights->Shape() : weight_shape_);
   ORT_RETURN_IF_ERROR(CheckInputs(input->Shape(),
@@ -453,7 +490,8 @@ Status Attention<T>::Compute(OpKernelContext* context) const {
                                   bias->Shape(),
                                   mask_index,
                                   past,
-                                  extra_add_qk));
+                                  extra_add_qk,
+                                  past_seq_len));
 
   const auto shape = input->Shape().GetDims();
   const int batch_size = static_cast<int>(shape[0]);
@@ -598,7 +636,7 @@ Status Attention<T>::Compute(OpKernelContext* context) const {
   return ApplyAttention(Q, K, V, mask_index, past, output,
                         batch_size, sequence_length,
                         qkv_head_size[0], qkv_head_size[2], v_hidden_size,
-                        extra_add_qk, context);
+                        extra_add_qk, context, past_seq_len);
 }
 }  // namespace contrib
 }  // namespace onnxruntime
@@ -36,6 +36,14 @@ class AttentionBase {
 
     is_unidirectional_ = info.GetAttrOrDefault<int64_t>("unidirectional", 0) == 1;
 
+    past_present_share_buffer_ = info.GetAttrOrDefault<int64_t>("past_present_share_buffer", 0) != 0;
+
+    window_ = static_cast<int>(info.GetAttrOrDefault<int64_t>("window", 0));
+    ORT_ENFORCE(window_ >= 0, "window shall not be negative, got ", window_);
+
+    num_global_tokens_ = static_cast<int>(info.GetAttrOrDefault<int64_t>("num_global_tokens", 0));
+    ORT_ENFORCE(num_global_tokens_ >= 0, "num_global_tokens shall not be negative, got ", num_global_tokens_);
+
     if (!info.GetAttrs<int64_t>("qkv_hidden_sizes", qkv_hidden_sizes_).IsOK() || qkv_hidden_sizes_.empty()) {
       qkv_hidden_sizes_.resize(0);
     }
@@ -46,10 +54,14 @@ class AttentionBase {
                      const TensorShape& bias_shape,
                      const Tensor*& mask_index,  // For dummy mask with shape (1, 1) or (batch_size, 1), it will be updated to nullptr.
                      const Tensor* past,
-                     const Tensor* extra_add_qk) const;
+                     const Tensor* extra_add_qk,
+                     const Tensor* past_seq_len = nullptr) const;
 
   int num_heads_;                          // number of attention heads
   bool is_unidirectional_;                 // whether every token can only attend to previous tokens.
+  bool past_present_share_buffer_;         // whether present is written in place into a max length past buffer
+  int window_;                             // one sided length of sliding window attention, or 0 for full attention
+  int num_global_tokens_;                  // number of leading tokens that attend and are attended globally
   std::vector<int64_t> qkv_hidden_sizes_;  // Q, K, V path hidden layer sizes
 };
 
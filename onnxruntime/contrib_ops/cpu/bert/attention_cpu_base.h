@@ -3,6 +3,10 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 #include "attention_base.h"
 #include "attention_helper.h"
 
@@ -30,18 +34,42 @@ class AttentionCPUBase : public AttentionBase {
                         int v_head_size,             // head_size
                         int v_hidden_size,           // hidden_size
                         const Tensor* extra_add_qk,  // extra add in QK. Its size is BxNxSxS
-                        OpKernelContext* context) const {
+                        OpKernelContext* context,
+                        const Tensor* past_seq_len = nullptr) const {  // valid length of a shared past buffer
     AllocatorPtr allocator;
     ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&allocator));
 
     auto* tp = context->GetOperatorThreadPool();
 
     int past_sequence_length = 0;
-    Tensor* present = GetPresent(context, past, batch_size, v_head_size, sequence_length, past_sequence_length);
+    int max_sequence_length = 0;  // capacity of the shared past/present buffer, or 0 when present is a new buffer
+    Tensor* present = nullptr;
+    if (past_present_share_buffer_) {
+      // The new key and value are appended in place after the valid positions of the max length past buffer.
+      // CheckInputs has already verified that past and past_sequence_length are given and fit into the buffer.
+      max_sequence_length = static_cast<int>(past->Shape()[3]);
+      past_sequence_length = *past_seq_len->Data<int32_t>();
+      present = context->Output(1, past->Shape());
+      ORT_RETURN_IF(present == nullptr, "past_present_share_buffer requires the present output");
+    } else {
+      present = GetPresent(context, past, batch_size, v_head_size, sequence_length, past_sequence_length);
+    }
 
     // Total sequence length including that of past state: S* = S' + S
     const int all_sequence_length = past_sequence_length + sequence_length;
 
+    if (window_ > 0) {
+      ComputeWindowAttention(output->MutableData<T>(), Q, K, V,
+                             mask_index != nullptr ? mask_index->Data<int32_t>() : nullptr,
+                             mask_index != nullptr ? mask_index->Shape().GetDims() : gsl::span<const int64_t>{},
+                             batch_size, sequence_length, past_sequence_length, max_sequence_length,
+                             qk_head_size == 0 ? v_head_size : qk_head_size, v_head_size, v_hidden_size,
+                             past != nullptr ? past->Data<T>() : nullptr,
+                             present != nullptr ? present->MutableData<T>() : nullptr,
+                             tp);
+      return Status::OK();
+    }
+
     // Compute the attention score. It does 2 things:
     //         I. attention_probs(B, N, S, S*) = 1/sqrt(H) x Q(B, N, S, H) x K'(B, N, S*, H -> B, N, H, S*) +
     //                                           1 x mask_data(B, N, S, S*)
@@ -74,7 +102,7 @@ class AttentionCPUBase : public AttentionBase {
 
     ComputeAttentionProbs<T>(static_cast<T*>(attention_probs), Q, K,
                              mask_index_data, mask_index_dims, static_cast<T*>(mask_data), has_unidirectional,
-                             batch_size, sequence_length, past_sequence_length,
+                             batch_size, sequence_length, past_sequence_length, max_sequence_length,
                              qk_head_size == 0 ? v_head_size : qk_head_size,
                              past_data, present_data, tp, extra_add_qk_data);
 
@@ -85,13 +113,169 @@ class AttentionCPUBase : public AttentionBase {
 
     ComputeVxAttentionScore(output->MutableData<T>(), static_cast<T*>(out_tmp_data),
                             static_cast<T*>(attention_probs), V,
-                            batch_size, sequence_length, past_sequence_length, v_head_size, v_hidden_size,
-                            past_data, present_data, tp);
+                            batch_size, sequence_length, past_sequence_length, max_sequence_length,
+                            v_head_size, v_hidden_size, past_data, present_data, tp);
 
     return Status::OK();
   }
 
  private:
+  // Sliding window attention: each token attends to the tokens within window_ positions on each side (only previous
+  // ones when unidirectional), and to the first num_global_tokens_ tokens. Those global tokens attend to all tokens.
+  // Queries are split into blocks, and each block is multiplied with the band of keys covered by its windows, so
+  // memory and compute are O(S x W) instead of O(S x S*). Positions are counted from the start of past state.
+  template <typename T>
+  void ComputeWindowAttention(T* output,                                // output with size BxSxNxH
+                              const T* Q,                               // Q data. Its size is BxNxSxH
+                              const T* K,                               // K data. Its size is BxNxSxH
+                              const T* V,                               // V data. Its size is BxNxSxH
+                              const int32_t* mask_index,                // mask index. nullptr if no mask.
+                              gsl::span<const int64_t> mask_index_dims,  // mask index shape, 1D or 2D
+                              int batch_size,                           // batch size of self-attention
+                              int sequence_length,                      // sequence length of self-attention
+                              int past_sequence_length,                 // sequence length of past state
+                              int max_sequence_length,                  // capacity of shared past/present, or 0
+                              int qk_head_size,                         // head size of Q and K
+                              int v_head_size,                          // head size of V
+                              int v_hidden_size,                        // hidden size of output
+                              const T* past,                            // past state
+                              T* present,                               // present state
+                              ThreadPool* tp) const {
+    const int all_sequence_length = past_sequence_length + sequence_length;  // S* = S' + S
+    const std::ptrdiff_t loop_len = static_cast<std::ptrdiff_t>(batch_size) * num_heads_;
+
+    // Keys and values of all positions: concatenate or append K and V to past state when there is present state.
+    const T* k_state = K;
+    const T* v_state = V;
+    size_t k_state_chunk_length = static_cast<size_t>(sequence_length) * qk_head_size;
+    size_t v_state_chunk_length = static_cast<size_t>(sequence_length) * v_head_size;
+    if (present != nullptr) {
+      const size_t past_chunk_length = static_cast<size_t>(past_sequence_length) * v_head_size;  // S' x H
+      const size_t input_chunk_length = static_cast<size_t>(sequence_length) * v_head_size;      // S x H
+      const size_t present_chunk_length = past_chunk_length + input_chunk_length;                // S* x H
+      const size_t max_chunk_length = static_cast<size_t>(max_sequence_length) * v_head_size;    // M x H
+      const size_t state_chunk_length = max_chunk_length > 0 ? max_chunk_length : present_chunk_length;
+      const size_t past_state_chunk_length = max_chunk_length > 0 ? max_chunk_length : past_chunk_length;
+
+      const double copy_cost = static_cast<double>(state_chunk_length);
+      ThreadPool::TryParallelFor(tp, 2 * loop_len, copy_cost, [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        for (std::ptrdiff_t i = begin; i != end; ++i) {
+          const std::ptrdiff_t kv = i / loop_len;  // 0 for key, 1 for value
+          const std::ptrdiff_t j = i % loop_len;
+          const T* chunk = (kv == 0 ? K : V) + input_chunk_length * j;
+          const T* past_kv = past != nullptr ? past + kv * loop_len * past_state_chunk_length : nullptr;
+          T* present_kv = present + kv * loop_len * state_chunk_length;
+          if (max_chunk_length > 0) {
+            AppendStateChunk(past_kv, chunk, present_kv, past_chunk_length, input_chunk_length, max_chunk_length, j);
+          } else {
+            ConcatStateChunk(past_kv, chunk, present_kv, past_chunk_length, present_chunk_length, j);
+          }
+        }
+      });
+
+      k_state = present;
+      v_state = present + loop_len * state_chunk_length;
+      k_state_chunk_length = state_chunk_length;
+      v_state_chunk_length = state_chunk_length;
+    }
+
+    // Mask of keys: (B)xS* with 0 for valid positions and -10000.0 for masked ones.
+    std::vector<T> key_mask;
+    if (mask_index != nullptr) {
+      key_mask.assign(static_cast<size_t>(batch_size) * all_sequence_length, static_cast<T>(0.0f));
+      PrepareMask(mask_index, mask_index_dims, key_mask.data(), false, batch_size, 1, all_sequence_length - 1);
+    }
+
+    // Queries at positions before num_global_tokens_ attend globally in the first block, followed by blocks of
+    // local queries.
+    const int num_global_tokens = std::min(num_global_tokens_, all_sequence_length);
+    const int num_global_queries = std::clamp(num_global_tokens - past_sequence_length, 0, sequence_length);
+    const int block_size = std::clamp(window_, 16, 64);
+    const int num_local_blocks = (sequence_length - num_global_queries + block_size - 1) / block_size;
+    const int num_blocks = num_local_blocks + (num_global_queries > 0 ? 1 : 0);
+    const int max_columns = std::min(all_sequence_length, num_global_tokens + block_size + 2 * window_);
+    const size_t scores_size = std::max(static_cast<size_t>(num_global_queries) * all_sequence_length,
+                                        static_cast<size_t>(block_size) * max_columns);
+    const float alpha = 1.0f / sqrt(static_cast<float>(qk_head_size));
+
+    const double cost = static_cast<double>(block_size) * max_columns * (qk_head_size + v_head_size);
+    ThreadPool::TryParallelFor(tp, loop_len * num_blocks, cost, [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+      std::vector<T> scores(scores_size);
+      for (std::ptrdiff_t i = begin; i != end; ++i) {
+        const std::ptrdiff_t j = i / num_blocks;  // index of (batch, head)
+        const int block_index = static_cast<int>(i % num_blocks);
+        const int batch_index = static_cast<int>(j / num_heads_);
+        const int head_index = static_cast<int>(j % num_heads_);
+
+        // Queries [query_start, query_end) of this block attend to the first num_global_columns keys, and keys
+        // in [key_start, key_end). Global queries attend to all keys.
+        const bool is_global = num_global_queries > 0 && block_index == 0;
+        int query_start = 0;
+        int query_end = num_global_queries;
+        int key_start = 0;
+        int key_end = all_sequence_length;
+        if (!is_global) {
+          query_start = num_global_queries + (block_index - (num_global_queries > 0 ? 1 : 0)) * block_size;
+          query_end = std::min(query_start + block_size, sequence_length);
+          key_start = std::max(past_sequence_length + query_start - window_, 0);
+          key_end = is_unidirectional_ ? past_sequence_length + query_end
+                                       : std::min(past_sequence_length + query_end + window_, all_sequence_length);
+        }
+        const int num_global_columns = std::min(num_global_tokens, key_start);
+        const int num_queries = query_end - query_start;
+        const int num_keys = key_end - key_start;
+        const int num_columns = num_global_columns + num_keys;
+
+        const T* q = Q + static_cast<size_t>(sequence_length) * qk_head_size * j + query_start * qk_head_size;
+        const T* k = k_state + k_state_chunk_length * j;
+        const T* v = v_state + v_state_chunk_length * j;
+
+        // scores(num_queries, num_columns) = 1/sqrt(H) x Q x [K of global tokens, K of key band]'
+        if (num_global_columns > 0) {
+          math::GemmEx<T, ThreadPool>(CblasNoTrans, CblasTrans, num_queries, num_global_columns, qk_head_size, alpha,
+                                      q, qk_head_size, k, qk_head_size, 0.0f,
+                                      scores.data(), num_columns, nullptr);
+        }
+        math::GemmEx<T, ThreadPool>(CblasNoTrans, CblasTrans, num_queries, num_keys, qk_head_size, alpha,
+                                    q, qk_head_size, k + key_start * qk_head_size, qk_head_size, 0.0f,
+                                    scores.data() + num_global_columns, num_columns, nullptr);
+
+        // Apply window, unidirectional and key masks.
+        const T* mask = key_mask.empty() ? nullptr
+                                         : key_mask.data() + static_cast<size_t>(batch_index) * all_sequence_length;
+        for (int r = 0; r < num_queries; r++) {
+          const int position = past_sequence_length + query_start + r;
+          T* row = scores.data() + static_cast<size_t>(r) * num_columns;
+          for (int c = 0; c < num_columns; c++) {
+            const int key = c < num_global_columns ? c : key_start + c - num_global_columns;
+            const bool is_attended = (is_global || key < num_global_tokens || std::abs(position - key) <= window_) &&
+                                     !(is_unidirectional_ && key > position);
+            if (!is_attended) {
+              row[c] = static_cast<T>(-10000.0f);
+            } else if (mask != nullptr) {
+              row[c] += mask[key];
+            }
+          }
+        }
+
+        ComputeAttentionSoftmaxInplace(scores.data(), num_queries, num_columns, nullptr);
+
+        // output(num_queries, H) = scores x [V of global tokens, V of key band], written to (B, S, N, H) directly.
+        T* out = output + (static_cast<size_t>(batch_index) * sequence_length + query_start) * v_hidden_size +
+                 static_cast<size_t>(head_index) * v_head_size;
+        if (num_global_columns > 0) {
+          math::GemmEx<T, ThreadPool>(CblasNoTrans, CblasNoTrans, num_queries, v_head_size, num_global_columns, 1.0f,
+                                      scores.data(), num_columns, v, v_head_size, 0.0f,
+                                      out, v_hidden_size, nullptr);
+        }
+        math::GemmEx<T, ThreadPool>(CblasNoTrans, CblasNoTrans, num_queries, v_head_size, num_keys, 1.0f,
+                                    scores.data() + num_global_columns, num_columns,
+                                    v + key_start * v_head_size, v_head_size, num_global_columns > 0 ? 1.0f : 0.0f,
+                                    out, v_hidden_size, nullptr);
+      }
+    });
+  }
+
   // Helper function to compute the attention probs. It does 2 things:
   //  I. attention_probs(B, N, S, S*) = 1/sqrt(H) x Q(B, N, S, H) x K'(B, N, S*, H -> B, N, H, S*) +
   //                                    1 x mask_data(B, N, S, S*)
@@ -107,6 +291,7 @@ class AttentionCPUBase : public AttentionBase {
                              int batch_size,                            // batch size of self-attention
                              int sequence_length,                       // sequence length of self-attention
                              int past_sequence_length,                  // sequence length of past state
+                             int max_sequence_length,                   // capacity of shared past/present, or 0
                              int head_size,                             // head size of self-attention
                              const T* past,                             // past state
                              T* present,                                // present state
@@ -117,6 +302,7 @@ class AttentionCPUBase : public AttentionBase {
     const size_t past_chunk_length = static_cast<size_t>(past_sequence_length) * head_size;  // S' x H
     const size_t input_chunk_length = static_cast<size_t>(sequence_length) * head_size;      // S x H
     const size_t present_chunk_length = past_chunk_length + input_chunk_length;              // S* x H
+    const size_t max_chunk_length = static_cast<size_t>(max_sequence_length) * head_size;    // M x H
 
     {
       // mask_data is nullptr when mask_index is nullptr and not unidirectional, otherwise its shape is BxSxS*
@@ -151,8 +337,13 @@ class AttentionCPUBase : public AttentionBase {
 
           const T* k = K + input_chunk_length * i;
           if (nullptr != present) {
-            // Concatenate past_K and K : (BxNx)S'xH, (BxNx)SxH -> (BxNx)S*xH
-            k = ConcatStateChunk(past, k, present, past_chunk_length, present_chunk_length, i);
+            if (max_chunk_length > 0) {
+              // Append K after the valid part of the shared buffer: (BxNx)SxH -> (BxNx)MxH
+              k = AppendStateChunk(past, k, present, past_chunk_length, input_chunk_length, max_chunk_length, i);
+            } else {
+              // Concatenate past_K and K : (BxNx)S'xH, (BxNx)SxH -> (BxNx)S*xH
+              k = ConcatStateChunk(past, k, present, past_chunk_length, present_chunk_length, i);
+            }
           }
 
           // Compute Q*K' + AttentionMask
@@ -199,6 +390,7 @@ class AttentionCPUBase : public AttentionBase {
                                int batch_size,            // batch size
                                int sequence_length,       // sequence length
                                int past_sequence_length,  // sequence length in past state
+                               int max_sequence_length,   // capacity of shared past/present, or 0
                                int head_size,             // head size
                                int hidden_size,           // hidden size
                                const T* past,             // past state
@@ -208,13 +400,14 @@ class AttentionCPUBase : public AttentionBase {
     const size_t past_chunk_length = static_cast<size_t>(past_sequence_length * head_size);  // S' x H
     const size_t input_chunk_length = static_cast<size_t>(sequence_length * head_size);      // S x H
     const size_t present_chunk_length = past_chunk_length + input_chunk_length;              // S* x H
+    const size_t max_chunk_length = static_cast<size_t>(max_sequence_length) * head_size;    // M x H
 
     // Move the pointer of past and present to start of v values.
     if (nullptr != past) {
-      past += batch_size * num_heads_ * past_sequence_length * head_size;
+      past += batch_size * num_heads_ * (max_chunk_length > 0 ? max_chunk_length : past_chunk_length);
     }
     if (nullptr != present) {
-      present += batch_size * num_heads_ * all_sequence_length * head_size;
+      present += batch_size * num_heads_ * (max_chunk_length > 0 ? max_chunk_length : present_chunk_length);
     }
 
     const double cost =
@@ -224,8 +417,13 @@ class AttentionCPUBase : public AttentionBase {
       for (std::ptrdiff_t i = begin; i != end; ++i) {
         const T* v = V + input_chunk_length * i;
         if (nullptr != present) {
-          // concatenate past_V and V: (BxNx)S'xH, (BxNx)SxH -> (BxNx)S*xH
-          v = ConcatStateChunk(past, v, present, past_chunk_length, present_chunk_length, i);
+          if (max_chunk_length > 0) {
+            // Append V after the valid part of the shared buffer: (BxNx)SxH -> (BxNx)MxH
+            v = AppendStateChunk(past, v, present, past_chunk_length, input_chunk_length, max_chunk_length, i);
+          } else {
+            // concatenate past_V and V: (BxNx)S'xH, (BxNx)SxH -> (BxNx)S*xH
+            v = ConcatStateChunk(past, v, present, past_chunk_length, present_chunk_length, i);
+          }
         }
 
         T* current_tmp_data = reinterpret_cast<T*>(tmp_buffer) + input_chunk_length * i;
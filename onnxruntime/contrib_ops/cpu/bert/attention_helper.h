@@ -171,5 +171,25 @@ T* ConcatStateChunk(const T* past,
   return start;
 }
 
+// Append an input state chunk SxH after the first S' rows of a present state chunk that has room for M rows.
+// When past and present share one buffer the append happens in place. Otherwise the whole past chunk MxH is
+// copied first. Returns a pointer to the start of present state chunk.
+template <typename T>
+T* AppendStateChunk(const T* past,
+                    const T* chunk,
+                    T* present,
+                    size_t past_chunk_length,
+                    size_t input_chunk_length,
+                    size_t max_chunk_length,
+                    std::ptrdiff_t i) {
+  T* start = present + i * max_chunk_length;
+  if (nullptr != past && past != present) {
+    memcpy(start, past + i * max_chunk_length, max_chunk_length * sizeof(T));
+  }
+
+  memcpy(start + past_chunk_length, chunk, input_chunk_length * sizeof(T));
+  return start;
+}
+
 }  // namespace contrib
 }  // namespace onnxruntime
@@ -3,10 +3,16 @@
 
 #include "embed_layer_norm.h"
 #include "embed_layer_norm_helper.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/util/math.h"
 #include "core/util/math_cpuonly.h"
 #include "core/platform/threadpool.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cmath>
+#include <type_traits>
+#include <vector>
 
 namespace onnxruntime {
 namespace contrib {
@@ -23,6 +29,89 @@ namespace contrib {
       EmbedLayerNorm<T>);
 
 REGISTER_KERNEL_TYPED(float)
+REGISTER_KERNEL_TYPED(MLFloat16)
+
+namespace embed_layer_norm {
+
+void NormalizeEmbeddingSum(const float* word,
+                           const float* position,
+                           const float* segment,
+                           const float* gamma,
+                           const float* beta,
+                           float epsilon,
+                           int64_t hidden_size,
+                           float* output,
+                           float* embedding_sum) {
+  EigenVectorArrayMap<float> y(output, hidden_size);
+  if (segment != nullptr) {
+    y = ConstEigenVectorArrayMap<float>(word, hidden_size) + ConstEigenVectorArrayMap<float>(position, hidden_size) +
+        ConstEigenVectorArrayMap<float>(segment, hidden_size);
+  } else {
+    y = ConstEigenVectorArrayMap<float>(word, hidden_size) + ConstEigenVectorArrayMap<float>(position, hidden_size);
+  }
+  if (embedding_sum != nullptr) {
+    std::copy_n(output, hidden_size, embedding_sum);
+  }
+
+  const float mean = y.sum() / hidden_size;
+  const float variance = (y - mean).square().sum() / hidden_size;
+  const float inverse_std = 1.0f / std::sqrt(variance + epsilon);
+  y = (y - mean) * inverse_std * ConstEigenVectorArrayMap<float>(gamma, hidden_size) +
+      ConstEigenVectorArrayMap<float>(beta, hidden_size);
+}
+
+void ComputeMaskIndex(const int32_t* mask,
+                      int batch_size,
+                      int sequence_length,
+                      int32_t* mask_index,
+                      concurrency::ThreadPool* tp) {
+  if (nullptr == mask) {
+    std::fill_n(mask_index, batch_size, 0);
+    return;
+  }
+
+  concurrency::ThreadPool::TryParallelFor(
+      tp, batch_size, static_cast<double>(sequence_length), [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        for (std::ptrdiff_t b = begin; b != end; ++b) {
+          const int32_t* cur_mask = mask + b * sequence_length;
+          mask_index[b] = static_cast<int32_t>(std::count(cur_mask, cur_mask + sequence_length, 1));
+        }
+      });
+}
+
+}  // namespace embed_layer_norm
+
+namespace {
+
+// Rows of float tables are used in place, and rows of float16 tables are converted to float in buffer.
+const float* ToFloat(const float* row, int64_t /*hidden_size*/, float* /*buffer*/) {
+  return row;
+}
+
+const float* ToFloat(const MLFloat16* row, int64_t hidden_size, float* buffer) {
+  MlasConvertHalfToFloatBuffer(&row->val, buffer, static_cast<size_t>(hidden_size));
+  return buffer;
+}
+
+// A float output row is computed in place, and a float16 one is computed in buffer and converted by FromFloat.
+float* FloatOutput(float* row, float* /*buffer*/) {
+  return row;
+}
+
+float* FloatOutput(MLFloat16* /*row*/, float* buffer) {
+  return buffer;
+}
+
+void FromFloat(const float* /*source*/, int64_t /*hidden_size*/, float* /*row*/) {
+}
+
+void FromFloat(const float* source, int64_t hidden_size, MLFloat16* row) {
+  for (int64_t i = 0; i < hidden_size; i++) {
+    row[i] = MLFloat16(math::floatToHalf(source[i]));
+  }
+}
+
+}  // namespace
 
 EmbedLayerNormBase::EmbedLayerNormBase(const OpKernelInfo& op_kernel_info) : OpKernel(op_kernel_info) {
   ORT_ENFORCE(op_kernel_info.GetAttr<float>("epsilon", &epsilon_).IsOK());
@@ -74,73 +163,77 @@ Status EmbedLayerNorm<T>::Compute(OpKernelContext* context) const {
   const T* word_embedding_data = word_embedding->Data<T>();
   const T* position_embedding_data = position_embedding->Data<T>();
   const T* segment_embedding_data = (nullptr == segment_embedding) ? nullptr : segment_embedding->Data<T>();
-  const T* gamma_data = gamma->Data<T>();
-  const T* beta_data = beta->Data<T>();
   const int32_t* position_ids_data = (nullptr == position_ids) ? nullptr : position_ids->Data<int32_t>();
   T* output_data = output->MutableData<T>();
   T* embedding_sum_data = (embedding_sum != nullptr) ? embedding_sum->MutableData<T>() : nullptr;
 
+  // gamma and beta are converted to float once when they are float16.
+  constexpr bool is_float = std::is_same<T, float>::value;
+  std::vector<float> gamma_beta(is_float ? 0 : 2 * hidden_size);
+  const float* gamma_data = ToFloat(gamma->Data<T>(), hidden_size, gamma_beta.data());
+  const float* beta_data = ToFloat(beta->Data<T>(), hidden_size, gamma_beta.data() + (is_float ? 0 : hidden_size));
+
   // Calculate output
   {
     std::atomic_bool failed{false};
 
     int n = batch_size * sequence_length;
-    concurrency::ThreadPool::TryBatchParallelFor(
-        context->GetOperatorThreadPool(), n, [=, &failed](ptrdiff_t index) {
-          int word_col_index = input_ids_data[index];
-          if (word_col_index < 0 || word_col_index >= word_embedding_length) {
-            failed.store(true, std::memory_order_release);
-            return;
-          }
-          int position_col_index = (position_ids_data == nullptr) ? index % sequence_length : position_ids_data[index];
-          if (position_col_index >= position_embedding_length) {
-            failed.store(true, std::memory_order_release);
-            return;
-          }
-          int segment_col_index = 0;
-          if (nullptr != segment_ids_data) {
-            segment_col_index = segment_ids_data[index];
-            if (segment_col_index < 0 || segment_col_index >= segment_embedding_length) {
+    const double cost = static_cast<double>(hidden_size) * 8.0;
+    concurrency::ThreadPool::TryParallelFor(
+        context->GetOperatorThreadPool(), n, cost, [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+          // Float rows of word, position and segment embedding, output and embedding sum when T is float16.
+          std::vector<float> buffer(is_float ? 0 : 5 * hidden_size);
+          float* word_buffer = buffer.data();
+          float* position_buffer = word_buffer + (is_float ? 0 : hidden_size);
+          float* segment_buffer = position_buffer + (is_float ? 0 : hidden_size);
+          float* output_buffer = segment_buffer + (is_float ? 0 : hidden_size);
+          float* embedding_sum_buffer = output_buffer + (is_float ? 0 : hidden_size);
+
+          for (std::ptrdiff_t index = begin; index != end; ++index) {
+            int word_col_index = input_ids_data[index];
+            if (word_col_index < 0 || word_col_index >= word_embedding_length) {
               failed.store(true, std::memory_order_release);
               return;
             }
-          }
+            int position_col_index = (position_ids_data == nullptr) ? static_cast<int>(index % sequence_length)
+                                                                    : position_ids_data[index];
+            if (position_col_index < 0 || position_col_index >= position_embedding_length) {
+              failed.store(true, std::memory_order_release);
+              return;
+            }
+            int segment_col_index = 0;
+            if (nullptr != segment_ids_data) {
+              segment_col_index = segment_ids_data[index];
+              if (segment_col_index < 0 || segment_col_index >= segment_embedding_length) {
+                failed.store(true, std::memory_order_release);
+                return;
+              }
+            }
 
-          T* y = output_data + index * hidden_size;
-          T* y1 = nullptr;
-          if (embedding_sum_data != nullptr) {
-            y1 = embedding_sum_data + index * hidden_size;
-          }
-          const T* input_word_embedding = word_embedding_data + word_col_index * hidden_size;
-          const T* input_position_embedding = position_embedding_data + position_col_index * hidden_size;
-          const T* input_segment_embedding = (nullptr == segment_embedding_data)
-                                                 ? nullptr
-                                                 : segment_embedding_data + segment_col_index * hidden_size;
-
-          T sum = static_cast<T>(0);
-          for (int i = 0; i < hidden_size; i++) {
-            T subtotal = input_word_embedding[i] + input_position_embedding[i];
-            if (nullptr != segment_embedding_data)
-              subtotal += input_segment_embedding[i];
-            y[i] = subtotal;
+            const float* input_word_embedding =
+                ToFloat(word_embedding_data + word_col_index * hidden_size, hidden_size, word_buffer);
+            const float* input_position_embedding =
+                ToFloat(position_embedding_data + position_col_index * hidden_size, hidden_size, position_buffer);
+            const float* input_segment_embedding =
+                (nullptr == segment_embedding_data)
+                    ? nullptr
+                    : ToFloat(segment_embedding_data + segment_col_index * hidden_size, hidden_size, segment_buffer);
+
+            T* y = output_data + index * hidden_size;
+            T* y1 = (embedding_sum_data != nullptr) ? embedding_sum_data + index * hidden_size : nullptr;
+            float* y_float = FloatOutput(y, output_buffer);
+            float* y1_float = (y1 != nullptr) ? FloatOutput(y1, embedding_sum_buffer) : nullptr;
+
+            embed_layer_norm::NormalizeEmbeddingSum(input_word_embedding, input_position_embedding,
+                                                    input_segment_embedding, gamma_data, beta_data, epsilon(),
+                                                    hidden_size, y_float, y1_float);
+
+            FromFloat(y_float, hidden_size, y);
             if (y1 != nullptr) {
-              y1[i] = subtotal;
+              FromFloat(y1_float, hidden_size, y1);
             }
-            sum += subtotal;
-          }
-          T mean = sum / hidden_size;
-          sum = 0;
-          for (int i = 0; i < hidden_size; i++) {
-            T a = y[i] - mean;
-            y[i] = a;
-            sum += a * a;
           }
-          T e = sqrt(sum / hidden_size + static_cast<T>(epsilon()));
-          for (int i = 0; i < hidden_size; i++) {
-            y[i] = y[i] / e * gamma_data[i] + beta_data[i];
-          }
-        },
-        0);
+        });
 
     if (failed.load(std::memory_order_acquire)) {
       return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "input index out of range");
@@ -148,22 +241,9 @@ Status EmbedLayerNorm<T>::Compute(OpKernelContext* context) const {
   }
 
   // Calculate mask
-  if (nullptr != mask) {
-    const int32_t* mask_data = mask->Data<int32_t>();
-    int32_t* mask_index_data = mask_index->MutableData<int32_t>();
-    for (int b = 0; b < batch_size; b++) {
-      int32_t cur_sum = 0;
-      const int32_t* cur_mask_data = mask_data + (static_cast<int64_t>(b) * sequence_length);
-      for (int s = 0; s < sequence_length; ++s) {
-        if (cur_mask_data[s] == 1) {
-          cur_sum += cur_mask_data[s];
-        }
-      }
-      mask_index_data[b] = cur_sum;
-    }
-  } else {
-    memset(mask_index->MutableData<int32_t>(), 0, batch_size * sizeof(int32_t));
-  }
+  embed_layer_norm::ComputeMaskIndex((nullptr != mask) ? mask->Data<int32_t>() : nullptr, batch_size,
+                                     sequence_length, mask_index->MutableData<int32_t>(),
+                                     context->GetOperatorThreadPool());
 
   return Status::OK();
 }
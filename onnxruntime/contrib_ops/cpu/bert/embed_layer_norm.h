@@ -5,10 +5,36 @@
 
 #include "core/common/common.h"
 #include "core/framework/op_kernel.h"
+#include "core/platform/threadpool.h"
 
 namespace onnxruntime {
 namespace contrib {
 
+namespace embed_layer_norm {
+
+// Layer normalization of the sum of word, position and segment (optional) embedding rows of one token:
+//   output = (x - mean(x)) / sqrt(variance(x) + epsilon) * gamma + beta, where x = word + position + segment.
+// The first pass writes x to output and embedding_sum (optional), and the second pass normalizes output in place,
+// so that the row stays in cache.
+void NormalizeEmbeddingSum(const float* word,
+                           const float* position,
+                           const float* segment,
+                           const float* gamma,
+                           const float* beta,
+                           float epsilon,
+                           int64_t hidden_size,
+                           float* output,
+                           float* embedding_sum);
+
+// mask_index(B) is the number of ones in each row of mask(B, S), or 0 when there is no mask.
+void ComputeMaskIndex(const int32_t* mask,
+                      int batch_size,
+                      int sequence_length,
+                      int32_t* mask_index,
+                      concurrency::ThreadPool* tp);
+
+}  // namespace embed_layer_norm
+
 class EmbedLayerNormBase : public OpKernel {
  public:
   explicit EmbedLayerNormBase(const OpKernelInfo& op_kernel_info);
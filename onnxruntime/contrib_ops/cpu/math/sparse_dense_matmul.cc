@@ -4,6 +4,8 @@
 #if !defined(DISABLE_SPARSE_TENSORS)
 
 #include "core/framework/sparse_tensor.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
 #include "core/providers/cpu/math/gemm_matmul_common.h"
 #include "core/providers/cpu/math/matmul_helper.h"
 #include "core/util/math.h"
@@ -44,8 +46,26 @@ struct ComputeCtx {
   bool trans_A;
   bool trans_B;
   float alpha;
+  concurrency::ThreadPool* thread_pool;
 };
 
+// Handle float CSR sparse format without transposes using MLAS, which computes rows of the output
+// in parallel and vectorizes the columns.
+void SparseToDenseCsrMlas(const ComputeCtx& ctx, const SparseTensor& A, const Tensor& B, Tensor& output) {
+  const auto& a_dims = A.DenseShape().GetDims();
+  const auto& b_dims = B.Shape().GetDims();
+  auto csr_view = A.AsCsr();
+
+  MLAS_SPARSE_MATRIX sparse_A;
+  sparse_A.BlockRowStart = csr_view.Outer().Data<int64_t>();
+  sparse_A.BlockColumnIndex = csr_view.Inner().Data<int64_t>();
+  sparse_A.BlockValues = A.Values().Data<float>();
+
+  const auto N = static_cast<size_t>(b_dims[1]);
+  MlasSparseGemm(static_cast<size_t>(a_dims[0]), N, sparse_A, ctx.alpha, B.Data<float>(), N,
+                 output.MutableData<float>(), N, ctx.thread_pool);
+}
+
 #if !defined(__i386__) && !defined(_M_IX86) && !defined(__wasm__) && !defined(__ANDROID__)
 template <typename T>
 inline void SparseDenseMatMulImpl(const ComputeCtx& ctx, const ConstSparseMatrixMap<T>& map_A,
@@ -132,19 +152,28 @@ struct SparseToDenseCoo {
     const int rhs_index_a = (ctx.trans_A) ? 0 : 1;
     const auto out_left = out_dims[0];
 
-    // XXX: Make this parallel
     for (size_t i = 0; i < nnz; ++i) {
       const auto m = a_indicies_map(i, lhs_index_a);
       const auto k = a_indicies_map(i, rhs_index_a);
       ORT_RETURN_IF_NOT(k < lhs_right, "COO k index: ", k, " is out of bounds of lhs_right: ", lhs_right);
       ORT_RETURN_IF_NOT(m < out_left, "COO m index: ", m, " is out of bounds of out_left: ", out_left);
-      const T a_value = a_values[i];
-      for (int64_t n = 0; n < rhs_right; ++n) {
-        const T b_value = (ctx.trans_B) ? map_b(n, k) : map_b(k, n);
-        output_map(m, n) += Mul(a_value, ctx.alpha, b_value);
-      }
     }
 
+    // Entries may be in any order, so each thread accumulates all of them into its own range of output columns.
+    concurrency::ThreadPool::TryParallelFor(
+        ctx.thread_pool, rhs_right, static_cast<double>(nnz),
+        [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+          for (size_t i = 0; i < nnz; ++i) {
+            const auto m = a_indicies_map(i, lhs_index_a);
+            const auto k = a_indicies_map(i, rhs_index_a);
+            const T a_value = a_values[i];
+            for (std::ptrdiff_t n = first; n < last; ++n) {
+              const T b_value = (ctx.trans_B) ? map_b(n, k) : map_b(k, n);
+              output_map(m, n) += Mul(a_value, ctx.alpha, b_value);
+            }
+          }
+        });
+
     return Status::OK();
   }
 };
@@ -179,7 +208,7 @@ Status SparseToDenseMatMul::Compute(OpKernelContext* ctx) const {
   utils::MLTypeCallDispatcher<float, double, int32_t, uint32_t, int64_t, uint64_t> t_disp(A->GetElementType());
   // I am not expecting to do the below in every kernel but this is a reference
   // implementation to show the expectations.
-  ComputeCtx compute_ctx{trans_a_attr_ != 0, trans_b_attr_ != 0, alpha_attr_};
+  ComputeCtx compute_ctx{trans_a_attr_ != 0, trans_b_attr_ != 0, alpha_attr_, ctx->GetOperatorThreadPool()};
   if (A->Format() == SparseFormat::kCoo) {
     auto coo_view = A->AsCoo();
     const auto num_dims = coo_view.Indices().Shape().NumDimensions();
@@ -187,6 +216,13 @@ Status SparseToDenseMatMul::Compute(OpKernelContext* ctx) const {
     ORT_RETURN_IF_NOT(A->Values().Shape().Size() * 2 == coo_view.Indices().Shape().Size(), "Expecting 2xValues == indices");
     auto status = t_disp.InvokeRet<Status, SparseToDenseCoo>(compute_ctx, *A, *B, *output);
     ORT_RETURN_IF_ERROR(status);
+  } else if (A->Format() == SparseFormat::kCsrc && A->IsDataType<float>() &&
+             !compute_ctx.trans_A && !compute_ctx.trans_B) {
+    auto csr_view = A->AsCsr();
+    ORT_RETURN_IF_NOT(A->Values().Shape().Size() == csr_view.Inner().Shape().Size(),
+                      "Expecting the same number NNZ == size of Inner indices");
+    ORT_RETURN_IF_NOT((A_shape.GetDims()[0] + 1) == csr_view.Outer().Shape().Size(), "Outer size must be M + 1");
+    SparseToDenseCsrMlas(compute_ctx, *A, *B, *output);
 // Eigen has a bug in x86 where it calculates reallocation size as -1
 // and throws bad_alloc
 #if !defined(__i386__) && !defined(_M_IX86) && !defined(__wasm__) && !defined(__ANDROID__)
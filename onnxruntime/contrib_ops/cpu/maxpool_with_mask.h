@@ -76,7 +76,7 @@ struct MaxpoolWithMask2DTask final {
   const TensorShapeVector& kernel_shape;
   const TensorShapeVector& pads;
   TensorOpCost Cost() {
-    double loop_count = static_cast<double>(pooled_height * kernel_shape[0]);
+    double loop_count = static_cast<double>(pooled_height * pooled_width * kernel_shape[0] * kernel_shape[1]);
     return TensorOpCost{loop_count, loop_count, loop_count};
   }
 
@@ -136,7 +136,8 @@ struct MaxpoolWithMask3DTask final {
   const TensorShapeVector& kernel_shape;
   const TensorShapeVector& pads;
   TensorOpCost Cost() {
-    double loop_count = static_cast<double>(pooled_height * kernel_shape[0]);
+    double loop_count = static_cast<double>(pooled_height * pooled_width * pooled_depth * kernel_shape[0] *
+                                            kernel_shape[1] * kernel_shape[2]);
     return TensorOpCost{loop_count, loop_count, loop_count};
   }
 
@@ -223,6 +224,24 @@ class MaxpoolWithMask : public OpKernel, public PoolBase {
     int64_t pooled_width = kernel_shape.size() > 1 ? output_dims[3] : 1;
     int64_t pooled_depth = kernel_shape.size() > 2 ? output_dims[4] : 1;
 
+    // The tasks stop the innermost loop of a window at the first masked element. When the masked elements form a
+    // suffix of every innermost row, this is the same as pooling an input where they are the lowest value.
+    if (kernel_shape.size() <= 3) {
+      const int64_t row_size = kernel_shape.size() == 1 ? height : (kernel_shape.size() == 2 ? width : depth);
+      AllocatorPtr alloc;
+      ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&alloc));
+      auto masked_input = IAllocator::MakeUniquePtr<float>(alloc, static_cast<size_t>(x_shape.Size()));
+      if (MaskRowSuffixes(X_data, M_data, x_shape[0] * channels, height * width * depth, row_size,
+                          m_shape[0] * m_shape[1], kernel_shape.size() > 1, masked_input.get())) {
+        const int64_t strides[3]{stride_h(), kernel_shape.size() > 1 ? stride_w() : 1,
+                                 kernel_shape.size() > 2 ? stride_d() : 1};
+        MlasMaximumPoolWithIndices(kernel_shape.size(), x_shape.GetDims().data(), kernel_shape.data(), nullptr,
+                                   pads.data(), strides, output_dims.data(), false, masked_input.get(), Y_data,
+                                   nullptr, tp);
+        return Status::OK();
+      }
+    }
+
     switch (kernel_shape.size()) {
       case 1: {
         int64_t x_step = height;
@@ -263,6 +282,31 @@ class MaxpoolWithMask : public OpKernel, public PoolBase {
 
     return Status::OK();
   }
+
+ private:
+  // Returns false if a masked element of an innermost row of the input is followed by an unmasked one. Otherwise,
+  // writes the input with the masked elements replaced by the lowest value to masked_data. As in the tasks, the
+  // first element of a channel is never masked when more than one dimension is pooled.
+  static bool MaskRowSuffixes(const float* X_data, const int32_t* M_data, int64_t total_channels, int64_t x_step,
+                              int64_t row_size, int64_t total_mask_channels, bool keep_first, float* masked_data) {
+    for (int64_t c = 0; c < total_channels; ++c) {
+      const float* x_d = X_data + c * x_step;
+      const int32_t* m_d = M_data + (c * x_step) % total_mask_channels;
+      float* masked_d = masked_data + c * x_step;
+      for (int64_t row = 0; row < x_step; row += row_size) {
+        bool masked = false;
+        for (int64_t i = row; i < row + row_size; ++i) {
+          const bool masked_element = m_d[i] == 0 && !(keep_first && i == 0);
+          if (masked && !masked_element) {
+            return false;
+          }
+          masked = masked_element;
+          masked_d[i] = masked ? std::numeric_limits<float>::lowest() : x_d[i];
+        }
+      }
+    }
+    return true;
+  }
 };
 
 }  // namespace contrib
@@ -1,8 +1,13 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 #include "core/framework/op_kernel.h"
 #include "contrib_ops/cpu/bert/attention_cpu_base.h"
+#include "contrib_ops/cpu/bert/attention_helper.h"
 #include "core/providers/common.h"
 #include "core/util/math.h"
 #include "core/util/qmath.h"
@@ -32,10 +37,17 @@ class QAttention : public OpKernel, public AttentionCPUBase {
                                    /*out*/ bool& used_shared_buffers) override;
 
  private:
+  // Computes the attention with 8 bit integer matrix multiplications instead of ApplyAttention.
+  Status ComputeQuantizedAttention(const T* Q, const T* K, const T* V,
+                                   const Tensor* mask_index, const Tensor* past, Tensor* output,
+                                   int batch_size, int sequence_length, int head_size, int hidden_size,
+                                   OpKernelContext* context) const;
+
   BufferUniquePtr packed_weights_;
   size_t packed_weights_size_;
   TensorShape weight_shape_;
   bool weights_is_signed_;
+  bool quantize_attention_;
 };
 
 // These ops are internal-only, so register outside of onnx
@@ -53,7 +65,9 @@ ONNX_OPERATOR_TYPED_KERNEL_EX(
     QAttention<float>);
 
 template <typename T>
-QAttention<T>::QAttention(const OpKernelInfo& info) : OpKernel(info), AttentionCPUBase(info) {}
+QAttention<T>::QAttention(const OpKernelInfo& info) : OpKernel(info), AttentionCPUBase(info) {
+  quantize_attention_ = info.GetAttrOrDefault<int64_t>("quantize_attention", 0) != 0;
+}
 
 template <typename T>
 Status QAttention<T>::PrePack(const Tensor& weights, int input_idx, AllocatorPtr alloc,
@@ -284,11 +298,171 @@ Status QAttention<T>::Compute(OpKernelContext* context) const {
     MlasGemmBatch(gemm_shape, gemm_data_vec.data(), loop_len, tp);
   }
 
+  if (quantize_attention_ && window_ == 0) {
+    return ComputeQuantizedAttention(Q, K, V, mask_index, past_tensor, output,
+                                     batch_size, sequence_length, head_size, hidden_size, context);
+  }
+
   // Compute the attention score and apply the score to V
   return ApplyAttention(Q, K, V, mask_index, past_tensor, output,
                         batch_size, sequence_length,
                         head_size, head_size, hidden_size, nullptr, context);
 }
 
+template <typename T>
+Status QAttention<T>::ComputeQuantizedAttention(const T* Q, const T* K, const T* V,
+                                                const Tensor* mask_index, const Tensor* past, Tensor* output,
+                                                int batch_size, int sequence_length, int head_size, int hidden_size,
+                                                OpKernelContext* context) const {
+  auto* tp = context->GetOperatorThreadPool();
+
+  int past_sequence_length = 0;
+  Tensor* present = GetPresent(context, past, batch_size, head_size, sequence_length, past_sequence_length);
+
+  const int all_sequence_length = past_sequence_length + sequence_length;                 // S* = S' + S
+  const size_t past_chunk_length = static_cast<size_t>(past_sequence_length) * head_size;  // S' x H
+  const size_t input_chunk_length = static_cast<size_t>(sequence_length) * head_size;      // S x H
+  const size_t present_chunk_length = past_chunk_length + input_chunk_length;              // S* x H
+  const size_t scores_length = static_cast<size_t>(sequence_length) * all_sequence_length;  // S x S*
+  const std::ptrdiff_t loop_len = static_cast<std::ptrdiff_t>(batch_size) * num_heads_;
+
+  // Mask (B)xSxS* with 0 for attended positions and -10000.0 for masked ones.
+  const bool has_unidirectional = (is_unidirectional_ && sequence_length > 1);
+  std::vector<T> mask_data;
+  if (mask_index != nullptr || has_unidirectional) {
+    mask_data.assign(static_cast<size_t>(batch_size) * scores_length, static_cast<T>(0.0f));
+    PrepareMask(mask_index != nullptr ? mask_index->Data<int32_t>() : nullptr,
+                mask_index != nullptr ? mask_index->Shape().GetDims() : gsl::span<const int64_t>{},
+                mask_data.data(), has_unidirectional, batch_size, sequence_length, past_sequence_length);
+  }
+
+  const T* past_data = past != nullptr ? past->Data<T>() : nullptr;
+  T* present_data = present != nullptr ? present->MutableData<T>() : nullptr;
+  T* output_data = output->MutableData<T>();
+  const float alpha = 1.0f / std::sqrt(static_cast<float>(head_size));
+
+  // Q of each head, each row of K and each column of V are quantized to uint8 with their own scale and zero point,
+  // so that scores and output are dequantized per column by the output processors of QGEMM. Attention
+  // probabilities are in [0, 1] and quantized to uint8 with a scale of 1/255.
+  constexpr float probs_scale = 1.0f / 255.0f;
+
+  const double cost = static_cast<double>(scores_length) * head_size * 2;
+  ThreadPool::TryParallelFor(tp, loop_len, cost, [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+    std::vector<uint8_t> q_quantized(input_chunk_length);
+    std::vector<uint8_t> k_quantized(present_chunk_length);
+    std::vector<uint8_t> k_transposed(present_chunk_length);
+    std::vector<T> v_transposed(present_chunk_length);
+    std::vector<uint8_t> v_quantized(present_chunk_length);
+    std::vector<uint8_t> v_quantized_transposed(present_chunk_length);
+    std::vector<T> scores(scores_length);
+    std::vector<uint8_t> probs_quantized(scores_length);
+    std::vector<float> k_scales(all_sequence_length);
+    std::vector<uint8_t> k_zero_points(all_sequence_length);
+    std::vector<float> v_scales(head_size);
+    std::vector<uint8_t> v_zero_points(head_size);
+
+    for (std::ptrdiff_t i = begin; i != end; ++i) {
+      const int batch_index = static_cast<int>(i / num_heads_);
+      const int head_index = static_cast<int>(i % num_heads_);
+
+      // Keys and values of all positions: (BxNx)S*xH
+      const T* k = K + input_chunk_length * i;
+      const T* v = V + input_chunk_length * i;
+      if (present_data != nullptr) {
+        k = ConcatStateChunk(past_data, k, present_data, past_chunk_length, present_chunk_length, i);
+        v = ConcatStateChunk(past_data != nullptr ? past_data + loop_len * past_chunk_length : nullptr, v,
+                             present_data + loop_len * present_chunk_length,
+                             past_chunk_length, present_chunk_length, i);
+      }
+
+      float q_scale;
+      uint8_t q_zero_point;
+      const T* q = Q + input_chunk_length * i;
+      GetQuantizationParameter(q, static_cast<int64_t>(input_chunk_length), q_scale, q_zero_point, nullptr);
+      MlasQuantizeLinear(q, q_quantized.data(), input_chunk_length, q_scale, q_zero_point);
+
+      // K is transposed to H rows of S*, the layout of B in QGEMM, after its rows are quantized.
+      for (int j = 0; j < all_sequence_length; j++) {
+        const T* k_row = k + static_cast<size_t>(j) * head_size;
+        GetQuantizationParameter(k_row, head_size, k_scales[j], k_zero_points[j], nullptr);
+        MlasQuantizeLinear(k_row, k_quantized.data() + static_cast<size_t>(j) * head_size, head_size,
+                           k_scales[j], k_zero_points[j]);
+        k_scales[j] *= alpha * q_scale;
+      }
+      MlasTranspose(k_quantized.data(), k_transposed.data(), static_cast<size_t>(all_sequence_length),
+                    static_cast<size_t>(head_size));
+
+      // Columns of V are quantized as rows of V'.
+      MlasTranspose(v, v_transposed.data(), static_cast<size_t>(all_sequence_length), static_cast<size_t>(head_size));
+      for (int j = 0; j < head_size; j++) {
+        const T* v_row = v_transposed.data() + static_cast<size_t>(j) * all_sequence_length;
+        GetQuantizationParameter(v_row, all_sequence_length, v_scales[j], v_zero_points[j], nullptr);
+        MlasQuantizeLinear(v_row, v_quantized_transposed.data() + static_cast<size_t>(j) * all_sequence_length,
+                           all_sequence_length, v_scales[j], v_zero_points[j]);
+        v_scales[j] *= probs_scale;
+      }
+      MlasTranspose(v_quantized_transposed.data(), v_quantized.data(), static_cast<size_t>(head_size),
+                    static_cast<size_t>(all_sequence_length));
+
+      // scores(S, S*) = 1/sqrt(H) x Q(S, H) x K'(H, S*), dequantized by the output processor
+      MLAS_QGEMM_SCALE_BIAS_OUTPUT_PROCESSOR scores_processor(scores.data(), all_sequence_length, k_scales.data(),
+                                                              nullptr, MLAS_QGEMM_OUTPUT_MODE::ZeroMode,
+                                                              MLAS_QUANTIZATION_GRANULARITY::PerColumn);
+      MLAS_GEMM_QUANT_SHAPE_PARAMS scores_shape;
+      scores_shape.M = sequence_length;
+      scores_shape.N = all_sequence_length;
+      scores_shape.K = head_size;
+
+      MLAS_GEMM_QUANT_DATA_PARAMS scores_params;
+      scores_params.A = q_quantized.data();
+      scores_params.lda = head_size;
+      scores_params.ZeroPointA = q_zero_point;
+      scores_params.B = k_transposed.data();
+      scores_params.ldb = all_sequence_length;
+      scores_params.ZeroPointB = k_zero_points.data();
+      scores_params.PerColumnZeroPoints = true;
+      scores_params.C = reinterpret_cast<int32_t*>(scores.data());
+      scores_params.ldc = all_sequence_length;
+      scores_params.OutputProcessor = &scores_processor;
+      MlasGemm(scores_shape, scores_params, nullptr);
+
+      if (!mask_data.empty()) {
+        const T* mask = mask_data.data() + static_cast<size_t>(batch_index) * scores_length;
+        for (size_t j = 0; j < scores_length; j++) {
+          scores[j] += mask[j];
+        }
+      }
+
+      ComputeAttentionSoftmaxInplace(scores.data(), sequence_length, all_sequence_length, nullptr);
+      MlasQuantizeLinear(scores.data(), probs_quantized.data(), scores_length, probs_scale, static_cast<uint8_t>(0));
+
+      // output(S, H) = probs(S, S*) x V(S*, H), written to (B, S, N, H) directly.
+      T* out = output_data + static_cast<size_t>(batch_index) * sequence_length * hidden_size +
+               static_cast<size_t>(head_index) * head_size;
+      MLAS_QGEMM_SCALE_BIAS_OUTPUT_PROCESSOR output_processor(out, hidden_size, v_scales.data(), nullptr,
+                                                              MLAS_QGEMM_OUTPUT_MODE::ZeroMode,
+                                                              MLAS_QUANTIZATION_GRANULARITY::PerColumn);
+      MLAS_GEMM_QUANT_SHAPE_PARAMS output_shape;
+      output_shape.M = sequence_length;
+      output_shape.N = head_size;
+      output_shape.K = all_sequence_length;
+
+      MLAS_GEMM_QUANT_DATA_PARAMS output_params;
+      output_params.A = probs_quantized.data();
+      output_params.lda = all_sequence_length;
+      output_params.B = v_quantized.data();
+      output_params.ldb = head_size;
+      output_params.ZeroPointB = v_zero_points.data();
+      output_params.PerColumnZeroPoints = true;
+      output_params.C = reinterpret_cast<int32_t*>(out);
+      output_params.ldc = hidden_size;
+      output_params.OutputProcessor = &output_processor;
+      MlasGemm(output_shape, output_params, nullptr);
+    }
+  });
+
+  return Status::OK();
+}
+
 }  // namespace contrib
 }  // namespace onnxruntime
@@ -7,11 +7,12 @@
 #include "core/common/safeint.h"
 #include "core/util/math.h"
 #include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
 
 namespace onnxruntime {
 namespace contrib {
 
-template <typename T8Bits>
+template <typename T>
 class NhwcMaxPool : public OpKernel {
  public:
   explicit NhwcMaxPool(const OpKernelInfo& info) : OpKernel(info),
@@ -24,8 +25,8 @@ class NhwcMaxPool : public OpKernel {
   PoolAttributes pool_attrs_;
 };
 
-template <typename T8Bits>
-Status NhwcMaxPool<T8Bits>::Compute(OpKernelContext* context) const {
+template <typename T>
+Status NhwcMaxPool<T>::Compute(OpKernelContext* context) const {
   const auto* X = context->Input<Tensor>(0);
   const TensorShape& input_shape = X->Shape();
 
@@ -70,23 +71,43 @@ Status NhwcMaxPool<T8Bits>::Compute(OpKernelContext* context) const {
 
   constexpr int64_t output_batch_count = 512;
 
+  // Each unit of work produces up to output_batch_count output pixels of one
+  // image. The units are split across the workers of the thread pool and each
+  // worker uses its own slice of the indirection buffer.
+  const int64_t output_block_count = (output_image_size + output_batch_count - 1) / output_batch_count;
+  const std::ptrdiff_t total_work = static_cast<std::ptrdiff_t>(N * output_block_count);
+  if (total_work == 0) {
+    return Status::OK();
+  }
+
+  concurrency::ThreadPool* thread_pool = context->GetOperatorThreadPool();
+  const std::ptrdiff_t worker_count =
+      std::min<std::ptrdiff_t>(concurrency::ThreadPool::DegreeOfParallelism(thread_pool), total_work);
+
   // Allocate indirection buffer pointers and prepare a padding vector for the
   // im2col transform.
   AllocatorPtr alloc;
   ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&alloc));
-  int64_t col_buffer_batch_count = std::min(output_image_size, output_batch_count);
-  auto* col_data = alloc->Alloc(SafeInt<size_t>(sizeof(const T8Bits*)) * kernel_size * col_buffer_batch_count);
+  const int64_t col_buffer_batch_count = std::min(output_image_size, output_batch_count);
+  const size_t col_buffer_worker_size = SafeInt<size_t>(kernel_size) * col_buffer_batch_count;
+  auto* col_data = alloc->Alloc(SafeInt<size_t>(sizeof(const T*)) * col_buffer_worker_size * worker_count);
   BufferUniquePtr col_buffer(col_data, BufferDeleter(std::move(alloc)));
-  std::vector<T8Bits> padding_data(static_cast<size_t>(C), std::numeric_limits<T8Bits>::lowest());
+  std::vector<T> padding_data(static_cast<size_t>(C), std::numeric_limits<T>::lowest());
+
+  const auto* Xdata = X->Data<T>();
+  auto* Ydata = Y->MutableData<T>();
 
-  const auto* Xdata = X->Data<T8Bits>();
-  auto* Ydata = Y->MutableData<T8Bits>();
+  auto pool_worker = [&](std::ptrdiff_t worker) {
+    auto work = concurrency::ThreadPool::PartitionWork(worker, worker_count, total_work);
+    T const** worker_col_buffer = static_cast<T const**>(col_buffer.get()) + worker * col_buffer_worker_size;
 
-  for (int64_t image_id = 0; image_id < N; ++image_id) {
-    for (int64_t output_start = 0; output_start < output_image_size;) {
-      int64_t output_count = std::min(output_image_size - output_start, output_batch_count);
-      math::Im2col<T8Bits, StorageOrder::NHWC>()(
-          Xdata,
+    for (std::ptrdiff_t work_index = work.start; work_index < work.end; ++work_index) {
+      const int64_t image_id = work_index / output_block_count;
+      const int64_t output_start = (work_index % output_block_count) * output_batch_count;
+      const int64_t output_count = std::min(output_image_size - output_start, output_batch_count);
+
+      math::Im2col<T, StorageOrder::NHWC>()(
+          Xdata + image_id * input_image_size * C,
           C,
           input_shape.GetDims().data() + 1,
           output_dims.data() + 1,
@@ -97,21 +118,18 @@ Status NhwcMaxPool<T8Bits>::Compute(OpKernelContext* context) const {
           static_cast<ptrdiff_t>(spatial_dims),
           output_start,
           output_count,
-          static_cast<T8Bits const**>(col_buffer.get()),
+          worker_col_buffer,
           padding_data.data());
       MlasMaximumPool(
-          static_cast<T8Bits const**>(col_buffer.get()),
-          Ydata,
+          worker_col_buffer,
+          Ydata + (image_id * output_image_size + output_start) * C,
           static_cast<size_t>(C),
           static_cast<size_t>(output_count),
           static_cast<size_t>(kernel_size));
-
-      Ydata += output_count * C;
-      output_start += output_count;
     }
+  };
 
-    Xdata += input_image_size * C;
-  }
+  concurrency::ThreadPool::TrySimpleParallelFor(thread_pool, worker_count, pool_worker);
 
   return Status::OK();
 }
@@ -127,6 +145,7 @@ Status NhwcMaxPool<T8Bits>::Compute(OpKernelContext* context) const {
           .TypeConstraint("T", DataTypeImpl::GetTensorType<T>()), \
       NhwcMaxPool<T>);
 
+REGISTER_NHWCMAXPOOL_TYPED_KERNEL(float);
 REGISTER_NHWCMAXPOOL_TYPED_KERNEL(int8_t);
 REGISTER_NHWCMAXPOOL_TYPED_KERNEL(uint8_t);
 
@@ -3,18 +3,34 @@
 
 #include "qembed_layer_norm.h"
 
+#include <atomic>
 #include <cmath>
+#include <vector>
 
+#include "contrib_ops/cpu/bert/embed_layer_norm.h"
 #include "contrib_ops/cpu/bert/embed_layer_norm_helper.h"
 #include "core/framework/op_kernel.h"
 #include "core/providers/common.h"
 #include "core/quantization/quantization.h"
+#include "core/util/math_cpuonly.h"
 
 namespace onnxruntime {
 namespace contrib {
 
 namespace {
 
+// Dequantize a row of an embedding table with Eigen, so that it is vectorized.
+template <typename QuantizedType>
+void DequantizeRow(const QuantizedType* row,
+                   int64_t hidden_size,
+                   const quantization::Params<QuantizedType>& params,
+                   float* output) {
+  EigenVectorArrayMap<float>(output, hidden_size) =
+      (ConstEigenVectorArrayMap<QuantizedType>(row, hidden_size).template cast<float>() -
+       static_cast<float>(params.zero_point)) *
+      params.scale;
+}
+
 template <typename T, typename QuantizedType>
 Status ComputeInternal(OpKernelContext* context, float epsilon) {
   const Tensor* input_ids = context->Input<Tensor>(0);
@@ -86,80 +102,61 @@ Status ComputeInternal(OpKernelContext* context, float epsilon) {
 
   T* output_data = output->MutableData<T>();
 
+  // gamma and beta are dequantized once.
+  std::vector<float> gamma_beta(2 * hidden_size);
+  DequantizeRow(gamma_data, hidden_size, gamma_params, gamma_beta.data());
+  DequantizeRow(beta_data, hidden_size, beta_params, gamma_beta.data() + hidden_size);
+
   // Perform the Op:
   {
     std::atomic_bool failed{false};
 
-    // TODO: Profile and tune this batch parallel execution based on input size.
-    // More info: https://github.com/microsoft/onnxruntime/pull/8124/files#r656629895
     int n = batch_size * sequence_length;
-    concurrency::ThreadPool::TryBatchParallelFor(
-        context->GetOperatorThreadPool(), n, [=, &failed](ptrdiff_t index) {
-          int word_col_index = input_ids_data[index];
-          if (word_col_index < 0 || word_col_index >= word_embedding_length) {
-            failed.store(true, std::memory_order_release);
-            return;
-          }
-          int position_col_index = index % sequence_length;
-          if (position_col_index >= position_embedding_length) {
-            failed.store(true, std::memory_order_release);
-            return;
-          }
-          int segment_col_index = 0;
-          if (nullptr != segment_ids_data) {
-            segment_col_index = segment_ids_data[index];
-            if (segment_col_index < 0 || segment_col_index >= segment_embedding_length) {
+    const double cost = static_cast<double>(hidden_size) * 8.0;
+    concurrency::ThreadPool::TryParallelFor(
+        context->GetOperatorThreadPool(), n, cost, [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+          // Dequantized rows of word, position and segment embedding.
+          std::vector<float> buffer(3 * hidden_size);
+          float* word_buffer = buffer.data();
+          float* position_buffer = word_buffer + hidden_size;
+          float* segment_buffer = position_buffer + hidden_size;
+
+          for (std::ptrdiff_t index = begin; index != end; ++index) {
+            int word_col_index = input_ids_data[index];
+            if (word_col_index < 0 || word_col_index >= word_embedding_length) {
               failed.store(true, std::memory_order_release);
               return;
             }
-          }
-
-          // Grab inputs for the embeddings for the current batch index:
-          const QuantizedType* input_word_embedding =
-              word_embedding_data + word_col_index * hidden_size;
-          const QuantizedType* input_position_embedding =
-              position_embedding_data + position_col_index * hidden_size;
-          const QuantizedType* input_segment_embedding = nullptr;
-          if (segment_embedding_data != nullptr) {
-            input_segment_embedding =
-                segment_embedding_data + segment_col_index * hidden_size;
-          }
-
-          T* output = output_data + (index * hidden_size);
+            int position_col_index = static_cast<int>(index % sequence_length);
+            if (position_col_index >= position_embedding_length) {
+              failed.store(true, std::memory_order_release);
+              return;
+            }
+            int segment_col_index = 0;
+            if (nullptr != segment_ids_data) {
+              segment_col_index = segment_ids_data[index];
+              if (segment_col_index < 0 || segment_col_index >= segment_embedding_length) {
+                failed.store(true, std::memory_order_release);
+                return;
+              }
+            }
 
-          T sum = static_cast<T>(0);
-          for (int i = 0; i < hidden_size; ++i) {
-            // TODO(kreeger): Use a table query to improve performance:
-            T subtotal = quantization::Dequantize<QuantizedType>(input_word_embedding[i],
-                                                                 word_embedding_params) +
-                         quantization::Dequantize<QuantizedType>(input_position_embedding[i],
-                                                                 position_embedding_params);
+            // Dequantize the embeddings of the current token:
+            DequantizeRow(word_embedding_data + word_col_index * hidden_size, hidden_size,
+                          word_embedding_params, word_buffer);
+            DequantizeRow(position_embedding_data + position_col_index * hidden_size, hidden_size,
+                          position_embedding_params, position_buffer);
             if (segment_embedding_data != nullptr) {
-              subtotal += quantization::Dequantize<QuantizedType>(input_segment_embedding[i],
-                                                                  segment_embedding_params);
+              DequantizeRow(segment_embedding_data + segment_col_index * hidden_size, hidden_size,
+                            segment_embedding_params, segment_buffer);
             }
-            output[i] = subtotal;
-            sum += subtotal;
-          }
-
-          T mean = sum / hidden_size;
-          sum = 0;
 
-          for (int i = 0; i < hidden_size; i++) {
-            T a = output[i] - mean;
-            output[i] = a;
-            sum += a * a;
+            embed_layer_norm::NormalizeEmbeddingSum(word_buffer, position_buffer,
+                                                    segment_embedding_data != nullptr ? segment_buffer : nullptr,
+                                                    gamma_beta.data(), gamma_beta.data() + hidden_size, epsilon,
+                                                    hidden_size, output_data + index * hidden_size, nullptr);
           }
-
-          T e = sqrt(sum / hidden_size + epsilon);
-          for (int i = 0; i < hidden_size; i++) {
-            // TODO(kreeger): Consider keeping these as int8 or use PrePack()!
-            T cur_gamma = quantization::Dequantize<QuantizedType>(gamma_data[i], gamma_params);
-            T cur_beta = quantization::Dequantize<QuantizedType>(beta_data[i], beta_params);
-            output[i] = output[i] / e * cur_gamma + cur_beta;
-          }
-        },
-        0);
+        });
 
     if (failed.load(std::memory_order_acquire)) {
       return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "input index out of range");
@@ -167,22 +164,9 @@ Status ComputeInternal(OpKernelContext* context, float epsilon) {
   }
 
   // Calculate mask
-  if (nullptr != mask) {
-    const int32_t* mask_data = mask->Data<int32_t>();
-    int32_t* mask_index_data = mask_index->MutableData<int32_t>();
-    for (int b = 0; b < batch_size; b++) {
-      int32_t cur_sum = 0;
-      const int32_t* cur_mask_data = mask_data + (static_cast<int64_t>(b) * sequence_length);
-      for (int s = 0; s < sequence_length; ++s) {
-        if (cur_mask_data[s] == 1) {
-          cur_sum += cur_mask_data[s];
-        }
-      }
-      mask_index_data[b] = cur_sum;
-    }
-  } else {
-    memset(mask_index->MutableData<int32_t>(), 0, batch_size * sizeof(int32_t));
-  }
+  embed_layer_norm::ComputeMaskIndex((nullptr != mask) ? mask->Data<int32_t>() : nullptr, batch_size,
+                                     sequence_length, mask_index->MutableData<int32_t>(),
+                                     context->GetOperatorThreadPool());
   return Status::OK();
 }
 
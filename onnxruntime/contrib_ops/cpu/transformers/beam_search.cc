@@ -87,6 +87,7 @@ Status BeamSearch::SetupSubgraphExecutionInfo(const SessionState& session_state,
                                         gpt_subgraph_->num_heads,
                                         gpt_subgraph_->head_size,
                                         gpt_subgraph_->num_layers);
+      gpt_subgraph_->EnablePrefixCache(static_cast<size_t>(parameters_.prefix_cache_size));
     }
   } else if (parameters_.model_type == IBeamSearchParameters::kModelTypeT5) {
     if (attribute_name == "encoder") {
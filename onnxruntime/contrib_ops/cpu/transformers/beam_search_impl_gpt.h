@@ -80,6 +80,7 @@ Status BeamSearchGpt<T>::CreateInitialFeeds(gsl::span<int32_t>& sequence_lengths
                                           this->implicit_inputs_,
                                           this->parameters_->num_beams,
                                           this->parameters_->pad_token_id,
+                                          this->parameters_->max_length,
                                           sequence_lengths,
                                           expanded_input_ids,
                                           feeds,
@@ -108,7 +109,8 @@ Status BeamSearchGpt<T>::UpdateFeeds(
                             beam_indices,
                             this->parameters_->num_beams,
                             gpt_subgraph_.GetFirstPastInputIndex(),
-                            gpt_subgraph_.GetFirstPresentOutputIndex());
+                            gpt_subgraph_.GetFirstPresentOutputIndex(),
+                            gpt_subgraph_.IsPastPresentShareBuffer());
 }
 
 template <typename T>
@@ -133,7 +135,8 @@ Status BeamSearchGpt<T>::Execute(const FeedsFetchesManager& feeds_fetches_manage
   this->parameters_->output_scores = (output_scores != nullptr);
 
   std::vector<OrtValue> feeds;
-  // TODO(tianleiwu): allocate fetches. use ping-pong buffers for past state.
+  // Fetches are allocated by the subgraph, except present state that shares buffers with past state
+  // when the subgraph supports it (see GptSubgraph::PrepareFetches).
   std::vector<OrtValue> fetches;
 
   // Initialize resources
@@ -189,6 +192,9 @@ Status BeamSearchGpt<T>::Execute(const FeedsFetchesManager& feeds_fetches_manage
 #ifdef DEBUG_GENERATION
   const IConsoleDumper* dumper = this->GetConsoleDumper();
 #endif
+  // Reuse past state of prompt prefix that was computed in previous runs.
+  gpt_subgraph_.UsePrefixCache(cpu_state.sequence_lengths, parameters->num_beams, feeds, this->context_.Logger());
+
   // Position ids for all iterations except the first. It uses memory buffer owned by next_positions.
   OrtValue position_ids;
   int64_t dims[] = {parameters->BatchBeamSize(), 1};
@@ -217,6 +223,7 @@ Status BeamSearchGpt<T>::Execute(const FeedsFetchesManager& feeds_fetches_manage
     }
 #endif
 
+    gpt_subgraph_.PrepareFetches(feeds, fetches);
     status = utils::ExecuteSubgraph(this->decoder_session_state_,
                                     feeds_fetches_manager,
                                     feeds,
@@ -228,6 +235,11 @@ Status BeamSearchGpt<T>::Execute(const FeedsFetchesManager& feeds_fetches_manage
 
     ORT_RETURN_IF_ERROR(status);
 
+    if (iteration_counter == 1) {
+      gpt_subgraph_.UpdatePrefixCache(cpu_state.sequence_lengths, parameters->num_beams,
+                                      expanded_input_ids_in_cpu, feeds, fetches);
+    }
+
     const OrtValue& logits = fetches[0];
     gsl::span<int32_t> beam_next_tokens;
     gsl::span<int32_t> beam_indices;
@@ -24,6 +24,8 @@ void BeamSearchParameters::ParseFromAttributes(const OpKernelInfo& info) {
   pad_token_id = static_cast<int>(info.GetAttrOrDefault<int64_t>("pad_token_id", -1));
   decoder_start_token_id = static_cast<int>(info.GetAttrOrDefault<int64_t>("decoder_start_token_id", -1));
   no_repeat_ngram_size = static_cast<int>(info.GetAttrOrDefault<int64_t>("no_repeat_ngram_size", 0));
+  prefix_cache_size = info.GetAttrOrDefault<int64_t>("prefix_cache_size", 0);
+  ORT_ENFORCE(prefix_cache_size >= 0, "prefix_cache_size shall not be negative, got ", prefix_cache_size);
 }
 
 void BeamSearchParameters::ParseFromInputs(OpKernelContext* context) {
@@ -20,6 +20,9 @@ struct BeamSearchParameters : public IBeamSearchParameters {
   void ParseFromInputs(OpKernelContext* context);
 
   void SetSubgraphParameters(int vocab_size, int num_heads, int head_size, int num_layers);
+
+  // Memory budget in bytes of the cache of past state for prompt prefixes. 0 disables the cache.
+  int64_t prefix_cache_size = 0;
 };
 
 }  // namespace transformers
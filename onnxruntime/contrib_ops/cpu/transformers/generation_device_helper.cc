@@ -11,6 +11,7 @@
 #include "contrib_ops/cpu/transformers/sequences.h"
 #include "contrib_ops/cpu/transformers/beam_search_scorer.h"
 #include "contrib_ops/cpu/transformers/generation_device_helper.h"
+#include "contrib_ops/cpu/transformers/sampling_cpu_helper.h"
 #include "contrib_ops/cpu/transformers/subgraph_t5_decoder.h"
 #include "contrib_ops/cpu/transformers/subgraph_gpt.h"
 
@@ -436,6 +437,18 @@ Status GreedySearchProcessLogits(
   dumper->Print("next_token_scores after logits processor", next_token_scores.data(), batch_size, 1, vocab_size);
 #endif
 
+  if (parameters->do_sample) {
+    // next_tokens = torch.multinomial(softmax(top_k_top_p_filtering(scores / temperature)), num_samples=1)
+    SamplingCpuHelper::SampleNextTokens(next_token_scores,
+                                        greedy_state->sampling_probs,
+                                        greedy_state->sampling_indices,
+                                        greedy_state->next_tokens_cpu,
+                                        *parameters,
+                                        greedy_state->generator,
+                                        thread_pool);
+    return Status::OK();
+  }
+
   // next_tokens = torch.argmax(scores, dim=-1)
   int64_t next_token_scores_dims[] = {static_cast<int64_t>(batch_size), vocab_size};
   TensorShape next_token_scores_shape(&next_token_scores_dims[0], 2);
@@ -531,6 +544,84 @@ void PickGptPastState(const std::vector<OrtValue>& last_outputs,
   }
 }
 
+// Reorder the valid part of past state in place for GPT model when past and present share max length buffers.
+// Only beams whose source beam differs are rewritten. A source beam is staged in a temporary buffer only when its
+// own state is overwritten by the reorder, so beams that keep their state cost nothing.
+template <typename T>
+void ReorderGptPastStateInPlace(std::vector<OrtValue>& next_inputs,
+                                gsl::span<const int32_t>& beam_indices,
+                                int gpt_subgraph_first_past_input_idx,
+                                int num_layers,
+                                int past_sequence_length,
+                                AllocatorPtr allocator) {
+  const size_t batch_beam_size = beam_indices.size();
+  std::vector<int> staged_slot(batch_beam_size, -1);
+  int staged_count = 0;
+  bool has_reorder = false;
+  for (size_t j = 0; j < batch_beam_size; j++) {
+    const size_t beam_index = static_cast<size_t>(beam_indices[j]);
+    if (beam_index != j) {
+      has_reorder = true;
+      if (static_cast<size_t>(beam_indices[beam_index]) != beam_index && staged_slot[beam_index] < 0) {
+        staged_slot[beam_index] = staged_count++;
+      }
+    }
+  }
+
+  if (!has_reorder || past_sequence_length == 0) {
+    return;
+  }
+
+  // shape is like (2, batch_beam_size, 12, max_length, 64)
+  const TensorShape& past_shape = next_inputs[gpt_subgraph_first_past_input_idx].Get<Tensor>().Shape();
+  const size_t num_heads = static_cast<size_t>(past_shape[2]);
+  const size_t head_size = static_cast<size_t>(past_shape[4]);
+  const size_t max_chunk_length = static_cast<size_t>(past_shape[3]) * head_size;
+  const size_t valid_chunk_length = static_cast<size_t>(past_sequence_length) * head_size;
+  const size_t block_size_per_beam = num_heads * max_chunk_length;
+  const size_t past_key_size = batch_beam_size * block_size_per_beam;
+  const size_t staged_size_per_beam = 2 * num_heads * valid_chunk_length;
+
+  IAllocatorUniquePtr<T> staged_buffer;
+  if (staged_count > 0) {
+    staged_buffer = IAllocator::MakeUniquePtr<T>(allocator, SafeInt<size_t>(staged_count) * staged_size_per_beam);
+  }
+
+  for (int i = 0; i < num_layers; ++i) {
+    T* past_data = next_inputs[gpt_subgraph_first_past_input_idx + i].GetMutable<Tensor>()->MutableData<T>();
+
+    // Key and value of one beam: 2 x num_heads chunks of valid_chunk_length elements.
+    auto beam_chunk = [&](size_t beam, size_t k) {
+      return past_data + (k / num_heads) * past_key_size + beam * block_size_per_beam +
+             (k % num_heads) * max_chunk_length;
+    };
+
+    for (size_t beam = 0; beam < batch_beam_size; beam++) {
+      if (staged_slot[beam] >= 0) {
+        T* staged = staged_buffer.get() + static_cast<size_t>(staged_slot[beam]) * staged_size_per_beam;
+        for (size_t k = 0; k < 2 * num_heads; k++) {
+          memcpy(staged + k * valid_chunk_length, beam_chunk(beam, k), valid_chunk_length * sizeof(T));
+        }
+      }
+    }
+
+    for (size_t j = 0; j < batch_beam_size; j++) {
+      const size_t beam_index = static_cast<size_t>(beam_indices[j]);
+      if (beam_index == j) {
+        continue;
+      }
+
+      for (size_t k = 0; k < 2 * num_heads; k++) {
+        const T* source = staged_slot[beam_index] >= 0
+                              ? staged_buffer.get() + static_cast<size_t>(staged_slot[beam_index]) * staged_size_per_beam +
+                                    k * valid_chunk_length
+                              : beam_chunk(beam_index, k);
+        memcpy(beam_chunk(j, k), source, valid_chunk_length * sizeof(T));
+      }
+    }
+  }
+}
+
 template <typename T>
 Status UpdateGptFeeds(
     AllocatorPtr allocator,
@@ -544,7 +635,8 @@ Status UpdateGptFeeds(
     gsl::span<const int32_t> beam_indices,
     int num_beams,
     int gpt_subgraph_first_past_input_idx,
-    int gpt_subgraph_first_present_output_idx) {
+    int gpt_subgraph_first_present_output_idx,
+    bool past_present_share_buffer) {
   // last_outputs: logits, present_0, present_1, ...
   // next_inputs: input_ids, position_id, attention_mask, past_0, past_1
   ORT_UNUSED_PARAMETER(stream);
@@ -591,7 +683,17 @@ Status UpdateGptFeeds(
   next_inputs[2] = attention_mask;
 
   // Update past state
-  if (num_beams == 1) {
+  if (past_present_share_buffer) {
+    // present_* outputs were written in place into the past_* buffers. Reorder beams and advance the valid length.
+    const int num_layers = static_cast<int>(last_outputs.size()) - gpt_subgraph_first_present_output_idx;
+    const int past_sequence_length = current_length - 1;
+    if (num_beams > 1) {
+      ReorderGptPastStateInPlace<T>(next_inputs, beam_indices, gpt_subgraph_first_past_input_idx,
+                                    num_layers, past_sequence_length, allocator);
+    }
+    OrtValue& past_sequence_length_value = next_inputs[gpt_subgraph_first_past_input_idx + num_layers];
+    *past_sequence_length_value.GetMutable<Tensor>()->MutableData<int32_t>() = past_sequence_length;
+  } else if (num_beams == 1) {
     // feed present_* output to past_* inputs one by one
     const int k = gpt_subgraph_first_past_input_idx - gpt_subgraph_first_present_output_idx;
     for (size_t i = gpt_subgraph_first_present_output_idx; i < last_outputs.size(); ++i) {
@@ -851,7 +953,8 @@ template Status UpdateGptFeeds<float>(
     gsl::span<const int32_t> beam_indices,
     int num_beams,
     int gpt_subgraph_first_past_input_idx,
-    int gpt_subgraph_first_present_output_idx);
+    int gpt_subgraph_first_present_output_idx,
+    bool past_present_share_buffer);
 
 template Status UpdateDecoderFeeds<float>(
     AllocatorPtr allocator,
@@ -120,7 +120,8 @@ using UpdateGptFeedsFunc = std::function<Status(
     gsl::span<const int32_t> beam_indices,
     int num_beams,
     int gpt_subgraph_first_past_input_idx,
-    int gpt_subgraph_first_present_output_idx)>;
+    int gpt_subgraph_first_present_output_idx,
+    bool past_present_share_buffer)>;
 
 // Create encoder inputs (for encoder-decoder model like T5).
 using CreateEncoderInputsFunc = std::function<Status(
@@ -248,7 +249,8 @@ Status UpdateGptFeeds(
     gsl::span<const int32_t> beam_indices,
     int num_beams,
     int gpt_subgraph_first_past_input_idx,
-    int gpt_subgraph_first_present_output_idx);
+    int gpt_subgraph_first_present_output_idx,
+    bool past_present_share_buffer);
 
 // ---------------------------------------------------------------
 // Functions for encoder-decoder model like T5
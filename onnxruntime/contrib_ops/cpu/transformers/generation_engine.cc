@@ -0,0 +1,407 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <utility>
+#include "core/common/safeint.h"
+#include "core/framework/session_state.h"
+#include "core/framework/tensor.h"
+#include "core/framework/utils.h"
+#include "contrib_ops/cpu/transformers/generation_engine.h"
+#include "contrib_ops/cpu/transformers/generation_device_helper.h"
+#include "contrib_ops/cpu/transformers/generation_shared.h"
+#include "contrib_ops/cpu/transformers/sampling_cpu_helper.h"
+
+namespace onnxruntime {
+namespace contrib {
+namespace transformers {
+
+GenerationEngine::GenerationEngine(const SessionState& session_state,
+                                   const Node& node,
+                                   const GenerationEngineOptions& options,
+                                   TokenCallback on_token)
+    : session_state_(session_state),
+      options_(options),
+      on_token_(std::move(on_token)) {
+  ORT_ENFORCE(options_.max_batch_size > 0, "max_batch_size shall be positive, got ", options_.max_batch_size);
+  ORT_ENFORCE(node.OpType() == "BeamSearch" || node.OpType() == "GreedySearch" || node.OpType() == "Sampling",
+              "GenerationEngine requires a BeamSearch, GreedySearch or Sampling node, got ", node.OpType());
+
+  const NodeAttributes& attributes = node.GetAttributes();
+  auto get_int_attribute = [&attributes](const std::string& name, int64_t default_value) {
+    auto it = attributes.find(name);
+    return it == attributes.end() ? default_value : it->second.i();
+  };
+  ORT_ENFORCE(get_int_attribute("model_type", IBeamSearchParameters::kModelTypeGpt) ==
+                  IBeamSearchParameters::kModelTypeGpt,
+              "GenerationEngine only supports GPT-2 model_type");
+  eos_token_id_ = static_cast<int>(get_int_attribute("eos_token_id", -1));
+  pad_token_id_ = static_cast<int>(get_int_attribute("pad_token_id", -1));
+
+  // The subgraph keeps a reference to the attribute name, so the key of the node attribute is used.
+  auto decoder = attributes.find("decoder");
+  ORT_ENFORCE(decoder != attributes.end(), "Node ", node.Name(), " has no decoder subgraph");
+  subgraph_session_state_ = session_state.GetSubgraphSessionState(node.Index(), decoder->first);
+  ORT_ENFORCE(subgraph_session_state_ != nullptr, "Subgraph SessionState was not found for decoder of ",
+              node.Name());
+
+  gpt_subgraph_ = std::make_unique<GptSubgraph>(node, decoder->first, subgraph_session_state_->GetGraphViewer());
+  ORT_THROW_IF_ERROR(gpt_subgraph_->Setup(session_state, *subgraph_session_state_));
+  ORT_ENFORCE(gpt_subgraph_->GetProvider()->Type() == kCpuExecutionProvider,
+              "GenerationEngine only supports CPU execution provider");
+  ORT_ENFORCE(!gpt_subgraph_->IsOutputFloat16(), "GenerationEngine only supports float decoder outputs");
+  ORT_ENFORCE(!gpt_subgraph_->IsPastPresentShareBuffer(),
+              "GenerationEngine does not support decoder with past_sequence_length input");
+  gpt_subgraph_->EnablePrefixCache(options_.prefix_cache_size);
+  allocator_ = gpt_subgraph_->GetProvider()->GetAllocator(0, OrtMemTypeDefault);
+
+  // Implicit inputs of the decoder are outer scope values, which are initializers of the main graph.
+  const auto& initializers = session_state.GetInitializedTensors();
+  for (const NodeArg* entry : node.ImplicitInputDefs()) {
+    int idx = -1;
+    ORT_THROW_IF_ERROR(session_state.GetOrtValueNameIdxMap().GetIdx(entry->Name(), idx));
+    auto initializer = initializers.find(idx);
+    ORT_ENFORCE(initializer != initializers.end(), "GenerationEngine requires implicit input ", entry->Name(),
+                " of the decoder to be an initializer");
+    implicit_inputs_.push_back(&initializer->second);
+  }
+}
+
+int64_t GenerationEngine::AddRequest(GenerationRequest request) {
+  ORT_ENFORCE(!request.input_ids.empty(), "input_ids of a request shall not be empty");
+  ORT_ENFORCE(request.max_new_tokens > 0, "max_new_tokens shall be positive, got ", request.max_new_tokens);
+  for (int32_t token : request.input_ids) {
+    ORT_ENFORCE(token >= 0 && token < gpt_subgraph_->vocab_size, "input_ids shall be in the range of [0, ",
+                gpt_subgraph_->vocab_size, "), got ", token);
+  }
+  if (request.do_sample) {
+    ORT_ENFORCE(request.temperature > 0.0f, "temperature shall be greater than 0, got ", request.temperature);
+    ORT_ENFORCE(request.top_k >= 0, "top_k shall not be negative, got ", request.top_k);
+    ORT_ENFORCE(request.top_p > 0.0f && request.top_p <= 1.0f,
+                "top_p shall be in the range of (0, 1], got ", request.top_p);
+  }
+
+  auto sequence = std::make_unique<Sequence>();
+  sequence->request = std::move(request);
+  sequence->generator.seed(static_cast<std::default_random_engine::result_type>(sequence->request.seed));
+
+  std::lock_guard<OrtMutex> lock(mutex_);
+  sequence->id = next_request_id_++;
+  int64_t request_id = sequence->id;
+  pending_.push_back(std::move(sequence));
+  return request_id;
+}
+
+void GenerationEngine::CancelRequest(int64_t request_id) {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  cancelled_.insert(request_id);
+}
+
+bool GenerationEngine::HasWork() const {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  return !pending_.empty() || num_running_ > 0;
+}
+
+Status GenerationEngine::Run() {
+  while (HasWork()) {
+    ORT_RETURN_IF_ERROR(Step());
+  }
+  return Status::OK();
+}
+
+Status GenerationEngine::Step() {
+  // Apply cancellations, and take as many queued requests as the free slots after eviction.
+  std::vector<std::unique_ptr<Sequence>> admitted;
+  {
+    std::lock_guard<OrtMutex> lock(mutex_);
+    if (!cancelled_.empty()) {
+      for (auto& sequence : running_) {
+        if (cancelled_.count(sequence->id) > 0) {
+          sequence->finished = true;
+        }
+      }
+      pending_.erase(std::remove_if(pending_.begin(), pending_.end(),
+                                    [this](const std::unique_ptr<Sequence>& sequence) {
+                                      return cancelled_.count(sequence->id) > 0;
+                                    }),
+                     pending_.end());
+      cancelled_.clear();
+    }
+
+    size_t num_kept = static_cast<size_t>(std::count_if(running_.begin(), running_.end(),
+                                                        [](const std::unique_ptr<Sequence>& sequence) {
+                                                          return !sequence->finished;
+                                                        }));
+    while (!pending_.empty() && num_kept + admitted.size() < static_cast<size_t>(options_.max_batch_size)) {
+      admitted.push_back(std::move(pending_.front()));
+      pending_.pop_front();
+    }
+  }
+
+  std::vector<OrtValue> admitted_present;
+  int admitted_length = 0;
+  if (!admitted.empty()) {
+    ORT_RETURN_IF_ERROR(Prefill(admitted, admitted_present, admitted_length));
+  }
+
+  auto is_finished = [](const std::unique_ptr<Sequence>& sequence) { return sequence->finished; };
+  bool evicted = std::any_of(running_.begin(), running_.end(), is_finished);
+  bool joined = !std::all_of(admitted.begin(), admitted.end(), is_finished);
+
+  // Batch changes: gather past states of remaining and new sequences into new feeds.
+  if (evicted || joined) {
+    std::vector<std::unique_ptr<Sequence>> running;
+    std::vector<PastRow> rows;
+    const size_t first_past = static_cast<size_t>(gpt_subgraph_->GetFirstPastInputIndex());
+    const int64_t running_batch_size = static_cast<int64_t>(running_.size());
+    for (int64_t i = 0; i < running_batch_size; i++) {
+      if (!running_[i]->finished) {
+        rows.push_back({&feeds_[first_past], running_batch_size, i, past_length_});
+        running.push_back(std::move(running_[i]));
+      }
+    }
+
+    const int64_t admitted_batch_size = static_cast<int64_t>(admitted.size());
+    for (int64_t i = 0; i < admitted_batch_size; i++) {
+      if (!admitted[i]->finished) {
+        rows.push_back({&admitted_present[0], admitted_batch_size, i, admitted_length});
+        running.push_back(std::move(admitted[i]));
+      }
+    }
+
+    running_ = std::move(running);
+    CreateDecodeFeeds(rows);
+  }
+
+  {
+    std::lock_guard<OrtMutex> lock(mutex_);
+    num_running_ = running_.size();
+  }
+
+  if (running_.empty()) {
+    return Status::OK();
+  }
+
+  return Decode();
+}
+
+Status GenerationEngine::Prefill(std::vector<std::unique_ptr<Sequence>>& sequences,
+                                 std::vector<OrtValue>& present,
+                                 int& present_length) {
+  const int64_t batch_size = static_cast<int64_t>(sequences.size());
+  int64_t sequence_length = 0;
+  for (const auto& sequence : sequences) {
+    sequence_length = std::max(sequence_length, static_cast<int64_t>(sequence->request.input_ids.size()));
+  }
+
+  // Prompts are padded on the left, like padded input_ids of GreedySearch.
+  OrtValue input_ids;
+  int64_t input_dims[] = {batch_size, sequence_length};
+  Tensor::InitOrtValue(DataTypeImpl::GetType<int32_t>(), TensorShape(&input_dims[0], 2), allocator_, input_ids);
+  int32_t* word_id = input_ids.GetMutable<Tensor>()->MutableData<int32_t>();
+  for (const auto& sequence : sequences) {
+    const std::vector<int32_t>& prompt = sequence->request.input_ids;
+    word_id = std::fill_n(word_id, sequence_length - static_cast<int64_t>(prompt.size()), pad_token_id_);
+    word_id = std::copy(prompt.begin(), prompt.end(), word_id);
+  }
+
+  std::vector<int32_t> sequence_lengths_buffer(static_cast<size_t>(batch_size));
+  gsl::span<int32_t> sequence_lengths(sequence_lengths_buffer);
+  std::vector<OrtValue> feeds;
+  OrtValue expanded_input_ids;
+  IAllocatorUniquePtr<char> buffer;
+  ORT_RETURN_IF_ERROR(gpt_subgraph_->CreateInitialFeeds(input_ids.Get<Tensor>(),
+                                                        implicit_inputs_,
+                                                        1,
+                                                        pad_token_id_,
+                                                        static_cast<int>(sequence_length),
+                                                        sequence_lengths,
+                                                        expanded_input_ids,
+                                                        feeds,
+                                                        GenerationCpuDeviceHelper::CreateGptInputs,
+                                                        GenerationCpuDeviceHelper::AddToFeeds,
+                                                        buffer));
+
+  // Each sequence keeps the attention mask of its prompt, since tokens equal to pad_token_id are masked out too.
+  const int32_t* mask = feeds[2].Get<Tensor>().Data<int32_t>();
+  for (int64_t i = 0; i < batch_size; i++) {
+    Sequence& sequence = *sequences[i];
+    const int64_t padding = sequence_length - static_cast<int64_t>(sequence.request.input_ids.size());
+    sequence.attention_mask.assign(mask + i * sequence_length + padding, mask + (i + 1) * sequence_length);
+    sequence.position = sequence_lengths[i];
+  }
+
+  gpt_subgraph_->UsePrefixCache(sequence_lengths, 1, feeds, session_state_.Logger());
+
+  std::vector<OrtValue> fetches;
+  ORT_RETURN_IF_ERROR(RunSubgraph(feeds, fetches));
+
+  gpt_subgraph_->UpdatePrefixCache(sequence_lengths, 1, expanded_input_ids, feeds, fetches);
+
+  const Tensor& logits = fetches[0].Get<Tensor>();
+  const int64_t logits_length = logits.Shape()[1];
+  const int64_t vocab_size = logits.Shape()[2];
+  const float* logits_data = logits.Data<float>();
+  for (int64_t i = 0; i < batch_size; i++) {
+    const float* last_logits = logits_data + SafeInt<size_t>((i + 1) * logits_length - 1) * vocab_size;
+    AppendNextToken(*sequences[i], gsl::make_span(last_logits, static_cast<size_t>(vocab_size)));
+  }
+
+  const int first_present = gpt_subgraph_->GetFirstPresentOutputIndex();
+  present.assign(fetches.begin() + first_present, fetches.begin() + first_present + gpt_subgraph_->num_layers);
+  present_length = static_cast<int>(sequence_length);
+  return Status::OK();
+}
+
+Status GenerationEngine::Decode() {
+  std::vector<OrtValue> fetches;
+  ORT_RETURN_IF_ERROR(RunSubgraph(feeds_, fetches));
+
+  const int64_t batch_size = static_cast<int64_t>(running_.size());
+  const Tensor& logits = fetches[0].Get<Tensor>();
+  const int64_t vocab_size = logits.Shape()[2];
+  const float* logits_data = logits.Data<float>();
+  next_tokens_.resize(running_.size());
+  for (int64_t i = 0; i < batch_size; i++) {
+    Sequence& sequence = *running_[i];
+    sequence.attention_mask.push_back(1);
+    sequence.position++;
+    const float* last_logits = logits_data + SafeInt<size_t>(i) * vocab_size;
+    AppendNextToken(sequence, gsl::make_span(last_logits, static_cast<size_t>(vocab_size)));
+    next_tokens_[i] = sequence.next_token;
+  }
+  past_length_++;
+
+  // Present state becomes the past state of next step as long as the batch does not change.
+  return GenerationCpuDeviceHelper::UpdateGptFeeds<float>(allocator_,
+                                                          nullptr,
+                                                          fetches,
+                                                          feeds_,
+                                                          past_length_ + 1,
+                                                          position_ids_,
+                                                          true,
+                                                          next_tokens_,
+                                                          {},
+                                                          1,
+                                                          gpt_subgraph_->GetFirstPastInputIndex(),
+                                                          gpt_subgraph_->GetFirstPresentOutputIndex(),
+                                                          false);
+}
+
+void GenerationEngine::CreateDecodeFeeds(gsl::span<const PastRow> rows) {
+  int past_length = 0;
+  for (const auto& sequence : running_) {
+    past_length = std::max(past_length, sequence->Length());
+  }
+
+  // Feeds are ordered as in GptSubgraph::CreateInitialFeeds: input_ids, position_ids, attention_mask, past_0, ...,
+  // past_{num_layers - 1}, then implicit inputs.
+  const int64_t batch_size = static_cast<int64_t>(running_.size());
+  auto int32_type = DataTypeImpl::GetType<int32_t>();
+  int64_t input_dims[] = {batch_size, 1};
+  int64_t mask_dims[] = {batch_size, static_cast<int64_t>(past_length) + 1};
+  OrtValue input_ids;
+  OrtValue position_ids;
+  OrtValue attention_mask;
+  Tensor::InitOrtValue(int32_type, TensorShape(&input_dims[0], 2), allocator_, input_ids);
+  Tensor::InitOrtValue(int32_type, TensorShape(&input_dims[0], 2), allocator_, position_ids);
+  Tensor::InitOrtValue(int32_type, TensorShape(&mask_dims[0], 2), allocator_, attention_mask);
+
+  int32_t* word_id = input_ids.GetMutable<Tensor>()->MutableData<int32_t>();
+  int32_t* position = position_ids.GetMutable<Tensor>()->MutableData<int32_t>();
+  int32_t* mask = attention_mask.GetMutable<Tensor>()->MutableData<int32_t>();
+  for (int64_t i = 0; i < batch_size; i++) {
+    const Sequence& sequence = *running_[i];
+    word_id[i] = sequence.next_token;
+    position[i] = sequence.position;
+
+    // Mask out the padding on the left of past state.
+    mask = std::fill_n(mask, past_length - sequence.Length(), 0);
+    mask = std::copy(sequence.attention_mask.begin(), sequence.attention_mask.end(), mask);
+    *mask++ = 1;
+  }
+
+  std::vector<OrtValue> feeds;
+  feeds.reserve(static_cast<size_t>(gpt_subgraph_->num_subgraph_inputs) + implicit_inputs_.size());
+  feeds.push_back(input_ids);
+  feeds.push_back(position_ids);
+  feeds.push_back(attention_mask);
+
+  // Valid part of each row is aligned to the right, and the new padding on the left is cleared.
+  const int num_heads = gpt_subgraph_->num_heads;
+  const size_t head_size = static_cast<size_t>(gpt_subgraph_->head_size);
+  const size_t chunk_size = static_cast<size_t>(past_length) * head_size;  // past_length x head_size
+  int64_t past_dims[] = {2, batch_size, num_heads, past_length, gpt_subgraph_->head_size};
+  TensorShape past_shape(&past_dims[0], 5);
+  for (int layer = 0; layer < gpt_subgraph_->num_layers; layer++) {
+    OrtValue past;
+    Tensor::InitOrtValue(DataTypeImpl::GetType<float>(), past_shape, allocator_, past);
+    float* target = past.GetMutable<Tensor>()->MutableData<float>();
+
+    for (int64_t kv = 0; kv < 2; kv++) {
+      for (int64_t r = 0; r < batch_size; r++) {
+        const PastRow& row = rows[r];
+        const float* source = row.past[layer].Get<Tensor>().Data<float>();
+        const size_t source_chunk_size = static_cast<size_t>(row.past_length) * head_size;
+        const size_t valid_size = static_cast<size_t>(running_[r]->Length()) * head_size;
+        const size_t padding_size = chunk_size - valid_size;
+        for (int64_t n = 0; n < num_heads; n++) {
+          float* target_chunk = target + SafeInt<size_t>((kv * batch_size + r) * num_heads + n) * chunk_size;
+          const float* source_chunk = source +
+                                      SafeInt<size_t>((kv * row.batch_size + row.row) * num_heads + n) *
+                                          source_chunk_size +
+                                      (source_chunk_size - valid_size);
+          std::fill_n(target_chunk, padding_size, 0.0f);
+          memcpy(target_chunk + padding_size, source_chunk, valid_size * sizeof(float));
+        }
+      }
+    }
+
+    feeds.push_back(past);
+  }
+
+  for (const OrtValue* entry : implicit_inputs_) {
+    feeds.push_back(*entry);
+  }
+
+  feeds_ = std::move(feeds);
+  position_ids_ = position_ids;
+  past_length_ = past_length;
+}
+
+Status GenerationEngine::RunSubgraph(std::vector<OrtValue>& feeds, std::vector<OrtValue>& fetches) {
+  gpt_subgraph_->PrepareFetches(feeds, fetches);
+  return utils::ExecuteSubgraph(*subgraph_session_state_,
+                                *gpt_subgraph_->GetFeedsFetchesManager(),
+                                feeds,
+                                fetches,
+                                {},
+                                ExecutionMode::ORT_SEQUENTIAL,
+                                terminate_flag_,
+                                session_state_.Logger());
+}
+
+void GenerationEngine::AppendNextToken(Sequence& sequence, gsl::span<const float> logits) {
+  const GenerationRequest& request = sequence.request;
+  int32_t token = 0;
+  if (request.do_sample) {
+    probs_.resize(logits.size());
+    indices_.resize(logits.size());
+    std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+    token = SamplingCpuHelper::SampleToken(logits, probs_, indices_, request.temperature, request.top_k,
+                                           request.top_p, 1, distribution(sequence.generator));
+  } else {
+    token = static_cast<int32_t>(std::max_element(logits.begin(), logits.end()) - logits.begin());
+  }
+
+  sequence.next_token = token;
+  sequence.num_generated++;
+  sequence.finished = (token == eos_token_id_ || sequence.num_generated >= request.max_new_tokens);
+  if (on_token_) {
+    on_token_(sequence.id, token, sequence.finished);
+  }
+}
+
+}  // namespace transformers
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,155 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <random>
+#include <unordered_set>
+#include <vector>
+#include "gsl/gsl"
+#include "core/common/common.h"
+#include "core/framework/allocator.h"
+#include "core/framework/ort_value.h"
+#include "core/platform/ort_mutex.h"
+#include "contrib_ops/cpu/transformers/subgraph_gpt.h"
+
+namespace onnxruntime {
+class SessionState;
+
+namespace contrib {
+namespace transformers {
+
+struct GenerationEngineOptions {
+  int max_batch_size = 8;        // maximum number of sequences in the running batch
+  size_t prefix_cache_size = 0;  // memory budget in bytes of the prefix cache of the decoder. 0 disables it.
+};
+
+struct GenerationRequest {
+  std::vector<int32_t> input_ids;  // prompt without padding
+  int max_new_tokens = 16;         // maximum number of tokens to generate, including eos_token_id
+  bool do_sample = false;          // sample next token instead of picking the one with highest score
+  float temperature = 1.0f;        // parameters of sampling, see Sampling operator
+  int top_k = 0;
+  float top_p = 1.0f;
+  int seed = 0;
+};
+
+// Continuous batching text generation with the GPT-2 decoder of a BeamSearch, GreedySearch or Sampling node.
+//
+// The engine runs the "decoder" subgraph of the node through GptSubgraph, so feeds are created and updated the same
+// way as in those operators, and its prefix cache is shared by all requests. It keeps a running batch of sequences,
+// and each Step() generates one token for every running sequence. Requests can be added at any time: they are
+// admitted into free slots of the batch at the next step, and finished or cancelled sequences are evicted right
+// away, so short requests do not wait for long ones. Generated tokens are streamed through a callback.
+//
+// Each sequence keeps its own length, position and attention mask. Like padded input_ids of GreedySearch, past
+// states of the batch are aligned to the right and the padding on the left is masked out. While the batch does
+// not change, present states of a step are fed as past states of next step by UpdateGptFeeds. When sequences join
+// or leave, their rows of past state are gathered into a new batch with the padding trimmed.
+class GenerationEngine {
+ public:
+  // Receives each generated token of a request. finished is true for the last token of the request.
+  using TokenCallback = std::function<void(int64_t request_id, int32_t token, bool finished)>;
+
+  // node is a BeamSearch, GreedySearch or Sampling node of the graph of session_state, which shall outlive the
+  // engine. Its eos_token_id and pad_token_id attributes are used for all requests.
+  GenerationEngine(const SessionState& session_state,
+                   const Node& node,
+                   const GenerationEngineOptions& options,
+                   TokenCallback on_token);
+
+  // Queue a request and return its id. It joins the running batch at the next Step(). Thread safe.
+  int64_t AddRequest(GenerationRequest request);
+
+  // Stop a queued or running request. No more tokens are reported for it. Thread safe.
+  void CancelRequest(int64_t request_id);
+
+  // Evict finished sequences, admit queued requests into the free slots of the batch and run their prompts, which
+  // generates their first token, then generate one token for every running sequence.
+  Status Step();
+
+  // Call Step() until all requests are finished.
+  Status Run();
+
+  // Whether there are queued or running requests. Thread safe.
+  bool HasWork() const;
+
+  // Number of sequences in the running batch.
+  size_t NumRunning() const { return running_.size(); }
+
+  const GptSubgraph& GetSubgraph() const { return *gpt_subgraph_; }
+
+ private:
+  struct Sequence {
+    int64_t id;
+    GenerationRequest request;
+    std::vector<int32_t> attention_mask;  // mask of the tokens in past state, without the padding of the batch
+    int32_t next_token = 0;               // last generated token, which is the input of next step
+    int32_t position = 0;                 // position id of next_token
+    int num_generated = 0;
+    bool finished = false;
+    std::default_random_engine generator;
+
+    // Number of tokens in past state.
+    int Length() const { return static_cast<int>(attention_mask.size()); }
+  };
+
+  // A row of a batched past state (2, batch_size, num_heads, past_length, head_size) for each layer.
+  struct PastRow {
+    const OrtValue* past;  // past state of the first layer. The other layers follow.
+    int64_t batch_size;
+    int64_t row;
+    int past_length;
+  };
+
+  // Run the prompts of new sequences in one batch. Outputs the present states and their sequence length.
+  Status Prefill(std::vector<std::unique_ptr<Sequence>>& sequences,
+                 std::vector<OrtValue>& present,
+                 int& present_length);
+
+  // Run one step for the running batch.
+  Status Decode();
+
+  // Create decode feeds of the running batch from rows of past states. The past length is the longest sequence.
+  void CreateDecodeFeeds(gsl::span<const PastRow> rows);
+
+  Status RunSubgraph(std::vector<OrtValue>& feeds, std::vector<OrtValue>& fetches);
+
+  // Pick next token from the logits of the last position, and report it.
+  void AppendNextToken(Sequence& sequence, gsl::span<const float> logits);
+
+  const SessionState& session_state_;
+  const SessionState* subgraph_session_state_;
+  std::unique_ptr<GptSubgraph> gpt_subgraph_;
+  std::vector<const OrtValue*> implicit_inputs_;
+  GenerationEngineOptions options_;
+  TokenCallback on_token_;
+  AllocatorPtr allocator_;
+  int eos_token_id_ = -1;
+  int pad_token_id_ = -1;
+  bool terminate_flag_ = false;
+
+  // Running batch. Row i of the feeds belongs to running_[i]. The padding of the row is past_length_ - Length().
+  std::vector<std::unique_ptr<Sequence>> running_;
+  std::vector<OrtValue> feeds_;
+  OrtValue position_ids_;  // (batch_size, 1) buffer that UpdateGptFeeds increases in place
+  int past_length_ = 0;
+
+  // Work buffers of decoding and sampling.
+  std::vector<int32_t> next_tokens_;
+  std::vector<float> probs_;
+  std::vector<int32_t> indices_;
+
+  mutable OrtMutex mutex_;  // protects the members below, which are updated by AddRequest and CancelRequest.
+  std::deque<std::unique_ptr<Sequence>> pending_;
+  std::unordered_set<int64_t> cancelled_;
+  int64_t next_request_id_ = 0;
+  size_t num_running_ = 0;  // copy of running_.size() that is used in HasWork
+};
+
+}  // namespace transformers
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <random>
 #include <utility>
 #include "gsl/gsl"
 #include "core/framework/allocator.h"
@@ -53,6 +54,11 @@ struct IGreedySearchState {
   gsl::span<bool> eos_meet;             // shape (batch_size)
   gsl::span<T> next_token_scores;       // shape (batch_size, vocab_size)
   gsl::span<int32_t> next_tokens;       // shape (batch_size)
+
+  // The following are used only by Sampling operator in CPU.
+  gsl::span<float> sampling_probs;      // shape (batch_size, vocab_size), probabilities of candidate tokens.
+  gsl::span<int32_t> sampling_indices;  // shape (batch_size, vocab_size), candidate tokens sorted by probability.
+  std::default_random_engine generator;
 };
 
 class ISequences {
@@ -60,6 +66,10 @@ class ISequences {
   virtual ~ISequences() {}
   virtual gsl::span<const int32_t> GetSequence(int beam_index) const = 0;
   virtual int GetSequenceLength() const = 0;
+
+  // Returns the beam index of last step that each sequence continues from. It is empty when the last step did not
+  // reorder sequences, like in greedy search.
+  virtual gsl::span<const int32_t> GetPreviousBeamIndices() const = 0;
 };
 
 class ILogitsProcessorList {
@@ -111,6 +121,14 @@ struct IBeamSearchParameters {
   gsl::span<const int32_t> vocab_mask;
   gsl::span<const int32_t> prefix_vocab_mask;
 
+  // Parameters for Sampling operator.
+  bool do_sample = false;      // sample next token instead of picking the one with highest score
+  float temperature = 1.0f;    // scores are divided by temperature before softmax
+  int top_k = 0;               // sample from the top_k tokens only. 0 means no limit.
+  float top_p = 1.0f;          // sample from the smallest set of tokens with cumulative probability >= top_p
+  int min_tokens_to_keep = 1;  // minimum number of tokens to keep after top_p filtering
+  int seed = 0;                // seed of random number generator
+
   // Parameters from outputs.
   bool output_scores;  // whether scores existed in output
 
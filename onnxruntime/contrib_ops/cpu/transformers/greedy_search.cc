@@ -31,6 +31,7 @@
 #include "contrib_ops/cpu/transformers/sequences.h"
 #include "contrib_ops/cpu/transformers/dump_tensor.h"
 #include "contrib_ops/cpu/transformers/greedy_search_impl_gpt.h"
+#include "contrib_ops/cpu/transformers/greedy_search_impl_speculative.h"
 
 using namespace ONNX_NAMESPACE;
 using namespace onnxruntime::common;
@@ -67,6 +68,9 @@ void GreedySearch::Init(const OpKernelInfo& info) {
 
   ORT_ENFORCE(info.GetAttr<ONNX_NAMESPACE::GraphProto>("decoder", &proto).IsOK());
   ORT_IGNORE_RETURN_VALUE(proto);
+
+  ORT_ENFORCE(parameters_.model_type == 0 || !info.GetAttr<ONNX_NAMESPACE::GraphProto>("draft_decoder", &proto).IsOK(),
+              "draft_decoder is only supported by decoder only model like GPT-2");
 }
 
 Status GreedySearch::SetupSubgraphExecutionInfo(const SessionState& session_state,
@@ -84,6 +88,14 @@ Status GreedySearch::SetupSubgraphExecutionInfo(const SessionState& session_stat
                                         gpt_subgraph_->num_heads,
                                         gpt_subgraph_->head_size,
                                         gpt_subgraph_->num_layers);
+      gpt_subgraph_->EnablePrefixCache(static_cast<size_t>(parameters_.prefix_cache_size));
+    } else if (attribute_name == "draft_decoder") {
+      ORT_ENFORCE(draft_gpt_subgraph_ == nullptr,
+                  "SetupSubgraphExecutionInfo should only be called once for each subgraph.");
+      draft_gpt_subgraph_ = std::make_unique<GptSubgraph>(node, attribute_name,
+                                                          subgraph_session_state.GetGraphViewer());
+      ORT_RETURN_IF_ERROR(draft_gpt_subgraph_->Setup(session_state, subgraph_session_state));
+      draft_feeds_fetches_manager_ = draft_gpt_subgraph_->GetFeedsFetchesManager();
     }
   } else if (parameters_.model_type == IBeamSearchParameters::kModelTypeT5) {  // encoder-decoder like T5
     ORT_THROW("Not Implemented");
@@ -116,6 +128,12 @@ Status GreedySearch::SetupSubgraphExecutionInfo(const SessionState& session_stat
 }
 
 Status GreedySearch::Compute(OpKernelContext* ctx) const {
+  // make a copy since we will update the parameters based on inputs later
+  GreedySearchParameters parameters = parameters_;
+  return ComputeWithParameters(ctx, parameters);
+}
+
+Status GreedySearch::ComputeWithParameters(OpKernelContext* ctx, GreedySearchParameters& parameters) const {
   auto* ctx_internal = static_cast<OpKernelContextInternal*>(ctx);
 
   auto* decoder_session_state = ctx_internal->SubgraphSessionState("decoder");
@@ -124,8 +142,38 @@ Status GreedySearch::Compute(OpKernelContext* ctx) const {
 
   concurrency::ThreadPool* thread_pool = ctx->GetOperatorThreadPool();
 
-  // make a copy since we will update the parameters based on inputs later
-  GreedySearchParameters parameters = parameters_;
+  if (parameters_.model_type == 0 && draft_gpt_subgraph_ != nullptr) {  // GPT-2 with speculative decoding
+    auto* draft_session_state = ctx_internal->SubgraphSessionState("draft_decoder");
+    ORT_ENFORCE(draft_session_state, "Subgraph SessionState was not found for 'draft_decoder' attribute.");
+    ORT_ENFORCE(draft_feeds_fetches_manager_,
+                "CreateFeedsFetchesManager must be called prior to execution of graph.");
+
+    ORT_RETURN_IF(cuda_stream_ != nullptr, "Speculative decoding is only supported by CPU execution provider");
+    ORT_RETURN_IF(gpt_subgraph_->IsOutputFloat16() || draft_gpt_subgraph_->IsOutputFloat16(),
+                  "Speculative decoding only supports float decoder and draft_decoder");
+    ORT_RETURN_IF(draft_gpt_subgraph_->vocab_size != gpt_subgraph_->vocab_size,
+                  "draft_decoder shall have same vocabulary size as decoder, got ",
+                  draft_gpt_subgraph_->vocab_size, " and ", gpt_subgraph_->vocab_size);
+
+    GreedySearchSpeculativeGpt<float> impl{
+        *ctx_internal,
+        *decoder_session_state,
+        *gpt_subgraph_,
+        *draft_session_state,
+        *draft_gpt_subgraph_,
+        thread_pool,
+        dumper_,
+        parameters,
+        GenerationCpuDeviceHelper::CreateGptInputs,
+        GenerationCpuDeviceHelper::AddToFeeds,
+        GenerationCpuDeviceHelper::TopK,
+        GenerationCpuDeviceHelper::GreedySearchProcessLogits<float>,
+        GenerationCpuDeviceHelper::InitGreedyState<float>,
+        GenerationCpuDeviceHelper::DeviceCopy<float>};
+    ORT_RETURN_IF_ERROR(impl.Initialize());
+
+    return impl.Execute(*decoder_feeds_fetches_manager_, *draft_feeds_fetches_manager_);
+  }
 
   if (parameters_.model_type == 0) {  // GPT-2
     // Subgraph has constraint that the output is either float or float16
@@ -28,6 +28,7 @@ class GreedySearch : public IControlFlowKernel {
       : IControlFlowKernel(info),
         // encoder_feeds_fetches_manager_(nullptr),
         decoder_feeds_fetches_manager_(nullptr),
+        draft_feeds_fetches_manager_(nullptr),
         cuda_stream_(nullptr),
         dumper_(nullptr) {
     Init(info);
@@ -42,6 +43,9 @@ class GreedySearch : public IControlFlowKernel {
                                     const SessionState& subgraph_session_state) override;
 
  protected:
+  // Run generation with parameters that are copied from parameters_ and updated for this run.
+  Status ComputeWithParameters(OpKernelContext* ctx, GreedySearchParameters& parameters) const;
+
   void SetComputeStream(void* stream) { cuda_stream_ = stream; }
   void SetConsoleDumper(IConsoleDumper* dumper) { dumper_ = dumper; }
 
@@ -97,10 +101,15 @@ class GreedySearch : public IControlFlowKernel {
   // FeedsFetchesManager* encoder_feeds_fetches_manager_;
   FeedsFetchesManager* decoder_feeds_fetches_manager_;
 
+  // Draft model of speculative decoding. It is optional.
+  std::unique_ptr<GptSubgraph> draft_gpt_subgraph_;
+  FeedsFetchesManager* draft_feeds_fetches_manager_;
+
   void* cuda_stream_;
 
   IConsoleDumper* dumper_;
 
+ protected:
   GreedySearchParameters parameters_;
 };
 
@@ -44,6 +44,17 @@ struct GreedySearchState : public IGreedySearchState<T> {
     this->next_positions = AllocateBuffer<int32_t>(allocator, next_positions_buffer_, batch_size);
   }
 
+  // Allocate work buffers of sampling, and seed the random number generator.
+  void InitSampling(AllocatorPtr cpu_allocator,
+                    int batch_size,
+                    int vocab_size,
+                    int seed) {
+    size_t buffer_size = SafeInt<size_t>(batch_size) * vocab_size;
+    this->sampling_probs = AllocateBuffer<float>(cpu_allocator, sampling_probs_buffer_, buffer_size);
+    this->sampling_indices = AllocateBuffer<int32_t>(cpu_allocator, sampling_indices_buffer_, buffer_size);
+    this->generator.seed(static_cast<std::default_random_engine::result_type>(seed));
+  }
+
   void SetSequence(gsl::span<const int32_t> input_ids_in_cpu,
                    size_t batch_beam_size,
                    int max_length,
@@ -65,6 +76,8 @@ struct GreedySearchState : public IGreedySearchState<T> {
   BufferUniquePtr next_tokens_cpu_buffer_;
   BufferUniquePtr next_positions_buffer_;
   BufferUniquePtr eos_meet_buffer_;
+  BufferUniquePtr sampling_probs_buffer_;
+  BufferUniquePtr sampling_indices_buffer_;
 };
 
 // Base class of gready search implementation that is common for both GPT-2 and Bart/T5.
@@ -140,6 +153,9 @@ Status GreedySearchBase<T>::Initialize() {
 
   ORT_RETURN_IF_ERROR(CheckScalarInput("max_length", 1, true));
   ORT_RETURN_IF_ERROR(CheckScalarInput("min_length", 2, false));
+  if (parameters_->do_sample) {
+    ORT_RETURN_IF_ERROR(CheckScalarInput("seed", 6, false));
+  }
 
   ORT_RETURN_IF_ERROR(CheckInputs(this->context_));
 
@@ -149,7 +165,7 @@ Status GreedySearchBase<T>::Initialize() {
   if (!this->IsCuda()) {
     // Logits processor is used in CPU only. In CUDA, cuda kernels are used instead.
     // Initialize processors after CheckInputs so that parameters_->vocab_mask is ready.
-    this->logits_processors_.Init(*parameters_);
+    this->logits_processors_.Init(*parameters_, this->thread_pool_);
   }
 
   return Status::OK();
@@ -85,6 +85,7 @@ Status GreedySearchGpt<T>::CreateInitialFeeds(gsl::span<int32_t>& sequence_lengt
                                           this->implicit_inputs_,
                                           this->parameters_->num_beams,
                                           this->parameters_->pad_token_id,
+                                          this->parameters_->max_length,
                                           sequence_lengths,
                                           expanded_input_ids,
                                           feeds,
@@ -113,7 +114,8 @@ Status GreedySearchGpt<T>::UpdateFeeds(
                             place_holder,
                             this->parameters_->num_beams,
                             gpt_subgraph_.GetFirstPastInputIndex(),
-                            gpt_subgraph_.GetFirstPresentOutputIndex());
+                            gpt_subgraph_.GetFirstPresentOutputIndex(),
+                            gpt_subgraph_.IsPastPresentShareBuffer());
 }
 
 template <typename T>
@@ -138,6 +140,13 @@ Status GreedySearchGpt<T>::Execute(const FeedsFetchesManager& feeds_fetches_mana
                     parameters->max_length,
                     this->IsCuda());
 
+  if (parameters->do_sample) {
+    greedy_state.InitSampling(this->cpu_allocator_,
+                              static_cast<int>(parameters->BatchBeamSize()),
+                              static_cast<int>(parameters->vocab_size),
+                              parameters->seed);
+  }
+
   IAllocatorUniquePtr<char> buffer;
   OrtValue expanded_input_ids_in_cpu;
   ORT_RETURN_IF_ERROR(CreateInitialFeeds(greedy_state.sequence_lengths, expanded_input_ids_in_cpu, feeds, buffer));
@@ -156,6 +165,9 @@ Status GreedySearchGpt<T>::Execute(const FeedsFetchesManager& feeds_fetches_mana
   const IConsoleDumper* dumper = this->GetConsoleDumper();
 #endif
 
+  // Reuse past state of prompt prefix that was computed in previous runs.
+  gpt_subgraph_.UsePrefixCache(greedy_state.sequence_lengths, parameters->num_beams, feeds, this->context_.Logger());
+
   // position ids for all iterations except the first. It uses memory buffer owned by next_positions.
   OrtValue position_ids;
   int64_t dims[] = {parameters->BatchBeamSize(), 1};
@@ -178,6 +190,7 @@ Status GreedySearchGpt<T>::Execute(const FeedsFetchesManager& feeds_fetches_mana
     dumper->Print("attention_mask", feeds[2]);
 #endif
 
+    gpt_subgraph_.PrepareFetches(feeds, fetches);
     status = utils::ExecuteSubgraph(this->decoder_session_state_,
                                     feeds_fetches_manager,
                                     feeds,
@@ -189,6 +202,11 @@ Status GreedySearchGpt<T>::Execute(const FeedsFetchesManager& feeds_fetches_mana
 
     ORT_RETURN_IF_ERROR(status);
 
+    if (iteration_counter == 1) {
+      gpt_subgraph_.UpdatePrefixCache(greedy_state.sequence_lengths, parameters->num_beams,
+                                      expanded_input_ids_in_cpu, feeds, fetches);
+    }
+
     const OrtValue& logits = fetches[0];
     gsl::span<int32_t> next_tokens;
     ORT_RETURN_IF_ERROR(this->GenerateNextToken(logits,
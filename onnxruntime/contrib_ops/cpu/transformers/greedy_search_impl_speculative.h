@@ -0,0 +1,394 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+#include <algorithm>
+#include <vector>
+#include "contrib_ops/cpu/transformers/greedy_search_impl_base.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+namespace transformers {
+
+// Greedy search or sampling of GPT-2 model with speculative decoding. In each iteration, a small draft model
+// proposes a few tokens one by one, then the target model (decoder) runs once on all of them and generates the next
+// token after each proposed token. Proposed tokens are accepted as long as they are same as generated tokens in all
+// sequences of the batch, and the past state of both models are truncated to the accepted length.
+// Since every token is still generated from logits of the target model, the output is same as GreedySearchGpt.
+template <typename T>
+class GreedySearchSpeculativeGpt : public GreedySearchBase<T> {
+ public:
+  GreedySearchSpeculativeGpt(OpKernelContextInternal& context,
+                             const SessionState& decoder_session_state,
+                             GptSubgraph& gpt_subgraph,
+                             const SessionState& draft_session_state,
+                             GptSubgraph& draft_subgraph,
+                             concurrency::ThreadPool* thread_pool,
+                             IConsoleDumper* cuda_dumper,
+                             GreedySearchParameters& params,
+                             const GenerationDeviceHelper::CreateGptInputsFunc& create_inputs_func,
+                             const GenerationDeviceHelper::AddToFeedsFunc& add_to_feeds_func,
+                             const GenerationDeviceHelper::TopkFunc& topk_func,
+                             const GenerationDeviceHelper::GreedySearchProcessLogitsFunc<T>& process_logits_func,
+                             const GenerationDeviceHelper::InitGreedyStateFunc<T>& init_greedy_state_func,
+                             const GenerationDeviceHelper::DeviceCopyFunc<float>& device_copy_func)
+      : GreedySearchBase<T>(context,
+                            decoder_session_state,
+                            thread_pool,
+                            nullptr,
+                            cuda_dumper,
+                            params,
+                            topk_func,
+                            process_logits_func,
+                            device_copy_func),
+        gpt_subgraph_(gpt_subgraph),
+        draft_session_state_(draft_session_state),
+        draft_subgraph_(draft_subgraph),
+        create_inputs_func_(create_inputs_func),
+        add_to_feeds_func_(add_to_feeds_func),
+        init_greedy_state_func_(init_greedy_state_func) {
+  }
+
+  // Execute speculative decoding in iterations until stopping criteria is reached.
+  Status Execute(const FeedsFetchesManager& feeds_fetches_manager,
+                 const FeedsFetchesManager& draft_feeds_fetches_manager);
+
+ private:
+  // Inputs and past state of one decoder subgraph.
+  struct DecoderState {
+    GptSubgraph* subgraph;
+    const SessionState* session_state;
+    const FeedsFetchesManager* feeds_fetches_manager;
+    std::vector<OrtValue> feeds;
+    std::vector<OrtValue> fetches;
+    int past_length = 0;  // number of positions in past state
+  };
+
+  // Prepare the inputs for first inference of a subgraph.
+  Status CreateInitialFeeds(DecoderState& decoder,
+                            gsl::span<int32_t> sequence_lengths,
+                            OrtValue& expanded_input_ids,
+                            IAllocatorUniquePtr<char>& buffer);
+
+  // Run a decoder on the tokens that are not in its past state: tokens of sequences in the range of
+  // [past_length, current_length), followed by the first num_draft_tokens proposed tokens.
+  Status RunDecoder(DecoderState& decoder,
+                    const GreedySearchState<T>& greedy_state,
+                    int current_length,
+                    int num_draft_tokens);
+
+  // Keep the first past_length positions in past state.
+  void TruncatePast(DecoderState& decoder, int past_length);
+
+  GptSubgraph& gpt_subgraph_;
+  const SessionState& draft_session_state_;
+  GptSubgraph& draft_subgraph_;
+
+  // Attention mask and position ids of the prompt, and proposed tokens of draft model in shape
+  // (batch_size, num_speculative_tokens).
+  OrtValue prompt_attention_mask_;
+  OrtValue prompt_position_ids_;
+  std::vector<int32_t> draft_tokens_;
+
+  // Device specific functions
+  GenerationDeviceHelper::CreateGptInputsFunc create_inputs_func_;
+  GenerationDeviceHelper::AddToFeedsFunc add_to_feeds_func_;
+  GenerationDeviceHelper::InitGreedyStateFunc<T> init_greedy_state_func_;
+};
+
+template <typename T>
+Status GreedySearchSpeculativeGpt<T>::CreateInitialFeeds(DecoderState& decoder,
+                                                         gsl::span<int32_t> sequence_lengths,
+                                                         OrtValue& expanded_input_ids,
+                                                         IAllocatorUniquePtr<char>& buffer) {
+  const OrtValue* input_ids_value = this->context_.GetInputOrtValue(0);
+  const Tensor& input_ids = input_ids_value->Get<Tensor>();
+  return decoder.subgraph->CreateInitialFeeds(input_ids,
+                                              this->implicit_inputs_,
+                                              this->parameters_->num_beams,
+                                              this->parameters_->pad_token_id,
+                                              this->parameters_->max_length,
+                                              sequence_lengths,
+                                              expanded_input_ids,
+                                              decoder.feeds,
+                                              this->create_inputs_func_,
+                                              this->add_to_feeds_func_,
+                                              buffer);
+}
+
+template <typename T>
+Status GreedySearchSpeculativeGpt<T>::RunDecoder(DecoderState& decoder,
+                                                 const GreedySearchState<T>& greedy_state,
+                                                 int current_length,
+                                                 int num_draft_tokens) {
+  const int batch_size = this->parameters_->BatchBeamSize();
+  const int prompt_length = this->parameters_->sequence_length;
+  const int num_speculative_tokens = this->parameters_->num_speculative_tokens;
+  const int past_length = decoder.past_length;
+  const int total_length = current_length + num_draft_tokens;
+  const int input_length = total_length - past_length;
+  ORT_ENFORCE(input_length > 0);
+
+  // Positions of the prompt come from the initial inputs. Generated tokens have mask 1, and their position ids
+  // continue from the number of non-padding tokens in the prompt.
+  auto int32_type = DataTypeImpl::GetType<int32_t>();
+  int64_t ids_dims[] = {batch_size, input_length};
+  int64_t mask_dims[] = {batch_size, total_length};
+  OrtValue input_ids;
+  OrtValue position_ids;
+  OrtValue attention_mask;
+  Tensor::InitOrtValue(int32_type, TensorShape(&ids_dims[0], 2), this->temp_space_allocator_, input_ids);
+  Tensor::InitOrtValue(int32_type, TensorShape(&ids_dims[0], 2), this->temp_space_allocator_, position_ids);
+  Tensor::InitOrtValue(int32_type, TensorShape(&mask_dims[0], 2), this->temp_space_allocator_, attention_mask);
+  int32_t* input_ids_data = input_ids.GetMutable<Tensor>()->MutableData<int32_t>();
+  int32_t* position_data = position_ids.GetMutable<Tensor>()->MutableData<int32_t>();
+  int32_t* mask_data = attention_mask.GetMutable<Tensor>()->MutableData<int32_t>();
+  const int32_t* prompt_mask = prompt_attention_mask_.Get<Tensor>().Data<int32_t>();
+  const int32_t* prompt_positions = prompt_position_ids_.Get<Tensor>().Data<int32_t>();
+
+  for (int i = 0; i < batch_size; i++) {
+    gsl::span<const int32_t> sequence = greedy_state.sequences.GetSequence(i);
+    for (int j = 0; j < total_length; j++) {
+      const int32_t mask = j < prompt_length ? prompt_mask[i * prompt_length + j] : 1;
+      mask_data[i * total_length + j] = mask;
+      if (j >= past_length) {
+        const int k = j - past_length;
+        input_ids_data[i * input_length + k] = j < current_length
+                                                   ? sequence[j]
+                                                   : draft_tokens_[i * num_speculative_tokens + j - current_length];
+        position_data[i * input_length + k] = j < prompt_length
+                                                  ? prompt_positions[i * prompt_length + j]
+                                                  : greedy_state.sequence_lengths[i] + (j - prompt_length);
+      }
+    }
+  }
+
+  std::vector<OrtValue>& feeds = decoder.feeds;
+  feeds[0] = input_ids;
+  feeds[1] = position_ids;
+  feeds[2] = attention_mask;
+
+  const GptSubgraph& subgraph = *decoder.subgraph;
+  if (subgraph.IsPastPresentShareBuffer()) {
+    OrtValue& past_sequence_length = feeds[static_cast<size_t>(subgraph.GetFirstPastInputIndex()) +
+                                           subgraph.num_layers];
+    *past_sequence_length.GetMutable<Tensor>()->MutableData<int32_t>() = past_length;
+  }
+
+  decoder.fetches.clear();
+  subgraph.PrepareFetches(feeds, decoder.fetches);
+  ORT_RETURN_IF_ERROR(utils::ExecuteSubgraph(*decoder.session_state,
+                                             *decoder.feeds_fetches_manager,
+                                             feeds,
+                                             decoder.fetches,
+                                             {},
+                                             ExecutionMode::ORT_SEQUENTIAL,
+                                             this->context_.GetTerminateFlag(),
+                                             this->context_.Logger()));
+
+  // present_* outputs become past_* inputs. They are already in the past buffers when the buffers are shared.
+  if (!subgraph.IsPastPresentShareBuffer()) {
+    for (int i = 0; i < subgraph.num_layers; i++) {
+      feeds[static_cast<size_t>(subgraph.GetFirstPastInputIndex()) + i] =
+          decoder.fetches[static_cast<size_t>(subgraph.GetFirstPresentOutputIndex()) + i];
+    }
+  }
+  decoder.past_length = total_length;
+
+  return Status::OK();
+}
+
+template <typename T>
+void GreedySearchSpeculativeGpt<T>::TruncatePast(DecoderState& decoder, int past_length) {
+  if (past_length >= decoder.past_length) {
+    return;
+  }
+
+  // Shared buffers only need a smaller past_sequence_length in next run.
+  const GptSubgraph& subgraph = *decoder.subgraph;
+  if (!subgraph.IsPastPresentShareBuffer()) {
+    for (int i = 0; i < subgraph.num_layers; i++) {
+      OrtValue& past = decoder.feeds[static_cast<size_t>(subgraph.GetFirstPastInputIndex()) + i];
+      const Tensor& past_tensor = past.Get<Tensor>();
+
+      // Past state has shape (2, batch_size, num_heads, decoder.past_length, head_size).
+      const auto& dims = past_tensor.Shape().GetDims();
+      const int64_t num_chunks = dims[0] * dims[1] * dims[2];
+      const int64_t head_size = dims[4];
+      int64_t truncated_dims[] = {dims[0], dims[1], dims[2], past_length, head_size};
+      OrtValue truncated;
+      Tensor::InitOrtValue(past_tensor.DataType(), TensorShape(&truncated_dims[0], 5),
+                           this->temp_space_allocator_, truncated);
+
+      const T* source = past_tensor.Data<T>();
+      T* target = truncated.GetMutable<Tensor>()->MutableData<T>();
+      const size_t chunk_size = SafeInt<size_t>(past_length) * head_size;
+      for (int64_t j = 0; j < num_chunks; j++) {
+        std::copy_n(source + j * dims[3] * head_size, chunk_size, target + j * past_length * head_size);
+      }
+      past = truncated;
+    }
+  }
+
+  decoder.past_length = past_length;
+}
+
+template <typename T>
+Status GreedySearchSpeculativeGpt<T>::Execute(const FeedsFetchesManager& feeds_fetches_manager,
+                                              const FeedsFetchesManager& draft_feeds_fetches_manager) {
+  const GreedySearchParameters* parameters = this->parameters_;
+  const int batch_size = parameters->BatchBeamSize();
+  const int vocab_size = parameters->vocab_size;
+  const int num_speculative_tokens = parameters->num_speculative_tokens;
+
+  // Allocate output tensors.
+  int64_t sequences_dims[] = {parameters->batch_size, parameters->max_length};
+  TensorShape sequences_shape(&sequences_dims[0], sizeof(sequences_dims) / sizeof(sequences_dims[0]));
+  Tensor* output_sequences = this->context_.Output(0, sequences_shape);
+
+  GreedySearchState<T> greedy_state;
+  greedy_state.Init(this->cpu_allocator_,
+                    this->temp_space_allocator_,
+                    batch_size,
+                    vocab_size,
+                    static_cast<int>(parameters->sequence_length),
+                    parameters->max_length,
+                    this->IsCuda());
+
+  if (parameters->do_sample) {
+    greedy_state.InitSampling(this->cpu_allocator_, batch_size, vocab_size, parameters->seed);
+  }
+
+  DecoderState target{&gpt_subgraph_, &this->decoder_session_state_, &feeds_fetches_manager};
+  DecoderState draft{&draft_subgraph_, &draft_session_state_, &draft_feeds_fetches_manager};
+
+  IAllocatorUniquePtr<char> buffer;
+  IAllocatorUniquePtr<char> draft_buffer;
+  OrtValue expanded_input_ids_in_cpu;
+  OrtValue draft_expanded_input_ids;
+  BufferUniquePtr draft_sequence_lengths_buffer;
+  gsl::span<int32_t> draft_sequence_lengths = AllocateBuffer<int32_t>(this->cpu_allocator_,
+                                                                      draft_sequence_lengths_buffer,
+                                                                      batch_size);
+  ORT_RETURN_IF_ERROR(CreateInitialFeeds(target, greedy_state.sequence_lengths, expanded_input_ids_in_cpu, buffer));
+  ORT_RETURN_IF_ERROR(CreateInitialFeeds(draft, draft_sequence_lengths, draft_expanded_input_ids, draft_buffer));
+  prompt_position_ids_ = target.feeds[1];
+  prompt_attention_mask_ = target.feeds[2];
+
+  init_greedy_state_func_(&greedy_state,
+                          greedy_state.sequence_lengths,
+                          this->cuda_stream_);
+
+  gsl::span<const int32_t> input_ids = expanded_input_ids_in_cpu.Get<Tensor>().DataAsSpan<int32_t>();
+  greedy_state.SetSequence(input_ids,
+                           static_cast<size_t>(batch_size),
+                           parameters->max_length,
+                           parameters->sequence_length);
+
+  // Reuse past state of prompt prefix that was computed in previous runs.
+  target.past_length = gpt_subgraph_.UsePrefixCache(greedy_state.sequence_lengths, parameters->num_beams,
+                                                    target.feeds, this->context_.Logger());
+
+  draft_tokens_.assign(static_cast<size_t>(batch_size) * num_speculative_tokens, 0);
+
+  // Logits of one position in the output of target model, in the shape of (batch_size, 1, vocab_size).
+  BufferUniquePtr step_logits_buffer;
+  gsl::span<T> step_logits_data = AllocateBuffer<T>(this->cpu_allocator_,
+                                                    step_logits_buffer,
+                                                    SafeInt<size_t>(batch_size) * vocab_size);
+  int64_t step_logits_dims[] = {batch_size, 1, vocab_size};
+  OrtValue step_logits;
+  Tensor::InitOrtValue(DataTypeImpl::GetType<T>(),
+                       TensorShape(&step_logits_dims[0], 3),
+                       step_logits_data.data(),
+                       this->cpu_allocator_->Info(),
+                       step_logits);
+
+  int current_length = parameters->sequence_length;
+  int iteration_counter = 0;
+  bool all_eos_meet = false;
+  while (current_length < parameters->max_length && !all_eos_meet) {
+    // At most max_length - current_length tokens can be generated, and the target model generates one token
+    // more than the proposed tokens.
+    const int num_draft_tokens = std::min(num_speculative_tokens, parameters->max_length - current_length - 1);
+
+    // Draft model proposes tokens one by one. Like generated tokens, a proposed end token is replaced by padding.
+    for (int j = 0; j < num_draft_tokens; j++) {
+      ORT_RETURN_IF_ERROR(RunDecoder(draft, greedy_state, current_length, j));
+      const Tensor& logits = draft.fetches[0].Get<Tensor>();
+      const int64_t logits_length = logits.Shape()[1];
+      const T* logits_data = logits.Data<T>();
+      for (int i = 0; i < batch_size; i++) {
+        const T* row = logits_data + (static_cast<int64_t>(i) * logits_length + logits_length - 1) * vocab_size;
+        int32_t token = static_cast<int32_t>(std::max_element(row, row + vocab_size) - row);
+        draft_tokens_[i * num_speculative_tokens + j] = token == parameters->eos_token_id
+                                                            ? parameters->pad_token_id
+                                                            : token;
+      }
+    }
+
+    // Target model runs once to get logits after each proposed token.
+    ORT_RETURN_IF_ERROR(RunDecoder(target, greedy_state, current_length, num_draft_tokens));
+    if (iteration_counter == 0) {
+      gpt_subgraph_.UpdatePrefixCache(greedy_state.sequence_lengths, parameters->num_beams,
+                                      expanded_input_ids_in_cpu, target.feeds, target.fetches);
+    }
+    const Tensor& logits = target.fetches[0].Get<Tensor>();
+    const int64_t logits_length = logits.Shape()[1];
+    const T* logits_data = logits.Data<T>();
+
+    // Generate tokens from logits until a generated token is different from the proposed one in any sequence.
+    for (int j = 0; j <= num_draft_tokens; j++) {
+      const int64_t position = logits_length - (num_draft_tokens + 1) + j;
+      for (int i = 0; i < batch_size; i++) {
+        const T* source = logits_data + (static_cast<int64_t>(i) * logits_length + position) * vocab_size;
+        std::copy_n(source, vocab_size, step_logits_data.data() + static_cast<size_t>(i) * vocab_size);
+      }
+
+      iteration_counter++;
+      gsl::span<int32_t> next_tokens;
+      ORT_RETURN_IF_ERROR(this->GenerateNextToken(step_logits,
+                                                  next_tokens,
+                                                  greedy_state,
+                                                  iteration_counter,
+                                                  parameters->eos_token_id));
+      ++current_length;
+
+      // When all batches are finished, stop earlier to avoid wasting computation.
+      all_eos_meet = std::all_of(greedy_state.eos_meet.begin(), greedy_state.eos_meet.end(),
+                                 [](bool eos_meet) { return eos_meet; });
+      if (all_eos_meet || j == num_draft_tokens) {
+        break;
+      }
+
+      bool accepted = true;
+      for (int i = 0; i < batch_size && accepted; i++) {
+        accepted = (next_tokens[i] == draft_tokens_[i * num_speculative_tokens + j]);
+      }
+      if (!accepted) {
+        break;
+      }
+    }
+
+    // The last generated token is not in past state yet. Past state of rejected tokens is discarded.
+    TruncatePast(target, current_length - 1);
+    TruncatePast(draft, current_length - 1);
+  }
+
+  // Copy the sequences to output
+  gsl::span<int32_t> output = output_sequences->MutableDataAsSpan<int32_t>();
+  for (int batch_id = 0; batch_id < parameters->batch_size; ++batch_id) {
+    auto batch_output = output.subspan(
+        static_cast<size_t>(batch_id) * parameters->max_length,
+        parameters->max_length);
+    gsl::span<const int32_t> sequence_source = greedy_state.sequences.GetSequence(batch_id);
+    gsl::copy(sequence_source, batch_output);
+  }
+
+  return Status::OK();
+}
+
+}  // namespace transformers
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -14,6 +14,23 @@ void GreedySearchParameters::ParseFromAttributes(const OpKernelInfo& info) {
   pad_token_id = static_cast<int>(info.GetAttrOrDefault<int64_t>("pad_token_id", -1));
   decoder_start_token_id = static_cast<int>(info.GetAttrOrDefault<int64_t>("decoder_start_token_id", -1));
   no_repeat_ngram_size = static_cast<int>(info.GetAttrOrDefault<int64_t>("no_repeat_ngram_size", 0));
+  prefix_cache_size = info.GetAttrOrDefault<int64_t>("prefix_cache_size", 0);
+  ORT_ENFORCE(prefix_cache_size >= 0, "prefix_cache_size shall not be negative, got ", prefix_cache_size);
+  num_speculative_tokens = static_cast<int>(info.GetAttrOrDefault<int64_t>("num_speculative_tokens", 4));
+  ORT_ENFORCE(num_speculative_tokens >= 1, "num_speculative_tokens shall be at least 1, got ", num_speculative_tokens);
+}
+
+void GreedySearchParameters::ParseSamplingAttributes(const OpKernelInfo& info) {
+  do_sample = true;
+  temperature = info.GetAttrOrDefault<float>("temperature", 1.0f);
+  top_k = static_cast<int>(info.GetAttrOrDefault<int64_t>("top_k", 0));
+  top_p = info.GetAttrOrDefault<float>("top_p", 1.0f);
+  min_tokens_to_keep = static_cast<int>(info.GetAttrOrDefault<int64_t>("min_tokens_to_keep", 1));
+
+  ORT_ENFORCE(temperature > 0.0f, "temperature shall be greater than 0, got ", temperature);
+  ORT_ENFORCE(top_k >= 0, "top_k shall not be negative, got ", top_k);
+  ORT_ENFORCE(top_p > 0.0f && top_p <= 1.0f, "top_p shall be in the range of (0, 1], got ", top_p);
+  ORT_ENFORCE(min_tokens_to_keep >= 1, "min_tokens_to_keep shall be at least 1, got ", min_tokens_to_keep);
 }
 
 void GreedySearchParameters::ParseFromInputs(OpKernelContext* context) {
@@ -39,6 +56,14 @@ void GreedySearchParameters::ParseFromInputs(OpKernelContext* context) {
   auto* repetition_penalty_tensor = context->Input<Tensor>(3);
   repetition_penalty = repetition_penalty_tensor ? static_cast<float>(*repetition_penalty_tensor->Data<float>()) : 1.0f;
   ORT_ENFORCE(repetition_penalty > 0.0f, "repetition_penalty shall be greater than 0, got ", repetition_penalty);
+
+  // When seed is not given, the seed set by the Sampling operator for this run is used.
+  if (do_sample) {
+    auto* seed_tensor = context->Input<Tensor>(6);
+    if (seed_tensor) {
+      seed = static_cast<int>(*seed_tensor->Data<int32_t>());
+    }
+  }
 }
 
 }  // namespace transformers
@@ -15,7 +15,13 @@ struct GreedySearchParameters : public BeamSearchParameters {
 
   void ParseFromAttributes(const OpKernelInfo& info);
 
+  // Parse the additional attributes of Sampling operator, and enable sampling.
+  void ParseSamplingAttributes(const OpKernelInfo& info);
+
   void ParseFromInputs(OpKernelContext* context);
+
+  // Number of tokens proposed by the draft decoder in each step of speculative decoding.
+  int num_speculative_tokens = 4;
 };
 
 }  // namespace transformers
@@ -4,50 +4,115 @@
 #include <memory>
 #include <assert.h>
 #include "core/common/safeint.h"
+#include "core/platform/threadpool.h"
 #include "contrib_ops/cpu/transformers/logits_processor.h"
-#include "contrib_ops/cpu/transformers/dump_tensor.h"
 
 namespace onnxruntime {
 namespace contrib {
 namespace transformers {
 
-template <typename T>
-gsl::span<T> NextTokenScores<T>::GetScores(int batch_beam_index) {
-  assert(batch_beam_index >= 0 && batch_beam_index < batch_beam_size);
-  return scores.subspan(static_cast<gsl::index>(batch_beam_index) * vocab_size, vocab_size);
+// Base of the polynomial rolling hash of n-gram prefixes.
+constexpr uint64_t kHashBase = 0x100000001B3ULL;
+
+void SequenceTokenIndex::Init(int vocab_size, bool track_unique_tokens, int ngram_size) {
+  track_unique_tokens_ = track_unique_tokens;
+  if (track_unique_tokens_) {
+    token_bits_.assign((static_cast<size_t>(vocab_size) + 63) / 64, 0);
+  }
+
+  ngram_size_ = ngram_size;
+  window_power_ = 1;
+  for (int i = 1; i < ngram_size_; i++) {
+    window_power_ *= kHashBase;
+  }
 }
 
-template <typename T>
-void NextTokenScores<T>::SetScore(int token_id, T score) {
-  assert(token_id >= 0 && token_id < vocab_size);
-  for (int i = 0; i < batch_beam_size; i++) {
-    scores[static_cast<gsl::index>(i) * vocab_size + token_id] = score;
+void SequenceTokenIndex::Build(gsl::span<const int32_t> sequence) {
+  for (int32_t token : unique_tokens_) {
+    token_bits_[static_cast<size_t>(token) / 64] = 0;
+  }
+  unique_tokens_.clear();
+
+  window_hash_ = 0;
+  std::fill(ngram_keys_.begin(), ngram_keys_.end(), 0);
+  num_ngrams_ = 0;
+
+  for (size_t length = 1; length <= sequence.size(); length++) {
+    Append(sequence.first(length));
   }
 }
 
-#ifdef DEBUG_GENERATION
-template <typename T>
-void DumpScores(const char* name, const NextTokenScores<T>& next_token_scores) {
-  std::cout << name << std::endl;
-  ORT_UNUSED_PARAMETER(next_token_scores);
+void SequenceTokenIndex::Append(gsl::span<const int32_t> sequence) {
+  const size_t length = sequence.size();
+  const int32_t token = sequence[length - 1];
+
+  if (track_unique_tokens_) {
+    uint64_t& bits = token_bits_[static_cast<size_t>(token) / 64];
+    const uint64_t bit = uint64_t{1} << (static_cast<size_t>(token) % 64);
+    if ((bits & bit) == 0) {
+      bits |= bit;
+      unique_tokens_.push_back(token);
+    }
+  }
+
+  if (ngram_size_ > 1) {
+    // The new token completes the n-gram whose prefix is the window of last ngram_size - 1 tokens.
+    const size_t prefix_length = static_cast<size_t>(ngram_size_) - 1;
+    if (length > prefix_length) {
+      InsertNGram(window_hash_, static_cast<int32_t>(length - 1 - prefix_length));
+    }
+
+    // Roll the window: add the new token and remove the token that leaves the window.
+    window_hash_ = window_hash_ * kHashBase + static_cast<uint64_t>(token);
+    if (length > prefix_length) {
+      window_hash_ -= window_power_ * static_cast<uint64_t>(sequence[length - 1 - prefix_length]);
+    }
+  }
+}
+
+void SequenceTokenIndex::InsertNGram(uint64_t prefix_hash, int32_t start) {
+  // Keep the load factor at most 1/2.
+  if (2 * (num_ngrams_ + 1) > ngram_keys_.size()) {
+    std::vector<uint64_t> keys = std::move(ngram_keys_);
+    std::vector<int32_t> starts = std::move(ngram_starts_);
+    const size_t capacity = std::max<size_t>(64, 2 * keys.size());
+    ngram_keys_.assign(capacity, 0);
+    ngram_starts_.assign(capacity, 0);
+    ngram_shift_ = 64;
+    for (size_t size = capacity; size > 1; size /= 2) {
+      ngram_shift_--;
+    }
+
+    num_ngrams_ = 0;
+    for (size_t i = 0; i < keys.size(); i++) {
+      if (keys[i] != 0) {
+        InsertNGram(keys[i], starts[i]);
+      }
+    }
+  }
+
+  // 0 marks an empty slot, so it is not used as key.
+  const uint64_t key = prefix_hash == 0 ? 1 : prefix_hash;
+  const size_t mask = ngram_keys_.size() - 1;
+  size_t slot = GetSlot(key);
+  while (ngram_keys_[slot] != 0) {
+    slot = (slot + 1) & mask;
+  }
+  ngram_keys_[slot] = key;
+  ngram_starts_[slot] = start;
+  num_ngrams_++;
 }
-#endif
 
-// Interface for all scorers for beam search or beam sample.
 template <typename T>
 MinLengthLogitsProcessor<T>::MinLengthLogitsProcessor(int min_length, int eos_token_id)
     : min_length_(min_length), eos_token_id_(eos_token_id) {}
 
 template <typename T>
-void MinLengthLogitsProcessor<T>::Process(const ISequences* sequences,
-                                          NextTokenScores<T>& next_token_scores) {
-  if (sequences->GetSequenceLength() < min_length_) {
-    next_token_scores.SetScore(eos_token_id_, std::numeric_limits<T>::lowest());
+void MinLengthLogitsProcessor<T>::Process(const BeamTokens& tokens,
+                                          gsl::span<T> beam_token_scores) {
+  if (static_cast<int>(tokens.sequence.size()) < min_length_) {
+    beam_token_scores[eos_token_id_] = std::numeric_limits<T>::lowest();
   }
-
-#ifdef DEBUG_GENERATION
-  DumpScores("MinLengthLogitsProcessor", next_token_scores);
-#endif
 }
 
 template <typename T>
@@ -55,31 +120,16 @@ RepetitionPenaltyLogitsProcessor<T>::RepetitionPenaltyLogitsProcessor(float pena
 }
 
 template <typename T>
-void RepetitionPenaltyLogitsProcessor<T>::Process(const ISequences* sequences,
-                                                  NextTokenScores<T>& next_token_scores) {
-  const int batch_beam_size = next_token_scores.batch_beam_size;
-  for (int i = 0; i < batch_beam_size; i++) {
-    gsl::span<T> beam_token_scores = next_token_scores.GetScores(i);
-    gsl::span<const int32_t> sequence = sequences->GetSequence(i);
-
-    // Find unique word IDs in sequence.
-    std::unordered_set<int32_t> unique_word_ids;
-    for (const auto& word_id : sequence) {
-      unique_word_ids.insert(word_id);
-    }
-
-    for (const int32_t word_id : unique_word_ids) {
-      T score = beam_token_scores[word_id];
-
-      // If score < 0, then repetition penalty > 1.0 has to multiplied to reduce the previous token probability,
-      // This assumes that scores are either positive (like ctrl) or negative (like GPT-2), but not a mixture.
-      beam_token_scores[word_id] = (score < 0 ? score * penalty_ : score / penalty_);
-    }
+void RepetitionPenaltyLogitsProcessor<T>::Process(const BeamTokens& tokens,
+                                                  gsl::span<T> beam_token_scores) {
+  assert(tokens.index != nullptr);
+  for (const int32_t word_id : tokens.index->UniqueTokens()) {
+    T score = beam_token_scores[word_id];
+
+    // If score < 0, then repetition penalty > 1.0 has to multiplied to reduce the previous token probability,
+    // This assumes that scores are either positive (like ctrl) or negative (like GPT-2), but not a mixture.
+    beam_token_scores[word_id] = (score < 0 ? score * penalty_ : score / penalty_);
   }
-
-#ifdef DEBUG_GENERATION
-  DumpScores("RepetitionPenaltyLogitsProcessor", next_token_scores);
-#endif
 }
 
 template <typename T>
@@ -87,122 +137,142 @@ NoRepeatNGramLogitsProcessor<T>::NoRepeatNGramLogitsProcessor(int ngram_size) :
 }
 
 template <typename T>
-void NoRepeatNGramLogitsProcessor<T>::Process(const ISequences* sequences,
-                                              NextTokenScores<T>& next_token_scores) {
-  if (ngram_size_ == 0 || ngram_size_ > sequences->GetSequenceLength()) {
+void NoRepeatNGramLogitsProcessor<T>::Process(const BeamTokens& tokens,
+                                              gsl::span<T> beam_token_scores) {
+  if (ngram_size_ == 0 || ngram_size_ > static_cast<int>(tokens.sequence.size())) {
     return;
   }
 
-  const gsl::index prefix_length = static_cast<gsl::index>(ngram_size_) - 1;
-  int batch_beam_size = next_token_scores.batch_beam_size;
-
-  for (int i = 0; i < batch_beam_size; i++) {
-    gsl::span<T> beam_token_scores = next_token_scores.GetScores(i);
-    gsl::span<const int32_t> sequence = sequences->GetSequence(i);
-
-    gsl::span<const int32_t> prefix = sequence.subspan(sequence.length() - prefix_length);
-    ORT_ENFORCE(prefix.length() == prefix_length);
-
-    std::unordered_set<int32_t> blocked_word_ids;
-    for (int j = 0; j <= static_cast<int>(sequence.length()) - ngram_size_; j++) {
-      // Here we use naive algorithm for matching. The complexity is O(batch_beam_size * ngram_size * sequence_length)
-      // TODO(tianleiwu): build N-Gram index (hash table with prefix of length NGram - 1 as key,
-      //                  and list of last word of NGram as value) for fast matching.
-      if (ngram_size_ == 1 || prefix == sequence.subspan(j, prefix_length)) {
-        blocked_word_ids.insert(sequence[static_cast<gsl::index>(j) + prefix_length]);
-      }
-    }
-
-    for (const int32_t word_id : blocked_word_ids) {
-      beam_token_scores[word_id] = std::numeric_limits<T>::lowest();
-    }
-  }
-
-#ifdef DEBUG_GENERATION
-  DumpScores("NoRepeatNGramLogitsProcessor", next_token_scores);
-#endif
-}
-
-template <typename T>
-VocabMaskLogitsProcessor<T>::VocabMaskLogitsProcessor(const gsl::span<const int32_t>& vocab_mask)
-    : vocab_mask_(vocab_mask) {
+  assert(tokens.index != nullptr);
+  tokens.index->ForEachRepeatedNGramToken(tokens.sequence, [&beam_token_scores](int32_t word_id) {
+    beam_token_scores[word_id] = std::numeric_limits<T>::lowest();
+  });
 }
 
 template <typename T>
-void VocabMaskLogitsProcessor<T>::Process(const ISequences* /*sequences*/,
-                                          NextTokenScores<T>& next_token_scores) {
-  assert(!vocab_mask_.empty());
-
-  // Process vocabulary mask and set tokens with mask value 0 to -inf.
-  T* p = next_token_scores.scores.data();
-  // next_token_scores shape (batch_size * num_beams, vocab_size)
-  // vocab_mask shape (vocab_size).
-  for (int i = 0; i < next_token_scores.batch_beam_size; i++) {
-    for (int j = 0; j < next_token_scores.vocab_size; j++, p++) {
-      if (vocab_mask_[j] == 0) {
-        *p = std::numeric_limits<T>::lowest();
-      }
+VocabMaskLogitsProcessor<T>::VocabMaskLogitsProcessor(const gsl::span<const int32_t>& vocab_mask) {
+  for (size_t i = 0; i < vocab_mask.size(); i++) {
+    if (vocab_mask[i] == 0) {
+      masked_tokens_.push_back(static_cast<int32_t>(i));
     }
   }
-
-#ifdef DEBUG_GENERATION
-  DumpScores("VocabMaskLogitsProcessor", next_token_scores);
-#endif
 }
 
 template <typename T>
-PrefixVocabMaskLogitsProcessor<T>::PrefixVocabMaskLogitsProcessor(const gsl::span<const int32_t>& prefix_vocab_mask,
-                                                                  int batch_size)
-    : prefix_vocab_mask_(prefix_vocab_mask),
-      batch_size_(batch_size) {
+void VocabMaskLogitsProcessor<T>::Process(const BeamTokens& /*tokens*/,
+                                          gsl::span<T> beam_token_scores) {
+  // Set tokens with mask value 0 to -inf. Only masked tokens are visited instead of the whole vocabulary.
+  T* p = beam_token_scores.data();
+  for (const int32_t word_id : masked_tokens_) {
+    p[word_id] = std::numeric_limits<T>::lowest();
+  }
 }
 
 template <typename T>
-void PrefixVocabMaskLogitsProcessor<T>::Process(const ISequences* /*sequences*/,
-                                                NextTokenScores<T>& next_token_scores) {
-  assert(!prefix_vocab_mask_.empty());
-
-  // next_token_scores shape (batch_size * num_beams, vocab_size)
-  int num_beams = next_token_scores.batch_beam_size / batch_size_;
-  assert(num_beams * batch_size_ == next_token_scores.batch_beam_size);
-
-  // Process prefix vocabulary mask and set tokens with mask value 0 to -inf.
+PrefixVocabMaskLogitsProcessor<T>::PrefixVocabMaskLogitsProcessor(const gsl::span<const int32_t>& prefix_vocab_mask,
+                                                                  int batch_size,
+                                                                  int num_beams)
+    : num_beams_(num_beams) {
   // prefix_vocab_mask shape (batch_size, vocab_size).
-  T* p = next_token_scores.scores.data();
-  for (int i = 0; i < batch_size_; i++) {
-    size_t prefix_vocab_mask_offset = SafeInt<size_t>(i) * next_token_scores.vocab_size;
-    for (int j = 0; j < num_beams; j++) {
-      for (int k = 0; k < next_token_scores.vocab_size; k++, p++) {
-        if (prefix_vocab_mask_[prefix_vocab_mask_offset + static_cast<size_t>(k)] == 0) {
-          *p = std::numeric_limits<T>::lowest();
-        }
-      }
+  assert(!prefix_vocab_mask.empty());
+  const size_t vocab_size = prefix_vocab_mask.size() / static_cast<size_t>(batch_size);
+  masked_offsets_.push_back(0);
+  for (size_t i = 0; i < prefix_vocab_mask.size(); i++) {
+    if (prefix_vocab_mask[i] == 0) {
+      masked_tokens_.push_back(static_cast<int32_t>(i % vocab_size));
+    }
+    if ((i + 1) % vocab_size == 0) {
+      masked_offsets_.push_back(masked_tokens_.size());
     }
   }
+}
 
-#ifdef DEBUG_GENERATION
-  DumpScores("PrefixVocabMaskLogitsProcessor", next_token_scores);
-#endif
+template <typename T>
+void PrefixVocabMaskLogitsProcessor<T>::Process(const BeamTokens& tokens,
+                                                gsl::span<T> beam_token_scores) {
+  // Set tokens with mask value 0 in the batch of the beam to -inf.
+  const size_t batch_index = static_cast<size_t>(tokens.beam_index / num_beams_);
+  assert(batch_index + 1 < masked_offsets_.size());
+  T* p = beam_token_scores.data();
+  for (size_t i = masked_offsets_[batch_index]; i < masked_offsets_[batch_index + 1]; i++) {
+    p[masked_tokens_[i]] = std::numeric_limits<T>::lowest();
+  }
 }
 
-void LogitsProcessorList::Init(const BeamSearchParameters& parameters) {
-  LogitsProcessorInitImpl<BeamSearchParameters>(parameters);
+void LogitsProcessorList::Init(const BeamSearchParameters& parameters, concurrency::ThreadPool* thread_pool) {
+  LogitsProcessorInitImpl<BeamSearchParameters>(parameters, thread_pool);
 }
 
-void LogitsProcessorList::Init(const GreedySearchParameters& parameters) {
-  LogitsProcessorInitImpl<GreedySearchParameters>(parameters);
+void LogitsProcessorList::Init(const GreedySearchParameters& parameters, concurrency::ThreadPool* thread_pool) {
+  LogitsProcessorInitImpl<GreedySearchParameters>(parameters, thread_pool);
 }
 
 void LogitsProcessorList::Process(const ISequences* sequences,
                                   gsl::span<float>& next_token_scores,
                                   int step) {
-  NextTokenScores<float> input_scores = {next_token_scores, batch_beam_size_, vocab_size_};
-  for (size_t i = 0; i < processor_list_.size(); i++) {
-    // Prefix vocab mask is applied to first iteration only.
-    if (step > 1 && processor_list_[i] == prefix_vocab_mask_processor_.get()) {
-      continue;
+  if (processor_list_.empty()) {
+    return;
+  }
+
+  // Token indices are updated with the new token when sequences grow by one token since last call, and built from
+  // the whole sequences otherwise, like in the first step.
+  const int sequence_length = sequences->GetSequenceLength();
+  const bool incremental = sequence_length == indexed_length_ + 1;
+  gsl::span<const int32_t> previous_beam_indices = sequences->GetPreviousBeamIndices();
+  if (use_token_index_ && incremental && !previous_beam_indices.empty()) {
+    reference_counts_.assign(static_cast<size_t>(batch_beam_size_), 0);
+    for (int32_t beam_index : previous_beam_indices) {
+      reference_counts_[beam_index]++;
     }
-    processor_list_[i]->Process(sequences, input_scores);
+  }
+
+  std::vector<SequenceTokenIndex>& previous_indices = token_indices_[current_indices_];
+  std::vector<SequenceTokenIndex>& indices = token_indices_[1 - current_indices_];
+
+  // Prefix vocab mask is applied to first iteration only.
+  const ILogitsProcessor<float>* skipped = step > 1 ? prefix_vocab_mask_processor_.get() : nullptr;
+
+  // Updating token index costs a few operations per token of sequence, and processors touch a small part of
+  // the vocabulary.
+  const double cost = static_cast<double>(sequence_length) * 4.0 + static_cast<double>(vocab_size_) / 16.0;
+  concurrency::ThreadPool::TryParallelFor(
+      thread_pool_, static_cast<std::ptrdiff_t>(batch_beam_size_), cost,
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        for (std::ptrdiff_t i = begin; i < end; i++) {
+          const int beam_index = static_cast<int>(i);
+          BeamTokens tokens{beam_index, sequences->GetSequence(beam_index), nullptr};
+
+          if (use_token_index_) {
+            SequenceTokenIndex& index = indices[beam_index];
+            if (!incremental) {
+              index.Build(tokens.sequence);
+            } else {
+              // Take the index of the beam that this beam continues from. It is moved when no other beam
+              // continues from the same beam, which is always the case in greedy search.
+              const int previous = previous_beam_indices.empty() ? beam_index : previous_beam_indices[beam_index];
+              if (previous_beam_indices.empty() || reference_counts_[previous] == 1) {
+                std::swap(index, previous_indices[previous]);
+              } else {
+                index = previous_indices[previous];
+              }
+              index.Append(tokens.sequence);
+            }
+            tokens.index = &index;
+          }
+
+          gsl::span<float> beam_token_scores = next_token_scores.subspan(
+              SafeInt<gsl::index>(beam_index) * vocab_size_, static_cast<gsl::index>(vocab_size_));
+          for (ILogitsProcessor<float>* processor : processor_list_) {
+            if (processor != skipped) {
+              processor->Process(tokens, beam_token_scores);
+            }
+          }
+        }
+      });
+
+  if (use_token_index_) {
+    current_indices_ = 1 - current_indices_;
+    indexed_length_ = sequence_length;
   }
 }
 
@@ -3,6 +3,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <memory>
+#include <vector>
 #include "core/common/inlined_containers.h"
 #include "contrib_ops/cpu/transformers/sequences.h"
 #include "contrib_ops/cpu/transformers/beam_search_parameters.h"
@@ -13,25 +16,92 @@ namespace onnxruntime {
 namespace contrib {
 namespace transformers {
 
-template <typename T>
-struct NextTokenScores {
-  gsl::span<T>& scores;
-  int batch_beam_size;
-  int vocab_size;
+// Index of tokens in the sequence of a beam. It is updated with the new token of each step, so that logits processors
+// do not rescan the whole sequence: a bitmap of seen tokens with the list of unique tokens, and a hash table of
+// n-grams keyed by a rolling hash of their prefix.
+class SequenceTokenIndex {
+ public:
+  void Init(int vocab_size, bool track_unique_tokens, int ngram_size);
+
+  // Build the index from the whole sequence.
+  void Build(gsl::span<const int32_t> sequence);
 
-  gsl::span<T> GetScores(int batch_beam_index);
+  // Update the index with the last token of the sequence. The index shall contain the sequence without that token.
+  void Append(gsl::span<const int32_t> sequence);
 
-  void SetScore(int token_id, T score);
+  // Unique tokens in order of first appearance.
+  gsl::span<const int32_t> UniqueTokens() const { return unique_tokens_; }
+
+  // Call func for each token that would complete an n-gram that is already in the sequence.
+  template <typename Func>
+  void ForEachRepeatedNGramToken(gsl::span<const int32_t> sequence, Func&& func) const;
+
+ private:
+  void InsertNGram(uint64_t prefix_hash, int32_t start);
+
+  size_t GetSlot(uint64_t key) const {
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> ngram_shift_);
+  }
+
+  bool track_unique_tokens_ = false;
+  std::vector<uint64_t> token_bits_;    // bitmap of tokens in the sequence, shape (vocab_size / 64)
+  std::vector<int32_t> unique_tokens_;  // tokens in the sequence without duplication
+
+  int ngram_size_ = 0;
+  uint64_t window_power_ = 1;        // kHashBase ** (ngram_size - 1)
+  uint64_t window_hash_ = 0;         // hash of the last ngram_size - 1 tokens
+  std::vector<uint64_t> ngram_keys_;  // open addressing hash table: prefix hash of n-gram, and 0 for empty slot
+  std::vector<int32_t> ngram_starts_;  // start position of the n-gram in the sequence
+  size_t num_ngrams_ = 0;
+  int ngram_shift_ = 64;  // 64 - log2(table size)
+};
+
+template <typename Func>
+void SequenceTokenIndex::ForEachRepeatedNGramToken(gsl::span<const int32_t> sequence, Func&& func) const {
+  const size_t length = sequence.size();
+  if (ngram_size_ == 0 || static_cast<size_t>(ngram_size_) > length) {
+    return;
+  }
+
+  if (ngram_size_ == 1) {
+    for (int32_t token : unique_tokens_) {
+      func(token);
+    }
+    return;
+  }
+
+  // Candidates with the same prefix hash are verified, so hash collisions do not block tokens by mistake.
+  const size_t prefix_length = static_cast<size_t>(ngram_size_) - 1;
+  gsl::span<const int32_t> prefix = sequence.subspan(length - prefix_length);
+  const uint64_t key = window_hash_ == 0 ? 1 : window_hash_;
+  const size_t mask = ngram_keys_.size() - 1;
+  for (size_t slot = GetSlot(key); ngram_keys_[slot] != 0; slot = (slot + 1) & mask) {
+    if (ngram_keys_[slot] == key) {
+      const size_t start = static_cast<size_t>(ngram_starts_[slot]);
+      if (std::equal(prefix.begin(), prefix.end(), sequence.begin() + start)) {
+        func(sequence[start + prefix_length]);
+      }
+    }
+  }
+}
+
+// Tokens of a beam that are visible to logits processors.
+struct BeamTokens {
+  int beam_index;
+  gsl::span<const int32_t> sequence;
+  const SequenceTokenIndex* index;  // index of the sequence. nullptr when no processor requires it.
 };
 
 // Interface for all scorers for beam search or beam sample.
+// Processors update the scores of one beam at a time, so that all processors are applied in a single pass over
+// the beams while the scores of a beam are in cache, and beams are processed in parallel.
 template <typename T>
 class ILogitsProcessor {
  public:
   virtual ~ILogitsProcessor() {}
 
-  virtual void Process(const ISequences* sequences,
-                       NextTokenScores<T>& next_token_scores) = 0;
+  virtual void Process(const BeamTokens& tokens,
+                       gsl::span<T> beam_token_scores) = 0;
 };
 
 template <typename T>
@@ -39,8 +109,8 @@ class MinLengthLogitsProcessor : public ILogitsProcessor<T> {
  public:
   MinLengthLogitsProcessor(int min_length, int eos_token_id);
 
-  void Process(const ISequences* sequences,
-               NextTokenScores<T>& next_token_scores) override;
+  void Process(const BeamTokens& tokens,
+               gsl::span<T> beam_token_scores) override;
 
  private:
   int min_length_;
@@ -52,8 +122,8 @@ class RepetitionPenaltyLogitsProcessor : public ILogitsProcessor<T> {
  public:
   RepetitionPenaltyLogitsProcessor(float penalty);
 
-  void Process(const ISequences* sequences,
-               NextTokenScores<T>& next_token_scores) override;
+  void Process(const BeamTokens& tokens,
+               gsl::span<T> beam_token_scores) override;
 
  private:
   float penalty_;
@@ -64,8 +134,8 @@ class NoRepeatNGramLogitsProcessor : public ILogitsProcessor<T> {
  public:
   NoRepeatNGramLogitsProcessor(int ngram_size);
 
-  void Process(const ISequences* sequences,
-               NextTokenScores<T>& next_token_scores) override;
+  void Process(const BeamTokens& tokens,
+               gsl::span<T> beam_token_scores) override;
 
  private:
   int ngram_size_;
@@ -76,36 +146,38 @@ class VocabMaskLogitsProcessor : public ILogitsProcessor<T> {
  public:
   VocabMaskLogitsProcessor(const gsl::span<const int32_t>& vocab_mask);
 
-  void Process(const ISequences* sequences,
-               NextTokenScores<T>& next_token_scores) override;
+  void Process(const BeamTokens& tokens,
+               gsl::span<T> beam_token_scores) override;
 
  private:
-  gsl::span<const int32_t> vocab_mask_;
+  std::vector<int32_t> masked_tokens_;  // tokens with mask value 0
 };
 
 template <typename T>
 class PrefixVocabMaskLogitsProcessor : public ILogitsProcessor<T> {
  public:
-  PrefixVocabMaskLogitsProcessor(const gsl::span<const int32_t>& vocab_mask, int batch_size);
+  PrefixVocabMaskLogitsProcessor(const gsl::span<const int32_t>& vocab_mask, int batch_size, int num_beams);
 
-  void Process(const ISequences* sequences,
-               NextTokenScores<T>& next_token_scores) override;
+  void Process(const BeamTokens& tokens,
+               gsl::span<T> beam_token_scores) override;
 
  private:
-  gsl::span<const int32_t> prefix_vocab_mask_;
-  const int batch_size_;
+  // Tokens with mask value 0 in batch i are masked_tokens_[masked_offsets_[i], masked_offsets_[i + 1]).
+  std::vector<int32_t> masked_tokens_;
+  std::vector<size_t> masked_offsets_;
+  const int num_beams_;
 };
 
 class LogitsProcessorList : public ILogitsProcessorList {
  public:
   LogitsProcessorList() = default;
-  void Init(const BeamSearchParameters& parameters);
-  void Init(const GreedySearchParameters& parameters);
+  void Init(const BeamSearchParameters& parameters, concurrency::ThreadPool* thread_pool);
+  void Init(const GreedySearchParameters& parameters, concurrency::ThreadPool* thread_pool);
   void Process(const ISequences* sequences, gsl::span<float>& next_token_scores, int step);
 
  private:
   template<typename GenerationParametersT>
-  void LogitsProcessorInitImpl(const GenerationParametersT& parameters) {
+  void LogitsProcessorInitImpl(const GenerationParametersT& parameters, concurrency::ThreadPool* thread_pool) {
     processor_list_.clear();
 
     if (parameters.repetition_penalty != 1.0f) {  // 1.0 means no penalty
@@ -130,7 +202,8 @@ class LogitsProcessorList : public ILogitsProcessorList {
       prefix_vocab_mask_processor_ = std::make_unique<
                                        PrefixVocabMaskLogitsProcessor<float>
                                      >(parameters.prefix_vocab_mask,
-                                       parameters.batch_size);
+                                       parameters.batch_size,
+                                       parameters.num_beams);
       processor_list_.push_back(prefix_vocab_mask_processor_.get());
     }
 
@@ -142,10 +215,25 @@ class LogitsProcessorList : public ILogitsProcessorList {
 
     batch_beam_size_ = parameters.BatchBeamSize();
     vocab_size_ = parameters.vocab_size;
+    thread_pool_ = thread_pool;
+
+    // Repetition penalty and n-gram blocking look up tokens of sequences in the token index.
+    use_token_index_ = repetition_penalty_processor_ != nullptr || no_repeat_ngram_processor_ != nullptr;
+    indexed_length_ = -1;
+    if (use_token_index_) {
+      const bool track_unique_tokens = repetition_penalty_processor_ != nullptr || parameters.no_repeat_ngram_size == 1;
+      for (auto& token_indices : token_indices_) {
+        token_indices.resize(static_cast<size_t>(batch_beam_size_));
+        for (auto& token_index : token_indices) {
+          token_index.Init(vocab_size_, track_unique_tokens, parameters.no_repeat_ngram_size);
+        }
+      }
+    }
   }
 
   int batch_beam_size_;
   int vocab_size_;
+  concurrency::ThreadPool* thread_pool_ = nullptr;
   InlinedVector<ILogitsProcessor<float>*> processor_list_;
 
   std::unique_ptr<RepetitionPenaltyLogitsProcessor<float>> repetition_penalty_processor_;
@@ -153,6 +241,14 @@ class LogitsProcessorList : public ILogitsProcessorList {
   std::unique_ptr<VocabMaskLogitsProcessor<float>> vocab_mask_processor_;
   std::unique_ptr<PrefixVocabMaskLogitsProcessor<float>> prefix_vocab_mask_processor_;
   std::unique_ptr<MinLengthLogitsProcessor<float>> min_length_processor_;
+
+  // Token indices of beams. The beams of a step continue from beams of previous step, so indices are rotated between
+  // two buffers: token_indices_[current_indices_] is for the sequences of last Process call.
+  bool use_token_index_ = false;
+  std::vector<SequenceTokenIndex> token_indices_[2];
+  int current_indices_ = 0;
+  int indexed_length_ = -1;  // sequence length of last Process call
+  std::vector<int> reference_counts_;  // number of beams that continue from each beam of previous step
 };
 
 }  // namespace transformers
@@ -0,0 +1,189 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include "core/common/safeint.h"
+#include "contrib_ops/cpu/transformers/prefix_cache.h"
+
+namespace onnxruntime {
+namespace contrib {
+namespace transformers {
+
+namespace {
+
+constexpr uint64_t kHashBase = 0x100000001B3ULL;
+
+// Offset of the state of (layer, key or value, head) in Entry::data, or in past state of a sequence when
+// num_layers is 1.
+size_t ChunkOffset(int kv, int batch_size, int batch_index, int num_heads, int head, int length, int head_size) {
+  return ((SafeInt<size_t>(kv) * batch_size + batch_index) * num_heads + head) * length * head_size;
+}
+
+}  // namespace
+
+void PrefixCache::Entry::CopyTo(int length,
+                                gsl::span<float* const> past,
+                                int batch_size,
+                                int batch_index,
+                                int max_length) const {
+  ORT_ENFORCE(length <= static_cast<int>(tokens.size()) && length <= max_length);
+  ORT_ENFORCE(past.size() == static_cast<size_t>(num_layers));
+
+  const int entry_length = static_cast<int>(tokens.size());
+  const size_t layer_size = SafeInt<size_t>(2) * num_heads * entry_length * head_size;
+  const size_t chunk_size = SafeInt<size_t>(length) * head_size;
+  for (int layer = 0; layer < num_layers; layer++) {
+    const float* source = data.data() + layer * layer_size;
+    for (int kv = 0; kv < 2; kv++) {
+      for (int head = 0; head < num_heads; head++) {
+        std::copy_n(source + ChunkOffset(kv, 1, 0, num_heads, head, entry_length, head_size),
+                    chunk_size,
+                    past[layer] + ChunkOffset(kv, batch_size, batch_index, num_heads, head, max_length, head_size));
+      }
+    }
+  }
+}
+
+PrefixCache::PrefixCache(size_t max_bytes, int block_size) : max_bytes_(max_bytes), block_size_(block_size) {
+  ORT_ENFORCE(block_size > 0, "block_size shall be positive, got ", block_size);
+}
+
+std::vector<uint64_t> PrefixCache::GetBlockHashes(gsl::span<const int32_t> tokens, int max_length) const {
+  const int length = std::min(static_cast<int>(tokens.size()), max_length);
+  std::vector<uint64_t> hashes;
+  hashes.reserve(static_cast<size_t>(std::max(length / block_size_, 0)));
+
+  uint64_t hash = 0;
+  for (int i = 0; i + block_size_ <= length; i += block_size_) {
+    for (int j = i; j < i + block_size_; j++) {
+      hash = hash * kHashBase + static_cast<uint32_t>(tokens[j]) + 1;
+    }
+    hashes.push_back(hash);
+  }
+  return hashes;
+}
+
+PrefixCache::NodeIterator PrefixCache::FindNode(uint64_t hash, gsl::span<const int32_t> tokens, int length) {
+  auto it = index_.find(hash);
+  if (it == index_.end()) {
+    return lru_.end();
+  }
+
+  // Tokens are compared since different prefixes might have the same hash.
+  const std::vector<int32_t>& entry_tokens = it->second->entry->tokens;
+  if (static_cast<int>(entry_tokens.size()) < length ||
+      !std::equal(tokens.begin(), tokens.begin() + length, entry_tokens.begin())) {
+    return lru_.end();
+  }
+  return it->second;
+}
+
+int PrefixCache::Find(gsl::span<const int32_t> tokens, int max_length, std::shared_ptr<const Entry>& entry) {
+  const std::vector<uint64_t> hashes = GetBlockHashes(tokens, max_length);
+
+  std::lock_guard<OrtMutex> lock(mutex_);
+  for (size_t i = hashes.size(); i > 0; i--) {
+    const int length = static_cast<int>(i) * block_size_;
+    NodeIterator node = FindNode(hashes[i - 1], tokens, length);
+    if (node != lru_.end()) {
+      lru_.splice(lru_.begin(), lru_, node);
+      entry = node->entry;
+      stats_.hits++;
+      stats_.reused_tokens += length;
+      return length;
+    }
+  }
+
+  stats_.misses++;
+  return 0;
+}
+
+void PrefixCache::Insert(gsl::span<const int32_t> tokens,
+                         gsl::span<const float* const> past,
+                         int batch_size,
+                         int batch_index,
+                         int num_heads,
+                         int max_length,
+                         int head_size) {
+  const int length = std::min(static_cast<int>(tokens.size()), max_length) / block_size_ * block_size_;
+  if (length == 0) {
+    return;
+  }
+
+  const int num_layers = static_cast<int>(past.size());
+  const size_t layer_size = SafeInt<size_t>(2) * num_heads * length * head_size;
+  const size_t bytes = (SafeInt<size_t>(num_layers) * layer_size + length) * sizeof(float);
+  if (bytes > max_bytes_) {
+    return;
+  }
+
+  std::vector<uint64_t> hashes = GetBlockHashes(tokens, length);
+  {
+    std::lock_guard<OrtMutex> lock(mutex_);
+    NodeIterator node = FindNode(hashes.back(), tokens, length);
+    if (node != lru_.end()) {
+      lru_.splice(lru_.begin(), lru_, node);
+      return;
+    }
+  }
+
+  // Copy the state outside of the lock.
+  auto entry = std::make_shared<Entry>();
+  entry->tokens.assign(tokens.begin(), tokens.begin() + length);
+  entry->num_layers = num_layers;
+  entry->num_heads = num_heads;
+  entry->head_size = head_size;
+  entry->data.resize(SafeInt<size_t>(num_layers) * layer_size);
+  const size_t chunk_size = SafeInt<size_t>(length) * head_size;
+  for (int layer = 0; layer < num_layers; layer++) {
+    float* target = entry->data.data() + layer * layer_size;
+    for (int kv = 0; kv < 2; kv++) {
+      for (int head = 0; head < num_heads; head++) {
+        std::copy_n(past[layer] + ChunkOffset(kv, batch_size, batch_index, num_heads, head, max_length, head_size),
+                    chunk_size,
+                    target + ChunkOffset(kv, 1, 0, num_heads, head, length, head_size));
+      }
+    }
+  }
+
+  std::lock_guard<OrtMutex> lock(mutex_);
+  if (FindNode(hashes.back(), tokens, length) != lru_.end()) {  // added by another run in the meantime
+    return;
+  }
+
+  lru_.push_front(Node{std::move(entry), std::move(hashes), bytes});
+  for (uint64_t hash : lru_.front().hashes) {
+    index_[hash] = lru_.begin();
+  }
+  stats_.bytes += bytes;
+  stats_.num_entries++;
+  Evict();
+}
+
+void PrefixCache::Evict() {
+  while (stats_.bytes > max_bytes_ && !lru_.empty()) {
+    NodeIterator node = std::prev(lru_.end());
+
+    // Shorter prefixes might be indexed to a newer entry that shares them.
+    for (uint64_t hash : node->hashes) {
+      auto it = index_.find(hash);
+      if (it != index_.end() && it->second == node) {
+        index_.erase(it);
+      }
+    }
+
+    stats_.bytes -= node->bytes;
+    stats_.num_entries--;
+    stats_.evictions++;
+    lru_.erase(node);
+  }
+}
+
+PrefixCacheStats PrefixCache::GetStats() const {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  return stats_;
+}
+
+}  // namespace transformers
+}  // namespace contrib
+}  // namespace onnxruntime
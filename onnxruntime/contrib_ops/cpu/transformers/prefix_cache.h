@@ -0,0 +1,99 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "core/common/common.h"
+#include "core/platform/ort_mutex.h"
+#include "gsl/gsl"
+
+namespace onnxruntime {
+namespace contrib {
+namespace transformers {
+
+struct PrefixCacheStats {
+  int64_t hits = 0;           // number of prompts that found a cached prefix
+  int64_t misses = 0;         // number of prompts that found no cached prefix
+  int64_t reused_tokens = 0;  // number of prompt tokens that were not computed again
+  int64_t evictions = 0;      // number of entries evicted to stay within the memory budget
+  size_t bytes = 0;           // memory used by cached entries
+  size_t num_entries = 0;
+};
+
+// Cache of GPT past state for prompt prefixes, which is shared by the runs of a generation operator, so that prompts
+// starting with the same tokens (like a long system prompt) need not compute past state of those tokens again.
+//
+// Prompts are split into blocks of block_size tokens, and an entry stores the past state of the full blocks of a
+// prompt. Each prefix of full blocks is indexed by the hash of its tokens, so a prompt reuses the longest prefix
+// of full blocks that it shares with any cached prompt. Least recently used entries are evicted when the memory
+// budget is exceeded. It is thread-safe.
+//
+// Past state of one layer uses the layout of GPT subgraph past inputs: (2, batch_size, num_heads, length, head_size).
+class PrefixCache {
+ public:
+  // Past state of all layers for one prompt prefix.
+  struct Entry {
+    std::vector<int32_t> tokens;
+    int num_layers;
+    int num_heads;
+    int head_size;
+    std::vector<float> data;  // shape (num_layers, 2, num_heads, tokens.size(), head_size)
+
+    // Copy past state of the first `length` tokens to sequence batch_index of past state of each layer,
+    // whose buffers have room for max_length tokens.
+    void CopyTo(int length, gsl::span<float* const> past, int batch_size, int batch_index, int max_length) const;
+  };
+
+  static constexpr int kDefaultBlockSize = 16;
+
+  explicit PrefixCache(size_t max_bytes, int block_size = kDefaultBlockSize);
+
+  // Find the longest cached prefix of tokens with no more than max_length tokens. Returns its length, which is a
+  // multiple of block size, or 0 when there is no cached prefix.
+  int Find(gsl::span<const int32_t> tokens, int max_length, std::shared_ptr<const Entry>& entry);
+
+  // Add past state of the full blocks of tokens. Past state of each layer has room for max_length tokens, and
+  // sequence batch_index of it contains the state of tokens.
+  void Insert(gsl::span<const int32_t> tokens,
+              gsl::span<const float* const> past,
+              int batch_size,
+              int batch_index,
+              int num_heads,
+              int max_length,
+              int head_size);
+
+  PrefixCacheStats GetStats() const;
+
+  int BlockSize() const { return block_size_; }
+
+ private:
+  struct Node {
+    std::shared_ptr<const Entry> entry;
+    std::vector<uint64_t> hashes;  // hash of each prefix of full blocks
+    size_t bytes;
+  };
+  using NodeIterator = std::list<Node>::iterator;
+
+  // Hash of each prefix of full blocks of tokens, up to max_length tokens.
+  std::vector<uint64_t> GetBlockHashes(gsl::span<const int32_t> tokens, int max_length) const;
+
+  // Find the node that has the prefix of `length` tokens with the given hash.
+  NodeIterator FindNode(uint64_t hash, gsl::span<const int32_t> tokens, int length);
+
+  void Evict();
+
+  const size_t max_bytes_;
+  const int block_size_;
+
+  mutable OrtMutex mutex_;
+  std::list<Node> lru_;  // most recently used first
+  std::unordered_map<uint64_t, NodeIterator> index_;
+  PrefixCacheStats stats_;
+};
+
+}  // namespace transformers
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,50 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/random_seed.h"
+#include "contrib_ops/cpu/transformers/sampling.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+#define REGISTER_KERNEL_TYPED(T)                                  \
+  ONNX_OPERATOR_TYPED_KERNEL_EX(                                  \
+      Sampling,                                                   \
+      kMSDomain,                                                  \
+      1,                                                          \
+      T,                                                          \
+      kCpuExecutionProvider,                                      \
+      (*KernelDefBuilder::Create())                               \
+          .TypeConstraint("T", DataTypeImpl::GetTensorType<T>()), \
+      transformers::Sampling);
+
+REGISTER_KERNEL_TYPED(float)
+
+namespace transformers {
+
+Sampling::Sampling(const OpKernelInfo& info) : GreedySearch(info) {
+  parameters_.ParseSamplingAttributes(info);
+
+  ORT_ENFORCE(parameters_.model_type == IBeamSearchParameters::kModelTypeGpt,
+              "Sampling only supports decoder only model like GPT-2");
+
+  // node index is added to the global seed to avoid two nodes generating the same sequence of random data
+  generator_ = std::default_random_engine{gsl::narrow_cast<uint32_t>(utils::GetRandomSeed() + info.node().Index())};
+}
+
+Status Sampling::Compute(OpKernelContext* ctx) const {
+  // make a copy since we will update the parameters based on inputs later
+  GreedySearchParameters parameters = parameters_;
+
+  // Seed of this run. It is replaced by the seed input when the input is given.
+  {
+    std::lock_guard<onnxruntime::OrtMutex> l(generator_mutex_);
+    parameters.seed = static_cast<int>(generator_() & 0x7fffffff);
+  }
+
+  return ComputeWithParameters(ctx, parameters);
+}
+
+}  // namespace transformers
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,30 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+#include <random>
+#include "core/platform/ort_mutex.h"
+#include "contrib_ops/cpu/transformers/greedy_search.h"
+
+namespace onnxruntime {
+namespace contrib {
+namespace transformers {
+
+// Sampling shares the subgraph execution and logits processors of greedy search. The next token is sampled
+// from the distribution after temperature, top_k and top_p filtering instead of picking the best one.
+class Sampling : public GreedySearch {
+ public:
+  explicit Sampling(const OpKernelInfo& info);
+
+  Status Compute(OpKernelContext* ctx) const override;
+
+ private:
+  // Seeds of runs without the seed input are drawn from generator_, so each run samples different tokens.
+  // Use generator_mutex_ to ensure Compute() can be called concurrently.
+  mutable std::default_random_engine generator_;
+  mutable onnxruntime::OrtMutex generator_mutex_;
+};
+
+}  // namespace transformers
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,149 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <numeric>
+#include "core/common/inlined_containers.h"
+#include "core/common/safeint.h"
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
+#include "contrib_ops/cpu/transformers/sampling_cpu_helper.h"
+
+namespace onnxruntime {
+namespace contrib {
+namespace SamplingCpuHelper {
+
+// Number of candidates sorted in the first round of top_p filtering. It is doubled in each following round, so only
+// the head of the distribution is sorted when most of the probability is on a few tokens, which is the common case.
+constexpr size_t kInitialSortedCandidates = 64;
+
+int32_t SampleToken(gsl::span<const float> scores,
+                    gsl::span<float> probs,
+                    gsl::span<int32_t> indices,
+                    float temperature,
+                    int top_k,
+                    float top_p,
+                    int min_tokens_to_keep,
+                    float uniform) {
+  const size_t vocab_size = scores.size();
+  ORT_ENFORCE(vocab_size > 0 && probs.size() >= vocab_size && indices.size() >= vocab_size);
+
+  // probs = softmax(scores / temperature)
+  float* p = probs.data();
+  if (temperature != 1.0f) {
+    const float scale = 1.0f / temperature;
+    const float* s = scores.data();
+    for (size_t i = 0; i < vocab_size; i++) {
+      p[i] = s[i] * scale;
+    }
+    MlasComputeSoftmax(p, p, 1, vocab_size, false, nullptr);
+  } else {
+    MlasComputeSoftmax(scores.data(), p, 1, vocab_size, false, nullptr);
+  }
+
+  const size_t limit = top_k > 0 ? std::min(vocab_size, static_cast<size_t>(top_k)) : vocab_size;
+  if (limit == vocab_size && top_p >= 1.0f) {
+    // No filtering. Sample from the whole vocabulary without sorting.
+    float total = 0.0f;
+    for (size_t i = 0; i < vocab_size; i++) {
+      total += p[i];
+    }
+
+    const float threshold = uniform * total;
+    float cumulative = 0.0f;
+    for (size_t i = 0; i + 1 < vocab_size; i++) {
+      cumulative += p[i];
+      if (cumulative > threshold) {
+        return static_cast<int32_t>(i);
+      }
+    }
+    return static_cast<int32_t>(vocab_size - 1);
+  }
+
+  // Sort candidates by probability in rounds until the kept tokens reach top_p, or all top_k tokens are sorted.
+  // Each round selects the next block of candidates with nth_element, and only sorts that block.
+  const size_t min_keep = std::min(limit, static_cast<size_t>(std::max(min_tokens_to_keep, 1)));
+  int32_t* index_begin = indices.data();
+  int32_t* index_end = index_begin + vocab_size;
+  std::iota(index_begin, index_end, 0);
+
+  // Higher probability first. Ties are broken by token id so that the result is deterministic.
+  auto greater = [p](int32_t a, int32_t b) { return p[a] > p[b] || (p[a] == p[b] && a < b); };
+
+  size_t kept = limit;
+  float kept_probability = 0.0f;
+  size_t sorted = 0;
+  size_t candidates = std::min(limit, kInitialSortedCandidates);
+  while (kept == limit) {
+    int32_t* first = index_begin + sorted;
+    int32_t* last = index_begin + candidates;
+    if (last != index_end) {
+      std::nth_element(first, last, index_end, greater);
+    }
+    std::sort(first, last, greater);
+
+    for (size_t i = sorted; i < candidates; i++) {
+      kept_probability += p[index_begin[i]];
+      if (i + 1 >= min_keep && kept_probability >= top_p) {
+        kept = i + 1;
+        break;
+      }
+    }
+
+    sorted = candidates;
+    if (sorted == limit) {
+      break;
+    }
+    candidates = std::min(limit, 2 * candidates);
+  }
+
+  // Sample from the kept tokens with probabilities renormalized by kept_probability.
+  const float threshold = uniform * kept_probability;
+  float cumulative = 0.0f;
+  for (size_t i = 0; i + 1 < kept; i++) {
+    cumulative += p[index_begin[i]];
+    if (cumulative > threshold) {
+      return index_begin[i];
+    }
+  }
+  return index_begin[kept - 1];
+}
+
+void SampleNextTokens(gsl::span<const float> next_token_scores,
+                      gsl::span<float> probs,
+                      gsl::span<int32_t> indices,
+                      gsl::span<int64_t> next_tokens,
+                      const transformers::IBeamSearchParameters& parameters,
+                      std::default_random_engine& generator,
+                      concurrency::ThreadPool* thread_pool) {
+  const int batch_size = parameters.batch_size;
+  const size_t vocab_size = static_cast<size_t>(parameters.vocab_size);
+
+  std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+  InlinedVector<float> uniforms(static_cast<size_t>(batch_size));
+  for (auto& uniform : uniforms) {
+    uniform = distribution(generator);
+  }
+
+  // Softmax and partial sort cost a few operations per token in vocabulary.
+  const double cost = static_cast<double>(vocab_size) * 8.0;
+  concurrency::ThreadPool::TryParallelFor(
+      thread_pool, static_cast<std::ptrdiff_t>(batch_size), cost,
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        for (std::ptrdiff_t i = begin; i < end; i++) {
+          const size_t offset = SafeInt<size_t>(i) * vocab_size;
+          next_tokens[i] = SampleToken(next_token_scores.subspan(offset, vocab_size),
+                                       probs.subspan(offset, vocab_size),
+                                       indices.subspan(offset, vocab_size),
+                                       parameters.temperature,
+                                       parameters.top_k,
+                                       parameters.top_p,
+                                       parameters.min_tokens_to_keep,
+                                       uniforms[static_cast<size_t>(i)]);
+        }
+      });
+}
+
+}  // namespace SamplingCpuHelper
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -0,0 +1,41 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/common/common.h"
+#include "contrib_ops/cpu/transformers/generation_shared.h"
+
+namespace onnxruntime {
+namespace concurrency {
+class ThreadPool;
+}
+namespace contrib {
+namespace SamplingCpuHelper {
+
+// Sample a token from softmax(scores / temperature), restricted to the top_k tokens with highest probability and
+// then to the smallest set of those tokens whose cumulative probability reaches top_p. At least min_tokens_to_keep
+// tokens are kept. uniform is a random number in [0, 1). probs and indices are work buffers of vocab_size elements.
+int32_t SampleToken(gsl::span<const float> scores,
+                    gsl::span<float> probs,
+                    gsl::span<int32_t> indices,
+                    float temperature,
+                    int top_k,
+                    float top_p,
+                    int min_tokens_to_keep,
+                    float uniform);
+
+// Sample next token for each sequence from next_token_scores with shape (batch_size, vocab_size).
+// Random numbers are drawn from the generator in batch order before sampling, so the result for a given seed
+// does not depend on the number of threads.
+void SampleNextTokens(gsl::span<const float> next_token_scores,
+                      gsl::span<float> probs,
+                      gsl::span<int32_t> indices,
+                      gsl::span<int64_t> next_tokens,
+                      const transformers::IBeamSearchParameters& parameters,
+                      std::default_random_engine& generator,
+                      concurrency::ThreadPool* thread_pool);
+
+}  // namespace SamplingCpuHelper
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -20,6 +20,7 @@ void Sequences::Init(gsl::span<int32_t> buffer, int batch_beam_size, int sequenc
   batch_beam_size_ = batch_beam_size;
   max_length_ = max_length;
   current_length_ = sequence_length;
+  previous_beam_indices_.clear();
 }
 
 gsl::span<const int32_t> Sequences::GetSequence(int beam_index) const {
@@ -34,6 +35,10 @@ int Sequences::GetSequenceLength() const {
   return current_length_;
 }
 
+gsl::span<const int32_t> Sequences::GetPreviousBeamIndices() const {
+  return previous_beam_indices_;
+}
+
 #ifdef DEBUG_GENERATION
 void Sequences::PrintSequences(const IConsoleDumper* dumper) const {
   for (int i = 0; i < batch_beam_size_; i++) {
@@ -66,6 +71,7 @@ void Sequences::AppendNextTokenToSequences(
   }
 
   ++current_length_;
+  previous_beam_indices_.assign(beam_indices.begin(), beam_indices.end());
 
   // Rotate buffer for next round.
   current_sequences_buffer = 1 - current_sequences_buffer;
@@ -81,6 +87,7 @@ void Sequences::AppendNextTokenToSequences(
   }
 
   ++current_length_;
+  previous_beam_indices_.clear();
 }
 
 }  // namespace transformers
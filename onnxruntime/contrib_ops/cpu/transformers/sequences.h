@@ -4,6 +4,7 @@
 #pragma once
 
 #include "gsl/gsl"
+#include "core/common/inlined_containers.h"
 #include "contrib_ops/cpu/transformers/generation_shared.h"
 
 namespace onnxruntime {
@@ -24,6 +25,9 @@ class Sequences : public ISequences {
   // Returns current sequence length.
   int GetSequenceLength() const override;
 
+  // Returns beam indices of last AppendNextTokenToSequences call, or empty when sequences were not reordered.
+  gsl::span<const int32_t> GetPreviousBeamIndices() const override;
+
 #ifdef DEBUG_GENERATION
   // Print the sequences to StdOut in debug mode
   void PrintSequences(const IConsoleDumper* dumper) const;
@@ -49,6 +53,9 @@ class Sequences : public ISequences {
   int batch_beam_size_;
   int max_length_;
   int current_length_;
+
+  // Beam indices of last append.
+  InlinedVector<int32_t> previous_beam_indices_;
 };
 
 }  // namespace transformers
@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
 #include "core/framework/framework_common.h"
 #include "core/framework/session_state.h"
 #include "core/framework/tensorprotoutils.h"
@@ -19,6 +20,7 @@ Status GptSubgraph::CreateInitialFeeds(
     const std::vector<const OrtValue*>& implicit_inputs,
     int num_beams,
     int pad_token_id,
+    int max_length,
     gsl::span<int32_t>& sequence_lengths,
     OrtValue& expanded_input_ids,
     std::vector<OrtValue>& feeds,
@@ -46,9 +48,13 @@ Status GptSubgraph::CreateInitialFeeds(
   auto default_allocator = provider->GetAllocator(0, OrtMemTypeDefault);
   allocator_ = default_allocator;
 
-  // Initialize empty past state
+  ORT_RETURN_IF(past_present_share_buffer_ && provider->Type() != kCpuExecutionProvider,
+                "GPT subgraph with past_sequence_length input is only supported by CPU execution provider");
+
+  // Initialize empty past state. With a shared buffer, past has room for max_length positions instead.
   auto past_type = IsOutputFloat16() ? DataTypeImpl::GetType<MLFloat16>() : DataTypeImpl::GetType<float>();
-  int64_t past_state_dims[] = {2, batch_size * num_beams, num_heads, 0, head_size};
+  int64_t past_state_dims[] = {2, batch_size * num_beams, num_heads, past_present_share_buffer_ ? max_length : 0,
+                               head_size};
   TensorShape past_shape(&past_state_dims[0], 5);
   OrtValue empty_past;
   Tensor::InitOrtValue(past_type, past_shape, default_allocator, empty_past);
@@ -73,8 +79,23 @@ Status GptSubgraph::CreateInitialFeeds(
                                         buffer));
 
   // The remaining inputs are past state.
-  for (int i = first_past_input_index_; i < num_subgraph_inputs; ++i) {
+  if (past_present_share_buffer_) {
+    // Each layer owns its buffer since it is written in place.
     feeds.push_back(empty_past);
+    for (int i = 1; i < num_layers; ++i) {
+      OrtValue past;
+      Tensor::InitOrtValue(past_type, past_shape, default_allocator, past);
+      feeds.push_back(past);
+    }
+
+    OrtValue past_sequence_length;
+    Tensor::InitOrtValue(DataTypeImpl::GetType<int32_t>(), TensorShape({}), cpu_allocator, past_sequence_length);
+    *past_sequence_length.GetMutable<Tensor>()->MutableData<int32_t>() = 0;
+    feeds.push_back(past_sequence_length);
+  } else {
+    for (int i = first_past_input_index_; i < num_subgraph_inputs; ++i) {
+      feeds.push_back(empty_past);
+    }
   }
 
   // Pass in implicit inputs
@@ -85,13 +106,163 @@ Status GptSubgraph::CreateInitialFeeds(
   return Status::OK();
 }
 
+void GptSubgraph::PrepareFetches(const std::vector<OrtValue>& feeds, std::vector<OrtValue>& fetches) const {
+  if (!past_present_share_buffer_) {
+    return;
+  }
+
+  fetches.resize(static_cast<size_t>(num_subgraph_outputs));
+  for (int i = 0; i < num_layers; ++i) {
+    fetches[static_cast<size_t>(first_present_output_index_) + i] = feeds[static_cast<size_t>(first_past_input_index_) + i];
+  }
+}
+
+void GptSubgraph::EnablePrefixCache(size_t max_bytes) {
+  ORT_ENFORCE(session_state_ != nullptr, "Setup must be called before EnablePrefixCache");
+  if (max_bytes > 0 && !IsOutputFloat16() && GetProvider()->Type() == kCpuExecutionProvider) {
+    prefix_cache_ = std::make_unique<PrefixCache>(max_bytes);
+  }
+}
+
+int GptSubgraph::UsePrefixCache(gsl::span<const int32_t> sequence_lengths,
+                                int num_beams,
+                                std::vector<OrtValue>& feeds,
+                                const logging::Logger& logger) {
+  if (prefix_cache_ == nullptr) {
+    return 0;
+  }
+
+  profiling::Profiler& profiler = session_state_->Profiler();
+  const bool is_profiler_enabled = profiler.IsEnabled();
+  TimePoint start_time;
+  if (is_profiler_enabled) {
+    start_time = profiler.Start();
+  }
+
+  const Tensor& input_ids = feeds[0].Get<Tensor>();
+  const int batch_beam_size = static_cast<int>(input_ids.Shape()[0]);
+  const int sequence_length = static_cast<int>(input_ids.Shape()[1]);
+  const int batch_size = batch_beam_size / num_beams;
+  const bool has_padding = std::any_of(sequence_lengths.begin(), sequence_lengths.begin() + batch_beam_size,
+                                       [sequence_length](int32_t length) { return length != sequence_length; });
+
+  // All sequences start from the shortest prefix found. At least one token is left to get the logits.
+  std::vector<std::shared_ptr<const PrefixCache::Entry>> entries(static_cast<size_t>(batch_size));
+  int prefix_length = has_padding ? 0 : sequence_length - 1;
+  gsl::span<const int32_t> input_ids_data = input_ids.DataAsSpan<int32_t>();
+  for (int b = 0; !has_padding && b < batch_size; b++) {
+    auto tokens = input_ids_data.subspan(static_cast<size_t>(b) * num_beams * sequence_length, sequence_length);
+    prefix_length = std::min(prefix_length, prefix_cache_->Find(tokens, sequence_length - 1, entries[b]));
+  }
+
+  // Cache statistics are logged, and recorded as an event of the session profiler so that they are available
+  // in the profile of a run.
+  const PrefixCacheStats stats = prefix_cache_->GetStats();
+  LOGS(logger, VERBOSE) << "Prefix cache reused " << prefix_length << " of " << sequence_length
+                        << " prompt tokens. Hits: " << stats.hits << ", misses: " << stats.misses
+                        << ", entries: " << stats.num_entries << ", bytes: " << stats.bytes;
+  if (is_profiler_enabled) {
+    profiler.EndTimeAndRecordEvent(profiling::NODE_EVENT,
+                                   (node.Name().empty() ? node.OpType() : node.Name()) + "_prefix_cache",
+                                   start_time,
+                                   {{"prompt_length", std::to_string(sequence_length)},
+                                    {"reused_length", std::to_string(prefix_length)},
+                                    {"hits", std::to_string(stats.hits)},
+                                    {"misses", std::to_string(stats.misses)},
+                                    {"reused_tokens", std::to_string(stats.reused_tokens)},
+                                    {"evictions", std::to_string(stats.evictions)},
+                                    {"num_entries", std::to_string(stats.num_entries)},
+                                    {"bytes", std::to_string(stats.bytes)}});
+  }
+  if (prefix_length == 0) {
+    return 0;
+  }
+
+  // Past state of every beam starts from the cached state of its prompt.
+  std::vector<float*> past(static_cast<size_t>(num_layers));
+  int max_length = prefix_length;
+  if (past_present_share_buffer_) {
+    max_length = static_cast<int>(feeds[first_past_input_index_].Get<Tensor>().Shape()[3]);
+    for (int i = 0; i < num_layers; i++) {
+      past[i] = feeds[static_cast<size_t>(first_past_input_index_) + i].GetMutable<Tensor>()->MutableData<float>();
+    }
+    OrtValue& past_sequence_length = feeds[static_cast<size_t>(first_past_input_index_) + num_layers];
+    *past_sequence_length.GetMutable<Tensor>()->MutableData<int32_t>() = prefix_length;
+  } else {
+    int64_t past_dims[] = {2, batch_beam_size, num_heads, prefix_length, head_size};
+    for (int i = 0; i < num_layers; i++) {
+      OrtValue past_value;
+      Tensor::InitOrtValue(DataTypeImpl::GetType<float>(), TensorShape(&past_dims[0], 5), allocator_, past_value);
+      past[i] = past_value.GetMutable<Tensor>()->MutableData<float>();
+      feeds[static_cast<size_t>(first_past_input_index_) + i] = past_value;
+    }
+  }
+  for (int i = 0; i < batch_beam_size; i++) {
+    entries[i / num_beams]->CopyTo(prefix_length, past, batch_beam_size, i, max_length);
+  }
+
+  // input_ids and position_ids keep the tokens after the prefix. attention_mask covers past and new tokens already.
+  const int new_length = sequence_length - prefix_length;
+  int64_t dims[] = {batch_beam_size, new_length};
+  for (int k = 0; k < 2; k++) {
+    const int32_t* source = feeds[k].Get<Tensor>().Data<int32_t>();
+    OrtValue sliced;
+    Tensor::InitOrtValue(DataTypeImpl::GetType<int32_t>(), TensorShape(&dims[0], 2), allocator_, sliced);
+    int32_t* target = sliced.GetMutable<Tensor>()->MutableData<int32_t>();
+    for (int i = 0; i < batch_beam_size; i++) {
+      std::copy_n(source + static_cast<size_t>(i) * sequence_length + prefix_length, new_length,
+                  target + static_cast<size_t>(i) * new_length);
+    }
+    feeds[k] = sliced;
+  }
+
+  return prefix_length;
+}
+
+void GptSubgraph::UpdatePrefixCache(gsl::span<const int32_t> sequence_lengths,
+                                    int num_beams,
+                                    const OrtValue& expanded_input_ids,
+                                    const std::vector<OrtValue>& feeds,
+                                    const std::vector<OrtValue>& fetches) {
+  if (prefix_cache_ == nullptr) {
+    return;
+  }
+
+  // Present state is in past buffers when they are shared.
+  std::vector<const float*> present(static_cast<size_t>(num_layers));
+  for (int i = 0; i < num_layers; i++) {
+    present[i] = past_present_share_buffer_
+                     ? feeds[static_cast<size_t>(first_past_input_index_) + i].Get<Tensor>().Data<float>()
+                     : fetches[static_cast<size_t>(first_present_output_index_) + i].Get<Tensor>().Data<float>();
+  }
+  const OrtValue& first_present = past_present_share_buffer_ ? feeds[first_past_input_index_]
+                                                             : fetches[first_present_output_index_];
+  const int max_length = static_cast<int>(first_present.Get<Tensor>().Shape()[3]);
+
+  const Tensor& input_ids = expanded_input_ids.Get<Tensor>();
+  const int batch_beam_size = static_cast<int>(input_ids.Shape()[0]);
+  const int sequence_length = static_cast<int>(input_ids.Shape()[1]);
+  gsl::span<const int32_t> input_ids_data = input_ids.DataAsSpan<int32_t>();
+  for (int i = 0; i < batch_beam_size; i += num_beams) {
+    if (sequence_lengths[i] == sequence_length) {
+      prefix_cache_->Insert(input_ids_data.subspan(static_cast<size_t>(i) * sequence_length, sequence_length),
+                            present, batch_beam_size, i, num_heads, max_length, head_size);
+    }
+  }
+}
+
 Status GptSubgraph::Validate(const std::vector<const NodeArg*>& subgraph_inputs,
                              const std::vector<const NodeArg*>& subgraph_outputs) {
   ORT_RETURN_IF(num_subgraph_outputs <= first_present_output_index_,
                 "Invalid GPT-2 subgraph: number of outputs shall be larger than 1 (Need past state in outputs).");
 
-  ORT_RETURN_IF(num_subgraph_inputs != num_subgraph_outputs + 2,
-                "Invalid GPT-2 subgraph: number of inputs shall be number of outputs plus 2");
+  // An optional last input past_sequence_length enables the shared past and present buffers.
+  past_present_share_buffer_ = (num_subgraph_inputs == num_subgraph_outputs + 3 &&
+                                subgraph_inputs[num_subgraph_inputs - 1]->Name() == "past_sequence_length");
+
+  ORT_RETURN_IF(num_subgraph_inputs != num_subgraph_outputs + (past_present_share_buffer_ ? 3 : 2),
+                "Invalid GPT-2 subgraph: number of inputs shall be number of outputs plus 2, "
+                "or plus 3 with past_sequence_length as the last input");
 
   ORT_RETURN_IF(subgraph_inputs[0]->Name() != "input_ids",
                 "subgraph input 0 shall be named as input_ids, got: ", subgraph_inputs[0]->Name());
@@ -147,6 +318,9 @@ Status GptSubgraph::Validate(const std::vector<const NodeArg*>& subgraph_inputs,
                 "subgraph input 1 (position_ids) shall have int32 type");
   ORT_RETURN_IF(subgraph_inputs[2]->TypeAsProto()->tensor_type().elem_type() != int32_type,
                 "subgraph input 2 (attention_mask) shall have int32 type");
+  ORT_RETURN_IF(past_present_share_buffer_ &&
+                    subgraph_inputs[num_subgraph_inputs - 1]->TypeAsProto()->tensor_type().elem_type() != int32_type,
+                "subgraph input past_sequence_length shall have int32 type");
 
   auto output_type = subgraph_outputs[0]->TypeAsProto()->tensor_type().elem_type();
   ORT_RETURN_IF(output_type != float32_type && output_type != float16_type,
@@ -3,7 +3,9 @@
 
 #pragma once
 
+#include <memory>
 #include "contrib_ops/cpu/transformers/subgraph_base.h"
+#include "contrib_ops/cpu/transformers/prefix_cache.h"
 
 namespace onnxruntime {
 namespace contrib {
@@ -26,6 +28,7 @@ class GptSubgraph : public Subgraph {
       const std::vector<const OrtValue*>& implicit_inputs,
       int num_beams,
       int pad_token_id,
+      int max_length,
       gsl::span<int32_t>& sequence_lengths,
       OrtValue& expanded_input_ids,
       std::vector<OrtValue>& feeds,
@@ -44,9 +47,41 @@ class GptSubgraph : public Subgraph {
     return first_present_output_index_;
   }
 
+  // Whether the subgraph has a past_sequence_length input, so that its Attention nodes append the new key and
+  // value in place into max length past buffers, which are also bound as the present outputs.
+  bool IsPastPresentShareBuffer() const {
+    return past_present_share_buffer_;
+  }
+
+  // Bind present outputs to the past buffers in feeds when they are shared. Other outputs are left unallocated.
+  void PrepareFetches(const std::vector<OrtValue>& feeds, std::vector<OrtValue>& fetches) const;
+
+  // Keep past state of prompt prefixes across runs within a memory budget. It is called after Setup, and the cache
+  // is only enabled for float subgraph in CPU execution provider.
+  void EnablePrefixCache(size_t max_bytes);
+
+  PrefixCache* GetPrefixCache() const { return prefix_cache_.get(); }
+
+  // Before the first inference, fill past state in feeds with the longest cached prefix shared by all prompts, and
+  // remove the prefix from input_ids and position_ids. Returns length of the prefix, which is 0 when nothing is
+  // reused. Prompts with padding are not looked up since their position ids do not match the cached state.
+  int UsePrefixCache(gsl::span<const int32_t> sequence_lengths,
+                     int num_beams,
+                     std::vector<OrtValue>& feeds,
+                     const logging::Logger& logger);
+
+  // After the first inference, add past state of the prompts in expanded_input_ids to the cache.
+  void UpdatePrefixCache(gsl::span<const int32_t> sequence_lengths,
+                         int num_beams,
+                         const OrtValue& expanded_input_ids,
+                         const std::vector<OrtValue>& feeds,
+                         const std::vector<OrtValue>& fetches);
+
  private:
   int first_past_input_index_;
   int first_present_output_index_;
+  bool past_present_share_buffer_ = false;
+  std::unique_ptr<PrefixCache> prefix_cache_;
 };
 
 }  // namespace transformers
@@ -1001,6 +1001,7 @@ ONNX_MS_OPERATOR_SET_SCHEMA(BeamSearch, 1,
                                 .Attr("model_type", "model type: 0 for GPT-2; 1 for encoder decoder like T5", AttributeProto::INT, static_cast<int64_t>(0))
                                 .Attr("encoder", "The subgraph for initialization of encoder and decoder. It will be called once before decoder subgraph.", AttributeProto::GRAPH, OPTIONAL_VALUE)
                                 .Attr("decoder", "Decoder subgraph to execute in a loop.", AttributeProto::GRAPH)
+                                .Attr("prefix_cache_size", "Memory budget in bytes of a cache of past state for prompt prefixes, which is shared by runs of this node so that prompts starting with the same tokens reuse the past state. 0 disables the cache. Only decoder only model like GPT-2 is supported. When profiling is enabled, cache statistics are recorded in an event named after the node with suffix _prefix_cache.", AttributeProto::INT, static_cast<int64_t>(0))
                                 .Input(0, "input_ids", "The sequence used as a prompt for the generation. Shape is (batch_size, sequence_length)", "I")
                                 .Input(1, "max_length", "The maximum length of the sequence to be generated. Shape is (1)", "I")
                                 .Input(2, "min_length", "The minimum length below which the score of eos_token_id is set to -Inf. Shape is (1)", "I", OpSchema::Optional)
@@ -1039,6 +1040,9 @@ ONNX_MS_OPERATOR_SET_SCHEMA(GreedySearch, 1,
                                 .Attr("model_type", "model type: 0 for decoder only like GPT-2; 1 for encoder decoder like Bart", AttributeProto::INT, static_cast<int64_t>(0))
                                 .Attr("encoder", "The subgraph for initialization of encoder and decoder. It will be called once before decoder subgraph.", AttributeProto::GRAPH, OPTIONAL_VALUE)
                                 .Attr("decoder", "Decoder subgraph to execute in a loop.", AttributeProto::GRAPH)
+                                .Attr("draft_decoder", "Decoder subgraph of a small draft model with the same vocabulary and the same inputs and outputs as decoder. When it is given, speculative decoding is used: the draft model proposes num_speculative_tokens tokens, and decoder verifies them in one run. Only decoder only model like GPT-2 is supported.", AttributeProto::GRAPH, OPTIONAL_VALUE)
+                                .Attr("num_speculative_tokens", "The number of tokens proposed by draft_decoder in each step of speculative decoding", AttributeProto::INT, static_cast<int64_t>(4))
+                                .Attr("prefix_cache_size", "Memory budget in bytes of a cache of past state for prompt prefixes, which is shared by runs of this node so that prompts starting with the same tokens reuse the past state. 0 disables the cache. Only decoder only model like GPT-2 is supported. When profiling is enabled, cache statistics are recorded in an event named after the node with suffix _prefix_cache.", AttributeProto::INT, static_cast<int64_t>(0))
                                 .Input(0, "input_ids", "The sequence used as a prompt for the generation. Shape is (batch_size, sequence_length)", "I")
                                 .Input(1, "max_length", "The maximum length of the sequence to be generated. Shape is (1)", "I")
                                 .Input(2, "min_length", "The minimum length below which the score of eos_token_id is set to -Inf. Shape is (1)", "I", OpSchema::Optional)
@@ -1053,6 +1057,37 @@ ONNX_MS_OPERATOR_SET_SCHEMA(GreedySearch, 1,
                                   GreedySearchShapeInference(ctx);
                                 }));
 
+ONNX_MS_OPERATOR_SET_SCHEMA(Sampling, 1,
+                            OpSchema()
+                                .SetDoc("Sampling for text generation with temperature, top-k and top-p (nucleus) filtering.")
+                                .Attr("eos_token_id", "The id of the end-of-sequence token", AttributeProto::INT)
+                                .Attr("pad_token_id", "The id of the padding token", AttributeProto::INT)
+                                .Attr("decoder_start_token_id", "The id of the token that indicates decoding starts.", AttributeProto::INT, static_cast<int64_t>(-1))
+                                .Attr("no_repeat_ngram_size", "no repeat ngrams size", AttributeProto::INT, static_cast<int64_t>(0))
+                                .Attr("temperature", "The value used to module the next token probabilities. Accepts value > 0.0", AttributeProto::FLOAT, 1.0f)
+                                .Attr("top_k", "The number of highest probability tokens to keep for sampling. 0 means no limit.", AttributeProto::INT, static_cast<int64_t>(0))
+                                .Attr("top_p", "Keep the smallest set of most probable tokens with probabilities that add up to top_p or higher. Accepts value in (0.0, 1.0]", AttributeProto::FLOAT, 1.0f)
+                                .Attr("min_tokens_to_keep", "Minimum number of tokens to keep after top_p filtering", AttributeProto::INT, static_cast<int64_t>(1))
+                                .Attr("model_type", "model type: 0 for decoder only like GPT-2", AttributeProto::INT, static_cast<int64_t>(0))
+                                .Attr("encoder", "The subgraph for initialization of encoder and decoder. It will be called once before decoder subgraph.", AttributeProto::GRAPH, OPTIONAL_VALUE)
+                                .Attr("decoder", "Decoder subgraph to execute in a loop.", AttributeProto::GRAPH)
+                                .Attr("draft_decoder", "Decoder subgraph of a small draft model with the same vocabulary and the same inputs and outputs as decoder. When it is given, speculative decoding is used: the draft model proposes num_speculative_tokens tokens, and decoder verifies them in one run. Only decoder only model like GPT-2 is supported.", AttributeProto::GRAPH, OPTIONAL_VALUE)
+                                .Attr("num_speculative_tokens", "The number of tokens proposed by draft_decoder in each step of speculative decoding", AttributeProto::INT, static_cast<int64_t>(4))
+                                .Attr("prefix_cache_size", "Memory budget in bytes of a cache of past state for prompt prefixes, which is shared by runs of this node so that prompts starting with the same tokens reuse the past state. 0 disables the cache. Only decoder only model like GPT-2 is supported. When profiling is enabled, cache statistics are recorded in an event named after the node with suffix _prefix_cache.", AttributeProto::INT, static_cast<int64_t>(0))
+                                .Input(0, "input_ids", "The sequence used as a prompt for the generation. Shape is (batch_size, sequence_length)", "I")
+                                .Input(1, "max_length", "The maximum length of the sequence to be generated. Shape is (1)", "I")
+                                .Input(2, "min_length", "The minimum length below which the score of eos_token_id is set to -Inf. Shape is (1)", "I", OpSchema::Optional)
+                                .Input(3, "repetition_penalty", "The parameter for repetition penalty. Default value 1.0 means no penalty. Accepts value > 0.0. Shape is (1)", "T", OpSchema::Optional)
+                                .Input(4, "vocab_mask", "Mask of vocabulary. Words that masked with 0 are not allowed to be generated, and 1 is allowed. Shape is (vacab_size)", "I", OpSchema::Optional)
+                                .Input(5, "prefix_vocab_mask", "Mask of vocabulary for first step. Words that masked with 0 are not allowed to be generated, and 1 is allowed. Shape is (batch_size, vocab_size)", "I", OpSchema::Optional)
+                                .Input(6, "seed", "Seed for random number generator. The same seed generates the same sequences. A random seed is used when it is not given. Shape is (1)", "I", OpSchema::Optional)
+                                .Output(0, "sequences", "Word IDs of generated sequences. Shape is (batch_size, max_sequence_length)", "I")
+                                .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors.")
+                                .TypeConstraint("I", {"tensor(int32)"}, "Constrain to integer types")
+                                .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+                                  GreedySearchShapeInference(ctx);
+                                }));
+
 ONNX_MS_OPERATOR_SET_SCHEMA(SampleOp, 1,
                             OpSchema()
                                 .Input(0, "X", "input", "T")
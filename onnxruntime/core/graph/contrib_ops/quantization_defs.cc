@@ -897,6 +897,10 @@ ONNX_MS_OPERATOR_SET_SCHEMA(
         .Attr("num_heads", "Number of attention heads", AttributeProto::INT)
         .Attr("unidirectional", "Whether every token can only attend to previous tokens. Default value is 0.",
               AttributeProto::INT, static_cast<int64_t>(0))
+        .Attr("quantize_attention",
+              "Whether to dynamically quantize Q, K, V and the attention probabilities to 8 bits, and compute the "
+              "attention with integer matrix multiplications on CPU. Default value is 0.",
+              AttributeProto::INT, static_cast<int64_t>(0))
         .Input(0, "input", "3D input tensor with shape (batch_size, sequence_length, input_hidden_size)", "T1")
         .Input(1, "weight",
                "2D input tensor with shape (input_hidden_size, 3 * hidden_size), hidden_size = num_heads * head_size",
@@ -946,6 +946,23 @@ MlasPool(
     MLAS_THREADPOOL* ThreadPool
     );
 
+void
+MLASCALL
+MlasMaximumPoolWithIndices(
+    size_t Dimensions,
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* DilationShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    bool ColumnMajorIndices,
+    const float* Input,
+    float* Output,
+    int64_t* Indices,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
 template<typename T8Bits>
 void
 MLASCALL
@@ -957,6 +974,16 @@ MlasMaximumPool(
     size_t KernelSize
     );
 
+void
+MLASCALL
+MlasMaximumPool(
+    const float* const* Input,
+    float* Output,
+    size_t Channels,
+    size_t OutputCount,
+    size_t KernelSize
+    );
+
 //
 // Miscellaneous compute routines.
 //
@@ -1057,6 +1084,58 @@ MlasTranspose(
     size_t N
     );
 
+//
+// Sparse matrix/dense matrix multiply routine.
+// C := alpha * A * B, where A is a sparse matrix.
+//
+
+/**
+ * @brief Single precision sparse matrix in block compressed sparse row format.
+ *        Rows are grouped into block rows of BlockRows rows, and each block row
+ *        stores its BlockRows x BlockColumns dense blocks that have non-zero
+ *        elements. Compressed sparse row format is the case of 1 x 1 blocks.
+ */
+struct MLAS_SPARSE_MATRIX {
+    size_t BlockRows = 1;                        /**< Supplies the number of rows of a block */
+    size_t BlockColumns = 1;                     /**< Supplies the number of columns of a block */
+    const int64_t* BlockRowStart = nullptr;      /**< Supplies the index of the first block of each block row,
+                                                      followed by the number of blocks */
+    const int64_t* BlockColumnIndex = nullptr;   /**< Supplies the column of the first element of each block */
+    const float* BlockValues = nullptr;          /**< Supplies the row major elements of each block */
+};
+
+/**
+ * @brief  Single precision sparse matrix/dense matrix multiply operation.
+ *         Rows of C are computed in parallel, and columns of B and C are
+ *         vectorized.
+ *
+ * @param M          Supplies the number of rows of matrix A and matrix C.
+ * @param N          Supplies the number of columns of matrix B and matrix C.
+ * @param A          Supplies the sparse matrix A. The rows of the last block
+ *                   row that are not less than M are ignored.
+ * @param alpha      Supplies the scalar alpha multiplier.
+ * @param B          Supplies the address of matrix B, which has a row for each
+ *                   column of matrix A.
+ * @param ldb        Supplies the first dimension of matrix B.
+ * @param C          Supplies the address of matrix C, which is overwritten.
+ * @param ldc        Supplies the first dimension of matrix C.
+ * @param ThreadPool Supplies the thread pool object to use, else nullptr if the
+ *                   base library threading support should be used.
+ */
+void
+MLASCALL
+MlasSparseGemm(
+    size_t M,
+    size_t N,
+    const MLAS_SPARSE_MATRIX& A,
+    float alpha,
+    const float* B,
+    size_t ldb,
+    float* C,
+    size_t ldc,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
 //
 // Buffer reordering routines.
 //
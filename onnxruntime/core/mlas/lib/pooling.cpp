@@ -1293,6 +1293,405 @@ Return Value:
 #endif
 }
 
+//
+// Define the parameters to execute segments of a maximum pooling operation
+// with dilations and indices on worker threads. The pooled dimensions are
+// aligned to the last of three dimensions: a missing leading dimension has
+// an input, output, kernel, dilation and stride of one and no padding.
+//
+
+struct MLAS_MAXIMUM_POOL_INDICES_WORK_BLOCK
+{
+    size_t Dimensions;
+    int64_t InputShape[3];
+    size_t InputSize;
+    size_t OutputShape[3];
+    int64_t KernelShape[3];
+    int64_t DilationShape[3];
+    int64_t Padding[3];
+    int64_t StrideShape[3];
+    bool ColumnMajorIndices;
+};
+
+//
+// Define the minimum number of input elements compared by a thread.
+//
+
+#define MLAS_POOL_INDICES_THREAD_COMPLEXITY (64 * 1024)
+
+MLAS_FORCEINLINE
+int64_t
+MlasPoolFirstValidIndex(
+    int64_t Start,
+    int64_t Dilation
+    )
+{
+    return Start >= 0 ? Start : Start + ((Dilation - 1 - Start) / Dilation) * Dilation;
+}
+
+MLAS_FORCEINLINE
+int64_t
+MlasPoolInputIndex(
+    const MLAS_MAXIMUM_POOL_INDICES_WORK_BLOCK* WorkBlock,
+    size_t Channel,
+    int64_t ih,
+    int64_t iw,
+    int64_t id
+    )
+{
+    const int64_t InputHeight = WorkBlock->InputShape[0];
+    const int64_t InputWidth = WorkBlock->InputShape[1];
+    const int64_t InputDepth = WorkBlock->InputShape[2];
+
+    const int64_t Offset = WorkBlock->ColumnMajorIndices ?
+        ih + iw * InputHeight + id * InputHeight * InputWidth :
+        (ih * InputWidth + iw) * InputDepth + id;
+
+    return int64_t(Channel * WorkBlock->InputSize) + Offset;
+}
+
+void
+MlasMaximumPoolWithIndicesRow(
+    const MLAS_MAXIMUM_POOL_INDICES_WORK_BLOCK* WorkBlock,
+    size_t Channel,
+    size_t ph,
+    size_t pw,
+    const float* Input,
+    float* Output,
+    int64_t* Indices
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the outputs of the innermost dimension for one
+    channel and one position of the leading output dimensions.
+
+    The maximum of a window is its first element in scan order that is
+    greater than all of the elements before it, so NaN values and values
+    equal to the lowest float are never selected. A window without such an
+    element produces the lowest float and an index of -1 in every pooled
+    dimension.
+
+Arguments:
+
+    WorkBlock - Supplies the structure that contains the pooling parameters.
+
+    Channel - Supplies the index of the channel over the batch.
+
+    ph - Supplies the position in the first aligned output dimension.
+
+    pw - Supplies the position in the second aligned output dimension.
+
+    Input - Supplies the input tensor of the channel.
+
+    Output - Supplies the output row.
+
+    Indices - Supplies the indices row, else nullptr.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const int64_t InputHeight = WorkBlock->InputShape[0];
+    const int64_t InputWidth = WorkBlock->InputShape[1];
+    const int64_t InputDepth = WorkBlock->InputShape[2];
+    const size_t OutputDepth = WorkBlock->OutputShape[2];
+
+    const int64_t KernelDepth = WorkBlock->KernelShape[2];
+    const int64_t DilationHeight = WorkBlock->DilationShape[0];
+    const int64_t DilationWidth = WorkBlock->DilationShape[1];
+    const int64_t DilationDepth = WorkBlock->DilationShape[2];
+    const int64_t PaddingDepth = WorkBlock->Padding[2];
+    const int64_t StrideDepth = WorkBlock->StrideShape[2];
+
+    const int64_t ihStart = int64_t(ph) * WorkBlock->StrideShape[0] - WorkBlock->Padding[0];
+    const int64_t ihFirst = MlasPoolFirstValidIndex(ihStart, DilationHeight);
+    const int64_t ihEnd = std::min(ihStart + WorkBlock->KernelShape[0] * DilationHeight, InputHeight);
+
+    const int64_t iwStart = int64_t(pw) * WorkBlock->StrideShape[1] - WorkBlock->Padding[1];
+    const int64_t iwFirst = MlasPoolFirstValidIndex(iwStart, DilationWidth);
+    const int64_t iwEnd = std::min(iwStart + WorkBlock->KernelShape[1] * DilationWidth, InputWidth);
+    const int64_t iwCount = iwEnd > iwFirst ? (iwEnd - iwFirst + DilationWidth - 1) / DilationWidth : 0;
+
+    //
+    // The index of a window without a maximum is -1 in the pooled dimensions
+    // and 0 in the missing leading dimensions.
+    //
+
+    const int64_t NotFoundHeight = WorkBlock->Dimensions == 3 ? -1 : 0;
+    const int64_t NotFoundWidth = WorkBlock->Dimensions >= 2 ? -1 : 0;
+
+    //
+    // With a stride of one, the windows of four consecutive outputs that lie
+    // entirely inside the input are reduced together. Every lane keeps the
+    // number of the window element that produced its maximum, which is
+    // exactly representable as a float for any practical kernel size.
+    //
+
+    size_t VectorBegin = OutputDepth;
+    size_t VectorEnd = OutputDepth;
+
+    if (StrideDepth == 1 &&
+        WorkBlock->KernelShape[0] * WorkBlock->KernelShape[1] * KernelDepth <= (int64_t(1) << 24)) {
+
+        const int64_t LastOutput = InputDepth - 1 + PaddingDepth - (KernelDepth - 1) * DilationDepth;
+
+        if (LastOutput >= PaddingDepth) {
+            VectorBegin = std::min(size_t(PaddingDepth), OutputDepth);
+            VectorEnd = std::min(size_t(LastOutput) + 1, OutputDepth);
+        }
+    }
+
+    size_t pd = 0;
+
+    while (pd < OutputDepth) {
+
+        if (pd >= VectorBegin && pd + 4 <= VectorEnd) {
+
+            const int64_t idStart = int64_t(pd) - PaddingDepth;
+
+            MLAS_FLOAT32X4 MaximumVector = MlasBroadcastFloat32x4(std::numeric_limits<float>::lowest());
+            MLAS_FLOAT32X4 ElementVector = MlasBroadcastFloat32x4(-1.0f);
+            float Element = 0.0f;
+
+            for (int64_t ih = ihFirst; ih < ihEnd; ih += DilationHeight) {
+                for (int64_t iw = iwFirst; iw < iwEnd; iw += DilationWidth) {
+
+                    const float* InputRow = Input + (ih * InputWidth + iw) * InputDepth + idStart;
+
+                    for (int64_t kd = 0; kd < KernelDepth; kd++) {
+
+                        MLAS_FLOAT32X4 InputVector = MlasLoadFloat32x4(InputRow + kd * DilationDepth);
+                        MLAS_FLOAT32X4 Greater = MlasGreaterThanFloat32x4(InputVector, MaximumVector);
+
+                        MaximumVector = MlasBlendFloat32x4(MaximumVector, InputVector, Greater);
+                        ElementVector = MlasBlendFloat32x4(ElementVector, MlasBroadcastFloat32x4(Element), Greater);
+                        Element += 1.0f;
+                    }
+                }
+            }
+
+            MlasStoreFloat32x4(&Output[pd], MaximumVector);
+
+            if (Indices != nullptr) {
+
+                float Elements[4];
+                MlasStoreFloat32x4(Elements, ElementVector);
+
+                for (size_t lane = 0; lane < 4; lane++) {
+
+                    if (Elements[lane] < 0.0f) {
+                        Indices[pd + lane] = MlasPoolInputIndex(WorkBlock, Channel, NotFoundHeight, NotFoundWidth, -1);
+                        continue;
+                    }
+
+                    const int64_t WindowElement = int64_t(Elements[lane]);
+                    const int64_t WindowRow = WindowElement / KernelDepth;
+
+                    Indices[pd + lane] = MlasPoolInputIndex(WorkBlock, Channel,
+                        ihFirst + (WindowRow / iwCount) * DilationHeight,
+                        iwFirst + (WindowRow % iwCount) * DilationWidth,
+                        idStart + int64_t(lane) + (WindowElement % KernelDepth) * DilationDepth);
+                }
+            }
+
+            pd += 4;
+            continue;
+        }
+
+        const int64_t idStart = int64_t(pd) * StrideDepth - PaddingDepth;
+        const int64_t idFirst = MlasPoolFirstValidIndex(idStart, DilationDepth);
+        const int64_t idEnd = std::min(idStart + KernelDepth * DilationDepth, InputDepth);
+
+        float Maximum = std::numeric_limits<float>::lowest();
+        int64_t hIndex = NotFoundHeight;
+        int64_t wIndex = NotFoundWidth;
+        int64_t dIndex = -1;
+
+        for (int64_t ih = ihFirst; ih < ihEnd; ih += DilationHeight) {
+            for (int64_t iw = iwFirst; iw < iwEnd; iw += DilationWidth) {
+
+                const float* InputRow = Input + (ih * InputWidth + iw) * InputDepth;
+
+                for (int64_t id = idFirst; id < idEnd; id += DilationDepth) {
+                    if (InputRow[id] > Maximum) {
+                        Maximum = InputRow[id];
+                        hIndex = ih;
+                        wIndex = iw;
+                        dIndex = id;
+                    }
+                }
+            }
+        }
+
+        Output[pd] = Maximum;
+
+        if (Indices != nullptr) {
+            Indices[pd] = MlasPoolInputIndex(WorkBlock, Channel, hIndex, wIndex, dIndex);
+        }
+
+        pd += 1;
+    }
+}
+
+void
+MLASCALL
+MlasMaximumPoolWithIndices(
+    size_t Dimensions,
+    const int64_t* InputShape,
+    const int64_t* KernelShape,
+    const int64_t* DilationShape,
+    const int64_t* Padding,
+    const int64_t* StrideShape,
+    const int64_t* OutputShape,
+    bool ColumnMajorIndices,
+    const float* Input,
+    float* Output,
+    int64_t* Indices,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the maximum pooling operation with dilations and
+    the optional index of every maximum, for channels first tensors.
+
+    The results match the scalar loops of the ONNX MaxPool operator: the
+    index of a maximum is its offset in the input tensor, where the channel
+    is counted over the batch and the pooled dimensions are in row major or
+    column major order.
+
+Arguments:
+
+    Dimensions - Supplies the number of pooled dimensions, from 1 to 3.
+
+    InputShape - Supplies the shape of the input tensor.
+
+    KernelShape - Supplies the shape of the kernel transform.
+
+    DilationShape - Supplies the dilation of the kernel, else nullptr for
+        dilations of one.
+
+    Padding - Supplies the number of padding elements at the edge of the input
+        tensor.
+
+    StrideShape - Supplies the shape of the stride.
+
+    OutputShape - Supplies the shape of the output tensor.
+
+    ColumnMajorIndices - Supplies true if the indices enumerate the pooled
+        dimensions in column major order.
+
+    Input - Supplies the input tensor.
+
+    Output - Supplies the output tensor.
+
+    Indices - Supplies the indices tensor, else nullptr if the indices are not
+        needed.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (Dimensions < 1 || Dimensions > 3) {
+#ifdef MLAS_NO_EXCEPTION
+        abort();
+#else
+        throw std::runtime_error("bad dimensions");
+#endif
+    }
+
+    MLAS_MAXIMUM_POOL_INDICES_WORK_BLOCK WorkBlock;
+
+    WorkBlock.Dimensions = Dimensions;
+    WorkBlock.ColumnMajorIndices = ColumnMajorIndices;
+
+    const size_t TotalChannelCount = size_t(InputShape[0]) * size_t(InputShape[1]);
+
+    size_t InputSize = 1;
+    int64_t KernelSize = 1;
+
+    for (size_t dim = 0; dim < 3; dim++) {
+
+        if (dim + Dimensions < 3) {
+            WorkBlock.InputShape[dim] = 1;
+            WorkBlock.OutputShape[dim] = 1;
+            WorkBlock.KernelShape[dim] = 1;
+            WorkBlock.DilationShape[dim] = 1;
+            WorkBlock.Padding[dim] = 0;
+            WorkBlock.StrideShape[dim] = 1;
+            continue;
+        }
+
+        const size_t src = dim + Dimensions - 3;
+
+        WorkBlock.InputShape[dim] = InputShape[src + 2];
+        WorkBlock.OutputShape[dim] = size_t(OutputShape[src + 2]);
+        WorkBlock.KernelShape[dim] = KernelShape[src];
+        WorkBlock.DilationShape[dim] = DilationShape != nullptr ? DilationShape[src] : 1;
+        WorkBlock.Padding[dim] = Padding[src];
+        WorkBlock.StrideShape[dim] = StrideShape[src];
+
+        InputSize *= size_t(InputShape[src + 2]);
+        KernelSize *= KernelShape[src];
+    }
+
+    WorkBlock.InputSize = InputSize;
+
+    //
+    // Partition the rows of the innermost output dimension over the threads.
+    //
+
+    const size_t OutputDepth = WorkBlock.OutputShape[2];
+    const size_t RowsPerChannel = WorkBlock.OutputShape[0] * WorkBlock.OutputShape[1];
+    const size_t RowCount = TotalChannelCount * RowsPerChannel;
+
+    if (RowCount == 0 || OutputDepth == 0) {
+        return;
+    }
+
+    const double Complexity = double(RowCount) * double(OutputDepth) * double(KernelSize);
+
+    ptrdiff_t TargetThreadCount = ptrdiff_t(Complexity / double(MLAS_POOL_INDICES_THREAD_COMPLEXITY)) + 1;
+    ptrdiff_t MaximumThreadCount = MlasGetMaximumThreadCount(ThreadPool);
+
+    if (TargetThreadCount >= MaximumThreadCount) {
+        TargetThreadCount = MaximumThreadCount;
+    }
+
+    if (size_t(TargetThreadCount) >= RowCount) {
+        TargetThreadCount = ptrdiff_t(RowCount);
+    }
+
+    MlasTrySimpleParallel(ThreadPool, TargetThreadCount, [&](ptrdiff_t tid) {
+
+        size_t RowIndex;
+        size_t RowRemaining;
+
+        MlasPartitionWork(tid, TargetThreadCount, RowCount, &RowIndex, &RowRemaining);
+
+        for (; RowRemaining > 0; RowIndex++, RowRemaining--) {
+
+            const size_t Channel = RowIndex / RowsPerChannel;
+            const size_t ph = (RowIndex % RowsPerChannel) / WorkBlock.OutputShape[1];
+            const size_t pw = RowIndex % WorkBlock.OutputShape[1];
+            const size_t OutputOffset = RowIndex * OutputDepth;
+
+            MlasMaximumPoolWithIndicesRow(&WorkBlock, Channel, ph, pw, Input + Channel * InputSize,
+                Output + OutputOffset, Indices != nullptr ? Indices + OutputOffset : nullptr);
+        }
+    });
+}
+
 template<typename T8Bits>
 void
 MLASCALL
@@ -1595,6 +1994,103 @@ Return Value:
     }
 }
 
+void
+MLASCALL
+MlasMaximumPool(
+    const float* const* Input,
+    float* Output,
+    size_t Channels,
+    size_t OutputCount,
+    size_t KernelSize
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the maximum pooling operation for channels last
+    floating point tensors.
+
+    The input is supplied as an indirection buffer in the same format as the
+    8-bit variant of this routine. Padding vectors should be filled with the
+    lowest float value (or -infinity) so that they never produce a maximum.
+
+Arguments:
+
+    Input - Supplies an indirection buffer to the elements of the input tensor.
+
+    Output - Supplies the output tensor in channels last format.
+
+    Channels - Supplies the number of channels.
+
+    OutputCount - Supplies the number of channel sized output elements to
+        produce.
+
+    KernelSize - Supplies the total number of channel sized kernel elements to
+        consume.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    while (OutputCount > 0) {
+
+        size_t ChannelOffset = 0;
+        size_t c = Channels;
+
+        while (c >= 8) {
+
+            MLAS_FLOAT32X4 MaximumVector0 = MlasBroadcastFloat32x4(std::numeric_limits<float>::lowest());
+            MLAS_FLOAT32X4 MaximumVector1 = MaximumVector0;
+
+            for (size_t k = 0; k < KernelSize; k++) {
+                MaximumVector0 = MlasMaximumFloat32x4(MaximumVector0, MlasLoadFloat32x4(&Input[k][ChannelOffset]));
+                MaximumVector1 = MlasMaximumFloat32x4(MaximumVector1, MlasLoadFloat32x4(&Input[k][ChannelOffset + 4]));
+            }
+
+            MlasStoreFloat32x4(&Output[0], MaximumVector0);
+            MlasStoreFloat32x4(&Output[4], MaximumVector1);
+            Output += 8;
+
+            ChannelOffset += 8;
+            c -= 8;
+        }
+
+        if (c >= 4) {
+
+            MLAS_FLOAT32X4 MaximumVector0 = MlasBroadcastFloat32x4(std::numeric_limits<float>::lowest());
+
+            for (size_t k = 0; k < KernelSize; k++) {
+                MaximumVector0 = MlasMaximumFloat32x4(MaximumVector0, MlasLoadFloat32x4(&Input[k][ChannelOffset]));
+            }
+
+            MlasStoreFloat32x4(&Output[0], MaximumVector0);
+            Output += 4;
+
+            ChannelOffset += 4;
+            c -= 4;
+        }
+
+        while (c > 0) {
+
+            float MaximumValue = std::numeric_limits<float>::lowest();
+
+            for (size_t k = 0; k < KernelSize; k++) {
+                MaximumValue = std::max(MaximumValue, Input[k][ChannelOffset]);
+            }
+
+            *Output++ = MaximumValue;
+
+            ChannelOffset += 1;
+            c -= 1;
+        }
+
+        Input += KernelSize;
+        OutputCount -= 1;
+    }
+}
+
 template
 void
 MLASCALL
@@ -0,0 +1,370 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    spgemm.cpp
+
+Abstract:
+
+    This module implements the single precision sparse matrix/dense matrix
+    multiply operation (SpGEMM), where the sparse matrix is stored in block
+    compressed sparse row format.
+
+--*/
+
+#include "mlasi.h"
+
+//
+// Define the number of columns of matrix C that are processed by a work item.
+//
+
+constexpr size_t MLAS_SPGEMM_STRIDEN = 256;
+
+//
+// Define the minimum number of multiply/add operations that are worth a
+// thread.
+//
+
+constexpr double MLAS_SPGEMM_THREAD_COMPLEXITY = 64 * 1024;
+
+template<size_t RowCount>
+void
+MlasSparseGemmKernel(
+    size_t BlockColumns,
+    size_t BlockStride,
+    const int64_t* BlockColumnIndex,
+    const float* BlockValues,
+    size_t BlockCount,
+    float alpha,
+    const float* B,
+    size_t ldb,
+    float* C,
+    size_t ldc,
+    size_t CountN
+    )
+/*++
+
+Routine Description:
+
+    This routine computes up to four rows of a block row of matrix C.
+
+Arguments:
+
+    BlockColumns - Supplies the number of columns of a block.
+
+    BlockStride - Supplies the number of elements of a block.
+
+    BlockColumnIndex - Supplies the column of matrix A of the first element of
+        each block of the block row.
+
+    BlockValues - Supplies the elements of the first row to compute of the
+        first block of the block row.
+
+    BlockCount - Supplies the number of blocks of the block row.
+
+    alpha - Supplies the scalar alpha multiplier.
+
+    B - Supplies the address of matrix B.
+
+    ldb - Supplies the first dimension of matrix B.
+
+    C - Supplies the address of matrix C.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    CountN - Supplies the number of columns of matrix B and matrix C.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    //
+    // Process 16 columns at a time, so that the accumulators of up to four
+    // rows stay in registers.
+    //
+
+    while (CountN >= 16) {
+
+        MLAS_FLOAT32X4 Accumulators[RowCount][4];
+
+        for (size_t r = 0; r < RowCount; r++) {
+            for (size_t i = 0; i < 4; i++) {
+                Accumulators[r][i] = MlasZeroFloat32x4();
+            }
+        }
+
+        for (size_t k = 0; k < BlockCount; k++) {
+
+            const float* b = B + size_t(BlockColumnIndex[k]) * ldb;
+            const float* a = BlockValues + k * BlockStride;
+
+            for (size_t j = 0; j < BlockColumns; j++) {
+
+                MLAS_FLOAT32X4 BElements[4];
+
+                for (size_t i = 0; i < 4; i++) {
+                    BElements[i] = MlasLoadFloat32x4(b + i * 4);
+                }
+
+                for (size_t r = 0; r < RowCount; r++) {
+                    const float AElement = a[r * BlockColumns + j];
+                    for (size_t i = 0; i < 4; i++) {
+                        Accumulators[r][i] = MlasMultiplyAddFloat32x4(BElements[i], AElement, Accumulators[r][i]);
+                    }
+                }
+
+                b += ldb;
+            }
+        }
+
+        for (size_t r = 0; r < RowCount; r++) {
+            for (size_t i = 0; i < 4; i++) {
+                MlasStoreFloat32x4(C + r * ldc + i * 4,
+                                   MlasMultiplyFloat32x4(Accumulators[r][i], MlasBroadcastFloat32x4(alpha)));
+            }
+        }
+
+        B += 16;
+        C += 16;
+        CountN -= 16;
+    }
+
+    //
+    // Process the remaining columns four at a time, then one at a time.
+    //
+
+    while (CountN > 0) {
+
+        const size_t CountVector = (CountN >= 4) ? 4 : 1;
+
+        MLAS_FLOAT32X4 Accumulators[RowCount];
+        float ScalarAccumulators[RowCount];
+
+        for (size_t r = 0; r < RowCount; r++) {
+            Accumulators[r] = MlasZeroFloat32x4();
+            ScalarAccumulators[r] = 0.0f;
+        }
+
+        for (size_t k = 0; k < BlockCount; k++) {
+
+            const float* b = B + size_t(BlockColumnIndex[k]) * ldb;
+            const float* a = BlockValues + k * BlockStride;
+
+            for (size_t j = 0; j < BlockColumns; j++) {
+
+                if (CountVector == 4) {
+                    MLAS_FLOAT32X4 BElements = MlasLoadFloat32x4(b);
+                    for (size_t r = 0; r < RowCount; r++) {
+                        Accumulators[r] = MlasMultiplyAddFloat32x4(BElements, a[r * BlockColumns + j], Accumulators[r]);
+                    }
+                } else {
+                    for (size_t r = 0; r < RowCount; r++) {
+                        ScalarAccumulators[r] += b[0] * a[r * BlockColumns + j];
+                    }
+                }
+
+                b += ldb;
+            }
+        }
+
+        for (size_t r = 0; r < RowCount; r++) {
+            if (CountVector == 4) {
+                MlasStoreFloat32x4(C + r * ldc, MlasMultiplyFloat32x4(Accumulators[r], MlasBroadcastFloat32x4(alpha)));
+            } else {
+                C[r * ldc] = ScalarAccumulators[r] * alpha;
+            }
+        }
+
+        B += CountVector;
+        C += CountVector;
+        CountN -= CountVector;
+    }
+}
+
+void
+MlasSparseGemmBlockRow(
+    const MLAS_SPARSE_MATRIX& A,
+    size_t BlockRow,
+    size_t CountM,
+    float alpha,
+    const float* B,
+    size_t ldb,
+    float* C,
+    size_t ldc,
+    size_t CountN
+    )
+/*++
+
+Routine Description:
+
+    This routine computes a block row of matrix C for a range of columns.
+
+Arguments:
+
+    A - Supplies the sparse matrix A.
+
+    BlockRow - Supplies the index of the block row.
+
+    CountM - Supplies the number of rows of the block row to compute.
+
+    alpha - Supplies the scalar alpha multiplier.
+
+    B - Supplies the address of matrix B at the first column to compute.
+
+    ldb - Supplies the first dimension of matrix B.
+
+    C - Supplies the address of matrix C at the first row and column of the
+        block row to compute.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    CountN - Supplies the number of columns to compute.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t BlockStart = size_t(A.BlockRowStart[BlockRow]);
+    const size_t BlockCount = size_t(A.BlockRowStart[BlockRow + 1]) - BlockStart;
+    const size_t BlockStride = A.BlockRows * A.BlockColumns;
+
+    const int64_t* BlockColumnIndex = A.BlockColumnIndex + BlockStart;
+    const float* BlockValues = A.BlockValues + BlockStart * BlockStride;
+
+    size_t RowOffset = 0;
+
+    while (RowOffset < CountM) {
+
+        const size_t RowCount = std::min(CountM - RowOffset, size_t(4));
+        const float* a = BlockValues + RowOffset * A.BlockColumns;
+        float* c = C + RowOffset * ldc;
+
+        switch (RowCount) {
+            case 1:
+                MlasSparseGemmKernel<1>(A.BlockColumns, BlockStride, BlockColumnIndex, a, BlockCount, alpha, B, ldb, c, ldc, CountN);
+                break;
+            case 2:
+                MlasSparseGemmKernel<2>(A.BlockColumns, BlockStride, BlockColumnIndex, a, BlockCount, alpha, B, ldb, c, ldc, CountN);
+                break;
+            case 3:
+                MlasSparseGemmKernel<3>(A.BlockColumns, BlockStride, BlockColumnIndex, a, BlockCount, alpha, B, ldb, c, ldc, CountN);
+                break;
+            default:
+                MlasSparseGemmKernel<4>(A.BlockColumns, BlockStride, BlockColumnIndex, a, BlockCount, alpha, B, ldb, c, ldc, CountN);
+                break;
+        }
+
+        RowOffset += RowCount;
+    }
+}
+
+void
+MLASCALL
+MlasSparseGemm(
+    size_t M,
+    size_t N,
+    const MLAS_SPARSE_MATRIX& A,
+    float alpha,
+    const float* B,
+    size_t ldb,
+    float* C,
+    size_t ldc,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the single precision sparse matrix/dense matrix
+    multiply operation C := alpha * A * B.
+
+    The block rows of matrix C and ranges of its columns are distributed over
+    the thread pool.
+
+Arguments:
+
+    M - Supplies the number of rows of matrix A and matrix C.
+
+    N - Supplies the number of columns of matrix B and matrix C.
+
+    A - Supplies the sparse matrix A.
+
+    alpha - Supplies the scalar alpha multiplier.
+
+    B - Supplies the address of matrix B.
+
+    ldb - Supplies the first dimension of matrix B.
+
+    C - Supplies the address of matrix C.
+
+    ldc - Supplies the first dimension of matrix C.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (M == 0 || N == 0) {
+        return;
+    }
+
+    const size_t BlockRows = A.BlockRows;
+    const size_t BlockRowCount = (M + BlockRows - 1) / BlockRows;
+    const size_t ChunkCountN = (N + MLAS_SPGEMM_STRIDEN - 1) / MLAS_SPGEMM_STRIDEN;
+    const size_t WorkCount = BlockRowCount * ChunkCountN;
+
+    //
+    // Compute the number of target threads given the complexity of the
+    // operation.
+    //
+
+    const size_t NonZeroCount = size_t(A.BlockRowStart[BlockRowCount] - A.BlockRowStart[0]) * BlockRows * A.BlockColumns;
+    const double Complexity = double(NonZeroCount) * double(N);
+
+    ptrdiff_t TargetThreadCount;
+
+    if (Complexity < double(MLAS_SPGEMM_THREAD_COMPLEXITY * GetMlasPlatform().MaximumThreadCount)) {
+        TargetThreadCount = ptrdiff_t(Complexity / double(MLAS_SPGEMM_THREAD_COMPLEXITY)) + 1;
+    } else {
+        TargetThreadCount = GetMlasPlatform().MaximumThreadCount;
+    }
+
+    ptrdiff_t MaximumThreadCount = MlasGetMaximumThreadCount(ThreadPool);
+
+    if (TargetThreadCount >= MaximumThreadCount) {
+        TargetThreadCount = MaximumThreadCount;
+    }
+
+    if (size_t(TargetThreadCount) > WorkCount) {
+        TargetThreadCount = ptrdiff_t(WorkCount);
+    }
+
+    MlasTrySimpleParallel(ThreadPool, TargetThreadCount, [&](ptrdiff_t tid) {
+        size_t WorkIndex;
+        size_t WorkRemaining;
+
+        MlasPartitionWork(tid, TargetThreadCount, WorkCount, &WorkIndex, &WorkRemaining);
+
+        for (size_t w = WorkIndex; w < WorkIndex + WorkRemaining; w++) {
+
+            const size_t BlockRow = w / ChunkCountN;
+            const size_t n = (w % ChunkCountN) * MLAS_SPGEMM_STRIDEN;
+            const size_t m = BlockRow * BlockRows;
+
+            MlasSparseGemmBlockRow(A, BlockRow, std::min(M - m, BlockRows), alpha, B + n, ldb,
+                                   C + m * ldc + n, ldc, std::min(N - n, MLAS_SPGEMM_STRIDEN));
+        }
+    });
+}
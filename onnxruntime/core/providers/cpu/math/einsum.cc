@@ -45,12 +45,22 @@ Status Einsum::Compute(OpKernelContext* context) const {
 
 Status Einsum::DeviceCompute(OpKernelContext* context, const std::vector<const Tensor*>& inputs,
                              AllocatorPtr allocator, concurrency::ThreadPool* tp) const {
+  // The CPU transposes get the thread pool of the kernel, as MatMul and ReduceSum do
+  auto transpose = [tp](const gsl::span<const size_t>& permutation, const Tensor& input, Tensor& output,
+                        const TensorShape* input_shape_override, void* einsum_cuda_assets) {
+    return EinsumOp::DeviceHelpers::CpuDeviceHelpers::Transpose(permutation, input, output, input_shape_override,
+                                                                einsum_cuda_assets, tp);
+  };
+  auto diagonal = [tp](const Tensor& input, int64_t dim_1, int64_t dim_2, AllocatorPtr allocator,
+                       void* einsum_cuda_assets) {
+    return EinsumOp::DeviceHelpers::CpuDeviceHelpers::Diagonal(input, dim_1, dim_2, allocator, einsum_cuda_assets, tp);
+  };
+
   // EinsumComputePreprocessor section -
   auto einsum_compute_preprocessor =
       EinsumComputePreprocessor(*einsum_equation_preprocessor_, inputs, allocator, nullptr);
 
-  einsum_compute_preprocessor.SetDeviceHelpers(EinsumOp::DeviceHelpers::CpuDeviceHelpers::Diagonal,
-                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::Transpose);
+  einsum_compute_preprocessor.SetDeviceHelpers(diagonal, transpose);
   // Compute all required metadata to be used at Einsum compute time and return error status code if one was generated
   ORT_RETURN_IF_ERROR(einsum_compute_preprocessor.Run());
 
@@ -62,7 +72,7 @@ Status Einsum::DeviceCompute(OpKernelContext* context, const std::vector<const T
                                                                        nullptr);
 
     // Set device specific methods (CPU methods) to be used during processing
-    einsum_compute_processor.SetDeviceHelpers(EinsumOp::DeviceHelpers::CpuDeviceHelpers::Transpose,
+    einsum_compute_processor.SetDeviceHelpers(transpose,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::MatMul<float>,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::ReduceSum<float>,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::DataCopy);
@@ -75,7 +85,7 @@ Status Einsum::DeviceCompute(OpKernelContext* context, const std::vector<const T
                                                                          nullptr);
 
     // Set device specific methods (CPU methods) to be used during processing
-    einsum_compute_processor.SetDeviceHelpers(EinsumOp::DeviceHelpers::CpuDeviceHelpers::Transpose,
+    einsum_compute_processor.SetDeviceHelpers(transpose,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::MatMul<int32_t>,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::ReduceSum<int32_t>,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::DataCopy);
@@ -89,7 +99,7 @@ Status Einsum::DeviceCompute(OpKernelContext* context, const std::vector<const T
                                                                         nullptr);
 
     // Set device specific methods (CPU methods) to be used during processing
-    einsum_compute_processor.SetDeviceHelpers(EinsumOp::DeviceHelpers::CpuDeviceHelpers::Transpose,
+    einsum_compute_processor.SetDeviceHelpers(transpose,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::MatMul<double>,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::ReduceSum<double>,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::DataCopy);
@@ -101,7 +111,7 @@ Status Einsum::DeviceCompute(OpKernelContext* context, const std::vector<const T
                                                                          einsum_compute_preprocessor,
                                                                          nullptr);
 
-    einsum_compute_processor.SetDeviceHelpers(EinsumOp::DeviceHelpers::CpuDeviceHelpers::Transpose,
+    einsum_compute_processor.SetDeviceHelpers(transpose,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::MatMul<int64_t>,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::ReduceSum<int64_t>,
                                               EinsumOp::DeviceHelpers::CpuDeviceHelpers::DataCopy);
@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include "einsum_auxiliary_ops.h"
+#include "core/mlas/inc/mlas.h"
 
 using namespace onnxruntime::common;
 
@@ -24,25 +25,66 @@ Status DataCopy(const Tensor& input, Tensor& output, void* /*einsum_cuda_assets*
 
 // CPU specific Transpose helper
 Status Transpose(const gsl::span<const size_t>& permutation, const Tensor& input,
-                 Tensor& output, const TensorShape* input_shape_override, void* /*einsum_cuda_assets*/) {
-  return TransposeBase::DoTranspose(permutation, input, output, input_shape_override);
+                 Tensor& output, const TensorShape* input_shape_override, void* /*einsum_cuda_assets*/,
+                 concurrency::ThreadPool* tp) {
+  return TransposeBase::DoTranspose(permutation, input, output, input_shape_override, tp);
+}
+
+// CPU specific MatMul helper(s)
+template <typename T>
+static void BatchedMatMul(const T* input_1_data, const T* input_2_data, T* output_data,
+                          size_t left_stride, size_t right_stride, size_t output_stride,
+                          size_t num_batches, size_t M, size_t K, size_t N, concurrency::ThreadPool* tp) {
+  if (num_batches == 1) {
+    math::MatMul<T>(static_cast<int>(M), static_cast<int>(N), static_cast<int>(K),
+                    input_1_data, input_2_data, output_data, tp);
+    return;
+  }
+
+  // Attention-like equations produce many small MatMuls - parallelize across the batches
+  // rather than within each (small) MatMul
+  concurrency::ThreadPool::TryParallelFor(
+      tp, static_cast<std::ptrdiff_t>(num_batches), static_cast<double>(M * N * K),
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        for (std::ptrdiff_t i = begin; i < end; ++i) {
+          math::MatMul<T>(
+              static_cast<int>(M),
+              static_cast<int>(N),
+              static_cast<int>(K),
+              input_1_data + i * left_stride,
+              input_2_data + i * right_stride,
+              output_data + i * output_stride, nullptr);
+        }
+      });
+}
+
+// Use the batched MLAS GEMM (as the MatMul op does) which partitions work across batches and
+// within each MatMul depending on the problem size
+static void BatchedMatMul(const float* input_1_data, const float* input_2_data, float* output_data,
+                          size_t left_stride, size_t right_stride, size_t output_stride,
+                          size_t num_batches, size_t M, size_t K, size_t N, concurrency::ThreadPool* tp) {
+  std::vector<MLAS_SGEMM_DATA_PARAMS> data(num_batches);
+  for (size_t i = 0; i < num_batches; ++i) {
+    data[i].A = input_1_data + i * left_stride;
+    data[i].lda = K;
+    data[i].B = input_2_data + i * right_stride;
+    data[i].ldb = N;
+    data[i].C = output_data + i * output_stride;
+    data[i].ldc = N;
+    data[i].alpha = 1.f;
+    data[i].beta = 0.f;
+  }
+  MlasGemmBatch(CblasNoTrans, CblasNoTrans, M, N, K, data.data(), num_batches, tp);
 }
 
-// CPU specific MatMul helper
 template <typename T>
 Status MatMul(const T* input_1_data, const T* input_2_data, T* output_data,
               size_t left_stride, size_t right_stride, size_t output_stride,
               size_t num_batches, size_t M, size_t K, size_t N, concurrency::ThreadPool* tp,
               void* /*einsum_cuda_assets*/) {
-  for (size_t i = 0; i < num_batches; ++i) {
-    math::MatMul<T>(
-        static_cast<int>(M),
-        static_cast<int>(N),
-        static_cast<int>(K),
-        input_1_data + i * left_stride,
-        input_2_data + i * right_stride,
-        output_data + i * output_stride, tp);
-  }
+  BatchedMatMul(input_1_data, input_2_data, output_data,
+                left_stride, right_stride, output_stride,
+                num_batches, M, K, N, tp);
 
   return Status::OK();
 }
@@ -156,7 +198,8 @@ static std::unique_ptr<Tensor> DiagonalInnermostDims(const Tensor& input,
   return output;
 }
 
-std::unique_ptr<Tensor> Diagonal(const Tensor& input, int64_t dim_1, int64_t dim_2, AllocatorPtr allocator, void* /*einsum_cuda_assets*/) {
+std::unique_ptr<Tensor> Diagonal(const Tensor& input, int64_t dim_1, int64_t dim_2, AllocatorPtr allocator, void* /*einsum_cuda_assets*/,
+                                 concurrency::ThreadPool* tp) {
   const auto& input_shape = input.Shape();
   const auto input_dims = input_shape.GetDims();
   auto rank = static_cast<int64_t>(input_dims.size());
@@ -179,6 +222,11 @@ std::unique_ptr<Tensor> Diagonal(const Tensor& input, int64_t dim_1, int64_t dim
 
   bool is_transpose_required = IsTransposeRequiredForDiagonal(dim_1, dim_2, rank);
   if (is_transpose_required) {
+    auto transpose = [tp](const gsl::span<const size_t>& perm, const Tensor& in, Tensor& out,
+                          const TensorShape* shape_override, void* einsum_cuda_assets) {
+      return Transpose(perm, in, out, shape_override, einsum_cuda_assets, tp);
+    };
+
     std::vector<size_t> permutation(rank, 0);
     int64_t first_dim_axis = -1;  // This is the axis eventually occupied by the first_dim
 
@@ -214,7 +262,7 @@ std::unique_ptr<Tensor> Diagonal(const Tensor& input, int64_t dim_1, int64_t dim
 
     // Permutate the input so that the dims from which we need the diagonal forms the innermost dims
     // (Pass in CPU Transpose function here as this Diagonal method will only be used for CPU based diagonal parsing)
-    auto transposed = EinsumOp::Transpose(input, input_dims, permutation, allocator, nullptr, Transpose);
+    auto transposed = EinsumOp::Transpose(input, input_dims, permutation, allocator, nullptr, transpose);
 
     // Parse the diagonal from the innermost dims
     output = DiagonalInnermostDims(*transposed, preserve_innermost_dim_val, allocator);
@@ -230,7 +278,7 @@ std::unique_ptr<Tensor> Diagonal(const Tensor& input, int64_t dim_1, int64_t dim
 
     // Permutate using the reverse permutation to get back the original axes ordering
     // (Pass in CPU Transpose function here as this Diagonal method will only be used for CPU based diagonal parsing)
-    output = EinsumOp::Transpose(*output, output->Shape().GetDims(), reverse_permutation, allocator, nullptr, Transpose);
+    output = EinsumOp::Transpose(*output, output->Shape().GetDims(), reverse_permutation, allocator, nullptr, transpose);
   } else {
     // No transposing required
     output = DiagonalInnermostDims(input, preserve_innermost_dim_val, allocator);
@@ -63,8 +63,10 @@ namespace CpuDeviceHelpers {
 
 Status DataCopy(const Tensor& input, Tensor& output, void* einsum_cuda_assets);
 
+// `tp` parallelizes the general N-D transpose, Einsum binds it to its own thread pool
 Status Transpose(const gsl::span<const size_t>& permutation, const Tensor& input,
-                 Tensor& output, const TensorShape* input_shape_override, void* einsum_cuda_assets);
+                 Tensor& output, const TensorShape* input_shape_override, void* einsum_cuda_assets,
+                 concurrency::ThreadPool* tp);
 
 template <typename T>
 Status MatMul(const T* input_1_data, const T* input_2_data, T* output_data,
@@ -78,7 +80,8 @@ std::unique_ptr<Tensor> ReduceSum(const Tensor& input, gsl::span<const int64_t>
                                   const TensorShape* input_shape_override,
                                   concurrency::ThreadPool* tp, void* einsum_cuda_assets);
 
-std::unique_ptr<Tensor> Diagonal(const Tensor& input, int64_t dim_1, int64_t dim_2, AllocatorPtr allocator, void* einsum_cuda_assets);
+std::unique_ptr<Tensor> Diagonal(const Tensor& input, int64_t dim_1, int64_t dim_2, AllocatorPtr allocator, void* einsum_cuda_assets,
+                                 concurrency::ThreadPool* tp);
 
 }  // namespace CpuDeviceHelpers
 
@@ -3,6 +3,9 @@
 
 #include "einsum_compute_preprocessor.h"
 
+#include <algorithm>
+#include <numeric>
+
 namespace onnxruntime {
 
 EinsumComputePreprocessor::EinsumComputePreprocessor(EinsumEquationPreprocessor& einsum_equation_preprocessor,
@@ -29,6 +32,8 @@ Status EinsumComputePreprocessor::Run() {
 
   ORT_RETURN_IF_ERROR(PreprocessInputs());
 
+  ORT_RETURN_IF_ERROR(CalculateContractionOrder());
+
   return Status::OK();
 }
 
@@ -56,6 +61,14 @@ const std::vector<int64_t>& EinsumComputePreprocessor::GetMappedSubscriptIndices
   return subscript_indices_to_output_indices_;
 }
 
+const std::vector<size_t>& EinsumComputePreprocessor::GetContractionOrder() const {
+  return contraction_order_;
+}
+
+const std::vector<int64_t>& EinsumComputePreprocessor::GetMappedSubscriptIndicesToLastContractionStep() const {
+  return subscript_indices_to_last_contraction_step_;
+}
+
 int64_t EinsumComputePreprocessor::GetNumSubscriptIndices() const {
   return num_subscript_indices_;
 }
@@ -476,4 +489,177 @@ Status EinsumComputePreprocessor::PreprocessInputs() {
   return Status::OK();
 }
 
+// Beyond this many inputs, we stop searching all contraction orders exhaustively and fall back to a greedy search
+static constexpr size_t kMaxInputsForExhaustiveContractionOrderSearch = 6;
+
+namespace {
+
+struct ContractionCost {
+  // Sum (over all pair-wise contractions) of the product of the dim values of all subscript labels involved
+  // (i.e.) the number of multiply-adds performed by the MatMul of each pair
+  double num_multiply_adds = 0;
+
+  // Size of the largest intermediate result
+  double max_intermediate_size = 0;
+
+  bool operator<(const ContractionCost& other) const {
+    if (num_multiply_adds != other.num_multiply_adds) {
+      return num_multiply_adds < other.num_multiply_adds;
+    }
+    return max_intermediate_size < other.max_intermediate_size;
+  }
+};
+
+}  // namespace
+
+static double SizeOfSubscriptIndices(uint64_t subscript_indices_mask, const std::vector<int64_t>& subscript_indices_to_dim_value) {
+  double size = 1;
+  for (size_t i = 0; i < subscript_indices_to_dim_value.size(); ++i) {
+    if (subscript_indices_mask & (uint64_t{1} << i)) {
+      size *= static_cast<double>(subscript_indices_to_dim_value[i]);
+    }
+  }
+  return size;
+}
+
+// Estimates the cost of contracting the inputs pair-wise (left to right) in the given order.
+// A subscript index that is not in the output is reduced right after the last input containing it has been processed.
+static ContractionCost EstimateContractionCost(gsl::span<const size_t> order,
+                                               const std::vector<uint64_t>& input_subscript_indices_masks,
+                                               uint64_t output_subscript_indices_mask,
+                                               const std::vector<int64_t>& subscript_indices_to_dim_value) {
+  // For each position in the order, the subscript indices that are seen in any of the inputs after it
+  InlinedVector<uint64_t> seen_after(order.size(), 0);
+  for (size_t i = order.size() - 1; i > 0; --i) {
+    seen_after[i - 1] = seen_after[i] | input_subscript_indices_masks[order[i]];
+  }
+
+  ContractionCost cost;
+  uint64_t current = input_subscript_indices_masks[order[0]] & (seen_after[0] | output_subscript_indices_mask);
+  for (size_t i = 1; i < order.size(); ++i) {
+    uint64_t involved = current | input_subscript_indices_masks[order[i]];
+    cost.num_multiply_adds += SizeOfSubscriptIndices(involved, subscript_indices_to_dim_value);
+    current = involved & (seen_after[i] | output_subscript_indices_mask);
+    cost.max_intermediate_size = std::max(cost.max_intermediate_size,
+                                          SizeOfSubscriptIndices(current, subscript_indices_to_dim_value));
+  }
+
+  return cost;
+}
+
+Status EinsumComputePreprocessor::CalculateContractionOrder() {
+  const size_t num_inputs = inputs_.size();
+
+  contraction_order_.resize(num_inputs);
+  std::iota(contraction_order_.begin(), contraction_order_.end(), size_t{0});
+
+  // With 2 or fewer inputs (or too many subscript labels to be tracked in a bit mask), the order of the inputs
+  // is left as such
+  if (num_inputs > 2 && static_cast<size_t>(num_subscript_indices_) <= 64) {
+    auto& cache = *einsum_equation_preprocessor_.contraction_order_cache_;
+
+    // The dim value of each subscript index along with the input ranks (which determine which inputs the
+    // broadcasted dims are seen in) determine the cost of any contraction order
+    std::vector<int64_t> shape_signature(subscript_indices_to_dim_value_);
+    for (const auto* input : inputs_) {
+      shape_signature.push_back(static_cast<int64_t>(input->Shape().NumDimensions()));
+    }
+
+    std::unique_lock<std::mutex> lock(cache.mutex);
+    auto cached = cache.contraction_orders.find(shape_signature);
+    if (cached != cache.contraction_orders.end()) {
+      contraction_order_ = cached->second;
+    } else {
+      lock.unlock();
+
+      std::vector<uint64_t> input_subscript_indices_masks(num_inputs, 0);
+      for (size_t i = 0; i < num_inputs; ++i) {
+        for (auto subscript_index : input_subscript_indices_[i]) {
+          input_subscript_indices_masks[i] |= uint64_t{1} << subscript_index;
+        }
+      }
+
+      uint64_t output_subscript_indices_mask = 0;
+      for (int64_t i = 0; i < num_subscript_indices_; ++i) {
+        if (subscript_indices_to_output_indices_[i] != -1) {
+          output_subscript_indices_mask |= uint64_t{1} << i;
+        }
+      }
+
+      auto estimate_cost = [&](gsl::span<const size_t> order) {
+        return EstimateContractionCost(order, input_subscript_indices_masks, output_subscript_indices_mask,
+                                       subscript_indices_to_dim_value_);
+      };
+
+      // Only move away from the order in which the inputs were given if there is a strictly cheaper one
+      auto best_cost = estimate_cost(contraction_order_);
+
+      if (num_inputs <= kMaxInputsForExhaustiveContractionOrderSearch) {
+        std::vector<size_t> order = contraction_order_;
+        while (std::next_permutation(order.begin(), order.end())) {
+          auto cost = estimate_cost(order);
+          if (cost < best_cost) {
+            best_cost = cost;
+            contraction_order_ = order;
+          }
+        }
+      } else {
+        // Greedy search: starting from each input, repeatedly pick the input that is cheapest to contract
+        // with the running result
+        std::vector<size_t> order;
+        order.reserve(num_inputs);
+        for (size_t first = 0; first < num_inputs; ++first) {
+          order.assign(1, first);
+          std::vector<bool> is_used(num_inputs, false);
+          is_used[first] = true;
+
+          while (order.size() < num_inputs) {
+            size_t best_next = num_inputs;
+            ContractionCost best_next_cost;
+            for (size_t next = 0; next < num_inputs; ++next) {
+              if (is_used[next]) {
+                continue;
+              }
+              order.push_back(next);
+              auto cost = estimate_cost(order);
+              order.pop_back();
+              if (best_next == num_inputs || cost < best_next_cost) {
+                best_next = next;
+                best_next_cost = cost;
+              }
+            }
+            order.push_back(best_next);
+            is_used[best_next] = true;
+          }
+
+          auto cost = estimate_cost(order);
+          if (cost < best_cost) {
+            best_cost = cost;
+            contraction_order_ = order;
+          }
+        }
+      }
+
+      lock.lock();
+      if (cache.contraction_orders.size() >= EinsumOp::max_cached_contraction_orders) {
+        cache.contraction_orders.clear();
+      }
+      cache.contraction_orders.emplace(std::move(shape_signature), contraction_order_);
+    }
+  }
+
+  // Map each subscript index to the step at which it can be reduced
+  subscript_indices_to_last_contraction_step_.assign(num_subscript_indices_, -1);
+  for (size_t step = 0; step < num_inputs; ++step) {
+    for (auto subscript_index : input_subscript_indices_[contraction_order_[step]]) {
+      // Subscript indices that appear in the output are never reduced
+      if (subscript_indices_to_last_input_[subscript_index] != -1) {
+        subscript_indices_to_last_contraction_step_[subscript_index] = static_cast<int64_t>(step);
+      }
+    }
+  }
+
+  return Status::OK();
+}
+
 }  // namespace onnxruntime
@@ -15,6 +15,10 @@
 
 #include "einsum_auxiliary_ops.h"
 
+#include <map>
+#include <memory>
+#include <mutex>
+
 namespace onnxruntime {
 
 namespace EinsumOp {
@@ -41,6 +45,17 @@ inline int64_t LetterToIndex(char ch) {
   return -1;
 }
 
+// Upper bound on the number of distinct input shape signatures we hold a contraction order for.
+// Models with dynamic shapes could otherwise grow the cache without bound.
+constexpr size_t max_cached_contraction_orders = 64;
+
+// Holds the contraction order chosen for each input shape signature seen so far.
+// The key is the dim value of each subscript index followed by the rank of each input.
+struct ContractionOrderCache {
+  std::mutex mutex;
+  std::map<std::vector<int64_t>, std::vector<size_t>> contraction_orders;
+};
+
 }  // namespace EinsumOp
 
 struct EinsumEquationPreprocessor {
@@ -76,9 +91,8 @@ struct EinsumEquationPreprocessor {
   }
 
   // Holds the pre-processed equation string
-  // In theory, we could re-write the einsum equation to lower overall cost of intermediate arrays
-  // See numpy.einsum_path for details/examples
-  // These are very advanced optimizations that we don't require for the average use-case
+  // The order in which the operands are contracted is chosen at Compute() time based on the input shapes
+  // (see EinsumComputePreprocessor::CalculateContractionOrder())
   std::string einsum_preprocessed_equation_;
 
   // In explicit form, holds the left side of the einsum equation
@@ -95,6 +109,12 @@ struct EinsumEquationPreprocessor {
 
   // Flag indicating if the Einsum op is being used in explicit form (i.e.) contains '->'
   bool is_explicit_ = false;
+
+  // Cache of contraction orders keyed by input shape signature
+  // This is a shared_ptr as each EinsumComputePreprocessor holds a copy of this instance and
+  // all copies need to share the same cache
+  std::shared_ptr<EinsumOp::ContractionOrderCache> contraction_order_cache_ =
+      std::make_shared<EinsumOp::ContractionOrderCache>();
 };
 
 // Prologue:
@@ -139,6 +159,14 @@ class EinsumComputePreprocessor final {
   // For each subscript index, hold the index it corresponds to in the output's shape
   const std::vector<int64_t>& GetMappedSubscriptIndicesToOutputindices() const;
 
+  // The order in which the inputs are to be contracted (pair-wise, left to right)
+  const std::vector<size_t>& GetContractionOrder() const;
+
+  // For each subscript index, hold the step in the contraction order at which it can be reduced
+  // (i.e.) the position in the contraction order of the last input the subscript index was seen in
+  // If the value is `-1`, the subscript index appears in the output and is never reduced
+  const std::vector<int64_t>& GetMappedSubscriptIndicesToLastContractionStep() const;
+
   // Get the number of subscript indices (subscript labels) in the einsum equation
   int64_t GetNumSubscriptIndices() const;
 
@@ -164,6 +192,11 @@ class EinsumComputePreprocessor final {
 
   Status PreprocessInputs();
 
+  // Choose the order in which the inputs are contracted so as to minimize the total number of multiply-adds
+  // performed by the pair-wise MatMuls (similar to numpy.einsum_path / opt_einsum)
+  // This is only relevant when there are more than 2 inputs
+  Status CalculateContractionOrder();
+
   // private members
   // Instance of EinsumEquationPreprocessor
   EinsumEquationPreprocessor einsum_equation_preprocessor_;
@@ -213,6 +246,13 @@ class EinsumComputePreprocessor final {
   // A value of -1 means the corresponding subscript index is not found in the output
   std::vector<int64_t> subscript_indices_to_output_indices_;
 
+  // The order in which the inputs are to be contracted
+  std::vector<size_t> contraction_order_;
+
+  // Holds the position in contraction_order_ of the last input to have the index corresponding to the subscript label
+  // If the value is `-1`, then the subscript label appears in the output
+  std::vector<int64_t> subscript_indices_to_last_contraction_step_;
+
   // Allocator to use for ad-hoc tensor buffer allocation
   AllocatorPtr allocator_;
 
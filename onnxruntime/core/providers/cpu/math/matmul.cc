@@ -2,6 +2,9 @@
 // Licensed under the MIT License.
 
 #include "core/providers/cpu/math/matmul.h"
+
+#include <algorithm>
+
 #include "core/providers/cpu/math/gemm_matmul_common.h"
 #include "core/providers/cpu/math/matmul_helper.h"
 #include "core/util/math.h"
@@ -126,6 +129,131 @@ Status MatMul<T>::Compute(OpKernelContext* ctx) const {
   return Status::OK();
 }
 
+namespace {
+
+// Weights that have at most this fraction of elements in non-zero blocks are multiplied as sparse matrices.
+constexpr double kMaxSparseDensity = 0.1;
+
+// A packed sparse weight is stored as the block rows and block columns, the index of the first block of each
+// block row, the column of each block, and the elements of the blocks.
+MLAS_SPARSE_MATRIX GetPackedSparseMatrix(const void* packed, size_t rows) {
+  const auto* header = static_cast<const int64_t*>(packed);
+  MLAS_SPARSE_MATRIX matrix;
+  matrix.BlockRows = static_cast<size_t>(header[0]);
+  matrix.BlockColumns = static_cast<size_t>(header[1]);
+  matrix.BlockRowStart = header + 2;
+  const size_t block_row_count = (rows + matrix.BlockRows - 1) / matrix.BlockRows;
+  matrix.BlockColumnIndex = matrix.BlockRowStart + block_row_count + 1;
+  matrix.BlockValues = reinterpret_cast<const float*>(matrix.BlockColumnIndex + matrix.BlockRowStart[block_row_count]);
+  return matrix;
+}
+
+// Packs the transpose of a 2-D weight, an N x K matrix, in block compressed sparse row format if it is sparse
+// enough. Larger blocks reuse each row of the dense matrix for more rows of the output, so they are preferred
+// unless they store many more zeros than 1 x 1 blocks.
+bool MatMulPackBSparseFp32(AllocatorPtr& alloc, const Tensor& tensor_b, bool trans_b,
+                           BufferUniquePtr& packed_b, size_t& packed_b_size) {
+  const auto& b_shape = tensor_b.Shape();
+  if (b_shape.NumDimensions() != 2 || b_shape.Size() == 0) {
+    return false;
+  }
+
+  const size_t K = trans_b ? static_cast<size_t>(b_shape[1]) : static_cast<size_t>(b_shape[0]);
+  const size_t N = trans_b ? static_cast<size_t>(b_shape[0]) : static_cast<size_t>(b_shape[1]);
+  const float* b_data = tensor_b.Data<float>();
+  auto element = [&](size_t n, size_t k) { return trans_b ? b_data[n * K + k] : b_data[k * N + n]; };
+
+  auto is_zero_block = [&](size_t n0, size_t k0, size_t rows, size_t columns) {
+    for (size_t n = n0; n < std::min(n0 + rows, N); n++) {
+      for (size_t k = k0; k < k0 + columns; k++) {
+        if (element(n, k) != 0.0f) {
+          return false;
+        }
+      }
+    }
+    return true;
+  };
+
+  auto count_blocks = [&](size_t rows, size_t columns) {
+    size_t count = 0;
+    for (size_t n = 0; n < N; n += rows) {
+      for (size_t k = 0; k < K; k += columns) {
+        count += is_zero_block(n, k, rows, columns) ? 0 : 1;
+      }
+    }
+    return count;
+  };
+
+  // Most weights are dense: non-zero elements are counted in memory order, and the scan stops as soon as there
+  // are too many of them, before any block shape is tried.
+  const size_t max_non_zero_count = static_cast<size_t>(kMaxSparseDensity * static_cast<double>(N * K));
+  size_t non_zero_count = 0;
+  for (size_t i = 0; i < N * K; i++) {
+    if (b_data[i] != 0.0f && ++non_zero_count > max_non_zero_count) {
+      return false;
+    }
+  }
+
+  size_t block_rows = 1;
+  size_t block_columns = 1;
+  size_t block_count = non_zero_count;
+
+  constexpr size_t block_shapes[][2] = {{4, 4}, {1, 4}};
+  for (const auto& block_shape : block_shapes) {
+    if (K % block_shape[1] != 0) {
+      continue;
+    }
+    const size_t count = count_blocks(block_shape[0], block_shape[1]);
+    if (2 * count * block_shape[0] * block_shape[1] <= 3 * non_zero_count) {
+      block_rows = block_shape[0];
+      block_columns = block_shape[1];
+      block_count = count;
+      break;
+    }
+  }
+
+  const size_t block_size = block_rows * block_columns;
+  if (static_cast<double>(block_count * block_size) > kMaxSparseDensity * static_cast<double>(N * K)) {
+    return false;
+  }
+
+  const size_t block_row_count = (N + block_rows - 1) / block_rows;
+  packed_b_size = sizeof(int64_t) * (2 + block_row_count + 1 + block_count) + sizeof(float) * block_count * block_size;
+  auto* packed_b_data = alloc->Alloc(packed_b_size);
+  packed_b = BufferUniquePtr(packed_b_data, BufferDeleter(alloc));
+
+  auto* header = static_cast<int64_t*>(packed_b_data);
+  header[0] = static_cast<int64_t>(block_rows);
+  header[1] = static_cast<int64_t>(block_columns);
+  int64_t* block_row_start = header + 2;
+  int64_t* block_column_index = block_row_start + block_row_count + 1;
+  float* block_values = reinterpret_cast<float*>(block_column_index + block_count);
+
+  size_t block_index = 0;
+  block_row_start[0] = 0;
+  for (size_t br = 0; br < block_row_count; br++) {
+    const size_t n0 = br * block_rows;
+    for (size_t k0 = 0; k0 < K; k0 += block_columns) {
+      if (is_zero_block(n0, k0, block_rows, block_columns)) {
+        continue;
+      }
+      block_column_index[block_index] = static_cast<int64_t>(k0);
+      float* values = block_values + block_index * block_size;
+      for (size_t r = 0; r < block_rows; r++) {
+        for (size_t c = 0; c < block_columns; c++) {
+          *values++ = (n0 + r < N) ? element(n0 + r, k0 + c) : 0.0f;
+        }
+      }
+      block_index++;
+    }
+    block_row_start[br + 1] = static_cast<int64_t>(block_index);
+  }
+
+  return true;
+}
+
+}  // namespace
+
 Status MatMul<float>::PrePack(const Tensor& tensor, int input_idx, /*out*/ AllocatorPtr alloc,
                               /*out*/ bool& is_packed,
                               /*out*/ PrePackedWeights* prepacked_weights) {
@@ -134,7 +262,16 @@ Status MatMul<float>::PrePack(const Tensor& tensor, int input_idx, /*out*/ Alloc
   // only pack Matrix B
   if (input_idx == 1) {
     size_t packed_b_size;
-    is_packed = GemmPackBFp32(alloc, tensor, trans_b_attr_ != 0, packed_b_, packed_b_size, b_shape_);
+    // The sparse kernel computes the transposed output, which does not apply to transposed batches.
+    if (!trans_batch_a_ && !trans_batch_b_) {
+      is_sparse_b_ = MatMulPackBSparseFp32(alloc, tensor, trans_b_attr_ != 0, packed_b_, packed_b_size);
+    }
+    if (is_sparse_b_) {
+      is_packed = true;
+      b_shape_ = tensor.Shape();
+    } else {
+      is_packed = GemmPackBFp32(alloc, tensor, trans_b_attr_ != 0, packed_b_, packed_b_size, b_shape_);
+    }
     bool share_prepacked_weights = (prepacked_weights != nullptr);
     if (is_packed && share_prepacked_weights) {
       prepacked_weights->buffers_.push_back(std::move(packed_b_));
@@ -187,6 +324,36 @@ Status MatMul<float>::Compute(OpKernelContext* ctx) const {
   const size_t lda = helper.Lda(trans_a);
   const size_t ldb = helper.Ldb(trans_b);
 
+  if (is_sparse_b_) {
+    // Compute Y' = B' * A' with the packed sparse B'. A' and Y' are the same as A and Y when M is 1.
+    const MLAS_SPARSE_MATRIX sparse_b = GetPackedSparseMatrix(packed_b_.get(), N);
+    const bool transpose_a = !trans_a && M > 1;
+    const bool transpose_y = M > 1;
+    const size_t a_buffer_size = transpose_a ? M * K : 0;
+    const size_t y_buffer_size = transpose_y ? M * N : 0;
+
+    AllocatorPtr allocator;
+    ORT_RETURN_IF_ERROR(ctx->GetTempSpaceAllocator(&allocator));
+    auto buffer = IAllocator::MakeUniquePtr<float>(allocator, a_buffer_size + y_buffer_size);
+    float* a_transposed = buffer.get();
+    float* y_transposed = a_transposed + a_buffer_size;
+
+    for (size_t i = 0; i < max_len; i++) {
+      const float* a_i = a_data + helper.LeftOffsets()[i];
+      float* y_i = y_data + helper.OutputOffsets()[i];
+      if (transpose_a) {
+        MlasTranspose(a_i, a_transposed, M, K);
+        a_i = a_transposed;
+      }
+      MlasSparseGemm(N, M, sparse_b, alpha_attr_, a_i, M, transpose_y ? y_transposed : y_i, M, thread_pool);
+      if (transpose_y) {
+        MlasTranspose(y_transposed, y_i, N, M);
+      }
+    }
+
+    return Status::OK();
+  }
+
   std::vector<MLAS_SGEMM_DATA_PARAMS> data(max_len);
   for (size_t i = 0; i < max_len; i++) {
     data[i].BIsPacked = bool(packed_b_);
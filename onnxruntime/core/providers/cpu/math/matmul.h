@@ -41,6 +41,8 @@ class MatMul<float> final : public OpKernel {
  private:
   TensorShape b_shape_;
   BufferUniquePtr packed_b_;
+  // packed_b_ holds the transpose of B as a block sparse matrix instead of the MLAS packed format
+  bool is_sparse_b_ = false;
 
   // For FusedMatMul contrib ops
   float alpha_attr_;
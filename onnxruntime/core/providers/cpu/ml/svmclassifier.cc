@@ -63,6 +63,9 @@ SVMClassifier::SVMClassifier(const OpKernelInfo& info)
   if (vector_count_ > 0) {
     feature_count_ = support_vectors_.size() / vector_count_;  //length of each support vector
     mode_ = SVM_TYPE::SVM_SVC;
+    if (get_kernel_type() == KERNEL::RBF) {
+      support_vector_norms_ = squared_norms<float>(support_vectors_, vector_count_, feature_count_);
+    }
   } else {
     feature_count_ = coefficients_.size() / class_count_;  //liblinear mode
     mode_ = SVM_TYPE::SVM_LINEAR;
@@ -245,66 +248,75 @@ Status SVMClassifier::ComputeImpl(OpKernelContext& ctx,
     // combine the input data with the support vectors and apply the kernel type
     // output is {num_batches, vector_count_}
     batched_kernel_dot<float>(x_data, support_vectors_, num_batches, vector_count_, feature_count_, 0.f, kernels_span,
-                              threadpool);
-
-    for (int64_t n = 0; n < num_batches; n++) {
-      // reduce scores from kernels using coefficients, taking into account the varying number of support vectors
-      // per class.
-      // coefficients: [num_classes - 1, vector_count_]
-      //
-      // e.g. say you have 3 classes, with 3 x 3 coefficients
-      //
-      // AA AB AC
-      // BA BB BC
-      // CA CB CC
-      //
-      // you can remove the diagonal line of items comparing a class with itself leaving one less row.
-      //
-      // BA AB AC
-      // CA CB BC
-      //
-      // for each class there is a coefficient per support vector, and a class has one or more support vectors.
-      //
-      // Combine the scores for the two combinations for two classes with their coefficient.
-      // e.g. AB combines with BA.
-      // If A has 3 support vectors and B has 2, there's a 3x2 block for AB and a 2x3 block for BA to combine
-
-      auto cur_kernels = kernels_span.subspan(n * vector_count_, vector_count_);
-      auto cur_scores = classifier_scores.subspan(n * num_slots_per_iteration, num_classifiers);
-      auto cur_votes = votes_span.subspan(n * class_count_, class_count_);
-      auto scores_iter = cur_scores.begin();
-
-      int64_t classifier_idx = 0;
-      for (int64_t i = 0; i < class_count_ - 1; i++) {
-        int64_t start_index_i = starting_vector_[i];  // start of support vectors for class i
-        int64_t class_i_support_count = vectors_per_class_[i];
-        int64_t i_coeff_row_offset = vector_count_ * i;
-
-        for (int64_t j = i + 1; j < class_count_; j++) {
-          int64_t start_index_j = starting_vector_[j];  // start of support vectors for class j
-          int64_t class_j_support_count = vectors_per_class_[j];
-          int64_t j_coeff_row_offset = vector_count_ * (j - 1);
-
-          double sum = 0;
-
-          const float* val1 = &(coefficients_[j_coeff_row_offset + start_index_i]);
-          const float* val2 = &(cur_kernels[start_index_i]);
-          for (int64_t m = 0; m < class_i_support_count; ++m, ++val1, ++val2)
-            sum += *val1 * *val2;
-
-          val1 = &(coefficients_[i_coeff_row_offset + start_index_j]);
-          val2 = &(cur_kernels[start_index_j]);
-
-          for (int64_t m = 0; m < class_j_support_count; ++m, ++val1, ++val2)
-            sum += *val1 * *val2;
-
-          sum += rho_[classifier_idx++];
-
-          *scores_iter++ = static_cast<float>(sum);
-          ++(cur_votes[sum > 0 ? i : j]);
-        }
-      }
-    }
+                              threadpool, support_vector_norms_.empty() ? nullptr : support_vector_norms_.data());
+
+    // every batch only writes its own scores and votes, so the reduction is parallelized over the batches
+    concurrency::ThreadPool::TryParallelFor(
+        threadpool, num_batches,
+        TensorOpCost{static_cast<double>(vector_count_ * (class_count_ - 1)) * 2 * sizeof(float),
+                     static_cast<double>(num_classifiers) * sizeof(float),
+                     static_cast<double>(vector_count_ * (class_count_ - 1)) * 2},
+        [this, &kernels_span, &classifier_scores, &votes_span, num_slots_per_iteration,
+         num_classifiers](ptrdiff_t first, ptrdiff_t last) {
+          for (ptrdiff_t n = first; n < last; n++) {
+            // reduce scores from kernels using coefficients, taking into account the varying number of support vectors
+            // per class.
+            // coefficients: [num_classes - 1, vector_count_]
+            //
+            // e.g. say you have 3 classes, with 3 x 3 coefficients
+            //
+            // AA AB AC
+            // BA BB BC
+            // CA CB CC
+            //
+            // you can remove the diagonal line of items comparing a class with itself leaving one less row.
+            //
+            // BA AB AC
+            // CA CB BC
+            //
+            // for each class there is a coefficient per support vector, and a class has one or more support vectors.
+            //
+            // Combine the scores for the two combinations for two classes with their coefficient.
+            // e.g. AB combines with BA.
+            // If A has 3 support vectors and B has 2, there's a 3x2 block for AB and a 2x3 block for BA to combine
+
+            auto cur_kernels = kernels_span.subspan(n * vector_count_, vector_count_);
+            auto cur_scores = classifier_scores.subspan(n * num_slots_per_iteration, num_classifiers);
+            auto cur_votes = votes_span.subspan(n * class_count_, class_count_);
+            auto scores_iter = cur_scores.begin();
+
+            int64_t classifier_idx = 0;
+            for (int64_t i = 0; i < class_count_ - 1; i++) {
+              int64_t start_index_i = starting_vector_[i];  // start of support vectors for class i
+              int64_t class_i_support_count = vectors_per_class_[i];
+              int64_t i_coeff_row_offset = vector_count_ * i;
+
+              for (int64_t j = i + 1; j < class_count_; j++) {
+                int64_t start_index_j = starting_vector_[j];  // start of support vectors for class j
+                int64_t class_j_support_count = vectors_per_class_[j];
+                int64_t j_coeff_row_offset = vector_count_ * (j - 1);
+
+                double sum = 0;
+
+                const float* val1 = &(coefficients_[j_coeff_row_offset + start_index_i]);
+                const float* val2 = &(cur_kernels[start_index_i]);
+                for (int64_t m = 0; m < class_i_support_count; ++m, ++val1, ++val2)
+                  sum += *val1 * *val2;
+
+                val1 = &(coefficients_[i_coeff_row_offset + start_index_j]);
+                val2 = &(cur_kernels[start_index_j]);
+
+                for (int64_t m = 0; m < class_j_support_count; ++m, ++val1, ++val2)
+                  sum += *val1 * *val2;
+
+                sum += rho_[classifier_idx++];
+
+                *scores_iter++ = static_cast<float>(sum);
+                ++(cur_votes[sum > 0 ? i : j]);
+              }
+            }
+          }
+        });
   }
 
   auto finalize_batch = [this, &final_scores, final_scores_per_batch,
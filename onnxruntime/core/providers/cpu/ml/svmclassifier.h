@@ -5,6 +5,7 @@
 
 #include "core/common/common.h"
 #include "core/framework/op_kernel.h"
+#include "core/platform/threadpool.h"
 #include "core/util/math_cpuonly.h"
 #include "ml_common.h"
 #include "core/providers/cpu/math/gemm.h"
@@ -30,37 +31,78 @@ class SVMCommon {
   void set_kernel_type(KERNEL new_kernel_type) { kernel_type_ = new_kernel_type; }
   KERNEL get_kernel_type() const { return kernel_type_; }
 
+  // squared L2 norm of each of the n vectors of k elements, given to batched_kernel_dot for the RBF kernel.
+  // The norms are accumulated in double as |a|^2 + |b|^2 - 2 a.b cancels most of their bits for close vectors.
+  template <typename T>
+  static std::vector<double> squared_norms(const gsl::span<const T> vectors, int64_t n, int64_t k) {
+    assert(vectors.size() == size_t(n * k));
+    std::vector<double> norms(n);
+    const T* cur = vectors.data();
+    for (int64_t i = 0; i < n; ++i, cur += k) {
+      norms[i] = squared_distance<T>(cur, nullptr, k);
+    }
+    return norms;
+  }
+
+  // |a - b|^2 accumulated in double, or |a|^2 if b is nullptr
+  template <typename T>
+  static double squared_distance(const T* a, const T* b, int64_t k) {
+    double sum = 0.;
+    for (int64_t i = 0; i < k; ++i) {
+      const double val = b == nullptr ? static_cast<double>(a[i]) : static_cast<double>(a[i]) - b[i];
+      sum += val * val;
+    }
+    return sum;
+  }
+
   template <typename T>
   void batched_kernel_dot(const gsl::span<const T> a, const gsl::span<const T> b,
                           int64_t m, int64_t n, int64_t k,
                           float scalar_C,
                           const gsl::span<T> out,
-                          concurrency::ThreadPool* threadpool) const {
+                          concurrency::ThreadPool* threadpool,
+                          const double* b_squared_norms = nullptr) const {
     assert(a.size() == size_t(m * k) && b.size() == size_t(k * n) && out.size() == size_t(m * n));
 
     if (kernel_type_ == KERNEL::RBF) {
-      T* cur_out = out.data();
-      const T* cur_batch = a.data();
-
-      // each batch has 'k' features
-      for (int64_t batch = 0; batch < m; ++batch) {
-        const T* cur_support_vector = b.data();
-
-        // broadcast the support vectors against the k features in each batch. output is one value per support vector
-        for (int64_t support_vector = 0; support_vector < n; ++support_vector) {
-          T sum = 0.f;
-          const T* cur_input = cur_batch;
-
-          for (int64_t feature = 0; feature < k; ++feature) {
-            T val = *cur_input++ - *cur_support_vector++;
-            sum += val * val;
-          }
+      // |a - b|^2 = |a|^2 + |b|^2 - 2 a.b, the dot products of the whole batch with every support vector
+      // come from one GEMM, the norms are added afterwards
+      std::vector<double> b_norms;
+      if (b_squared_norms == nullptr) {
+        b_norms = squared_norms<T>(b, n, k);
+        b_squared_norms = b_norms.data();
+      }
 
-          *cur_out++ = std::exp(-gamma_ * sum);
-        }
+      onnxruntime::Gemm<T>::ComputeGemm(CBLAS_TRANSPOSE::CblasNoTrans, CBLAS_TRANSPOSE::CblasTrans,
+                                        m, n, k,
+                                        -2.f, a.data(), b.data(), 0.f,
+                                        nullptr, nullptr,
+                                        out.data(),
+                                        threadpool);
 
-        cur_batch += k;  // move to start of next batch
-      }
+      // The rounding error of the GEMM is relative to |a|^2 + |b|^2, not to the distance. When the norms are more
+      // than kMaxRbfCancellation times the distance, too few bits are left and the distance is recomputed from
+      // the differences of the features.
+      concurrency::ThreadPool::TryParallelFor(
+          threadpool, m, TensorOpCost{static_cast<double>(k + n) * sizeof(T), static_cast<double>(n) * sizeof(T),
+                                      static_cast<double>(k + n * 4)},
+          [this, &a, &b, &out, n, k, b_squared_norms](ptrdiff_t first, ptrdiff_t last) {
+            constexpr double kMaxRbfCancellation = 16.;
+            for (ptrdiff_t batch = first; batch < last; ++batch) {
+              const T* cur_a = a.data() + batch * k;
+              const double a_norm = squared_distance<T>(cur_a, nullptr, k);
+              T* cur_out = out.data() + batch * n;
+              for (int64_t support_vector = 0; support_vector < n; ++support_vector) {
+                const double norms = a_norm + b_squared_norms[support_vector];
+                double distance = static_cast<double>(cur_out[support_vector]) + norms;
+                if (distance * kMaxRbfCancellation < norms) {
+                  distance = squared_distance<T>(cur_a, b.data() + support_vector * k, k);
+                }
+                cur_out[support_vector] = static_cast<T>(-gamma_ * distance);
+              }
+              MlasComputeExp(cur_out, cur_out, static_cast<size_t>(n));
+            }
+          });
     } else {
       float alpha = 1.f;
       float beta = 1.f;
@@ -106,6 +148,7 @@ class SVMClassifier final : public OpKernel, private SVMCommon {
   using SVMCommon::batched_kernel_dot;
   using SVMCommon::set_kernel_type;
   using SVMCommon::get_kernel_type;
+  using SVMCommon::squared_norms;
 
  public:
   SVMClassifier(const OpKernelInfo& info);
@@ -126,6 +169,7 @@ class SVMClassifier final : public OpKernel, private SVMCommon {
   std::vector<float> probb_;
   std::vector<float> coefficients_;
   std::vector<float> support_vectors_;
+  std::vector<double> support_vector_norms_;  // squared norms of the support vectors for the RBF kernel
   std::vector<int64_t> classlabels_ints_;
   std::vector<std::string> classlabels_strings_;
   POST_EVAL_TRANSFORM post_transform_;
@@ -83,6 +83,30 @@ struct TreeNodeElement {
   bool is_missing_track_true;
 };
 
+enum TreeNodeFlags {
+  kIsNotLeaf = 1,
+  kMissingTrackTrue = 2
+};
+
+// Node used to evaluate the trees. TreeNodeElement only exists while an ensemble is loaded.
+// The nodes of all the trees are stored in one contiguous array, each tree in breadth-first order:
+// the two children of a branch are next to each other and the top levels of a tree share cache lines.
+// A branch keeps the 32-bit offset of its true child, its false child follows it.
+// A leaf keeps the offset and the number of its weights in the weights table of the ensemble,
+// and its first weight in value so that single target ensembles never read the weights table.
+template <typename T>
+struct TreeNodeElementCompact {
+  T value;
+  int32_t feature_id;  // number of weights for a leaf
+  uint32_t truenode;   // offset of the first weight for a leaf
+  NODE_MODE mode;
+  uint8_t flags;
+
+  bool is_not_leaf() const { return (flags & kIsNotLeaf) != 0; }
+  bool is_missing_track_true() const { return (flags & kMissingTrackTrue) != 0; }
+  size_t n_weights() const { return static_cast<size_t>(feature_id); }
+};
+
 template <typename InputType, typename ThresholdType, typename OutputType>
 class TreeAggregator {
  protected:
@@ -107,7 +131,7 @@ class TreeAggregator {
   // 1 output
 
   void ProcessTreeNodePrediction1(ScoreValue<ThresholdType>& /*prediction*/,
-                                  const TreeNodeElement<ThresholdType>& /*root*/) const {}
+                                  const TreeNodeElementCompact<ThresholdType>& /*root*/) const {}
 
   void MergePrediction1(ScoreValue<ThresholdType>& /*prediction*/, ScoreValue<ThresholdType>& /*prediction2*/) const {}
 
@@ -120,8 +144,9 @@ class TreeAggregator {
 
   // N outputs
 
-  void ProcessTreeNodePrediction(InlinedVector<ScoreValue<ThresholdType>>& /*predictions*/, 
-                                 const TreeNodeElement<ThresholdType>& /*root*/) const {}
+  void ProcessTreeNodePrediction(InlinedVector<ScoreValue<ThresholdType>>& /*predictions*/,
+                                 const TreeNodeElementCompact<ThresholdType>& /*root*/,
+                                 const std::vector<SparseValue<ThresholdType>>& /*weights*/) const {}
 
   void MergePrediction(InlinedVector<ScoreValue<ThresholdType>>& /*predictions*/,
                        const InlinedVector<ScoreValue<ThresholdType>>& /*predictions2*/) const {}
@@ -157,8 +182,8 @@ class TreeAggregatorSum : public TreeAggregator<InputType, ThresholdType, Output
   // 1 output
 
   void ProcessTreeNodePrediction1(ScoreValue<ThresholdType>& prediction,
-                                  const TreeNodeElement<ThresholdType>& root) const {
-    prediction.score += root.weights[0].value;
+                                  const TreeNodeElementCompact<ThresholdType>& root) const {
+    prediction.score += root.value;
   }
 
   void MergePrediction1(ScoreValue<ThresholdType>& prediction, 
@@ -175,9 +200,11 @@ class TreeAggregatorSum : public TreeAggregator<InputType, ThresholdType, Output
 
   // N outputs
 
-  void ProcessTreeNodePrediction(InlinedVector<ScoreValue<ThresholdType>>& predictions, 
-                                 const TreeNodeElement<ThresholdType>& root) const {
-    for (auto it = root.weights.cbegin(); it != root.weights.cend(); ++it) {
+  void ProcessTreeNodePrediction(InlinedVector<ScoreValue<ThresholdType>>& predictions,
+                                 const TreeNodeElementCompact<ThresholdType>& root,
+                                 const std::vector<SparseValue<ThresholdType>>& weights) const {
+    auto it = weights.cbegin() + root.truenode;
+    for (auto end = it + root.n_weights(); it != end; ++it) {
       ORT_ENFORCE(it->i < (int64_t)predictions.size());
       predictions[it->i].score += it->value;
       predictions[it->i].has_score = 1;
@@ -259,9 +286,9 @@ class TreeAggregatorMin : public TreeAggregator<InputType, ThresholdType, Output
   // 1 output
 
   void ProcessTreeNodePrediction1(ScoreValue<ThresholdType>& prediction, 
-                                  const TreeNodeElement<ThresholdType>& root) const {
-    prediction.score = (!(prediction.has_score) || root.weights[0].value < prediction.score)
-                           ? root.weights[0].value
+                                  const TreeNodeElementCompact<ThresholdType>& root) const {
+    prediction.score = (!(prediction.has_score) || root.value < prediction.score)
+                           ? root.value
                            : prediction.score;
     prediction.has_score = 1;
   }
@@ -279,8 +306,10 @@ class TreeAggregatorMin : public TreeAggregator<InputType, ThresholdType, Output
   // N outputs
 
   void ProcessTreeNodePrediction(InlinedVector<ScoreValue<ThresholdType>>& predictions,
-                                 const TreeNodeElement<ThresholdType>& root) const {
-    for (auto it = root.weights.begin(); it != root.weights.end(); ++it) {
+                                 const TreeNodeElementCompact<ThresholdType>& root,
+                                 const std::vector<SparseValue<ThresholdType>>& weights) const {
+    auto it = weights.cbegin() + root.truenode;
+    for (auto end = it + root.n_weights(); it != end; ++it) {
       predictions[it->i].score = (!predictions[it->i].has_score || it->value < predictions[it->i].score)
                                      ? it->value
                                      : predictions[it->i].score;
@@ -315,9 +344,9 @@ class TreeAggregatorMax : public TreeAggregator<InputType, ThresholdType, Output
   // 1 output
 
   void ProcessTreeNodePrediction1(ScoreValue<ThresholdType>& prediction,
-                                  const TreeNodeElement<ThresholdType>& root) const {
-    prediction.score = (!(prediction.has_score) || root.weights[0].value > prediction.score)
-                           ? root.weights[0].value
+                                  const TreeNodeElementCompact<ThresholdType>& root) const {
+    prediction.score = (!(prediction.has_score) || root.value > prediction.score)
+                           ? root.value
                            : prediction.score;
     prediction.has_score = 1;
   }
@@ -334,8 +363,10 @@ class TreeAggregatorMax : public TreeAggregator<InputType, ThresholdType, Output
   // N outputs
 
   void ProcessTreeNodePrediction(InlinedVector<ScoreValue<ThresholdType>>& predictions,
-                                 const TreeNodeElement<ThresholdType>& root) const {
-    for (auto it = root.weights.begin(); it != root.weights.end(); ++it) {
+                                 const TreeNodeElementCompact<ThresholdType>& root,
+                                 const std::vector<SparseValue<ThresholdType>>& weights) const {
+    auto it = weights.cbegin() + root.truenode;
+    for (auto end = it + root.n_weights(); it != end; ++it) {
       predictions[it->i].score = (!predictions[it->i].has_score || it->value > predictions[it->i].score)
                                      ? it->value
                                      : predictions[it->i].score;
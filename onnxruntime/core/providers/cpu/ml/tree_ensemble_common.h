@@ -7,11 +7,100 @@
 #include "core/platform/ort_mutex.h"
 #include "core/platform/threadpool.h"
 #include "tree_ensemble_helper.h"
+#include <algorithm>
+#include <limits>
+#include <utility>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 namespace onnxruntime {
 namespace ml {
 namespace detail {
 
+// Number of rows walked together through a tree when a batch has several rows.
+constexpr int64_t kTreeRowBlock = 8;
+// Trees with a depth up to kQuickScorerMaxDepth have at most 64 leaves and are evaluated with
+// a QuickScorer bitvector when at least kQuickScorerMinRows rows are walked together.
+// QuickScorer compares the rows with every branch of a tree, one scalar compare at a time, where a walk
+// compares them with one branch per level: only trees with at most kQuickScorerMaxBranchesPerLevel
+// branches per level use it, a complete tree of depth 5 or 6 is walked faster.
+constexpr int64_t kQuickScorerMaxDepth = 6;
+constexpr int64_t kQuickScorerMaxBranchesPerLevel = 4;
+constexpr int64_t kQuickScorerMinRows = 4;
+// Trees with a depth up to kCompiledMaxDepth are compiled into perfect trees when the ensemble only uses
+// BRANCH_LEQ or BRANCH_LT and the leaves repeated to fill the last level at most multiply the nodes of
+// the tree by kCompiledMaxPadding.
+constexpr int64_t kCompiledMaxDepth = 10;
+constexpr int64_t kCompiledMaxPadding = 4;
+
+inline bool _isnan_(float x) { return std::isnan(x); }
+inline bool _isnan_(double x) { return std::isnan(x); }
+inline bool _isnan_(int64_t) { return false; }
+inline bool _isnan_(int32_t) { return false; }
+
+// Branch of a compiled tree. The branches of a perfect tree of depth D are stored in heap order,
+// the children of branch k are 2k+1 (true) and 2k+2 (false), the children of the last level are the leaves.
+template <typename T>
+struct TreeNodeElementCompiled {
+  T value;
+  int32_t feature_id;
+  int32_t is_missing_track_true;
+};
+
+// Evaluates a compiled tree: Depth branch-free steps, returns the index of the leaf.
+template <typename InputType, typename ThresholdType, bool LessThan, bool HasMissingTracks, size_t Depth>
+size_t _compiled_leaf_(const TreeNodeElementCompiled<ThresholdType>* nodes, const InputType* x_data) {
+  size_t k = 0;
+  for (size_t d = 0; d < Depth; ++d) {
+    const TreeNodeElementCompiled<ThresholdType>& node = nodes[k];
+    const InputType val = x_data[node.feature_id];
+    bool is_true = LessThan ? val < node.value : val <= node.value;
+    if (HasMissingTracks)
+      is_true = is_true | ((node.is_missing_track_true != 0) & _isnan_(val));
+    k = 2 * k + 2 - static_cast<size_t>(is_true);
+  }
+  return k - ((size_t(1) << Depth) - 1);
+}
+
+template <typename InputType, typename ThresholdType>
+using CompiledTreeFunction = size_t (*)(const TreeNodeElementCompiled<ThresholdType>*, const InputType*);
+
+template <typename InputType, typename ThresholdType, bool LessThan, bool HasMissingTracks, size_t... Depth>
+CompiledTreeFunction<InputType, ThresholdType> _compiled_tree_function_(size_t depth, std::index_sequence<Depth...>) {
+  static const CompiledTreeFunction<InputType, ThresholdType> functions[] = {
+      &_compiled_leaf_<InputType, ThresholdType, LessThan, HasMissingTracks, Depth>...};
+  return functions[depth];
+}
+
+// Node of an interpreted tree traversed on quantized rows, at the same offset as in nodes_.
+// Every feature of a row is quantized into the number of thresholds of the feature it is beyond,
+// a branch compares that bin to the index of its threshold in the sorted thresholds of its feature.
+struct TreeNodeElementQuantized {
+  uint32_t truenode;    // unused for a leaf
+  uint16_t feature_id;  // kQuantizedLeaf for a leaf
+  uint16_t threshold;   // kQuantizedMissingTrackTrue is set if missing values go to the true child
+};
+
+constexpr uint16_t kQuantizedLeaf = 0xFFFF;
+constexpr uint16_t kQuantizedMissingTrackTrue = 0x8000;
+constexpr uint16_t kQuantizedThresholdMask = 0x7FFF;
+constexpr uint16_t kQuantizedMissing = 0xFFFF;  // bin of a missing value
+constexpr size_t kQuantizedMaxThresholds = 0x7FFE;
+
+inline bool _is_true_(const TreeNodeElementQuantized& node, uint16_t bin) {
+  return bin <= (node.threshold & kQuantizedThresholdMask) ||
+         ((node.threshold & kQuantizedMissingTrackTrue) != 0 && bin == kQuantizedMissing);
+}
+
+template <typename InputType, typename ThresholdType>
+struct TreeCompiled {
+  CompiledTreeFunction<InputType, ThresholdType> leaf;  // nullptr if the tree is not compiled
+  uint32_t nodes;                                       // first branch in compiled_nodes_
+  uint32_t leaves;                                      // first leaf in compiled_leaves_
+};
+
+
 class TreeEnsembleCommonAttributes {
  public:
   int64_t get_target_or_class_count() const { return this->n_targets_or_classes_; }
@@ -40,8 +129,26 @@ template <typename InputType, typename ThresholdType, typename OutputType>
 class TreeEnsembleCommon : public TreeEnsembleCommonAttributes {
  protected:
   std::vector<ThresholdType> base_values_;
-  std::vector<TreeNodeElement<ThresholdType>> nodes_;
-  std::vector<TreeNodeElement<ThresholdType>*> roots_;
+  std::vector<TreeNodeElementCompact<ThresholdType>> nodes_;
+  std::vector<uint32_t> roots_;
+  std::vector<SparseValue<ThresholdType>> weights_;
+  // QuickScorer data: for every branch of a shallow tree, the bitvector of the leaves of its true subtree,
+  // the leaves of every shallow tree from left to right, and the first of them for every tree (-1 if deep).
+  std::vector<uint64_t> true_leaves_;
+  std::vector<uint32_t> shallow_leaves_;
+  std::vector<int64_t> shallow_leaves_start_;
+  // Compiled trees: their branches, the offsets of their leaves in nodes_, and for every tree its
+  // specialized evaluation function.
+  std::vector<TreeNodeElementCompiled<ThresholdType>> compiled_nodes_;
+  std::vector<uint32_t> compiled_leaves_;
+  std::vector<TreeCompiled<InputType, ThresholdType>> compiled_trees_;
+  // Quantized thresholds: the sorted thresholds of all the features one after the other, the first of them
+  // for every feature, and the quantized nodes of the interpreted trees. Empty if quantized_ is false.
+  bool quantized_ = false;
+  bool quantized_lt_ = false;
+  std::vector<ThresholdType> feature_thresholds_;
+  std::vector<uint32_t> feature_thresholds_start_;
+  std::vector<TreeNodeElementQuantized> quantized_nodes_;
 
  public:
   TreeEnsembleCommon() {}
@@ -74,8 +181,14 @@ class TreeEnsembleCommon : public TreeEnsembleCommonAttributes {
               const std::vector<ThresholdType>& target_class_weights_as_tensor);
 
  protected:
-  TreeNodeElement<ThresholdType>* ProcessTreeNodeLeave(TreeNodeElement<ThresholdType>* root,
-                                                       const InputType* x_data) const;
+  const TreeNodeElementCompact<ThresholdType>* ProcessTreeNodeLeave(size_t tree, const InputType* x_data,
+                                                                    const uint16_t* bins) const;
+  void ProcessTreeNodeLeaves(size_t tree, const InputType* x_data, const uint16_t* bins, int64_t stride,
+                             int64_t n_rows, const TreeNodeElementCompact<ThresholdType>** leaves) const;
+  void QuantizeRow(const InputType* x_data, uint16_t* bins) const;
+  const uint16_t* QuantizedRow(const uint16_t* bins, int64_t i) const {
+    return bins == nullptr ? nullptr : bins + i * (max_feature_id_ + 1);
+  }
 
   template <typename AGG>
   void ComputeAgg(concurrency::ThreadPool* ttp, const Tensor* X, Tensor* Y, Tensor* label, const AGG& agg) const;
@@ -194,13 +307,13 @@ Status TreeEnsembleCommon<InputType, ThresholdType, OutputType>::Init(int parall
   // filling nodes
 
   n_nodes_ = nodes_treeids.size();
-  nodes_.resize(n_nodes_);
-  roots_.clear();
+  std::vector<TreeNodeElement<ThresholdType>> nodes(n_nodes_);
+  std::vector<TreeNodeElement<ThresholdType>*> roots;
   std::unordered_map<TreeNodeElementId, TreeNodeElement<ThresholdType>*, TreeNodeElementId::hash_fn> idi;
   max_feature_id_ = 0;
 
   for (i = 0, limit = nodes_treeids.size(); i < limit; ++i) {
-    TreeNodeElement<ThresholdType>& node = nodes_[i];
+    TreeNodeElement<ThresholdType>& node = nodes[i];
     node.id.tree_id = static_cast<int>(nodes_treeids[i]);
     node.id.node_id = static_cast<int>(nodes_nodeids[i]);
     node.feature_id = static_cast<int>(nodes_featureids[i]);
@@ -234,10 +347,10 @@ Status TreeEnsembleCommon<InputType, ThresholdType, OutputType>::Init(int parall
   }
 
   TreeNodeElementId coor;
-  for (auto it = nodes_.begin(); it != nodes_.end(); ++it, ++i) {
+  for (auto it = nodes.begin(); it != nodes.end(); ++it, ++i) {
     if (!it->is_not_leaf)
       continue;
-    i = std::distance(nodes_.begin(), it);
+    i = std::distance(nodes.begin(), it);
     coor.tree_id = it->id.tree_id;
     coor.node_id = static_cast<int>(nodes_truenodeids[i]);
 
@@ -271,9 +384,9 @@ Status TreeEnsembleCommon<InputType, ThresholdType, OutputType>::Init(int parall
 
   int64_t previous = -1;
   for (i = 0; i < static_cast<size_t>(n_nodes_); ++i) {
-    if ((previous == -1) || (previous != nodes_[i].id.tree_id))
-      roots_.push_back(&(nodes_[i]));
-    previous = nodes_[i].id.tree_id;
+    if ((previous == -1) || (previous != nodes[i].id.tree_id))
+      roots.push_back(&(nodes[i]));
+    previous = nodes[i].id.tree_id;
   }
 
   TreeNodeElementId ind;
@@ -293,7 +406,7 @@ Status TreeEnsembleCommon<InputType, ThresholdType, OutputType>::Init(int parall
     idi[ind]->weights.push_back(w);
   }
 
-  n_trees_ = roots_.size();
+  n_trees_ = roots.size();
   has_missing_tracks_ = false;
   for (auto itm = nodes_missing_value_tracks_true.begin();
        itm != nodes_missing_value_tracks_true.end(); ++itm) {
@@ -302,6 +415,223 @@ Status TreeEnsembleCommon<InputType, ThresholdType, OutputType>::Init(int parall
       break;
     }
   }
+
+  // compact layout: every tree is copied in breadth-first order into one array,
+  // the leaf weights are moved into one table. A node reached twice is part of a cycle
+  // or shared by two branches, the false child of a branch must follow its true child
+  // so it cannot be shared.
+  nodes_.clear();
+  nodes_.reserve(nodes.size());
+  roots_.clear();
+  roots_.reserve(roots.size());
+  weights_.clear();
+  weights_.reserve(target_class_nodeids.size());
+  std::vector<std::pair<const TreeNodeElement<ThresholdType>*, int64_t>> queue;
+  std::vector<bool> visited(nodes.size(), false);
+  for (auto root : roots) {
+    const size_t first = nodes_.size();
+    roots_.push_back(static_cast<uint32_t>(first));
+    queue.clear();
+    queue.emplace_back(root, 0);
+    for (size_t q = 0; q < queue.size(); ++q) {
+      const TreeNodeElement<ThresholdType>& src = *queue[q].first;
+      const int64_t depth = queue[q].second;
+      const size_t index = static_cast<size_t>(queue[q].first - nodes.data());
+      if (visited[index]) {
+        ORT_THROW("Node ", src.id.node_id, " in tree ", src.id.tree_id,
+                  " is reached more than once, the tree has a cycle or a shared subtree.");
+      }
+      visited[index] = true;
+      TreeNodeElementCompact<ThresholdType> node;
+      node.mode = src.mode;
+      node.flags = src.is_missing_track_true ? kMissingTrackTrue : 0;
+      if (src.is_not_leaf) {
+        if (src.truenode == nullptr || src.falsenode == nullptr) {
+          ORT_THROW("Node ", src.id.node_id, " in tree ", src.id.tree_id, " is a branch without two children.");
+        }
+        if (depth >= max_tree_depth_) {
+          ORT_THROW("Tree ", src.id.tree_id, " is deeper than ", max_tree_depth_, " or has a cycle.");
+        }
+        node.value = src.value;
+        node.feature_id = src.feature_id;
+        node.truenode = static_cast<uint32_t>(first + queue.size());
+        node.flags |= kIsNotLeaf;
+        queue.emplace_back(src.truenode, depth + 1);
+        queue.emplace_back(src.falsenode, depth + 1);
+      } else {
+        node.value = src.weights.empty() ? 0 : src.weights[0].value;
+        node.feature_id = static_cast<int32_t>(src.weights.size());
+        node.truenode = static_cast<uint32_t>(weights_.size());
+        weights_.insert(weights_.end(), src.weights.begin(), src.weights.end());
+      }
+      nodes_.push_back(node);
+    }
+    ORT_ENFORCE(nodes_.size() <= std::numeric_limits<uint32_t>::max(),
+                "TreeEnsemble has too many nodes for 32-bit offsets.");
+  }
+
+  // QuickScorer bitvectors of the shallow trees, leaves are numbered from left to right
+  // (true subtree first)
+  true_leaves_.assign(nodes_.size(), 0);
+  shallow_leaves_.clear();
+  shallow_leaves_start_.assign(roots_.size(), -1);
+  std::vector<int64_t> depths;
+  std::vector<uint32_t> stack;
+
+  // compiled trees: every level of a perfect tree is filled from the breadth-first nodes,
+  // a leaf above the last level is repeated below padding branches
+  compiled_nodes_.clear();
+  compiled_leaves_.clear();
+  compiled_trees_.assign(roots_.size(), {nullptr, 0, 0});
+  NODE_MODE compiled_mode = NODE_MODE::LEAF;
+  for (auto it = nodes_.cbegin(); it != nodes_.cend(); ++it) {
+    if (it->is_not_leaf()) {
+      compiled_mode = it->mode;
+      break;
+    }
+  }
+  const bool compile = same_mode_ && (compiled_mode == NODE_MODE::BRANCH_LEQ || compiled_mode == NODE_MODE::BRANCH_LT);
+  std::vector<uint32_t> level, next_level;
+
+  for (size_t j = 0; j < roots_.size(); ++j) {
+    const size_t first = roots_[j];
+    const size_t end = j + 1 < roots_.size() ? roots_[j + 1] : nodes_.size();
+    depths.assign(end - first, 0);
+    int64_t depth = 0;
+    for (size_t k = first; k < end; ++k) {
+      if (nodes_[k].is_not_leaf()) {
+        depths[nodes_[k].truenode - first] = depths[nodes_[k].truenode + 1 - first] = depths[k - first] + 1;
+        depth = std::max(depth, depths[k - first] + 1);
+      }
+    }
+
+    if (compile && depth <= kCompiledMaxDepth &&
+        (int64_t(1) << (depth + 1)) - 1 <= kCompiledMaxPadding * static_cast<int64_t>(end - first)) {
+      TreeCompiled<InputType, ThresholdType>& compiled = compiled_trees_[j];
+      const auto depths_sequence = std::make_index_sequence<kCompiledMaxDepth + 1>();
+      if (compiled_mode == NODE_MODE::BRANCH_LT) {
+        compiled.leaf = has_missing_tracks_
+                            ? _compiled_tree_function_<InputType, ThresholdType, true, true>(depth, depths_sequence)
+                            : _compiled_tree_function_<InputType, ThresholdType, true, false>(depth, depths_sequence);
+      } else {
+        compiled.leaf = has_missing_tracks_
+                            ? _compiled_tree_function_<InputType, ThresholdType, false, true>(depth, depths_sequence)
+                            : _compiled_tree_function_<InputType, ThresholdType, false, false>(depth, depths_sequence);
+      }
+      compiled.nodes = static_cast<uint32_t>(compiled_nodes_.size());
+      compiled.leaves = static_cast<uint32_t>(compiled_leaves_.size());
+      compiled_nodes_.resize(compiled_nodes_.size() + (size_t(1) << depth) - 1);
+      level.assign(1, static_cast<uint32_t>(first));
+      for (int64_t d = 0; d < depth; ++d) {
+        TreeNodeElementCompiled<ThresholdType>* dst = compiled_nodes_.data() + compiled.nodes + level.size() - 1;
+        next_level.resize(2 * level.size());
+        for (size_t h = 0; h < level.size(); ++h) {
+          const TreeNodeElementCompact<ThresholdType>& src = nodes_[level[h]];
+          if (src.is_not_leaf()) {
+            dst[h].value = src.value;
+            dst[h].feature_id = src.feature_id;
+            dst[h].is_missing_track_true = src.is_missing_track_true() ? 1 : 0;
+            next_level[2 * h] = src.truenode;
+            next_level[2 * h + 1] = src.truenode + 1;
+          } else {
+            dst[h].value = 0;
+            dst[h].feature_id = 0;
+            dst[h].is_missing_track_true = 0;
+            next_level[2 * h] = next_level[2 * h + 1] = level[h];
+          }
+        }
+        level.swap(next_level);
+      }
+      compiled_leaves_.insert(compiled_leaves_.end(), level.begin(), level.end());
+      ORT_ENFORCE(compiled_nodes_.size() <= std::numeric_limits<uint32_t>::max() &&
+                      compiled_leaves_.size() <= std::numeric_limits<uint32_t>::max(),
+                  "TreeEnsemble has too many compiled nodes for 32-bit offsets.");
+    }
+
+    // a tree of n branches has 2n + 1 nodes
+    const int64_t branches = static_cast<int64_t>(end - first) / 2;
+    if (depth > kQuickScorerMaxDepth || branches > kQuickScorerMaxBranchesPerLevel * depth)
+      continue;
+
+    shallow_leaves_start_[j] = static_cast<int64_t>(shallow_leaves_.size());
+    stack.assign(1, static_cast<uint32_t>(first));
+    while (!stack.empty()) {
+      const uint32_t k = stack.back();
+      stack.pop_back();
+      if (nodes_[k].is_not_leaf()) {
+        stack.push_back(nodes_[k].truenode + 1);
+        stack.push_back(nodes_[k].truenode);
+      } else {
+        true_leaves_[k] = uint64_t(1) << (shallow_leaves_.size() - static_cast<size_t>(shallow_leaves_start_[j]));
+        shallow_leaves_.push_back(k);
+      }
+    }
+    // children follow their parent: a backward walk gathers the leaves of every subtree,
+    // a forward walk then replaces them by the leaves of the true child before the child is visited
+    for (size_t k = end; k-- > first;) {
+      if (nodes_[k].is_not_leaf()) {
+        true_leaves_[k] = true_leaves_[nodes_[k].truenode] | true_leaves_[nodes_[k].truenode + 1];
+      }
+    }
+    for (size_t k = first; k < end; ++k) {
+      if (nodes_[k].is_not_leaf()) {
+        true_leaves_[k] = true_leaves_[nodes_[k].truenode];
+      }
+    }
+  }
+
+  // quantized thresholds for the trees which are not compiled, the bin of a value
+  // gives the same comparisons as the value for every threshold of its feature
+  quantized_ = compile && max_feature_id_ < kQuantizedLeaf &&
+               std::any_of(compiled_trees_.cbegin(), compiled_trees_.cend(),
+                           [](const TreeCompiled<InputType, ThresholdType>& compiled) {
+                             return compiled.leaf == nullptr;
+                           });
+  quantized_lt_ = compiled_mode == NODE_MODE::BRANCH_LT;
+  feature_thresholds_.clear();
+  feature_thresholds_start_.clear();
+  quantized_nodes_.clear();
+  if (quantized_) {
+    std::vector<std::vector<ThresholdType>> thresholds(static_cast<size_t>(max_feature_id_ + 1));
+    for (auto it = nodes_.cbegin(); it != nodes_.cend() && quantized_; ++it) {
+      if (it->is_not_leaf()) {
+        quantized_ = !_isnan_(it->value);
+        thresholds[it->feature_id].push_back(it->value);
+      }
+    }
+    feature_thresholds_start_.reserve(thresholds.size() + 1);
+    for (auto it = thresholds.begin(); it != thresholds.end() && quantized_; ++it) {
+      std::sort(it->begin(), it->end());
+      it->erase(std::unique(it->begin(), it->end()), it->end());
+      quantized_ = it->size() <= kQuantizedMaxThresholds;
+      feature_thresholds_start_.push_back(static_cast<uint32_t>(feature_thresholds_.size()));
+      feature_thresholds_.insert(feature_thresholds_.end(), it->begin(), it->end());
+    }
+    feature_thresholds_start_.push_back(static_cast<uint32_t>(feature_thresholds_.size()));
+    if (quantized_) {
+      quantized_nodes_.resize(nodes_.size());
+      for (size_t k = 0; k < nodes_.size(); ++k) {
+        const TreeNodeElementCompact<ThresholdType>& src = nodes_[k];
+        TreeNodeElementQuantized& dst = quantized_nodes_[k];
+        if (src.is_not_leaf()) {
+          const std::vector<ThresholdType>& feature = thresholds[src.feature_id];
+          dst.truenode = src.truenode;
+          dst.feature_id = static_cast<uint16_t>(src.feature_id);
+          dst.threshold = static_cast<uint16_t>(std::lower_bound(feature.begin(), feature.end(), src.value) -
+                                                feature.begin());
+          if (src.is_missing_track_true())
+            dst.threshold |= kQuantizedMissingTrackTrue;
+        } else {
+          dst.truenode = 0;
+          dst.feature_id = kQuantizedLeaf;
+          dst.threshold = 0;
+        }
+      }
+    } else {
+      feature_thresholds_.clear();
+      feature_thresholds_start_.clear();
+    }
+  }
   return Status::OK();
 }
 
@@ -364,20 +694,35 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
   int64_t* label_data = label == nullptr ? nullptr : label->MutableData<int64_t>();
   auto max_num_threads = concurrency::ThreadPool::DegreeOfParallelism(ttp);
 
+  // every row is quantized once, the interpreted trees then compare bins
+  std::vector<uint16_t> bins;
+  if (quantized_) {
+    const int64_t n_features = max_feature_id_ + 1;
+    bins.resize(SafeInt<size_t>(N) * n_features);
+    concurrency::ThreadPool::TryParallelFor(
+        ttp, N, static_cast<double>(n_features * 8),
+        [this, x_data, stride, n_features, &bins](ptrdiff_t first, ptrdiff_t last) {
+          for (ptrdiff_t i = first; i < last; ++i) {
+            QuantizeRow(x_data + i * stride, bins.data() + i * n_features);
+          }
+        });
+  }
+  const uint16_t* q_data = bins.empty() ? nullptr : bins.data();
+
   if (n_targets_or_classes_ == 1) {
     if (N == 1) {
       ScoreValue<ThresholdType> score = {0, 0};
       if (n_trees_ <= parallel_tree_) { /* section A: 1 output, 1 row and not enough trees to parallelize */
         for (int64_t j = 0; j < n_trees_; ++j) {
-          agg.ProcessTreeNodePrediction1(score, *ProcessTreeNodeLeave(roots_[j], x_data));
+          agg.ProcessTreeNodePrediction1(score, *ProcessTreeNodeLeave(j, x_data, q_data));
         }
       } else { /* section B: 1 output, 1 row and enough trees to parallelize */
         std::vector<ScoreValue<ThresholdType>> scores(n_trees_, {0, 0});
         concurrency::ThreadPool::TryBatchParallelFor(
             ttp,
             SafeInt<int32_t>(n_trees_),
-            [this, &scores, &agg, x_data](ptrdiff_t j) {
-              agg.ProcessTreeNodePrediction1(scores[j], *ProcessTreeNodeLeave(roots_[j], x_data));
+            [this, &scores, &agg, x_data, q_data](ptrdiff_t j) {
+              agg.ProcessTreeNodePrediction1(scores[j], *ProcessTreeNodeLeave(j, x_data, q_data));
             },
             0);
 
@@ -387,17 +732,24 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
       }
       agg.FinalizeScores1(z_data, score, label_data);
     } else if (N <= parallel_N_) { /* section C: 1 output, 2+ rows but not enough rows to parallelize */
-      ScoreValue<ThresholdType> score;
+      ScoreValue<ThresholdType> scores[kTreeRowBlock];
+      const TreeNodeElementCompact<ThresholdType>* leaves[kTreeRowBlock];
       size_t j;
 
-      for (int64_t i = 0; i < N; ++i) {
-        score = {0, 0};
+      for (int64_t i = 0; i < N; i += kTreeRowBlock) {
+        const int64_t n_rows = std::min(kTreeRowBlock, N - i);
+        std::fill(scores, scores + n_rows, ScoreValue<ThresholdType>({0, 0}));
         for (j = 0; j < static_cast<size_t>(n_trees_); ++j) {
-          agg.ProcessTreeNodePrediction1(score, *ProcessTreeNodeLeave(roots_[j], x_data + i * stride));
+          ProcessTreeNodeLeaves(j, x_data + i * stride, QuantizedRow(q_data, i), stride, n_rows, leaves);
+          for (int64_t r = 0; r < n_rows; ++r) {
+            agg.ProcessTreeNodePrediction1(scores[r], *leaves[r]);
+          }
         }
 
-        agg.FinalizeScores1(z_data + i, score,
-                            label_data == nullptr ? nullptr : (label_data + i));
+        for (int64_t r = 0; r < n_rows; ++r) {
+          agg.FinalizeScores1(z_data + i + r, scores[r],
+                              label_data == nullptr ? nullptr : (label_data + i + r));
+        }
       }
     } else if (n_trees_ > max_num_threads) { /* section D: 1 output, 2+ rows and enough trees to parallelize */
       auto num_threads = std::min<int32_t>(max_num_threads, SafeInt<int32_t>(n_trees_));
@@ -405,15 +757,19 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
       concurrency::ThreadPool::TrySimpleParallelFor(
           ttp,
           num_threads,
-          [this, &agg, &scores, num_threads, x_data, N, stride](ptrdiff_t batch_num) {
+          [this, &agg, &scores, num_threads, x_data, q_data, N, stride](ptrdiff_t batch_num) {
             auto work = concurrency::ThreadPool::PartitionWork(batch_num, num_threads, this->n_trees_);
             for (int64_t i = 0; i < N; ++i) {
               scores[batch_num * N + i] = {0, 0};
             }
+            const TreeNodeElementCompact<ThresholdType>* leaves[kTreeRowBlock];
             for (auto j = work.start; j < work.end; ++j) {
-              for (int64_t i = 0; i < N; ++i) {
-                agg.ProcessTreeNodePrediction1(scores[batch_num * N + i],
-                                               *ProcessTreeNodeLeave(roots_[j], x_data + i * stride));
+              for (int64_t i = 0; i < N; i += kTreeRowBlock) {
+                const int64_t n_rows = std::min(kTreeRowBlock, N - i);
+                ProcessTreeNodeLeaves(j, x_data + i * stride, QuantizedRow(q_data, i), stride, n_rows, leaves);
+                for (int64_t r = 0; r < n_rows; ++r) {
+                  agg.ProcessTreeNodePrediction1(scores[batch_num * N + i + r], *leaves[r]);
+                }
               }
             }
           });
@@ -431,18 +787,27 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
                                   label_data == nullptr ? nullptr : (label_data + i));
             }
           });
-    } else { /* section E: 1 output, 2+ rows, parallelization by rows */
+    } else { /* section E: 1 output, 2+ rows, parallelization by blocks of rows */
       concurrency::ThreadPool::TryBatchParallelFor(
           ttp,
-          SafeInt<int32_t>(N),
-          [this, &agg, x_data, z_data, stride, label_data](ptrdiff_t i) {
-            ScoreValue<ThresholdType> score = {0, 0};
+          SafeInt<int32_t>((N + kTreeRowBlock - 1) / kTreeRowBlock),
+          [this, &agg, x_data, q_data, z_data, stride, label_data, N](ptrdiff_t block) {
+            const int64_t i = block * kTreeRowBlock;
+            const int64_t n_rows = std::min(kTreeRowBlock, N - i);
+            ScoreValue<ThresholdType> scores[kTreeRowBlock];
+            const TreeNodeElementCompact<ThresholdType>* leaves[kTreeRowBlock];
+            std::fill(scores, scores + n_rows, ScoreValue<ThresholdType>({0, 0}));
             for (size_t j = 0; j < static_cast<size_t>(n_trees_); ++j) {
-              agg.ProcessTreeNodePrediction1(score, *ProcessTreeNodeLeave(roots_[j], x_data + i * stride));
+              ProcessTreeNodeLeaves(j, x_data + i * stride, QuantizedRow(q_data, i), stride, n_rows, leaves);
+              for (int64_t r = 0; r < n_rows; ++r) {
+                agg.ProcessTreeNodePrediction1(scores[r], *leaves[r]);
+              }
             }
 
-            agg.FinalizeScores1(z_data + i, score,
-                                label_data == nullptr ? nullptr : (label_data + i));
+            for (int64_t r = 0; r < n_rows; ++r) {
+              agg.FinalizeScores1(z_data + i + r, scores[r],
+                                  label_data == nullptr ? nullptr : (label_data + i + r));
+            }
           },
           0);
     }
@@ -451,7 +816,7 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
       if (n_trees_ <= parallel_tree_) { /* section A2 */
         InlinedVector<ScoreValue<ThresholdType>> scores(n_targets_or_classes_, {0, 0});
         for (int64_t j = 0; j < n_trees_; ++j) {
-          agg.ProcessTreeNodePrediction(scores, *ProcessTreeNodeLeave(roots_[j], x_data));
+          agg.ProcessTreeNodePrediction(scores, *ProcessTreeNodeLeave(j, x_data, q_data), weights_);
         }
         agg.FinalizeScores(scores, z_data, -1, label_data);
       } else { /* section B2: 2+ outputs, 1 row, enough trees to parallelize */
@@ -460,11 +825,11 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
         concurrency::ThreadPool::TrySimpleParallelFor(
             ttp,
             num_threads,
-            [this, &agg, &scores, num_threads, x_data](ptrdiff_t batch_num) {
+            [this, &agg, &scores, num_threads, x_data, q_data](ptrdiff_t batch_num) {
               scores[batch_num].resize(n_targets_or_classes_, {0, 0});
               auto work = concurrency::ThreadPool::PartitionWork(batch_num, num_threads, n_trees_);
               for (auto j = work.start; j < work.end; ++j) {
-                agg.ProcessTreeNodePrediction(scores[batch_num], *ProcessTreeNodeLeave(roots_[j], x_data));
+                agg.ProcessTreeNodePrediction(scores[batch_num], *ProcessTreeNodeLeave(j, x_data, q_data), weights_);
               }
             });
         for (size_t i = 1, limit = scores.size(); i < limit; ++i) {
@@ -473,17 +838,26 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
         agg.FinalizeScores(scores[0], z_data, -1, label_data);
       }
     } else if (N <= parallel_N_) { /* section C2: 2+ outputs, 2+ rows, not enough rows to parallelize */
-      InlinedVector<ScoreValue<ThresholdType>> scores(n_targets_or_classes_);
+      std::vector<InlinedVector<ScoreValue<ThresholdType>>> scores(kTreeRowBlock);
+      const TreeNodeElementCompact<ThresholdType>* leaves[kTreeRowBlock];
       size_t j, limit;
 
-      for (int64_t i = 0; i < N; ++i) {
-        std::fill(scores.begin(), scores.end(), ScoreValue<ThresholdType>({0, 0}));
+      for (int64_t i = 0; i < N; i += kTreeRowBlock) {
+        const int64_t n_rows = std::min(kTreeRowBlock, N - i);
+        for (int64_t r = 0; r < n_rows; ++r) {
+          scores[r].assign(n_targets_or_classes_, {0, 0});
+        }
         for (j = 0, limit = roots_.size(); j < limit; ++j) {
-          agg.ProcessTreeNodePrediction(scores, *ProcessTreeNodeLeave(roots_[j], x_data + i * stride));
+          ProcessTreeNodeLeaves(j, x_data + i * stride, QuantizedRow(q_data, i), stride, n_rows, leaves);
+          for (int64_t r = 0; r < n_rows; ++r) {
+            agg.ProcessTreeNodePrediction(scores[r], *leaves[r], weights_);
+          }
         }
 
-        agg.FinalizeScores(scores, z_data + i * n_targets_or_classes_, -1,
-                           label_data == nullptr ? nullptr : (label_data + i));
+        for (int64_t r = 0; r < n_rows; ++r) {
+          agg.FinalizeScores(scores[r], z_data + (i + r) * n_targets_or_classes_, -1,
+                             label_data == nullptr ? nullptr : (label_data + i + r));
+        }
       }
     } else if (n_trees_ >= max_num_threads) { /* section: D2: 2+ outputs, 2+ rows, enough trees to parallelize*/
       auto num_threads = std::min<int32_t>(max_num_threads, SafeInt<int32_t>(n_trees_));
@@ -491,15 +865,19 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
       concurrency::ThreadPool::TrySimpleParallelFor(
           ttp,
           num_threads,
-          [this, &agg, &scores, num_threads, x_data, N, stride](ptrdiff_t batch_num) {
+          [this, &agg, &scores, num_threads, x_data, q_data, N, stride](ptrdiff_t batch_num) {
             auto work = concurrency::ThreadPool::PartitionWork(batch_num, num_threads, this->n_trees_);
             for (int64_t i = 0; i < N; ++i) {
               scores[batch_num * N + i].resize(n_targets_or_classes_, {0, 0});
             }
+            const TreeNodeElementCompact<ThresholdType>* leaves[kTreeRowBlock];
             for (auto j = work.start; j < work.end; ++j) {
-              for (int64_t i = 0; i < N; ++i) {
-                agg.ProcessTreeNodePrediction(scores[batch_num * N + i],
-                                              *ProcessTreeNodeLeave(roots_[j], x_data + i * stride));
+              for (int64_t i = 0; i < N; i += kTreeRowBlock) {
+                const int64_t n_rows = std::min(kTreeRowBlock, N - i);
+                ProcessTreeNodeLeaves(j, x_data + i * stride, QuantizedRow(q_data, i), stride, n_rows, leaves);
+                for (int64_t r = 0; r < n_rows; ++r) {
+                  agg.ProcessTreeNodePrediction(scores[batch_num * N + i + r], *leaves[r], weights_);
+                }
               }
             }
           });
@@ -522,69 +900,121 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
       concurrency::ThreadPool::TrySimpleParallelFor(
           ttp,
           num_threads,
-          [this, &agg, num_threads, x_data, z_data, label_data, N, stride](ptrdiff_t batch_num) {
+          [this, &agg, num_threads, x_data, q_data, z_data, label_data, N, stride](ptrdiff_t batch_num) {
             size_t j, limit;
-            InlinedVector<ScoreValue<ThresholdType>> scores(n_targets_or_classes_);
+            std::vector<InlinedVector<ScoreValue<ThresholdType>>> scores(kTreeRowBlock);
+            const TreeNodeElementCompact<ThresholdType>* leaves[kTreeRowBlock];
             auto work = concurrency::ThreadPool::PartitionWork(batch_num, num_threads, N);
 
-            for (auto i = work.start; i < work.end; ++i) {
-              std::fill(scores.begin(), scores.end(), ScoreValue<ThresholdType>({0, 0}));
+            for (auto i = work.start; i < work.end; i += kTreeRowBlock) {
+              const int64_t n_rows = std::min(kTreeRowBlock, static_cast<int64_t>(work.end - i));
+              for (int64_t r = 0; r < n_rows; ++r) {
+                scores[r].assign(n_targets_or_classes_, {0, 0});
+              }
               for (j = 0, limit = roots_.size(); j < limit; ++j) {
-                agg.ProcessTreeNodePrediction(scores, *ProcessTreeNodeLeave(roots_[j], x_data + i * stride));
+                ProcessTreeNodeLeaves(j, x_data + i * stride, QuantizedRow(q_data, i), stride, n_rows, leaves);
+                for (int64_t r = 0; r < n_rows; ++r) {
+                  agg.ProcessTreeNodePrediction(scores[r], *leaves[r], weights_);
+                }
               }
 
-              agg.FinalizeScores(scores,
-                                 z_data + i * n_targets_or_classes_, -1,
-                                 label_data == nullptr ? nullptr : (label_data + i));
+              for (int64_t r = 0; r < n_rows; ++r) {
+                agg.FinalizeScores(scores[r],
+                                   z_data + (i + r) * n_targets_or_classes_, -1,
+                                   label_data == nullptr ? nullptr : (label_data + i + r));
+              }
             }
           });
     }
   }
 }  // namespace detail
 
-#define TREE_FIND_VALUE(CMP)                                         \
-  if (has_missing_tracks_) {                                         \
-    while (root->is_not_leaf) {                                      \
-      val = x_data[root->feature_id];                                \
-      root = (val CMP root->value ||                                 \
-              (root->is_missing_track_true && _isnan_(val)))         \
-                 ? root->truenode                                    \
-                 : root->falsenode;                                  \
-    }                                                                \
-  } else {                                                           \
-    while (root->is_not_leaf) {                                      \
-      val = x_data[root->feature_id];                                \
-      root = val CMP root->value ? root->truenode : root->falsenode; \
-    }                                                                \
+#define TREE_FIND_VALUE(CMP)                                                   \
+  if (has_missing_tracks_) {                                                   \
+    while (root->is_not_leaf()) {                                              \
+      val = x_data[root->feature_id];                                          \
+      root = nodes + root->truenode +                                          \
+             ((val CMP root->value ||                                          \
+               (root->is_missing_track_true() && _isnan_(val)))                \
+                  ? 0                                                          \
+                  : 1);                                                        \
+    }                                                                          \
+  } else {                                                                     \
+    while (root->is_not_leaf()) {                                              \
+      val = x_data[root->feature_id];                                          \
+      root = nodes + root->truenode + (val CMP root->value ? 0 : 1);           \
+    }                                                                          \
   }
 
-inline bool _isnan_(float x) { return std::isnan(x); }
-inline bool _isnan_(double x) { return std::isnan(x); }
-inline bool _isnan_(int64_t) { return false; }
-inline bool _isnan_(int32_t) { return false; }
+inline size_t _lowest_bit_(uint64_t x) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+  unsigned long index;
+  _BitScanForward64(&index, x);
+  return static_cast<size_t>(index);
+#elif defined(__GNUC__) || defined(__clang__)
+  return static_cast<size_t>(__builtin_ctzll(x));
+#else
+  size_t index = 0;
+  for (; (x & 1) == 0; x >>= 1)
+    ++index;
+  return index;
+#endif
+}
+
+template <typename InputType, typename ThresholdType>
+inline bool _is_true_(const TreeNodeElementCompact<ThresholdType>& node, InputType val) {
+  bool is_true = false;
+  switch (node.mode) {
+    case NODE_MODE::BRANCH_LEQ:
+      is_true = val <= node.value;
+      break;
+    case NODE_MODE::BRANCH_LT:
+      is_true = val < node.value;
+      break;
+    case NODE_MODE::BRANCH_GTE:
+      is_true = val >= node.value;
+      break;
+    case NODE_MODE::BRANCH_GT:
+      is_true = val > node.value;
+      break;
+    case NODE_MODE::BRANCH_EQ:
+      is_true = val == node.value;
+      break;
+    case NODE_MODE::BRANCH_NEQ:
+      is_true = val != node.value;
+      break;
+    case NODE_MODE::LEAF:
+      break;
+  }
+  return is_true || (node.is_missing_track_true() && _isnan_(val));
+}
 
 template <typename InputType, typename ThresholdType, typename OutputType>
-TreeNodeElement<ThresholdType>*
+const TreeNodeElementCompact<ThresholdType>*
 TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ProcessTreeNodeLeave(
-    TreeNodeElement<ThresholdType>* root, const InputType* x_data) const {
+    size_t tree, const InputType* x_data, const uint16_t* bins) const {
+  const TreeNodeElementCompact<ThresholdType>* nodes = nodes_.data();
+  const TreeCompiled<InputType, ThresholdType>& compiled = compiled_trees_[tree];
+  if (compiled.leaf != nullptr) {
+    return nodes + compiled_leaves_[compiled.leaves + compiled.leaf(compiled_nodes_.data() + compiled.nodes, x_data)];
+  }
+
+  if (bins != nullptr) {
+    const TreeNodeElementQuantized* quantized_nodes = quantized_nodes_.data();
+    const TreeNodeElementQuantized* node = quantized_nodes + roots_[tree];
+    while (node->feature_id != kQuantizedLeaf) {
+      node = quantized_nodes + node->truenode + (_is_true_(*node, bins[node->feature_id]) ? 0 : 1);
+    }
+    return nodes + (node - quantized_nodes);
+  }
+
+  // The false child of a branch follows its true child.
+  const TreeNodeElementCompact<ThresholdType>* root = nodes + roots_[tree];
   InputType val;
   if (same_mode_) {
     switch (root->mode) {
       case NODE_MODE::BRANCH_LEQ:
-        if (has_missing_tracks_) {
-          while (root->is_not_leaf) {
-            val = x_data[root->feature_id];
-            root = (val <= root->value ||
-                    (root->is_missing_track_true && _isnan_(val)))
-                       ? root->truenode
-                       : root->falsenode;
-          }
-        } else {
-          while (root->is_not_leaf) {
-            val = x_data[root->feature_id];
-            root = val <= root->value ? root->truenode : root->falsenode;
-          }
-        }
+        TREE_FIND_VALUE(<=)
         break;
       case NODE_MODE::BRANCH_LT:
         TREE_FIND_VALUE(<)
@@ -606,48 +1036,147 @@ TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ProcessTreeNodeLeave(
     }
   } else {  // Different rules to compare to node thresholds.
     ThresholdType threshold;
-    while (root->is_not_leaf) {
+    bool is_true = false;
+    while (root->is_not_leaf()) {
       val = x_data[root->feature_id];
       threshold = root->value;
       switch (root->mode) {
         case NODE_MODE::BRANCH_LEQ:
-          root = val <= threshold || (root->is_missing_track_true && _isnan_(val))
-                     ? root->truenode
-                     : root->falsenode;
+          is_true = val <= threshold;
           break;
         case NODE_MODE::BRANCH_LT:
-          root = val < threshold || (root->is_missing_track_true && _isnan_(val))
-                     ? root->truenode
-                     : root->falsenode;
+          is_true = val < threshold;
           break;
         case NODE_MODE::BRANCH_GTE:
-          root = val >= threshold || (root->is_missing_track_true && _isnan_(val))
-                     ? root->truenode
-                     : root->falsenode;
+          is_true = val >= threshold;
           break;
         case NODE_MODE::BRANCH_GT:
-          root = val > threshold || (root->is_missing_track_true && _isnan_(val))
-                     ? root->truenode
-                     : root->falsenode;
+          is_true = val > threshold;
           break;
         case NODE_MODE::BRANCH_EQ:
-          root = val == threshold || (root->is_missing_track_true && _isnan_(val))
-                     ? root->truenode
-                     : root->falsenode;
+          is_true = val == threshold;
           break;
         case NODE_MODE::BRANCH_NEQ:
-          root = val != threshold || (root->is_missing_track_true && _isnan_(val))
-                     ? root->truenode
-                     : root->falsenode;
+          is_true = val != threshold;
           break;
         case NODE_MODE::LEAF:
           break;
       }
+      is_true = is_true || (root->is_missing_track_true() && _isnan_(val));
+      root = nodes + root->truenode + (is_true ? 0 : 1);
     }
   }
   return root;
 }
 
+// Walks n_rows <= kTreeRowBlock rows through a tree together. The rows of a compiled tree are evaluated
+// one after the other by its specialized function. The rows of a shallow tree are evaluated with
+// QuickScorer: every branch whose condition is false removes the leaves of its true subtree from the
+// bitvector of a row, the exit leaf is the first remaining one. The rows of a deep tree advance one level
+// at a time in lockstep so that their node fetches overlap.
+template <typename InputType, typename ThresholdType, typename OutputType>
+void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ProcessTreeNodeLeaves(
+    size_t tree, const InputType* x_data, const uint16_t* bins, int64_t stride, int64_t n_rows,
+    const TreeNodeElementCompact<ThresholdType>** leaves) const {
+  const TreeNodeElementCompact<ThresholdType>* nodes = nodes_.data();
+  if (n_rows == 1) {
+    leaves[0] = ProcessTreeNodeLeave(tree, x_data, bins);
+    return;
+  }
+
+  const TreeCompiled<InputType, ThresholdType>& compiled = compiled_trees_[tree];
+  if (compiled.leaf != nullptr) {
+    const TreeNodeElementCompiled<ThresholdType>* tree_nodes = compiled_nodes_.data() + compiled.nodes;
+    const uint32_t* tree_leaves = compiled_leaves_.data() + compiled.leaves;
+    for (int64_t r = 0; r < n_rows; ++r) {
+      leaves[r] = nodes + tree_leaves[compiled.leaf(tree_nodes, x_data + r * stride)];
+    }
+    return;
+  }
+
+  if (shallow_leaves_start_[tree] >= 0 && n_rows >= kQuickScorerMinRows) {
+    const size_t first = roots_[tree];
+    const size_t end = tree + 1 < roots_.size() ? roots_[tree + 1] : nodes_.size();
+    uint64_t remaining[kTreeRowBlock];
+    std::fill(remaining, remaining + n_rows, ~uint64_t(0));
+    for (size_t k = first; k < end; ++k) {
+      const TreeNodeElementCompact<ThresholdType>& node = nodes[k];
+      if (!node.is_not_leaf())
+        continue;
+      const uint64_t mask = ~true_leaves_[k];
+      const InputType* x = x_data + node.feature_id;
+      for (int64_t r = 0; r < n_rows; ++r) {
+        remaining[r] &= _is_true_(node, x[r * stride]) ? ~uint64_t(0) : mask;
+      }
+    }
+    const uint32_t* tree_leaves = shallow_leaves_.data() + shallow_leaves_start_[tree];
+    for (int64_t r = 0; r < n_rows; ++r) {
+      leaves[r] = nodes + tree_leaves[_lowest_bit_(remaining[r])];
+    }
+    return;
+  }
+
+  if (bins != nullptr) {
+    const int64_t n_features = max_feature_id_ + 1;
+    const TreeNodeElementQuantized* quantized_nodes = quantized_nodes_.data();
+    const TreeNodeElementQuantized* quantized_leaves[kTreeRowBlock];
+    for (int64_t r = 0; r < n_rows; ++r) {
+      quantized_leaves[r] = quantized_nodes + roots_[tree];
+    }
+    for (bool running = true; running;) {
+      running = false;
+      for (int64_t r = 0; r < n_rows; ++r) {
+        const TreeNodeElementQuantized* node = quantized_leaves[r];
+        if (node->feature_id != kQuantizedLeaf) {
+          quantized_leaves[r] = quantized_nodes + node->truenode +
+                                (_is_true_(*node, bins[r * n_features + node->feature_id]) ? 0 : 1);
+          running = true;
+        }
+      }
+    }
+    for (int64_t r = 0; r < n_rows; ++r) {
+      leaves[r] = nodes + (quantized_leaves[r] - quantized_nodes);
+    }
+    return;
+  }
+
+  for (int64_t r = 0; r < n_rows; ++r) {
+    leaves[r] = nodes + roots_[tree];
+  }
+  for (bool running = true; running;) {
+    running = false;
+    for (int64_t r = 0; r < n_rows; ++r) {
+      const TreeNodeElementCompact<ThresholdType>* node = leaves[r];
+      if (node->is_not_leaf()) {
+        leaves[r] = nodes + node->truenode + (_is_true_(*node, x_data[r * stride + node->feature_id]) ? 0 : 1);
+        running = true;
+      }
+    }
+  }
+}
+
+// The bin of a value is the number of thresholds of its feature it does not satisfy in the ascending
+// order: a branch is true if and only if the bin is not greater than the index of its threshold.
+template <typename InputType, typename ThresholdType, typename OutputType>
+void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::QuantizeRow(const InputType* x_data,
+                                                                           uint16_t* bins) const {
+  const ThresholdType* thresholds = feature_thresholds_.data();
+  for (int64_t f = 0; f <= max_feature_id_; ++f) {
+    const ThresholdType* begin = thresholds + feature_thresholds_start_[f];
+    const ThresholdType* end = thresholds + feature_thresholds_start_[f + 1];
+    const InputType val = x_data[f];
+    if (_isnan_(val)) {
+      bins[f] = kQuantizedMissing;
+    } else if (quantized_lt_) {  // val < threshold
+      bins[f] = static_cast<uint16_t>(
+          std::upper_bound(begin, end, val, [](InputType v, ThresholdType t) { return v < t; }) - begin);
+    } else {  // val <= threshold
+      bins[f] = static_cast<uint16_t>(
+          std::lower_bound(begin, end, val, [](ThresholdType t, InputType v) { return t < v; }) - begin);
+    }
+  }
+}
+
 // TI: input type
 // TH: threshold type, double if T==double, float otherwise
 // TO: output type
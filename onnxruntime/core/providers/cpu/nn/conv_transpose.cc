@@ -17,13 +17,243 @@
 
 #include "core/providers/cpu/nn/conv_transpose.h"
 
+#include <algorithm>
+
 #include "core/mlas/inc/mlas.h"
 #include "core/common/safeint.h"
 #include "core/util/math.h"
 #include "core/util/math_cpuonly.h"
+#include "core/platform/threadpool.h"
 
 namespace onnxruntime {
 
+namespace {
+
+// Scatters the column buffer for one group into the output image. Every output channel is written from its own
+// kernel_size rows of the column buffer, so the output channels are split across the thread pool.
+void ParallelCol2im(const float* col_buffer_data, const ConvTransposeAttributes::Prepare& p,
+                    const TensorShape& output_shape, int64_t num_output_channels, int64_t kernel_size,
+                    int64_t input_image_size, float* Ydata, concurrency::ThreadPool* thread_pool) {
+  const int64_t output_size = output_shape.Size();
+  const bool is_2d = p.X->Shape().NumDimensions() == 4;
+
+  concurrency::ThreadPool::TryParallelFor(
+      thread_pool, static_cast<std::ptrdiff_t>(num_output_channels),
+      static_cast<double>(kernel_size * input_image_size),
+      [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        const int64_t num_channels = static_cast<int64_t>(last - first);
+        const float* col_data = col_buffer_data + first * kernel_size * input_image_size;
+        float* Y_channel_data = Ydata + first * output_size;
+
+        if (is_2d) {
+          math::Col2im<float, CPUMathUtil, StorageOrder::NCHW>(
+              col_data,
+              num_channels,
+              output_shape[0],
+              output_shape[1],
+              p.kernel_shape[0],
+              p.kernel_shape[1],
+              p.dilations[0],
+              p.dilations[1],
+              p.pads[0],
+              p.pads[1],
+              p.pads[2],
+              p.pads[3],
+              p.strides[0],
+              p.strides[1],
+              Y_channel_data,
+              &CPUMathUtil::Instance());
+        } else {
+          math::Col2imNd<float, CPUMathUtil, StorageOrder::NCHW>(
+              col_data,
+              output_shape.GetDims().data(),
+              p.input_shape.GetDims().data(),
+              num_channels * kernel_size,
+              num_channels * output_size,
+              p.kernel_shape.data(),
+              p.strides.data(),
+              p.dilations.data(),
+              p.pads.data(),
+              static_cast<int>(p.kernel_shape.size()),
+              Y_channel_data,
+              &CPUMathUtil::Instance());
+        }
+      });
+}
+
+// A ConvTranspose with a 1x..x1 kernel, unit strides and no padding maps every input pixel to exactly one output
+// pixel, so the GEMM can write the output directly without going through a column buffer and col2im.
+bool IsPointwiseConvTranspose(const ConvTransposeAttributes::Prepare& p, int64_t kernel_size,
+                              int64_t input_image_size, int64_t output_size) {
+  if (kernel_size != 1 || input_image_size != output_size) {
+    return false;
+  }
+
+  return std::all_of(p.strides.cbegin(), p.strides.cend(), [](int64_t v) { return v == 1; }) &&
+         std::all_of(p.pads.cbegin(), p.pads.cend(), [](int64_t v) { return v == 0; });
+}
+
+// A 2D ConvTranspose with strides s_h x s_w splits into s_h x s_w output phases: the outputs (oh, ow) with
+// (oh + pad_top) % s_h == r_h and (ow + pad_left) % s_w == r_w only receive the kernel taps with kh % s_h == r_h and
+// kw % s_w == r_w. Every phase is a stride 1 convolution of the input with these taps in reverse order.
+struct SubpixelPhase {
+  int64_t taps;          // kernel taps of the phase
+  int64_t first_output;  // first output position of the phase
+  int64_t count;         // number of output positions of the phase
+  int64_t pads[2];       // padding of the phase convolution at the beginning and the end
+};
+
+// Returns false if a phase of the dimension has no kernel taps, has no outputs or would need a negative padding.
+bool GetSubpixelPhases(int64_t input_size, int64_t output_size, int64_t kernel, int64_t stride, int64_t pad,
+                       InlinedVector<SubpixelPhase>& phases) {
+  if (pad < 0 || kernel < stride) {
+    return false;
+  }
+
+  phases.resize(static_cast<size_t>(stride));
+  for (int64_t r = 0; r < stride; ++r) {
+    SubpixelPhase& phase = phases[static_cast<size_t>(r)];
+    const int64_t first_input = (pad - r + stride - 1) / stride;
+    phase.taps = (kernel - 1 - r) / stride + 1;
+    phase.first_output = first_input * stride + r - pad;
+    phase.count = phase.first_output < output_size ? (output_size - 1 - phase.first_output) / stride + 1 : 0;
+    phase.pads[0] = phase.taps - 1 - first_input;
+    phase.pads[1] = phase.count + first_input - input_size;
+    if (phase.count == 0 || phase.pads[0] < 0 || phase.pads[1] < 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// The sub-pixel decomposition applies to 2D ConvTranspose with a stride above 1 and no dilation.
+bool GetSubpixelConvTransposePhases(const ConvTransposeAttributes::Prepare& p,
+                                    InlinedVector<SubpixelPhase>& phases_h, InlinedVector<SubpixelPhase>& phases_w) {
+  if (p.X->Shape().NumDimensions() != 4 || (p.strides[0] == 1 && p.strides[1] == 1) ||
+      p.dilations[0] != 1 || p.dilations[1] != 1) {
+    return false;
+  }
+
+  return GetSubpixelPhases(p.input_shape[0], p.Y->Shape()[2], p.kernel_shape[0], p.strides[0], p.pads[0],
+                           phases_h) &&
+         GetSubpixelPhases(p.input_shape[1], p.Y->Shape()[3], p.kernel_shape[1], p.strides[1], p.pads[1],
+                           phases_w);
+}
+
+// Runs every output phase as an MLAS convolution of the whole batch into a phase buffer, and interleaves the phase
+// buffer into the output. The convolution adds the bias. The filter is either [C, M/group, kH, kW] or transposed
+// per group to [M/group * kH * kW, C/group] by PrePack.
+Status SubpixelConvTranspose(const ConvTransposeAttributes::Prepare& p, int64_t group, const float* filter_data,
+                             bool filter_transposed, const InlinedVector<SubpixelPhase>& phases_h,
+                             const InlinedVector<SubpixelPhase>& phases_w, AllocatorPtr alloc,
+                             concurrency::ThreadPool* thread_pool) {
+  const int64_t input_channels = p.num_input_channels / group;
+  const int64_t output_channels = p.num_output_channels / group;
+  const int64_t kernel_w = p.kernel_shape[1];
+  const int64_t kernel_size = p.kernel_shape[0] * kernel_w;
+  const int64_t filter_group_size = input_channels * output_channels * kernel_size;
+  const int64_t stride_h = p.strides[0];
+  const int64_t stride_w = p.strides[1];
+  const int64_t output_h = p.Y->Shape()[2];
+  const int64_t output_w = p.Y->Shape()[3];
+  const int64_t batch_channels = p.N * p.num_output_channels;
+
+  // Phase 0 has the most taps, but any phase may have the most outputs.
+  int64_t max_count_h = 0;
+  int64_t max_count_w = 0;
+  for (const auto& phase : phases_h) {
+    max_count_h = std::max(max_count_h, phase.count);
+  }
+  for (const auto& phase : phases_w) {
+    max_count_w = std::max(max_count_w, phase.count);
+  }
+  auto phase_filter = IAllocator::MakeUniquePtr<float>(
+      alloc, SafeInt<size_t>(p.num_output_channels) * input_channels * phases_h[0].taps * phases_w[0].taps);
+  auto phase_output = IAllocator::MakeUniquePtr<float>(alloc, SafeInt<size_t>(batch_channels) * max_count_h *
+                                                                  max_count_w);
+  IAllocatorUniquePtr<float> working_buffer;
+  size_t working_buffer_size = 0;
+
+  MLAS_ACTIVATION activation;
+  activation.ActivationKind = MlasIdentityActivation;
+  const float* Xdata = p.X->Data<float>();
+  const float* Bdata = p.B != nullptr ? p.B->Data<float>() : nullptr;
+  float* Ydata = p.Y->MutableData<float>();
+
+  for (int64_t r_h = 0; r_h < stride_h; ++r_h) {
+    const SubpixelPhase& phase_h = phases_h[static_cast<size_t>(r_h)];
+    for (int64_t r_w = 0; r_w < stride_w; ++r_w) {
+      const SubpixelPhase& phase_w = phases_w[static_cast<size_t>(r_w)];
+      const int64_t taps = phase_h.taps * phase_w.taps;
+
+      // Gather the taps of the phase in reverse order as a [M, C/group, taps_h, taps_w] convolution filter.
+      float* phase_filter_data = phase_filter.get();
+      concurrency::ThreadPool::TryParallelFor(
+          thread_pool, static_cast<std::ptrdiff_t>(p.num_output_channels),
+          static_cast<double>(input_channels * taps),
+          [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+            for (std::ptrdiff_t m = first; m < last; ++m) {
+              const int64_t group_id = m / output_channels;
+              const int64_t oc = m % output_channels;
+              const float* filter_group = filter_data + group_id * filter_group_size;
+              float* dst = phase_filter_data + m * input_channels * taps;
+              for (int64_t ic = 0; ic < input_channels; ++ic) {
+                for (int64_t a = 0; a < phase_h.taps; ++a) {
+                  const int64_t kh = r_h + (phase_h.taps - 1 - a) * stride_h;
+                  for (int64_t b = 0; b < phase_w.taps; ++b) {
+                    const int64_t k = kh * kernel_w + r_w + (phase_w.taps - 1 - b) * stride_w;
+                    *dst++ = filter_transposed ? filter_group[(oc * kernel_size + k) * input_channels + ic]
+                                               : filter_group[(ic * output_channels + oc) * kernel_size + k];
+                  }
+                }
+              }
+            }
+          });
+
+      const int64_t kernel_shape[2]{phase_h.taps, phase_w.taps};
+      const int64_t dilations[2]{1, 1};
+      const int64_t pads[4]{phase_h.pads[0], phase_w.pads[0], phase_h.pads[1], phase_w.pads[1]};
+      const int64_t strides[2]{1, 1};
+      const int64_t output_shape[2]{phase_h.count, phase_w.count};
+
+      MLAS_CONV_PARAMETERS parameters;
+      size_t phase_working_buffer_size;
+      MlasConvPrepare(&parameters, 2, static_cast<size_t>(p.N), static_cast<size_t>(group),
+                      static_cast<size_t>(input_channels), p.input_shape.GetDims().data(), kernel_shape, dilations,
+                      pads, strides, output_shape, static_cast<size_t>(output_channels), &activation,
+                      &phase_working_buffer_size, 0.0f, thread_pool);
+      if (phase_working_buffer_size > working_buffer_size) {
+        working_buffer = IAllocator::MakeUniquePtr<float>(alloc, phase_working_buffer_size);
+        working_buffer_size = phase_working_buffer_size;
+      }
+
+      MlasConv(&parameters, Xdata, phase_filter_data, Bdata, working_buffer.get(), phase_output.get(), thread_pool);
+
+      // Interleave the phase into every output channel.
+      const int64_t phase_size = phase_h.count * phase_w.count;
+      const float* phase_output_data = phase_output.get();
+      concurrency::ThreadPool::TryParallelFor(
+          thread_pool, static_cast<std::ptrdiff_t>(batch_channels), static_cast<double>(phase_size),
+          [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+            for (std::ptrdiff_t c = first; c < last; ++c) {
+              const float* src = phase_output_data + c * phase_size;
+              float* dst = Ydata + c * output_h * output_w + phase_h.first_output * output_w + phase_w.first_output;
+              for (int64_t j = 0; j < phase_h.count; ++j) {
+                float* dst_row = dst + j * stride_h * output_w;
+                for (int64_t i = 0; i < phase_w.count; ++i) {
+                  dst_row[i * stride_w] = *src++;
+                }
+              }
+            }
+          });
+    }
+  }
+
+  return Status::OK();
+}
+
+}  // namespace
+
 ONNX_CPU_OPERATOR_VERSIONED_KERNEL(
     ConvTranspose,
     1, 10,
@@ -241,22 +471,37 @@ Status ConvTranspose<float>::DoConvTranspose(OpKernelContext* context, bool dyna
   const int64_t kernel_dim = p.num_output_channels / conv_transpose_attrs_.group * kernel_size;
   const int64_t output_size = (p.Y->Shape().Slice(2)).Size();
 
-  AllocatorPtr alloc;
-  ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&alloc));
+  const bool is_pointwise = IsPointwiseConvTranspose(p, kernel_size, input_image_size, output_size);
+  const float* filter_data = p.F ? p.F->Data<float>() : static_cast<float*>(transposed_filter_.get());
 
-  const int64_t col_buffer_size = kernel_dim * p.input_shape.Size();
-  auto col_data = alloc->Alloc(SafeInt<size_t>(sizeof(float)) * col_buffer_size);
-  BufferUniquePtr col_buffer(col_data, BufferDeleter(std::move(alloc)));
-  float* col_buffer_data = static_cast<float*>(col_buffer.get());
+  InlinedVector<SubpixelPhase> phases_h;
+  InlinedVector<SubpixelPhase> phases_w;
+  if (!is_pointwise && GetSubpixelConvTransposePhases(p, phases_h, phases_w)) {
+    AllocatorPtr alloc;
+    ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&alloc));
+    return SubpixelConvTranspose(p, conv_transpose_attrs_.group, filter_data, p.F == nullptr, phases_h, phases_w,
+                                 std::move(alloc), thread_pool);
+  }
+
+  BufferUniquePtr col_buffer;
+  float* col_buffer_data = nullptr;
+  if (!is_pointwise) {
+    AllocatorPtr alloc;
+    ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&alloc));
+
+    const int64_t col_buffer_size = kernel_dim * p.input_shape.Size();
+    auto col_data = alloc->Alloc(SafeInt<size_t>(sizeof(float)) * col_buffer_size);
+    col_buffer = BufferUniquePtr(col_data, BufferDeleter(std::move(alloc)));
+    col_buffer_data = static_cast<float*>(col_buffer.get());
+  }
 
   const float* Xdata = p.X->Data<float>();
-  const float* filter_data = p.F ? p.F->Data<float>() : static_cast<float*>(transposed_filter_.get());
   float* Ydata = p.Y->MutableData<float>();
   TensorShape output_shape = p.Y->Shape().Slice(2);
 
   for (auto image_id = 0; image_id < p.N; ++image_id) {
     for (int group_id = 0; group_id < conv_transpose_attrs_.group; ++group_id) {
-      // Weight term
+      // Weight term. In the pointwise case this is the whole output for the group.
       math::Gemm<float>(
           p.F ? CblasTrans : CblasNoTrans,
           CblasNoTrans,
@@ -267,41 +512,12 @@ Status ConvTranspose<float>::DoConvTranspose(OpKernelContext* context, bool dyna
           filter_data + group_id * W_offset,
           Xdata + group_id * X_offset,
           0,
-          col_buffer_data,
+          is_pointwise ? Ydata + group_id * Y_offset : col_buffer_data,
           thread_pool);
 
-      if (p.X->Shape().NumDimensions() == 4) {
-        math::Col2im<float, CPUMathUtil, StorageOrder::NCHW>(
-            col_buffer_data,
-            p.num_output_channels / conv_transpose_attrs_.group,
-            p.Y->Shape()[2],
-            p.Y->Shape()[3],
-            p.kernel_shape[0],
-            p.kernel_shape[1],
-            p.dilations[0],
-            p.dilations[1],
-            p.pads[0],
-            p.pads[1],
-            p.pads[2],
-            p.pads[3],
-            p.strides[0],
-            p.strides[1],
-            Ydata + group_id * Y_offset,
-            &CPUMathUtil::Instance());
-      } else {
-        math::Col2imNd<float, CPUMathUtil, StorageOrder::NCHW>(
-            col_buffer_data,
-            output_shape.GetDims().data(),
-            p.input_shape.GetDims().data(),
-            kernel_dim,
-            Y_offset,
-            p.kernel_shape.data(),
-            p.strides.data(),
-            p.dilations.data(),
-            p.pads.data(),
-            static_cast<int>(p.kernel_shape.size()),
-            Ydata + group_id * Y_offset,
-            &CPUMathUtil::Instance());
+      if (!is_pointwise) {
+        ParallelCol2im(col_buffer_data, p, output_shape, p.num_output_channels / conv_transpose_attrs_.group,
+                       kernel_size, input_image_size, Ydata + group_id * Y_offset, thread_pool);
       }
     }
 
@@ -196,6 +196,18 @@ Status MaxPoolV8::ComputeImpl(OpKernelContext* context) const {
   auto* Y_data = Y->MutableData<T>();
   int64_t* I_data = I != nullptr ? I->MutableData<int64_t>() : nullptr;
 
+  // MLAS computes the dilated windows and the indices for floats
+  if constexpr (std::is_same<T, float>::value) {
+    if (kernel_shape.size() <= 3) {
+      const int64_t strides[3]{stride_h(), kernel_shape.size() > 1 ? stride_w() : 1,
+                               kernel_shape.size() > 2 ? stride_d() : 1};
+      MlasMaximumPoolWithIndices(kernel_shape.size(), x_shape.GetDims().data(), kernel_shape.data(),
+                                 pool_attrs_.dilations.data(), pads.data(), strides, output_dims.data(),
+                                 pool_attrs_.storage_order == 1, X_data, Y_data, I_data, tp);
+      return Status::OK();
+    }
+  }
+
   // The main loop
   int64_t channels = x_shape[1];
   int64_t height = x_shape[2];
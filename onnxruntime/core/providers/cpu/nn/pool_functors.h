@@ -6,6 +6,12 @@
 #include "core/providers/cpu/nn/pool_base.h"
 namespace onnxruntime {
 
+// Returns the first in-bounds sample of a dilated pooling window that starts at `start`. Together with
+// `std::min(end, size)` this lets the max pooling loops below skip padding without a per-sample bounds check.
+inline int64_t FirstValidPoolIndex(int64_t start, int64_t dilation) {
+  return start >= 0 ? start : start + ((dilation - 1 - start) / dilation) * dilation;
+}
+
 template <typename T, typename PoolType>
 struct Pool1DTask final {
   const T* X_data;
@@ -212,12 +218,10 @@ struct MaxPool1DTask final {
       int64_t hend = hstart + kernel_shape[0] * dilation_h;
       T Yh = std::numeric_limits<T>::lowest();
       int64_t h_index = -1;
-      for (int64_t h = hstart; h < hend; h += dilation_h) {
-        if (math::is_a_ge_zero_and_a_lt_b(h, height)) {
-          if (x_d[h] > Yh) {
-            Yh = x_d[h];
-            h_index = h;
-          }
+      for (int64_t h = FirstValidPoolIndex(hstart, dilation_h); h < std::min(hend, height); h += dilation_h) {
+        if (x_d[h] > Yh) {
+          Yh = x_d[h];
+          h_index = h;
         }
       }
       y_d[ph] = Yh;
@@ -271,17 +275,17 @@ struct MaxPool2DTask final {
         T Yh = std::numeric_limits<T>::lowest();
         int64_t h_index = -1;
         int64_t w_index = -1;
-        for (int64_t h = hstart; h < hend; h += dilation_h) {
-          if (math::is_a_ge_zero_and_a_lt_b(h, height)) {
-            for (int64_t w = wstart; w < wend; w += dilation_w) {
-              if (math::is_a_ge_zero_and_a_lt_b(w, width)) {
-                const int64_t input_index = h * width + w;
-                if (x_d[input_index] > Yh) {
-                  Yh = x_d[input_index];
-                  h_index = h;
-                  w_index = w;
-                }
-              }
+        const int64_t h_first = FirstValidPoolIndex(hstart, dilation_h);
+        const int64_t h_last = std::min(hend, height);
+        const int64_t w_first = FirstValidPoolIndex(wstart, dilation_w);
+        const int64_t w_last = std::min(wend, width);
+        for (int64_t h = h_first; h < h_last; h += dilation_h) {
+          const T* x_row = x_d + h * width;
+          for (int64_t w = w_first; w < w_last; w += dilation_w) {
+            if (x_row[w] > Yh) {
+              Yh = x_row[w];
+              h_index = h;
+              w_index = w;
             }
           }
         }
@@ -348,21 +352,19 @@ struct MaxPool3DTask {
           int64_t h_index = -1;
           int64_t w_index = -1;
           int64_t d_index = -1;
-          for (int64_t h = hstart; h < hend; h += dilation_h) {
-            if (math::is_a_ge_zero_and_a_lt_b(h, height)) {
-              for (int64_t w = wstart; w < wend; w += dilation_w) {
-                if (math::is_a_ge_zero_and_a_lt_b(w, width)) {
-                  for (int64_t d = dstart; d < dend; d += dilation_d) {
-                    if (math::is_a_ge_zero_and_a_lt_b(d, depth)) {
-                      const int64_t input_index = h * width * depth + w * depth + d;
-                      if (x_d[input_index] > Yh) {
-                        Yh = x_d[input_index];
-                        h_index = h;
-                        w_index = w;
-                        d_index = d;
-                      }
-                    }
-                  }
+          const int64_t h_last = std::min(hend, height);
+          const int64_t w_last = std::min(wend, width);
+          const int64_t d_first = FirstValidPoolIndex(dstart, dilation_d);
+          const int64_t d_last = std::min(dend, depth);
+          for (int64_t h = FirstValidPoolIndex(hstart, dilation_h); h < h_last; h += dilation_h) {
+            for (int64_t w = FirstValidPoolIndex(wstart, dilation_w); w < w_last; w += dilation_w) {
+              const T* x_row = x_d + (h * width + w) * depth;
+              for (int64_t d = d_first; d < d_last; d += dilation_d) {
+                if (x_row[d] > Yh) {
+                  Yh = x_row[d];
+                  h_index = h;
+                  w_index = w;
+                  d_index = d;
                 }
               }
             }
@@ -230,7 +230,7 @@ bool operator!=(FastReduceKind a, FastReduceKind b) {
 }
 
 bool ResultsNoTransposePrepareForReduce::equal(gsl::span<const int64_t> local_input_shape,
-                                               gsl::span<const int64_t> local_reduced_axes) {
+                                               gsl::span<const int64_t> local_reduced_axes) const {
   if (gsl::make_span(input_shape) != local_input_shape)
     return false;
   if (gsl::make_span(reduced_axes) != local_reduced_axes)
@@ -238,12 +238,28 @@ bool ResultsNoTransposePrepareForReduce::equal(gsl::span<const int64_t> local_in
   return true;
 }
 
-void ResultsNoTransposePrepareForReduce::ValidateNotEmpty() {
+void ResultsNoTransposePrepareForReduce::ValidateNotEmpty() const {
   ORT_ENFORCE(last_loop_red_size > 0);
   ORT_ENFORCE(last_loop_size > 0);
   ORT_ENFORCE(projected_index.size() > 0);
 }
 
+std::shared_ptr<ResultsNoTransposePrepareForReduce> ReducePrepareCache::Get(
+    gsl::span<const int64_t> input_shape, gsl::span<const int64_t> reduced_axes) const {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (last_results_ != nullptr && last_results_->equal(input_shape, reduced_axes)) {
+      return last_results_;
+    }
+  }
+  return std::make_shared<ResultsNoTransposePrepareForReduce>();
+}
+
+void ReducePrepareCache::Set(std::shared_ptr<ResultsNoTransposePrepareForReduce> results) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  last_results_ = std::move(results);
+}
+
 static void ValidateMustBeOverloaded() {
   ORT_ENFORCE(false, "must be overloaded.");
 }
@@ -421,7 +437,12 @@ void NoTransposeReduce1Loop(Tensor* output, const TensorShape& new_input_shape,
   data.from_data = from_data;
   data.to_data = to_data;
 
-  auto fn = [&data](std::ptrdiff_t first, std::ptrdiff_t end) {
+  // When the values reduced into one output are contiguous, aggall() processes them at once
+  // with vectorized code instead of calling update() for every value.
+  const bool contiguous_reduction = last_results.projected_index.size() == 1 &&
+                                    last_results.last_loop_red_inc == 1;
+
+  auto fn = [&data, contiguous_reduction](std::ptrdiff_t first, std::ptrdiff_t end) {
     const typename AGG::input_type* loop_red_ptr;
     const ResultsNoTransposePrepareForReduce& last_results = *data.last_results;
     int64_t main_index = first / last_results.last_loop_size;
@@ -429,13 +450,18 @@ void NoTransposeReduce1Loop(Tensor* output, const TensorShape& new_input_shape,
     int64_t origin = last_results.unprojected_index[main_index] + loop * last_results.last_loop_inc;
     for (int64_t main_index_last_loop = first; main_index_last_loop < end; ++main_index_last_loop) {
       AGG accumulator(data.denominator, data.from_data[origin + last_results.projected_index[0]]);
-      for (auto it = last_results.projected_index.begin(); it != last_results.projected_index.end(); ++it) {
-        loop_red_ptr = data.from_data + (origin + *it);
-        for (int64_t red = 0; red < data.loop_size; red += last_results.last_loop_red_inc) {
-          accumulator.update(loop_red_ptr[red]);
+      if (contiguous_reduction) {
+        data.to_data[main_index_last_loop] = accumulator.aggall(data.from_data + origin +
+                                                                last_results.projected_index[0]);
+      } else {
+        for (auto it = last_results.projected_index.begin(); it != last_results.projected_index.end(); ++it) {
+          loop_red_ptr = data.from_data + (origin + *it);
+          for (int64_t red = 0; red < data.loop_size; red += last_results.last_loop_red_inc) {
+            accumulator.update(loop_red_ptr[red]);
+          }
         }
+        data.to_data[main_index_last_loop] = accumulator.get_value();
       }
-      data.to_data[main_index_last_loop] = accumulator.get_value();
 
       ++loop;
       if (loop >= last_results.last_loop_size) {
@@ -773,7 +799,8 @@ static void ValidateKeepDims(const Tensor* input, int64_t keepdims) {
 template <typename AGG>
 void CommonReduce1Loop(OpKernelContext* ctx,
                        const gsl::span<const int64_t>& axes_, int64_t keepdims_,
-                       bool noop_with_empty_axes) {
+                       bool noop_with_empty_axes,
+                       const ReducePrepareCache* prepare_cache) {
   FastReduceKind fast_kind;
   TensorShapeVector fast_shape;
   TensorShapeVector output_shape;
@@ -799,14 +826,27 @@ void CommonReduce1Loop(OpKernelContext* ctx,
     return;
   }
 
-  ResultsNoTransposePrepareForReduce last_results;
-  NoTransposeReduce1Loop<AGG>(output, fast_shape, *input, fast_axes, ctx->GetOperatorThreadPool(), last_results);
+  if (prepare_cache == nullptr) {
+    ResultsNoTransposePrepareForReduce last_results;
+    NoTransposeReduce1Loop<AGG>(output, fast_shape, *input, fast_axes, ctx->GetOperatorThreadPool(), last_results);
+    return;
+  }
+
+  // a cached plan always matches fast_shape and fast_axes so NoTransposeReduce1Loop does not modify it
+  auto last_results = prepare_cache->Get(fast_shape, fast_axes);
+  const bool is_new_plan = !last_results->equal(fast_shape, fast_axes);
+  NoTransposeReduce1Loop<AGG>(output, fast_shape, *input, fast_axes, ctx->GetOperatorThreadPool(), *last_results);
+  if (is_new_plan && last_results->equal(fast_shape, fast_axes) &&
+      last_results->last_loop_red_size > 0 && last_results->last_loop_size > 0) {
+    prepare_cache->Set(std::move(last_results));
+  }
 }
 
 template <typename AGG>
 void CommonReduce2Loops(OpKernelContext* ctx,
                         const gsl::span<const int64_t>& axes_, int64_t keepdims_,
-                        bool noop_with_empty_axes) {
+                        bool noop_with_empty_axes,
+                        const ReducePrepareCache* prepare_cache) {
   FastReduceKind fast_kind;
   TensorShapeVector fast_shape, output_shape, fast_axes;
   if (CommonFastReduce<AGG>(ctx, axes_, keepdims_, noop_with_empty_axes,
@@ -831,64 +871,73 @@ void CommonReduce2Loops(OpKernelContext* ctx,
     return;
   }
 
-  ResultsNoTransposePrepareForReduce last_results;
-  NoTransposeReduce2Loops<AGG>(output, fast_shape, *input, fast_axes, ctx->GetOperatorThreadPool(), last_results);
+  if (prepare_cache == nullptr) {
+    ResultsNoTransposePrepareForReduce last_results;
+    NoTransposeReduce2Loops<AGG>(output, fast_shape, *input, fast_axes, ctx->GetOperatorThreadPool(), last_results);
+    return;
+  }
+
+  // a cached plan always matches fast_shape and fast_axes so NoTransposeReduce2Loops does not modify it
+  auto last_results = prepare_cache->Get(fast_shape, fast_axes);
+  const bool is_new_plan = !last_results->equal(fast_shape, fast_axes);
+  NoTransposeReduce2Loops<AGG>(output, fast_shape, *input, fast_axes, ctx->GetOperatorThreadPool(), *last_results);
+  if (is_new_plan && last_results->equal(fast_shape, fast_axes) &&
+      last_results->last_loop_red_size > 0 && last_results->last_loop_size > 0) {
+    prepare_cache->Set(std::move(last_results));
+  }
 }
 
 template <typename T>
 Status ReduceL1<T>::Compute(OpKernelContext* ctx) const {
-  // The following variable does not change if the input tensor and the
-  // axes do not either. It could be either cached in ctx or precomputed
-  // in the constructor if shape and axes are known at this stage.
-  CommonReduce1Loop<ReduceAggregatorL1<T>>(ctx, axes_, keepdims_);
+  CommonReduce1Loop<ReduceAggregatorL1<T>>(ctx, axes_, keepdims_, false, &prepare_cache_);
   return Status::OK();
 }
 
 template <typename T>
 Status ReduceL2<T>::Compute(OpKernelContext* ctx) const {
-  CommonReduce1Loop<ReduceAggregatorL2<T>>(ctx, axes_, keepdims_);
+  CommonReduce1Loop<ReduceAggregatorL2<T>>(ctx, axes_, keepdims_, false, &prepare_cache_);
   return Status::OK();
 }
 
 template <typename T>
 Status ReduceLogSum<T>::Compute(OpKernelContext* ctx) const {
-  CommonReduce1Loop<ReduceAggregatorLogSum<T>>(ctx, axes_, keepdims_);
+  CommonReduce1Loop<ReduceAggregatorLogSum<T>>(ctx, axes_, keepdims_, false, &prepare_cache_);
   return Status::OK();
 }
 
 template <typename T>
 Status ReduceLogSumExp<T>::Compute(OpKernelContext* ctx) const {
-  CommonReduce2Loops<ReduceAggregatorLogSumExp<T>>(ctx, axes_, keepdims_);
+  CommonReduce2Loops<ReduceAggregatorLogSumExp<T>>(ctx, axes_, keepdims_, false, &prepare_cache_);
   return Status::OK();
 }
 
 template <typename T>
 Status ReduceMax<T>::Compute(OpKernelContext* ctx) const {
-  CommonReduce1Loop<ReduceAggregatorMax<T>>(ctx, axes_, keepdims_);
+  CommonReduce1Loop<ReduceAggregatorMax<T>>(ctx, axes_, keepdims_, false, &prepare_cache_);
   return Status::OK();
 }
 
 template <typename T>
 Status ReduceMean<T>::Compute(OpKernelContext* ctx) const {
-  CommonReduce1Loop<ReduceAggregatorMean<T>>(ctx, axes_, keepdims_);
+  CommonReduce1Loop<ReduceAggregatorMean<T>>(ctx, axes_, keepdims_, false, &prepare_cache_);
   return Status::OK();
 }
 
 template <typename T>
 Status ReduceMin<T>::Compute(OpKernelContext* ctx) const {
-  CommonReduce1Loop<ReduceAggregatorMin<T>>(ctx, axes_, keepdims_);
+  CommonReduce1Loop<ReduceAggregatorMin<T>>(ctx, axes_, keepdims_, false, &prepare_cache_);
   return Status::OK();
 }
 
 template <typename T>
 Status ReduceProd<T>::Compute(OpKernelContext* ctx) const {
-  CommonReduce1Loop<ReduceAggregatorProd<T>>(ctx, axes_, keepdims_);
+  CommonReduce1Loop<ReduceAggregatorProd<T>>(ctx, axes_, keepdims_, false, &prepare_cache_);
   return Status::OK();
 }
 
 template <typename T>
 Status ReduceSum<T>::Compute(OpKernelContext* ctx) const {
-  CommonReduce1Loop<ReduceAggregatorSum<T>>(ctx, axes_, keepdims_, noop_with_empty_axes_);
+  CommonReduce1Loop<ReduceAggregatorSum<T>>(ctx, axes_, keepdims_, noop_with_empty_axes_, &prepare_cache_);
   return Status::OK();
 }
 
@@ -967,16 +1016,16 @@ std::unique_ptr<Tensor> ReduceSum<T>::Impl(const Tensor& input, gsl::span<const
 
 template <typename T>
 Status ReduceSumSquare<T>::Compute(OpKernelContext* ctx) const {
-  CommonReduce1Loop<ReduceAggregatorSumSquare<T>>(ctx, axes_, keepdims_);
+  CommonReduce1Loop<ReduceAggregatorSumSquare<T>>(ctx, axes_, keepdims_, false, &prepare_cache_);
   return Status::OK();
 }
 
 template <typename T>
 Status ArgMax<T>::Compute(OpKernelContext* ctx) const {
   if (select_last_index_) {
-    CommonReduce1Loop<ReduceAggregatorArgMaxLastIndex<T>>(ctx, axes_, keepdims_);
+    CommonReduce1Loop<ReduceAggregatorArgMaxLastIndex<T>>(ctx, axes_, keepdims_, false, &prepare_cache_);
   } else {
-    CommonReduce1Loop<ReduceAggregatorArgMax<T>>(ctx, axes_, keepdims_);
+    CommonReduce1Loop<ReduceAggregatorArgMax<T>>(ctx, axes_, keepdims_, false, &prepare_cache_);
   }
   return Status::OK();
 }
@@ -984,9 +1033,9 @@ Status ArgMax<T>::Compute(OpKernelContext* ctx) const {
 template <typename T>
 Status ArgMin<T>::Compute(OpKernelContext* ctx) const {
   if (select_last_index_) {
-    CommonReduce1Loop<ReduceAggregatorArgMinLastIndex<T>>(ctx, axes_, keepdims_);
+    CommonReduce1Loop<ReduceAggregatorArgMinLastIndex<T>>(ctx, axes_, keepdims_, false, &prepare_cache_);
   } else {
-    CommonReduce1Loop<ReduceAggregatorArgMin<T>>(ctx, axes_, keepdims_);
+    CommonReduce1Loop<ReduceAggregatorArgMin<T>>(ctx, axes_, keepdims_, false, &prepare_cache_);
   }
   return Status::OK();
 }
@@ -1002,15 +1051,19 @@ template class ReduceSum<int64_t>;
 
 template void CommonReduce1Loop<ReduceAggregatorSum<float>>(OpKernelContext* ctx,
                                                             const gsl::span<const int64_t>& axes_, int64_t keepdims_,
-                                                            bool noop_with_empty_axes);
+                                                            bool noop_with_empty_axes,
+                                                            const ReducePrepareCache* prepare_cache);
 template void CommonReduce1Loop<ReduceAggregatorSum<int32_t>>(OpKernelContext* ctx,
                                                               const gsl::span<const int64_t>& axes_, int64_t keepdims_,
-                                                              bool noop_with_empty_axes);
+                                                              bool noop_with_empty_axes,
+                                                              const ReducePrepareCache* prepare_cache);
 template void CommonReduce1Loop<ReduceAggregatorSum<double>>(OpKernelContext* ctx,
                                                              const gsl::span<const int64_t>& axes_, int64_t keepdims_,
-                                                             bool noop_with_empty_axes);
+                                                             bool noop_with_empty_axes,
+                                                             const ReducePrepareCache* prepare_cache);
 template void CommonReduce1Loop<ReduceAggregatorSum<int64_t>>(OpKernelContext* ctx,
                                                               const gsl::span<const int64_t>& axes_, int64_t keepdims_,
-                                                              bool noop_with_empty_axes);
+                                                              bool noop_with_empty_axes,
+                                                              const ReducePrepareCache* prepare_cache);
 
 }  // namespace onnxruntime
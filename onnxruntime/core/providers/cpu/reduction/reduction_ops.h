@@ -15,6 +15,8 @@
 #include "core/platform/threadpool.h"
 #include "core/common/safeint.h"
 #include <cmath>
+#include <memory>
+#include <mutex>
 
 namespace onnxruntime {
 
@@ -86,8 +88,25 @@ class ResultsNoTransposePrepareForReduce {
     last_loop_inc = 0;
   }
 
-  bool equal(gsl::span<const int64_t> local_input_shape, gsl::span<const int64_t> local_reduced_axes);
-  void ValidateNotEmpty();
+  bool equal(gsl::span<const int64_t> local_input_shape, gsl::span<const int64_t> local_reduced_axes) const;
+  void ValidateNotEmpty() const;
+};
+
+/**
+  Keeps the last ResultsNoTransposePrepareForReduce built by a kernel so that the projected and
+  unprojected index lists are not rebuilt on every run when the input shape and the axes do not change.
+  A cached plan is never modified once it was stored, so concurrent runs can share it.
+*/
+class ReducePrepareCache {
+ public:
+  // Returns the cached plan if it matches the shape and axes, a new empty plan otherwise.
+  std::shared_ptr<ResultsNoTransposePrepareForReduce> Get(gsl::span<const int64_t> input_shape,
+                                                          gsl::span<const int64_t> reduced_axes) const;
+  void Set(std::shared_ptr<ResultsNoTransposePrepareForReduce> results) const;
+
+ private:
+  mutable std::mutex mutex_;
+  mutable std::shared_ptr<ResultsNoTransposePrepareForReduce> last_results_;
 };
 
 template <typename T>
@@ -702,13 +721,15 @@ void NoTransposeReduce2Loops(Tensor* output, const TensorShape& new_input_shape,
 template <typename AGG>
 void CommonReduce1Loop(OpKernelContext* ctx,
                        const gsl::span<const int64_t>& axes_, int64_t keepdims_,
-                       bool noop_with_empty_axes = false);
+                       bool noop_with_empty_axes = false,
+                       const ReducePrepareCache* prepare_cache = nullptr);
 
 // Specific case for ReduceLogSumExp.
 template <typename AGG>
 void CommonReduce2Loops(OpKernelContext* ctx,
                         const gsl::span<const int64_t>& axes_, int64_t keepdims_,
-                        bool noop_with_empty_axes = false);
+                        bool noop_with_empty_axes = false,
+                        const ReducePrepareCache* prepare_cache = nullptr);
 
 template <bool allow_multi_axes>
 class ReduceKernelBase {
@@ -743,6 +764,8 @@ template <bool allow_multi_axes>
 class ReduceKernel : public OpKernel, public ReduceKernelBase<allow_multi_axes> {
  protected:
   ReduceKernel(const OpKernelInfo& info) : OpKernel(info), ReduceKernelBase<allow_multi_axes>(info) {}
+
+  ReducePrepareCache prepare_cache_;
 };
 
 template <typename T>
@@ -189,6 +189,7 @@ class UniDirectionalGru {
   bool linear_before_reset_;
 
   const float clip_;
+  const bool has_clip_;
 
   Direction direction_;
   bool use_bias_;
@@ -203,19 +204,16 @@ class UniDirectionalGru {
   gsl::span<T> batched_hidden0_;
   gsl::span<int> sequence_lengths_;
 
-  // Wb[zr] and Rb[zr] can always be added together upfront, and repeated to match the batch size for
-  // faster GEMM calculations, so these two members are all the
-  // Wb[z] + Rb[z] values added together, repeated batch_size_ times
-  IAllocatorUniquePtr<T> batched_bias_WRz_ptr_, batched_bias_WRr_ptr_;
-  gsl::span<T> batched_bias_WRz_, batched_bias_WRr_;
+  // The bias values that can be added to Xt*(W[zrh]^T) upfront (for all the steps at once), in zrh order.
+  // Wb[zr] and Rb[zr] can always be added together upfront.
+  // Wbh and Rbh can only be combined upfront if linear_before_reset_ is false, otherwise this holds Wbh alone.
+  IAllocatorUniquePtr<T> bias_zrh_ptr_;
+  gsl::span<T> bias_zrh_;
 
-  // Wbh and Rbh can only be combined upfront if linear_before_reset_ is false
-  IAllocatorUniquePtr<T> batched_bias_WRh_ptr_;
-  gsl::span<T> batched_bias_WRh_;
-
-  // if linear_before_reset_ is true, we need to setup Wbh and Rbh separately
-  IAllocatorUniquePtr<T> batched_bias_Wh_ptr_, batched_bias_Rh_ptr_;
-  gsl::span<T> batched_bias_Wh_, batched_bias_Rh_;
+  // if linear_before_reset_ is true, Rbh is added to Ht-1 * (Rh^T) at every step, so it is repeated to match
+  // the batch size for faster GEMM calculations
+  IAllocatorUniquePtr<T> batched_bias_Rh_ptr_;
+  gsl::span<T> batched_bias_Rh_;
 
   IAllocatorUniquePtr<T> linear_output_ptr_;
   gsl::span<T> linear_output_;
@@ -225,8 +223,6 @@ class UniDirectionalGru {
   gsl::span<T> inputs_reverse_;
   gsl::span<T> outputs_reverse_;
 
-  deepcpu::ClipWithBiasFuncPtr clip_with_bias_ptr_{};
-
   float zr_alpha_{};
   float zr_beta_{};
   float h_alpha_{};
@@ -427,11 +423,10 @@ UniDirectionalGru<T>::UniDirectionalGru(AllocatorPtr allocator,
       hidden_size_(hidden_size),
       linear_before_reset_(linear_before_reset),
       clip_(clip),
+      has_clip_(clip != std::numeric_limits<float>::max()),
       direction_(direction),
       use_bias_(!bias.empty()),
       ttp_(ttp) {
-  clip_with_bias_ptr_ = use_bias_ ? deepcpu::clip_add_bias : deepcpu::clip_ignore_bias;
-
   // setup activation function pointers and alpha/beta values to use with them
   reset_gate_ = deepcpu::GruResetGateFuncByName(activation_func_f.name);
   update_gate_ = deepcpu::ActivationFuncByName(activation_func_f.name);
@@ -452,33 +447,25 @@ UniDirectionalGru<T>::UniDirectionalGru(AllocatorPtr allocator,
     auto bias_Rr = bias.subspan(4 * hidden_size_, hidden_size_);
     auto bias_Ro = bias.subspan(5 * hidden_size_, hidden_size_);
 
-    // add Wb[zr] and Rb[zr] and replicate so we have batch_size_ copies of the result
-    auto combine_and_replicate = [&](gsl::span<const T>& bias_w,
-                                     gsl::span<const T>& bias_r,
-                                     gsl::span<T>& output) {
-      // add once
-      for (int i = 0; i < hidden_size_; ++i) {
-        output[i] = bias_w[i] + bias_r[i];
-      }
-
-      // replicate what we just wrote to the start of the output span so we have batch_size_ copies
-      auto values = output.cbegin();
-      ORT_IGNORE_RETURN_VALUE(RepeatVectorToConstructArray(values, values + hidden_size_,
-                                                           output.begin() + hidden_size_,  // skip the first batch
-                                                           batch_size_ - 1));              // and replicate batch size - 1 times
-    };
+    auto bias_WRz = bias_zrh_.subspan(0 * hidden_size_, hidden_size_);
+    auto bias_WRr = bias_zrh_.subspan(1 * hidden_size_, hidden_size_);
+    auto bias_WRh = bias_zrh_.subspan(2 * hidden_size_, hidden_size_);
 
     // we can always combine the z and r weights
-    combine_and_replicate(bias_Wz, bias_Rz, batched_bias_WRz_);
-    combine_and_replicate(bias_Wr, bias_Rr, batched_bias_WRr_);
+    for (int i = 0; i < hidden_size_; ++i) {
+      bias_WRz[i] = bias_Wz[i] + bias_Rz[i];
+      bias_WRr[i] = bias_Wr[i] + bias_Rr[i];
+    }
 
     // how we treat the h weight depends on whether linear_before_reset_ is set
     if (linear_before_reset_) {
-      // need to replicate Wb[o] and Rb[o] separately
-      ORT_IGNORE_RETURN_VALUE(RepeatVectorToConstructArray(bias_Wo.cbegin(), bias_Wo.cend(), batched_bias_Wh_.begin(), batch_size_));
+      // Wb[o] is added upfront, Rb[o] needs to be replicated separately
+      gsl::copy(bias_Wo, bias_WRh);
       ORT_IGNORE_RETURN_VALUE(RepeatVectorToConstructArray(bias_Ro.cbegin(), bias_Ro.cend(), batched_bias_Rh_.begin(), batch_size_));
     } else {
-      combine_and_replicate(bias_Wo, bias_Ro, batched_bias_WRh_);
+      for (int i = 0; i < hidden_size_; ++i) {
+        bias_WRh[i] = bias_Wo[i] + bias_Ro[i];
+      }
     }
   }
 
@@ -549,7 +536,14 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
               outputZRH_.begin(), outputZRH_.end(),
               hidden_size_x3, ttp_);
 
-  DumpMatrix("inputs with weights applied", outputZRH_.data(), seq_length_ * batch_size_ * 3, hidden_size_);
+  // the bias doesn't change between steps, so add it once to Xt*(W[zrh]^T) for all the steps
+  if (use_bias_) {
+    AddBiasToRows(total_rows, hidden_size_x3, bias_zrh_.data(),
+                  outputZRH_.data(), outputZRH_.data() + outputZRH_.size(), hidden_size_x3,
+                  ttp_);
+  }
+
+  DumpMatrix("inputs with weights and bias applied", outputZRH_.data(), seq_length_ * batch_size_ * 3, hidden_size_);
 
   // output shape is [seq_length, num_directions, batch_size, hidden_size]
   // if we are doing 2 directions and this is the forward pass we're writing to the real output so
@@ -561,38 +555,16 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
   if (direction_ == kForward && num_directions == 2)
     output_step_length = 2 * batch_size_ * hidden_size_;
 
-  // convenience end iterators we use in the loops below to detect any bounds issues
-  span_T_const_iter batched_bias_WRz_local_end = batched_bias_WRz_.cend();
-  span_T_const_iter batched_bias_WRr_local_end = batched_bias_WRr_.cend();
-  span_T_const_iter batched_bias_Wh_local_end = batched_bias_Wh_.cend();
-  span_T_const_iter batched_bias_Rh_local_end = batched_bias_Rh_.cend();
-  span_T_const_iter batched_bias_WRh_local_end = batched_bias_WRh_.cend();
-
   size_t out_added_offset;
 
+  // rough cost of the element-wise gate computations for one row of the batch
+  const double activation_cost_per_row = static_cast<double>(hidden_size_) * 32;
+
   span_T_const_iter prev_Ht = batched_hidden0_.cbegin();  // Ht-1
   span_T_const_iter prev_Ht_end = batched_hidden0_.cend();
   span_T_iter cur_h_local = cur_h_.begin();
   span_T_iter cur_h_local_end = cur_h_.end();
 
-  span_T_const_iter batched_bias_WRz_local{};
-  span_T_const_iter batched_bias_WRr_local{};
-  span_T_const_iter batched_bias_WRh_local{};
-  span_T_const_iter batched_bias_Wh_local{};
-  span_T_const_iter batched_bias_Rh_local{};
-
-  if (use_bias_) {
-    batched_bias_WRz_local = batched_bias_WRz_.cbegin();
-    batched_bias_WRr_local = batched_bias_WRr_.cbegin();
-
-    if (linear_before_reset_) {
-      batched_bias_Wh_local = batched_bias_Wh_.cbegin();
-      batched_bias_Rh_local = batched_bias_Rh_.cbegin();
-    } else {
-      batched_bias_WRh_local = batched_bias_WRh_.cbegin();
-    }
-  }
-
   {
     // Enter a parallel section encompassing the kernels invoked
     // below.  This lets the runtime system amortize loop entry/exit
@@ -625,9 +597,7 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
       if (linear_before_reset_) {
         // copy Rbh to linear output
         if (use_bias_) {
-          gsl::copy(batched_bias_Rh_.subspan(batched_bias_Rh_local - batched_bias_Rh_.begin(),
-                                             batched_bias_Rh_local_end - batched_bias_Rh_local),
-                    linear_output_);
+          gsl::copy(batched_bias_Rh_, linear_output_);
         }
 
         // compute Ht-1 * (Rh^T) + Rbh
@@ -645,57 +615,49 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
       }
 
       // 1st Set Of Activations
-      for (int r = 0; r < batch_size_; r++) {
-        const T* p_bias_r = use_bias_ ? SafeRawConstPointer<T>(batched_bias_WRr_local + r * hidden_size_,
-                                                               batched_bias_WRr_local_end, hidden_size_)
-                                      : nullptr;
-
-        // initialize p_rt with input to calculate rt. outputZRH_ has Xt*(Wr^T) + Ht-1*(Rr^T).
-        T* p_rt = SafeRawPointer(outputZRH_, out_added_offset + r * hidden_size_x3 + hidden_size_, hidden_size_);
-
-        // add the bias and clip. post: p_rt == Xt*(Wr^T) + Ht-1*(Rr^T) + Wbr + Rbr
-        clip_with_bias_ptr_(clip_, p_bias_r, p_rt, hidden_size_);
-
-        if (linear_before_reset_) {
-          // p_linear_output = Ht-1 * (Rh^T) + Rbh
-          T* p_linear_output = SafeRawPointer<T>(linear_output_, r * hidden_size_, hidden_size_);
-          T* p_cur_h = SafeRawPointer<T>(cur_h_local + r * hidden_size_, cur_h_local_end, hidden_size_);
-
-          // calculate rt in-place [p_rt = f(p_rt)]
-          // calculate rt (.) (Ht-1 * (Rh^T) + Rbh) using p_linear_output. write to p_cur_h
-          reset_gate_(p_linear_output, p_rt, p_cur_h, hidden_size_, zr_alpha_, zr_beta_);
-
-        } else {
-          const T* p_prev_Ht = SafeRawConstPointer<T>(prev_Ht + r * hidden_size_, prev_Ht_end, hidden_size_);
-          T* p_cur_h = SafeRawPointer<T>(cur_h_local + r * hidden_size_, cur_h_local_end, hidden_size_);
-
-          // calculate rt in-place [p_rt = f(p_rt)]
-          // calculate rt (.) Ht-1 using p_prev_Ht, and write to p_cur_h
-          reset_gate_(p_prev_Ht, p_rt, p_cur_h, hidden_size_, zr_alpha_, zr_beta_);
-        }
-      }
+      // Each row only touches its own hidden_size_ values so the rows are processed in parallel
+      concurrency::ThreadPool::TryParallelFor(
+          ttp_, batch_size_, activation_cost_per_row,
+          [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+            for (int r = static_cast<int>(first), end = static_cast<int>(last); r < end; r++) {
+              // initialize p_rt with input to calculate rt.
+              // outputZRH_ has Xt*(Wr^T) + Ht-1*(Rr^T) + Wbr + Rbr (the bias was added upfront).
+              T* p_rt = SafeRawPointer(outputZRH_, out_added_offset + r * hidden_size_x3 + hidden_size_, hidden_size_);
+
+              if (has_clip_) {
+                deepcpu::clip(clip_, p_rt, hidden_size_);
+              }
+
+              T* p_cur_h = SafeRawPointer<T>(cur_h_local + r * hidden_size_, cur_h_local_end, hidden_size_);
+
+              if (linear_before_reset_) {
+                // p_linear_output = Ht-1 * (Rh^T) + Rbh
+                T* p_linear_output = SafeRawPointer<T>(linear_output_, r * hidden_size_, hidden_size_);
+
+                // calculate rt in-place [p_rt = f(p_rt)]
+                // calculate rt (.) (Ht-1 * (Rh^T) + Rbh) using p_linear_output. write to p_cur_h
+                reset_gate_(p_linear_output, p_rt, p_cur_h, hidden_size_, zr_alpha_, zr_beta_);
+
+                // add rt (.) (Ht-1*(Rh^T) + Rbh) to Xt*(Wh^T) while it is still in cache
+                T* p_ht = SafeRawPointer<T>(outputZRH_, out_added_offset + r * hidden_size_x3 + hidden_size_x2,
+                                            hidden_size_);
+                deepcpu::elementwise_sum1(p_cur_h, p_ht, hidden_size_);
+              } else {
+                const T* p_prev_Ht = SafeRawConstPointer<T>(prev_Ht + r * hidden_size_, prev_Ht_end, hidden_size_);
+
+                // calculate rt in-place [p_rt = f(p_rt)]
+                // calculate rt (.) Ht-1 using p_prev_Ht, and write to p_cur_h
+                reset_gate_(p_prev_Ht, p_rt, p_cur_h, hidden_size_, zr_alpha_, zr_beta_);
+              }
+            }
+          });
 
 #if defined(DUMP_MATRIXES)
       std::string label = linear_before_reset_ ? "rt (.) (Ht-1 * (Rh^T) + Rbh)" : "rt (.) Ht-1";
 #endif
       DumpMatrix(label + seqno_str, &*cur_h_local, batch_size_, hidden_size_);
 
-      if (linear_before_reset_) {
-        // input contains rt (.) (Ht-1*(Rh^T) + Rbh)
-        auto input = cur_h_local;
-        // out_H currently contains Xt*(W[zrh]^T).
-        auto out_H = outputZRH_.begin() + out_added_offset;
-
-        for (int r = 0; r < batch_size_; r++) {
-          // skip over the inputs with Z and R weights
-          out_H += hidden_size_x2;
-          for (int h = 0; h < hidden_size_; ++h) {
-            *out_H += *input;
-            ++out_H;
-            ++input;
-          }
-        }
-      } else {
+      if (!linear_before_reset_) {
 #if defined(DUMP_MATRIXES)
         label += " * Rh^T";
 #endif
@@ -728,64 +690,53 @@ void UniDirectionalGru<T>::Compute(const gsl::span<const T>& inputs_arg,
         output_end = final_hidden_state.end();
       }
 
-      for (int r = 0; r < batch_size_; r++) {
-        if (step >= min_sequence_length && step >= sequence_lengths[r]) {
-          // if we need output for every step,
-          // or we need to set prev_Ht for an empty sequence to avoid warnings about using uninitialized values
-          if (output_sequence || (step == 0 && sequence_lengths[r] == 0)) {
-            auto fill_output = output + r * hidden_size_;
-            std::fill_n(&*fill_output, hidden_size_, T{});
-          }
-
-          continue;
-        }
-
-        const T* p_bias_z = use_bias_ ? SafeRawConstPointer<T>(batched_bias_WRz_local,
-                                                               batched_bias_WRz_local_end, hidden_size_)
-                                      : nullptr;
+      concurrency::ThreadPool::TryParallelFor(
+          ttp_, batch_size_, activation_cost_per_row,
+          [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+            for (int r = static_cast<int>(first), end = static_cast<int>(last); r < end; r++) {
+              if (step >= min_sequence_length && step >= sequence_lengths[r]) {
+                // if we need output for every step,
+                // or we need to set prev_Ht for an empty sequence to avoid warnings about using uninitialized values
+                if (output_sequence || (step == 0 && sequence_lengths[r] == 0)) {
+                  auto fill_output = output + r * hidden_size_;
+                  std::fill_n(&*fill_output, hidden_size_, T{});
+                }
 
-        // initialize p_zt with Xt*(Wz^T) + Ht-1*(Rz^T), which is most of the input to calculate zt:
-        T* p_zt = SafeRawPointer<T>(outputZRH_, out_added_offset + r * hidden_size_x3, hidden_size_);
+                continue;
+              }
 
-        // using p_zt, add bias and clip in-place
-        clip_with_bias_ptr_(clip_, p_bias_z, p_zt, hidden_size_);
+              // initialize p_zt with Xt*(Wz^T) + Ht-1*(Rz^T) + Wbz + Rbz, which is the input to calculate zt
+              T* p_zt = SafeRawPointer<T>(outputZRH_, out_added_offset + r * hidden_size_x3, hidden_size_);
 
-        // calculate zt in-place. p_zt = f(p_zt)
-        update_gate_(p_zt, hidden_size_, zr_alpha_, zr_beta_);
+              if (has_clip_) {
+                deepcpu::clip(clip_, p_zt, hidden_size_);
+              }
 
-        DumpMatrix("zt[" + std::to_string(r) + "]" + seqno_str, p_zt, 1, hidden_size_);
+              // calculate zt in-place. p_zt = f(p_zt)
+              update_gate_(p_zt, hidden_size_, zr_alpha_, zr_beta_);
 
-        const T* p_bias_h = nullptr;
-        if (use_bias_) {
-          if (linear_before_reset_) {
-            // Wbh
-            p_bias_h = SafeRawConstPointer<T>(batched_bias_Wh_local + r * hidden_size_,
-                                              batched_bias_Wh_local_end, hidden_size_);
-
-          } else {
-            // Wbh + Wrh
-            p_bias_h = SafeRawConstPointer<T>(batched_bias_WRh_local + r * hidden_size_,
-                                              batched_bias_WRh_local_end, hidden_size_);
-          }
-        }
+              DumpMatrix("zt[" + std::to_string(r) + "]" + seqno_str, p_zt, 1, hidden_size_);
 
-        // setup p_ht with input to calculate ht
-        // p_ht = Xt*(Wh^T) + (rt (.) Ht-1 * Rh^T)          #  linear_before_reset_ == false
-        //      = Xt*(Wh^T) + (rt (.) (Ht-1*(Rh^T) + Rbh))  #  linear_before_reset_ == true
-        T* p_ht = SafeRawPointer<T>(outputZRH_, out_added_offset + r * hidden_size_x3 + hidden_size_x2, hidden_size_);
+              // setup p_ht with input to calculate ht
+              // p_ht = Xt*(Wh^T) + Wbh + Rbh + (rt (.) Ht-1 * Rh^T)  #  linear_before_reset_ == false
+              //      = Xt*(Wh^T) + Wbh + (rt (.) (Ht-1*(Rh^T) + Rbh))  #  linear_before_reset_ == true
+              T* p_ht = SafeRawPointer<T>(outputZRH_, out_added_offset + r * hidden_size_x3 + hidden_size_x2,
+                                          hidden_size_);
 
-        // add Wbh [and Wrh] and clip
-        clip_with_bias_ptr_(clip_, p_bias_h, p_ht, hidden_size_);  // post: p_ht == input to g() for calculating ht
+              if (has_clip_) {
+                deepcpu::clip(clip_, p_ht, hidden_size_);  // post: p_ht == input to g() for calculating ht
+              }
 
-        DumpMatrix("ht input [" + std::to_string(r) + "]" + seqno_str, p_ht, 1, hidden_size_);
+              DumpMatrix("ht input [" + std::to_string(r) + "]" + seqno_str, p_ht, 1, hidden_size_);
 
-        const T* p_prev_Ht = SafeRawConstPointer<T>(prev_Ht + r * hidden_size_, prev_Ht_end, hidden_size_);
-        T* p_Ht = SafeRawPointer<T>(output + r * hidden_size_, output_end, hidden_size_);
+              const T* p_prev_Ht = SafeRawConstPointer<T>(prev_Ht + r * hidden_size_, prev_Ht_end, hidden_size_);
+              T* p_Ht = SafeRawPointer<T>(output + r * hidden_size_, output_end, hidden_size_);
 
-        // calculate ht = g(p_ht) and write in-place to p_ht
-        // calculate Ht = (1 - zt) (.) ht + zt (.) Ht-1 and write to p_Ht
-        output_gate_(p_ht, p_zt, p_prev_Ht, p_Ht, hidden_size_, h_alpha_, h_beta_);  // calculate ht and Ht
-      }
+              // calculate ht = g(p_ht) and write in-place to p_ht
+              // calculate Ht = (1 - zt) (.) ht + zt (.) Ht-1 and write to p_Ht
+              output_gate_(p_ht, p_zt, p_prev_Ht, p_Ht, hidden_size_, h_alpha_, h_beta_);  // calculate ht and Ht
+            }
+          });
 
       DumpMatrix("output" + seqno_str, &*output, batch_size_, hidden_size_);
 
@@ -837,14 +788,10 @@ void UniDirectionalGru<T>::AllocateBuffers() {
   batched_hidden0_ = Allocate(allocator_, batch_size_ * hidden_size_, batched_hidden0_ptr_, true);
 
   if (use_bias_) {
-    batched_bias_WRz_ = Allocate(allocator_, batch_size_ * hidden_size_, batched_bias_WRz_ptr_);
-    batched_bias_WRr_ = Allocate(allocator_, batch_size_ * hidden_size_, batched_bias_WRr_ptr_);
+    bias_zrh_ = Allocate(allocator_, 3 * hidden_size_, bias_zrh_ptr_);
 
     if (linear_before_reset_) {
-      batched_bias_Wh_ = Allocate(allocator_, batch_size_ * hidden_size_, batched_bias_Wh_ptr_);
       batched_bias_Rh_ = Allocate(allocator_, batch_size_ * hidden_size_, batched_bias_Rh_ptr_);
-    } else {
-      batched_bias_WRh_ = Allocate(allocator_, batch_size_ * hidden_size_, batched_bias_WRh_ptr_);
     }
   }
 
@@ -312,6 +312,24 @@ void ComputeGemm(const int M,
   MlasGemm(gemm_shape, gemm_params, thread_pool);
 }
 
+void AddBiasToRows(const int M,
+                   const int N,
+                   const float* bias,
+                   float* C,
+                   float* C_end,
+                   const int ldc,
+                   concurrency::ThreadPool* thread_pool) {
+  ORT_ENFORCE(C + (M * ldc - (ldc - N)) <= C_end);
+
+  concurrency::ThreadPool::TryParallelFor(
+      thread_pool, static_cast<std::ptrdiff_t>(M), static_cast<double>(N),
+      [bias, C, N, ldc](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (std::ptrdiff_t row = first; row < last; ++row) {
+          deepcpu::add_bias_into(bias, C + row * ldc, N);
+        }
+      });
+}
+
 namespace deepcpu {
 
 constexpr float alpha_1 = 4.89352455891786e-03f;
@@ -247,6 +247,17 @@ void ComputeGemm(const int M,
                  int32_t* quantize_agg_C_buffer,
                  concurrency::ThreadPool* thread_pool);
 
+// Adds bias (of size N) to each of the M rows of C, which has a leading dimension of ldc.
+// The bias terms of the gates do not depend on the step, so they are added once to the output of the GEMM
+// over all the inputs instead of at every step of the sequence.
+void AddBiasToRows(const int M,
+                   const int N,
+                   const float* bias,
+                   float* C,
+                   float* C_end,
+                   const int ldc,
+                   concurrency::ThreadPool* thread_pool);
+
 // helper to convert a span to a raw pointer
 // after validating the memory covered by the span supports the size required
 template <typename T>
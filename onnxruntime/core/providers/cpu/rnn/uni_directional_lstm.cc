@@ -3,6 +3,8 @@
 
 #include "uni_directional_lstm.h"
 
+#include <limits>
+
 #include "core/platform/threadpool.h"
 //TODO: fix the warnings
 #if defined(_MSC_VER) && !defined(__clang__)
@@ -59,8 +61,10 @@ UniDirectionalLstm<T>::UniDirectionalLstm(
       direction_(direction),
       input_forget_(input_forget),
       clip_(clip),
+      has_clip_(clip != std::numeric_limits<float>::max()),
       use_bias_(!bias.empty()),
       use_peepholes_(!peephole_weights.empty()),
+      fuse_gate_activations_(!use_peepholes_ && !input_forget_),
       thread_pool_(thread_pool) {
   activation_f_ = {deepcpu::ActivationFuncByName(activation_func_f.name), activation_func_f.alpha,
                    activation_func_f.beta};
@@ -71,8 +75,6 @@ UniDirectionalLstm<T>::UniDirectionalLstm(
   activation_h_ = {deepcpu::LstmMergeGatesFuncByName(activation_func_h.name), activation_func_h.alpha,
                    activation_func_h.beta};
 
-  clip_with_bias_ptr_ = use_bias_ ? deepcpu::clip_add_bias : deepcpu::clip_ignore_bias;
-
   SetNumThreads();
   AllocateBuffers();
   InitializeBuffers(initial_hidden_state, initial_cell_state);
@@ -99,10 +101,7 @@ void UniDirectionalLstm<T>::AllocateBuffers() {
   output_iofc_ = Allocate(allocator_, hidden_size_ * 4 * batch_size_ * seq_length_, output_iofc_ptr_);
 
   if (use_bias_) {
-    bias_WRi_ = Allocate(allocator_, hidden_size_, bias_WRi_ptr_);
-    bias_WRf_ = Allocate(allocator_, hidden_size_, bias_WRf_ptr_);
-    bias_WRo_ = Allocate(allocator_, hidden_size_, bias_WRo_ptr_);
-    bias_WRc_ = Allocate(allocator_, hidden_size_, bias_WRc_ptr_);
+    bias_WR_ = Allocate(allocator_, hidden_size_ * 4, bias_WR_ptr_);
   }
 
   if (direction_ == kReverse) {
@@ -170,19 +169,11 @@ void UniDirectionalLstm<T>::LoadPeepholeWeights(const gsl::span<const T>& peepho
 
 template <typename T>
 void UniDirectionalLstm<T>::LoadBias(const gsl::span<const T>& WbRb_values) {
-  // add Wb and Rb
-  auto copy_fused_bias = [this, &WbRb_values](int offset, gsl::span<T>& out) {
-    // gap between Wb and Wb value for an entry
-    const int Wb_to_Rb_offset = 4 * hidden_size_;
-
-    for (int j = 0; j < hidden_size_; ++j) out[j] = WbRb_values[j + offset] + WbRb_values[j + offset + Wb_to_Rb_offset];
-  };
-
-  int i = 0;
-  copy_fused_bias((i++) * hidden_size_, bias_WRi_);
-  copy_fused_bias((i++) * hidden_size_, bias_WRo_);
-  copy_fused_bias((i++) * hidden_size_, bias_WRf_);
-  copy_fused_bias((i++) * hidden_size_, bias_WRc_);
+  // add Wb and Rb. both are in iofc order, which matches the order of the gates in output_iofc_
+  const int Wb_to_Rb_offset = 4 * hidden_size_;
+  for (int j = 0; j < Wb_to_Rb_offset; ++j) {
+    bias_WR_[j] = WbRb_values[j] + WbRb_values[j + Wb_to_Rb_offset];
+  }
 
   /*
   i = 0;
@@ -195,10 +186,7 @@ void UniDirectionalLstm<T>::LoadBias(const gsl::span<const T>& WbRb_values) {
   DumpMatrix("Rb[f]", WbRb_values.data() + (i++ * hidden_size_), 1, hidden_size_);
   DumpMatrix("Rb[c]", WbRb_values.data() + (i++ * hidden_size_), 1, hidden_size_);
 
-  DumpMatrix("Wb[i]+Rb[i]", bias_WRi_.data(), 1, hidden_size_);
-  DumpMatrix("Wb[o]+Rb[o]", bias_WRo_.data(), 1, hidden_size_);
-  DumpMatrix("Wb[f]+Rb[f]", bias_WRf_.data(), 1, hidden_size_);
-  DumpMatrix("Wb[c]+Rb[c]", bias_WRc_.data(), 1, hidden_size_);
+  DumpMatrix("Wb[iofc]+Rb[iofc]", bias_WR_.data(), 1, 4 * hidden_size_);
   */
 }
 
@@ -285,7 +273,14 @@ void UniDirectionalLstm<T>::Compute(const gsl::span<const T>& inputs_arg,
               nullptr,
               thread_pool_);
 
-  DumpMatrix("Xt*(W[iofc]^T)", output_iofc_.data(), total_rows, hidden_size_x4);
+  // the bias doesn't change between steps, so add it once to Xt*(W[iofc]^T) for all the steps
+  if (use_bias_) {
+    AddBiasToRows(total_rows, hidden_size_x4, bias_WR_.data(),
+                  output_iofc_.data(), output_iofc_.data() + output_iofc_.size(), hidden_size_x4,
+                  thread_pool_);
+  }
+
+  DumpMatrix("Xt*(W[iofc]^T) + Wb[iofc] + Rb[iofc]", output_iofc_.data(), total_rows, hidden_size_x4);
 
   beta = 1.0f;  // calls to ComputeGemm now add to existing data
 
@@ -328,7 +323,7 @@ void UniDirectionalLstm<T>::Compute(const gsl::span<const T>& inputs_arg,
 
       span_T_iter step_out_IOFC = output_iofc_.begin() + (step * batch_size_ + seq_start) * hidden_size_x4;
 
-      // calculate Xt*(W[iofc]^T) + Ht-t*R[iofc]
+      // calculate Xt*(W[iofc]^T) + Wb[iofc] + Rb[iofc] + Ht-t*R[iofc]
       // Do it sequentially to avoid nested parallelism
       ComputeGemm(num_seq_to_compute_adjusted, hidden_size_x4, hidden_size_, alpha,
                   previous_state, previous_state_end,       // Ht-1
@@ -465,61 +460,78 @@ void UniDirectionalLstm<T>::GateComputations(
 
     // DumpMatrix("C_prev" + row_str, pCprev_hidden_size, 1, hidden_size_);
 
-    // Input Gate
-    if (use_peepholes_) {
-      deepcpu::elementwise_product(pCprev_hidden_size, SafeRawConstPointer<const T>(peephole_i_, 0, hidden_size_), pi,
-                                   hidden_size_);
-    }
-
-    const float* pBi = use_bias_ ? SafeRawConstPointer<T>(bias_WRi_, 0, hidden_size_) : nullptr;
-    clip_with_bias_ptr_(clip_, pBi, pi, hidden_size_);  // post: pi has input to f() to calculate i
-    activation_f_.func(pi, hidden_size_, activation_f_.alpha, activation_f_.beta);
-    // DumpMatrix("i" + row_str, pi, 1, hidden_size_);
+    // the bias has already been added to out (see Compute), so only the clip remains to be applied
+    if (fuse_gate_activations_) {
+      // i, o, f and c are contiguous so clip all 4 at once, and then apply f() to i, o and f at once
+      if (has_clip_) {
+        deepcpu::clip(clip_, pi, hidden_size_x4);
+      }
+      activation_f_.func(pi, 3 * hidden_size_, activation_f_.alpha, activation_f_.beta);
+      activation_g_.func(pc, hidden_size_, activation_g_.alpha, activation_g_.beta);
 
-    // Forget Gate
-    if (input_forget_) {
-      for (int i = 0; i < hidden_size_; i++) pf[i] = 1.0f - pi[i];
+      deepcpu::merge_lstm_gates_to_memory(pCprev_hidden_size, pi, pf, pc, pCprev_hidden_size, hidden_size_);
     } else {
+      // Input Gate
       if (use_peepholes_) {
-        deepcpu::elementwise_product(pCprev_hidden_size, SafeRawConstPointer<const T>(peephole_f_, 0, hidden_size_), pf,
+        deepcpu::elementwise_product(pCprev_hidden_size, SafeRawConstPointer<const T>(peephole_i_, 0, hidden_size_), pi,
                                      hidden_size_);
       }
 
-      const float* pBf = use_bias_ ? SafeRawConstPointer<T>(bias_WRf_, 0, hidden_size_) : nullptr;
-      clip_with_bias_ptr_(clip_, pBf, pf, hidden_size_);
-      activation_f_.func(pf, hidden_size_, activation_f_.alpha, activation_f_.beta);
-    }
+      if (has_clip_) {
+        deepcpu::clip(clip_, pi, hidden_size_);  // post: pi has input to f() to calculate i
+      }
+      activation_f_.func(pi, hidden_size_, activation_f_.alpha, activation_f_.beta);
+      // DumpMatrix("i" + row_str, pi, 1, hidden_size_);
 
-    // DumpMatrix("f" + row_str, pf, 1, hidden_size_);
+      // Forget Gate
+      if (input_forget_) {
+        for (int i = 0; i < hidden_size_; i++) pf[i] = 1.0f - pi[i];
+      } else {
+        if (use_peepholes_) {
+          deepcpu::elementwise_product(pCprev_hidden_size, SafeRawConstPointer<const T>(peephole_f_, 0, hidden_size_), pf,
+                                       hidden_size_);
+        }
 
-    // Block Gate
-    const float* pBc = use_bias_ ? SafeRawConstPointer<T>(bias_WRc_, 0, hidden_size_) : nullptr;
-    clip_with_bias_ptr_(clip_, pBc, pc, hidden_size_);
-    activation_g_.func(pc, hidden_size_, activation_g_.alpha, activation_g_.beta);
+        if (has_clip_) {
+          deepcpu::clip(clip_, pf, hidden_size_);
+        }
+        activation_f_.func(pf, hidden_size_, activation_f_.alpha, activation_f_.beta);
+      }
 
-    // DumpMatrix("c" + row_str, pc, 1, hidden_size_);
+      // DumpMatrix("f" + row_str, pf, 1, hidden_size_);
 
-    // C_current. use previous C value as input, and update in-place
-    float* pC_cur = pCprev_hidden_size;
+      // Block Gate
+      if (has_clip_) {
+        deepcpu::clip(clip_, pc, hidden_size_);
+      }
+      activation_g_.func(pc, hidden_size_, activation_g_.alpha, activation_g_.beta);
+
+      // DumpMatrix("c" + row_str, pc, 1, hidden_size_);
+
+      // C_current. use previous C value as input, and update in-place
 #ifdef PREVIOUS_BROKEN_VERSION
-    deepcpu::merge_lstm_gates_to_memory(pCprev_hidden_size + b * hidden_size_, pi, pf, pc,
-                                        pCprev_hidden_size + b * hidden_size_, hidden_size_);
-    // DumpMatrix("C", pCprev_hidden_size + b * hidden_size_, 1, hidden_size_);
+      deepcpu::merge_lstm_gates_to_memory(pCprev_hidden_size + b * hidden_size_, pi, pf, pc,
+                                          pCprev_hidden_size + b * hidden_size_, hidden_size_);
+      // DumpMatrix("C", pCprev_hidden_size + b * hidden_size_, 1, hidden_size_);
 #else
-    deepcpu::merge_lstm_gates_to_memory(pCprev_hidden_size, pi, pf, pc, pC_cur, hidden_size_);
-    // DumpMatrix("C", pC_cur, 1, hidden_size_);
+      deepcpu::merge_lstm_gates_to_memory(pCprev_hidden_size, pi, pf, pc, pCprev_hidden_size, hidden_size_);
+      // DumpMatrix("C", pCprev_hidden_size, 1, hidden_size_);
 #endif
 
-    // Output Gate
-    if (use_peepholes_)
-      deepcpu::elementwise_product(pCprev_hidden_size, SafeRawConstPointer<const T>(peephole_o_, 0, hidden_size_), po,
-                                   hidden_size_);
+      // Output Gate
+      if (use_peepholes_)
+        deepcpu::elementwise_product(pCprev_hidden_size, SafeRawConstPointer<const T>(peephole_o_, 0, hidden_size_), po,
+                                     hidden_size_);
 
-    // calculate 'ot'
-    const float* pBo = use_bias_ ? SafeRawConstPointer<T>(bias_WRo_, 0, hidden_size_) : nullptr;
-    clip_with_bias_ptr_(clip_, pBo, po, hidden_size_);
-    activation_f_.func(po, hidden_size_, activation_f_.alpha, activation_f_.beta);
-    // DumpMatrix("o" + row_str, po, 1, hidden_size_);
+      // calculate 'ot'
+      if (has_clip_) {
+        deepcpu::clip(clip_, po, hidden_size_);
+      }
+      activation_f_.func(po, hidden_size_, activation_f_.alpha, activation_f_.beta);
+      // DumpMatrix("o" + row_str, po, 1, hidden_size_);
+    }
+
+    float* pC_cur = pCprev_hidden_size;
 
     // calculate 'Ht'
     float* pH =
@@ -69,12 +69,17 @@ class UniDirectionalLstm {
   Direction direction_;
   bool input_forget_;
   float clip_;
+  bool has_clip_;
 
   bool batch_parallel_;
 
   bool use_bias_;
   bool use_peepholes_;
 
+  // Without peepholes or coupled input and forget gates, the i, o and f gates are independent of each other,
+  // and as they are contiguous in the output of the GEMM the activation for all three can be done in one call.
+  bool fuse_gate_activations_;
+
   int num_threads_ = -1;
 
   IAllocatorUniquePtr<T> output_iofc_ptr_;
@@ -87,10 +92,11 @@ class UniDirectionalLstm {
   gsl::span<T> internal_memory_prev_, batched_internal_memory_prev_;
   gsl::span<T> batched_internal_memory_clipped_;
 
-  IAllocatorUniquePtr<T> bias_WRi_ptr_, bias_WRf_ptr_, bias_WRo_ptr_, bias_WRc_ptr_;
+  // Wb[iofc] + Rb[iofc], in the same order as the gates in output_iofc_
+  IAllocatorUniquePtr<T> bias_WR_ptr_;
   IAllocatorUniquePtr<T> peephole_i_ptr_, peephole_f_ptr_, peephole_o_ptr_;
   IAllocatorUniquePtr<T> inputs_reverse_ptr_, outputs_reverse_ptr_;
-  gsl::span<T> bias_WRi_, bias_WRf_, bias_WRo_, bias_WRc_;
+  gsl::span<T> bias_WR_;
   gsl::span<T> inputs_reverse_, outputs_reverse_;
 
 #if defined(LSTM_NO_PEEPHOLE_COPY)
@@ -102,8 +108,6 @@ class UniDirectionalLstm {
   IAllocatorUniquePtr<int> sequence_lengths_ptr_;
   gsl::span<int> sequence_lengths_;
 
-  deepcpu::ClipWithBiasFuncPtr clip_with_bias_ptr_;
-
   ActivationInfo<deepcpu::ActivationFuncPtr> activation_f_;
   ActivationInfo<deepcpu::ActivationFuncPtr> activation_g_;
   ActivationInfo<deepcpu::LstmMergeGatesFuncPtr> activation_h_;
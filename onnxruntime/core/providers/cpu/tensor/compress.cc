@@ -3,6 +3,7 @@
 
 #include "core/providers/cpu/tensor/compress.h"
 #include "core/providers/common.h"
+#include "core/platform/threadpool.h"
 using namespace ::onnxruntime::common;
 
 namespace onnxruntime {
@@ -68,11 +69,12 @@ Status Compress::Compute(OpKernelContext* ctx) const {
   auto* output_data = static_cast<uint8_t*>(output_tensor->MutableDataRaw());
   auto element_bytes = input_tensor->DataType()->Size();
   bool is_string_type = input_tensor->IsDataTypeString();
-  int64_t output_index = 0;
 
+  // without an axis the flattened input is compressed, which is the same as compressing a single row
+  // with one element per entry
+  int64_t axes_left_stride = 1;
+  int64_t axes_right_stride = 1;
   if (has_axis_) {
-    int64_t axes_left_stride = 1;
-    int64_t axes_right_stride = 1;
     for (int i = 0; i < axis; ++i) {
       axes_left_stride *= input_dimensions[i];
     }
@@ -80,45 +82,57 @@ Status Compress::Compute(OpKernelContext* ctx) const {
     for (auto i = static_cast<size_t>(axis + 1); i < rank; ++i) {
       axes_right_stride *= input_dimensions[i];
     }
-    int64_t axes_included_right_stride = axes_right_stride * input_dimensions[axis];
-    int64_t axes_included_right_stride_bytes = axes_included_right_stride * element_bytes;
-    ORT_ENFORCE(axes_right_stride >= 0 &&
-                static_cast<uint64_t>(axes_right_stride) < std::numeric_limits<size_t>::max());
-    size_t axes_right_stride_bytes = 0;
-    if (!IAllocator::CalcMemSizeForArray(static_cast<size_t>(axes_right_stride), element_bytes,
-                                         &axes_right_stride_bytes))
-      return Status(ONNXRUNTIME, FAIL, "size overflow");
-    for (int i = 0; i < axes_left_stride; ++i) {
-      for (int j = 0; j < valid_condition_length; ++j) {
-        if (!condition_data[j]) {
-          continue;
-        }
-        if (is_string_type) {
-          for (int idxItem = 0; idxItem < axes_right_stride; ++idxItem) {
-            reinterpret_cast<std::string*>(output_data)[output_index + idxItem] =
-                reinterpret_cast<const std::string*>(input_data)[i * axes_included_right_stride + j * axes_right_stride + idxItem];
-          }
-          output_index += axes_right_stride;
-        } else {
-          memcpy(output_data + output_index, input_data + i * axes_included_right_stride_bytes + j * axes_right_stride_bytes, axes_right_stride_bytes);
-          output_index += axes_right_stride_bytes;
-        }
-      }
+  }
+  ORT_ENFORCE(axes_right_stride >= 0 &&
+              static_cast<uint64_t>(axes_right_stride) < std::numeric_limits<size_t>::max());
+  size_t axes_right_stride_bytes = 0;
+  if (!IAllocator::CalcMemSizeForArray(static_cast<size_t>(axes_right_stride), element_bytes,
+                                       &axes_right_stride_bytes))
+    return Status(ONNXRUNTIME, FAIL, "size overflow");
+
+  // consecutive selected entries form a run that is copied as a single block.
+  // run_offsets is the exclusive prefix sum of the run lengths, i.e. the output offset of each run in a row.
+  std::vector<int64_t> run_starts;
+  std::vector<int64_t> run_offsets{0};
+  for (int64_t j = 0; j < valid_condition_length; ++j) {
+    if (!condition_data[j]) {
+      continue;
     }
-  } else {
-    for (int i = 0; i < valid_condition_length; ++i) {
-      if (!condition_data[i]) {
-        continue;
-      }
-      if (is_string_type) {
-        reinterpret_cast<std::string*>(output_data)[output_index] = reinterpret_cast<const std::string*>(input_data)[i];
-      } else {
-        memcpy(output_data + output_index * element_bytes, input_data + i * element_bytes, element_bytes);
-      }
-      ++output_index;
+    int64_t run_end = j + 1;
+    while (run_end < valid_condition_length && condition_data[run_end]) {
+      ++run_end;
     }
+    run_starts.push_back(j);
+    run_offsets.push_back(run_offsets.back() + (run_end - j));
+    j = run_end;
   }
 
+  const auto num_runs = static_cast<int64_t>(run_starts.size());
+  const int64_t input_row_size = compress_input_length * axes_right_stride;
+  const int64_t output_row_size = positive_condition_count * axes_right_stride;
+
+  // every (row, run) pair is written to a distinct part of the output so they can be copied in parallel
+  const double cost = static_cast<double>(output_row_size) * element_bytes / static_cast<double>(num_runs);
+  concurrency::ThreadPool::TryParallelFor(
+      ctx->GetOperatorThreadPool(), static_cast<std::ptrdiff_t>(axes_left_stride * num_runs),
+      TensorOpCost{cost, cost, 0},
+      [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (std::ptrdiff_t n = first; n < last; ++n) {
+          const int64_t i = n / num_runs;
+          const int64_t run = n % num_runs;
+          const int64_t count = (run_offsets[run + 1] - run_offsets[run]) * axes_right_stride;
+          const int64_t input_offset = i * input_row_size + run_starts[run] * axes_right_stride;
+          const int64_t output_offset = i * output_row_size + run_offsets[run] * axes_right_stride;
+          if (is_string_type) {
+            std::copy_n(reinterpret_cast<const std::string*>(input_data) + input_offset, count,
+                        reinterpret_cast<std::string*>(output_data) + output_offset);
+          } else {
+            memcpy(output_data + output_offset * element_bytes, input_data + input_offset * element_bytes,
+                   static_cast<size_t>(count) * element_bytes);
+          }
+        }
+      });
+
   return Status::OK();
 }
 
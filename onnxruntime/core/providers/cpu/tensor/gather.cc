@@ -4,6 +4,7 @@
 //https://github.com/onnx/onnx/blob/main/docs/Operators.md#Gather
 #include "core/providers/cpu/tensor/gather.h"
 #include "core/common/common.h"
+#include "core/common/safeint.h"
 #include "core/framework/op_kernel_type_control_utils.h"
 #include "core/platform/threadpool.h"
 #include "core/providers/op_kernel_type_control.h"
@@ -100,30 +101,40 @@ Status GatherCopyData(const Tensor* indices_tensor, const uint8_t* src_base, uin
     }
   }
 
-  auto lambda = [&](int64_t index) {
-    int64_t batch = index / N;
-    int64_t i = index % N;
+  auto normalize_index = [axis_dim_limit](Tin idx) -> int64_t {
+    return idx < 0 ? static_cast<int64_t>(idx) + axis_dim_limit : static_cast<int64_t>(idx);
+  };
 
-    const int64_t src_offset_batch = batch * data_batch_bytes;
-    const int64_t dst_offset_batch = batch * gathered_batch_bytes;
-    Tin idx = indices_data[i];
-    idx = idx < 0 ? idx + static_cast<Tin>(axis_dim_limit) : idx;
-    const int64_t src_offset = src_offset_batch + idx * block_size;
-    const int64_t dst_offset = dst_offset_batch + i * block_size;
-
-    if (is_string_type) {
-      reinterpret_cast<std::string*>(dst_base)[dst_offset / element_bytes] =
-          reinterpret_cast<const std::string*>(src_base)[src_offset / element_bytes];
-    } else {
-      memcpy(dst_base + dst_offset, src_base + src_offset, block_size);
+  auto lambda = [&](ptrdiff_t first, ptrdiff_t last) {
+    for (int64_t index = first; index < last;) {
+      int64_t batch = index / N;
+      int64_t i = index % N;
+
+      const int64_t src_offset_batch = batch * data_batch_bytes;
+      const int64_t dst_offset_batch = batch * gathered_batch_bytes;
+      const int64_t idx = normalize_index(indices_data[i]);
+      const int64_t src_offset = src_offset_batch + idx * block_size;
+      const int64_t dst_offset = dst_offset_batch + i * block_size;
+
+      if (is_string_type) {
+        reinterpret_cast<std::string*>(dst_base)[dst_offset / element_bytes] =
+            reinterpret_cast<const std::string*>(src_base)[src_offset / element_bytes];
+        ++index;
+        continue;
+      }
+
+      // consecutive indices (e.g. a slice of an embedding table) read consecutive blocks from the input,
+      // so merge them into a single copy.
+      int64_t run = 1;
+      while (index + run < last && i + run < N && normalize_index(indices_data[i + run]) == idx + run) {
+        ++run;
+      }
+
+      memcpy(dst_base + dst_offset, src_base + src_offset, SafeInt<size_t>(run) * block_size);
+      index += run;
     }
   };
-  concurrency::ThreadPool::TryParallelFor(tp, M * N, static_cast<double>(block_size),
-                                          [&lambda](ptrdiff_t first, ptrdiff_t last) {
-                                            for (int index = static_cast<int>(first), end = static_cast<int>(last); index < end; ++index) {
-                                              lambda(index);
-                                            }
-                                          });
+  concurrency::ThreadPool::TryParallelFor(tp, M * N, static_cast<double>(block_size), lambda);
 
   return Status::OK();
 }
@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
 #include <string>
 #include "gather_elements.h"
 #include "onnxruntime_config.h"
@@ -119,12 +120,27 @@ static void core_impl(const Tensor* input_tensor, const Tensor* indices_tensor,
         auto input = input_data + CalculateOffset(inner_dim, input_shape_pitches, axis, indices_shape);
         auto indices = indices_data + inner_dim_size * inner_dim;
 
+        // Runs of indices that read consecutive input elements are copied as one block: along the innermost
+        // axis that is a run of consecutive indices, along any other axis a run of equal indices.
         if (innermost_axis) {
-          for (size_t i = 0; i < inner_dim_size; i++)
-            output[i] = input[GetIndex(i, indices, axis_size)];
+          for (size_t i = 0; i < inner_dim_size;) {
+            const int64_t index = GetIndex(i, indices, axis_size);
+            size_t run = 1;
+            while (i + run < inner_dim_size &&
+                   GetIndex(i + run, indices, axis_size) == index + static_cast<int64_t>(run))
+              ++run;
+            std::copy_n(input + index, run, output + i);
+            i += run;
+          }
         } else {
-          for (size_t i = 0; i < inner_dim_size; i++)
-            output[i] = input[GetIndex(i, indices, axis_size) * axis_pitch + i];
+          for (size_t i = 0; i < inner_dim_size;) {
+            const int64_t index = GetIndex(i, indices, axis_size);
+            size_t run = 1;
+            while (i + run < inner_dim_size && GetIndex(i + run, indices, axis_size) == index)
+              ++run;
+            std::copy_n(input + index * axis_pitch + i, run, output + i);
+            i += run;
+          }
         }
       }
       ORT_CATCH(const std::exception&) {
@@ -3,11 +3,15 @@
 
 #include "core/providers/cpu/tensor/grid_sample.h"
 
+#include <algorithm>
+
+#include "core/common/safeint.h"
 #include "core/framework/element_type_lists.h"
 #include "core/framework/TensorSeq.h"
 #include "core/providers/common.h"
 #include "core/framework/copy.h"
 #include "core/providers/op_kernel_type_control.h"
+#include "core/platform/threadpool.h"
 
 namespace onnxruntime {
 
@@ -86,34 +90,25 @@ void GsGetCubicCoeffs(float x, float coeffs[4]) {
 }
 
 template <typename T>
-T GsBicubicInterpolate(T p[4][4], float x, float y) {
-  float v[4] = {};
-  float coeffs[4] = {};
-  GsGetCubicCoeffs(x, coeffs);
-  for (int64_t i = 0; i < 4; i++) {
-    v[i] = coeffs[0] * p[i][0] + coeffs[1] * p[i][1] + coeffs[2] * p[i][2] + coeffs[3] * p[i][3];
-  }
-  GsGetCubicCoeffs(y, coeffs);
-  return static_cast<T>(coeffs[0] * v[0] + coeffs[1] * v[1] + coeffs[2] * v[2] + coeffs[3] * v[3]);
-}
-
-template <typename T>
-T GridSample<T>::PixelAtGrid(const T* image, int64_t r, int64_t c, int64_t H, int64_t W, float border[/* 4 */]) const {
-  T pixel = {};  // default 0
+int64_t GridSample<T>::PixelOffsetAtGrid(int64_t r, int64_t c, int64_t H, int64_t W, float border[/* 4 */]) const {
   if (padding_mode_ == Zeros) {
     if (c >= 0 && c < W && r >= 0 && r < H) {
-      pixel = image[r * W + c];
+      return r * W + c;
     }
+    return -1;  // zero padding
   } else if (padding_mode_ == Border) {
     c = std::clamp<int64_t>(c, 0, W - 1);
     r = std::clamp<int64_t>(r, 0, H - 1);
-    pixel = image[r * W + c];
   } else {  // (padding_mode_ == Reflection)
     c = static_cast<int64_t>(GsReflect(static_cast<T>(c), border[0], border[2]));
     r = static_cast<int64_t>(GsReflect(static_cast<T>(r), border[1], border[3]));
-    pixel = image[r * W + c];
   }
-  return pixel;
+  return r * W + c;
+}
+
+template <typename T>
+static inline T GsPixel(const T* image, int64_t offset) {
+  return offset >= 0 ? image[offset] : T{};
 }
 
 // When grid sampling, padding is applied before interpolation.
@@ -127,6 +122,8 @@ T GridSample<T>::PixelAtGrid(const T* image, int64_t r, int64_t c, int64_t H, in
 //         ...
 // would be interpolated as p = p00 / 4
 //
+// The sampling locations only depend on the grid, so the input offsets and interpolation weights of every
+// output location are computed once per batch and then shared by all the channels.
 template <typename T>
 Status GridSample<T>::Compute(OpKernelContext* context) const {
   const auto* input = context->Input<Tensor>(0);
@@ -168,75 +165,117 @@ Status GridSample<T>::Compute(OpKernelContext* context) const {
   }
   float border[] = {x_min, y_min, x_max, y_max};  // l-t-r-b
 
+  // number of input pixels read and of weights used per output location
+  const int64_t num_taps = mode_ == Nearest ? 1 : (mode_ == Bilinear ? 4 : 16);
+  const int64_t num_weights = mode_ == Nearest ? 0 : (mode_ == Bilinear ? 4 : 8);
+  const int64_t out_size = H_out * W_out;
+  std::vector<int64_t> offsets(SafeInt<size_t>(out_size) * num_taps);
+  std::vector<T> weights(SafeInt<size_t>(out_size) * num_weights);
+
   concurrency::ThreadPool* tp = H_out * W_out > 64 ? context->GetOperatorThreadPool() : nullptr;
   for (int64_t n = 0; n < N; n++) {
     const T* grid_data = grid->Data<T>() + n * (H_out * W_out) * 2;
-    concurrency::ThreadPool::TrySimpleParallelFor(
-        tp, C,
-        [&](std::ptrdiff_t c) {
-          const T* X_data = input->Data<T>() + (n * C + c) * (H_in * W_in);
-          T* Y_data = Y.MutableData<T>() + (n * C + c) * (H_out * W_out);
-
-          for (int64_t oy = 0; oy < H_out; oy++) {
-            for (int64_t ox = 0; ox < W_out; ox++) {
-              const T* gridpoint = grid_data + (oy * W_out + ox) * 2;
-              T* Y_gridpoint = Y_data + oy * W_out + ox;
-              auto nx = gridpoint[0];  // normalized location
-              auto ny = gridpoint[1];
-              auto x = GsDenormalize<T>(nx, W_in, align_corners_);  // actual location
-              auto y = GsDenormalize<T>(ny, H_in, align_corners_);
-
-              if (mode_ == Nearest) {
-                x = static_cast<T>(std::nearbyintf(static_cast<float>(x)));
-                y = static_cast<T>(std::nearbyintf(static_cast<float>(y)));
+
+    concurrency::ThreadPool::TryParallelFor(
+        tp, static_cast<std::ptrdiff_t>(out_size), static_cast<double>(num_taps * 8),
+        [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+          for (std::ptrdiff_t idx = first; idx < last; ++idx) {
+            const T* gridpoint = grid_data + idx * 2;
+            int64_t* offset = offsets.data() + idx * num_taps;
+            T* weight = weights.data() + idx * num_weights;
+            auto nx = gridpoint[0];  // normalized location
+            auto ny = gridpoint[1];
+            auto x = GsDenormalize<T>(nx, W_in, align_corners_);  // actual location
+            auto y = GsDenormalize<T>(ny, H_in, align_corners_);
+
+            if (mode_ == Nearest) {
+              x = static_cast<T>(std::nearbyintf(static_cast<float>(x)));
+              y = static_cast<T>(std::nearbyintf(static_cast<float>(y)));
+            }
+
+            if (x < x_min || x > x_max || y < y_min || y > y_max) {  // out of bound
+              if (padding_mode_ == Border) {
+                // use original border in both align_corner cases
+                x = std::clamp(x, static_cast<T>(0), static_cast<T>(W_in - 1));
+                y = std::clamp(y, static_cast<T>(0), static_cast<T>(H_in - 1));
+              } else if (padding_mode_ == Reflection) {
+                x = GsReflect(x, x_min, x_max);
+                y = GsReflect(y, y_min, y_max);
               }
+            }  // out of bound
 
-              if (x < x_min || x > x_max || y < y_min || y > y_max) {  // out of bound
-                if (padding_mode_ == Border) {
-                  // use original border in both align_corner cases
-                  x = std::clamp(x, static_cast<T>(0), static_cast<T>(W_in - 1));
-                  y = std::clamp(y, static_cast<T>(0), static_cast<T>(H_in - 1));
-                } else if (padding_mode_ == Reflection) {
-                  x = GsReflect(x, x_min, x_max);
-                  y = GsReflect(y, y_min, y_max);
-                }
-              }  // out of bound
+            if (mode_ == Nearest) {
+              // x, y are integers in all padding modes
+              offset[0] = PixelOffsetAtGrid(static_cast<int64_t>(y), static_cast<int64_t>(x), H_in, W_in, border);
+            } else if (mode_ == Bilinear) {
+              int64_t x1 = static_cast<int64_t>(std::floor(x));
+              int64_t y1 = static_cast<int64_t>(std::floor(y));
+              int64_t x2 = x1 + 1;
+              int64_t y2 = y1 + 1;
 
-              if (mode_ == Nearest) {
-                // x, y are integers in all padding modes
-                *Y_gridpoint = PixelAtGrid(X_data, static_cast<int64_t>(y), static_cast<int64_t>(x), H_in, W_in, border);
-                continue;
+              offset[0] = PixelOffsetAtGrid(y1, x1, H_in, W_in, border);
+              offset[1] = PixelOffsetAtGrid(y1, x2, H_in, W_in, border);
+              offset[2] = PixelOffsetAtGrid(y2, x1, H_in, W_in, border);
+              offset[3] = PixelOffsetAtGrid(y2, x2, H_in, W_in, border);
+
+              weight[0] = static_cast<T>(x2) - x;  // dx2
+              weight[1] = x - static_cast<T>(x1);  // dx1
+              weight[2] = static_cast<T>(y2) - y;  // dy2
+              weight[3] = y - static_cast<T>(y1);  // dy1
+            } else {  // (mode_ == Bicubic)
+              int64_t x0 = static_cast<int64_t>(std::floor(x)) - 1;  // top-left corner of the bbox
+              int64_t y0 = static_cast<int64_t>(std::floor(y)) - 1;
+              for (int64_t h = 0; h < 4; h++) {
+                for (int64_t w = 0; w < 4; w++) {
+                  offset[h * 4 + w] = PixelOffsetAtGrid(h + y0, w + x0, H_in, W_in, border);
+                }
               }
+              T dx = static_cast<T>(x - x0 - 1);
+              T dy = static_cast<T>(y - y0 - 1);
+              float coeffs[4] = {};
+              GsGetCubicCoeffs(static_cast<float>(dx), coeffs);
+              std::copy_n(coeffs, 4, weight);
+              GsGetCubicCoeffs(static_cast<float>(dy), coeffs);
+              std::copy_n(coeffs, 4, weight + 4);
+            }
+          }
+        });
 
-              if (mode_ == Bilinear) {
-                int64_t x1 = static_cast<int64_t>(std::floor(x));
-                int64_t y1 = static_cast<int64_t>(std::floor(y));
-                int64_t x2 = x1 + 1;
-                int64_t y2 = y1 + 1;
-
-                T p11 = PixelAtGrid(X_data, y1, x1, H_in, W_in, border);
-                T p12 = PixelAtGrid(X_data, y1, x2, H_in, W_in, border);
-                T p21 = PixelAtGrid(X_data, y2, x1, H_in, W_in, border);
-                T p22 = PixelAtGrid(X_data, y2, x2, H_in, W_in, border);
-
-                T dx2 = static_cast<T>(x2) - x;
-                T dx1 = x - static_cast<T>(x1);
-                T dy2 = static_cast<T>(y2) - y;
-                T dy1 = y - static_cast<T>(y1);
-                *Y_gridpoint = dy2 * (dx2 * p11 + dx1 * p12) + dy1 * (dx2 * p21 + dx1 * p22);
+    // interpolate all channels, one output row at a time
+    concurrency::ThreadPool::TryParallelFor(
+        tp, static_cast<std::ptrdiff_t>(C * H_out), static_cast<double>(W_out * num_taps * 2),
+        [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+          for (std::ptrdiff_t row = first; row < last; ++row) {
+            const int64_t c = row / H_out;
+            const int64_t oy = row % H_out;
+            const T* X_data = input->Data<T>() + (n * C + c) * (H_in * W_in);
+            T* Y_row = Y.MutableData<T>() + (n * C + c) * (H_out * W_out) + oy * W_out;
+            const int64_t* offset = offsets.data() + oy * W_out * num_taps;
+            const T* weight = weights.data() + oy * W_out * num_weights;
+
+            if (mode_ == Nearest) {
+              for (int64_t ox = 0; ox < W_out; ox++) {
+                Y_row[ox] = GsPixel(X_data, offset[ox]);
+              }
+            } else if (mode_ == Bilinear) {
+              for (int64_t ox = 0; ox < W_out; ox++, offset += 4, weight += 4) {
+                T p11 = GsPixel(X_data, offset[0]);
+                T p12 = GsPixel(X_data, offset[1]);
+                T p21 = GsPixel(X_data, offset[2]);
+                T p22 = GsPixel(X_data, offset[3]);
+                Y_row[ox] = weight[2] * (weight[0] * p11 + weight[1] * p12) +
+                            weight[3] * (weight[0] * p21 + weight[1] * p22);
               }
-              if (mode_ == Bicubic) {
-                int64_t x0 = static_cast<int64_t>(std::floor(x)) - 1;  // top-left corner of the bbox
-                int64_t y0 = static_cast<int64_t>(std::floor(y)) - 1;
-                T p[4][4] = {};  // [H][W]
-                for (int64_t h = 0; h < 4; h++) {
-                  for (int64_t w = 0; w < 4; w++) {
-                    p[h][w] = PixelAtGrid(X_data, h + y0, w + x0, H_in, W_in, border);
-                  }
+            } else {  // (mode_ == Bicubic)
+              for (int64_t ox = 0; ox < W_out; ox++, offset += 16, weight += 8) {
+                float v[4] = {};
+                for (int64_t i = 0; i < 4; i++) {
+                  v[i] = weight[0] * GsPixel(X_data, offset[i * 4 + 0]) +
+                         weight[1] * GsPixel(X_data, offset[i * 4 + 1]) +
+                         weight[2] * GsPixel(X_data, offset[i * 4 + 2]) +
+                         weight[3] * GsPixel(X_data, offset[i * 4 + 3]);
                 }
-                T dx = static_cast<T>(x - x0 - 1);
-                T dy = static_cast<T>(y - y0 - 1);
-                *Y_gridpoint = GsBicubicInterpolate(p, static_cast<float>(dx), static_cast<float>(dy));
+                Y_row[ox] = static_cast<T>(weight[4] * v[0] + weight[5] * v[1] + weight[6] * v[2] + weight[7] * v[3]);
               }
             }
           }
@@ -53,7 +53,8 @@ class GridSample final : public OpKernel {
     Reflection
   };
 
-  T PixelAtGrid(const T* image, int64_t r, int64_t c, int64_t H, int64_t W, float border[/* 4 */]) const;
+  // offset of the input pixel at (r, c) after padding, or -1 when it reads the zero padding
+  int64_t PixelOffsetAtGrid(int64_t r, int64_t c, int64_t H, int64_t W, float border[/* 4 */]) const;
 
   GridSampleInterpolationMode mode_{Bilinear};
   GridSamplePaddingMode padding_mode_{Zeros};
@@ -3,10 +3,13 @@
 
 #include "core/providers/cpu/tensor/nonzero_op.h"
 
+#include <algorithm>
 #include <cassert>
+#include <numeric>
 #include <vector>
 
-#include "core/util/math_cpuonly.h"
+#include "core/common/safeint.h"
+#include "core/platform/threadpool.h"
 
 namespace onnxruntime {
 // kernel builder functions
@@ -51,6 +54,11 @@ NONZERO_TYPED_KERNEL(float)
 #undef NONZERO_9_TYPED_KERNEL
 #undef NONZERO_TYPED_KERNEL
 
+namespace {
+// minimum number of input elements handled by one block of the count/write passes
+constexpr int64_t kNonZeroMinBlockSize = 16 * 1024;
+}  // namespace
+
 template <typename T>
 Status NonZero<T>::Compute(OpKernelContext* context) const {
   const auto X = context->Input<Tensor>(0);
@@ -59,59 +67,78 @@ Status NonZero<T>::Compute(OpKernelContext* context) const {
   const auto& X_shape = X->Shape();
   assert(X_shape.Size() >= 0);
 
-  const Eigen::Index coordinate_size = X_shape.IsScalar() ? 1 : X_shape.NumDimensions();
-  std::vector<int64_t> non_zero_indices_buffer{};
-  // reserve enough space for indices for every element of X
-  non_zero_indices_buffer.reserve(X_shape.Size() * coordinate_size);
-
+  // a scalar is handled as a tensor of shape {1}
+  const TensorShapeVector dims = X_shape.IsScalar() ? TensorShapeVector{1} : X_shape.AsShapeVector();
+  const int64_t coordinate_size = static_cast<int64_t>(dims.size());
+  const int64_t size = X_shape.Size();
   const T* data = X->Data<T>();
 
-  if (X_shape.IsScalar()) {
-    const T& value = *data;
-    if (value != T{}) {
-      non_zero_indices_buffer.push_back(0);
+  // Split the input into blocks. Non-zero values are counted per block in parallel, an exclusive prefix sum of
+  // the counts gives the output offset of every block and the coordinates are then written in parallel.
+  concurrency::ThreadPool* tp = context->GetOperatorThreadPool();
+  const std::ptrdiff_t num_blocks = static_cast<std::ptrdiff_t>(
+      std::max<int64_t>(1, std::min<int64_t>(concurrency::ThreadPool::DegreeOfParallelism(tp),
+                                             size / kNonZeroMinBlockSize)));
+  auto block_start = [size, num_blocks](std::ptrdiff_t block) {
+    return static_cast<int64_t>(SafeInt<int64_t>(size) * block / num_blocks);
+  };
+
+  std::vector<int64_t> block_offsets(num_blocks + 1, 0);
+  concurrency::ThreadPool::TrySimpleParallelFor(tp, num_blocks, [&](std::ptrdiff_t block) {
+    int64_t count = 0;
+    for (int64_t i = block_start(block), end = block_start(block + 1); i < end; ++i) {
+      count += data[i] != T{} ? 1 : 0;
     }
-  } else {
-    std::vector<int64_t> coordinate(coordinate_size, 0);
+    block_offsets[block + 1] = count;
+  });
+  std::partial_sum(block_offsets.begin(), block_offsets.end(), block_offsets.begin());
 
-    // as we iterate the entries, increment the coordinate for the current entry
-    // e.g. if shape is {2,2}, we start with 0,0 increment to 0,1 increment to 1,0 and finally 1,1
-    auto increment_coordinate = [&coordinate, &coordinate_size, &X_shape]() {
-      for (Eigen::Index idx = coordinate_size - 1; idx >= 0; --idx) {
-        int64_t& cur_coord = coordinate[idx];
-        if (cur_coord != X_shape[idx] - 1) {
-          ++cur_coord;
-          break;
-        }
-        cur_coord = 0;
-      }
-    };
+  const int64_t num_non_zero_values = block_offsets[num_blocks];
+  Tensor* const Y = context->Output(0, {coordinate_size, num_non_zero_values});
+  ORT_ENFORCE(Y, "failed to get first output!");
 
-    for (size_t i = 0, end = X_shape.Size(); i < end; ++i) {
-      const T& value = *data++;
-      if (value != T{}) {
-        non_zero_indices_buffer.insert(non_zero_indices_buffer.end(),
-                                       coordinate.begin(), coordinate.end());
-      }
+  if (num_non_zero_values == 0) {
+    return Status::OK();
+  }
 
-      increment_coordinate();
+  // the output is transposed: Y[d, k] is coordinate d of the k-th non-zero value
+  int64_t* y_data = Y->MutableData<int64_t>();
+  concurrency::ThreadPool::TrySimpleParallelFor(tp, num_blocks, [&](std::ptrdiff_t block) {
+    int64_t output_idx = block_offsets[block];
+    if (output_idx == block_offsets[block + 1]) {
+      return;
     }
-  }
 
-  const Eigen::Index num_non_zero_values = non_zero_indices_buffer.size() / coordinate_size;
+    const int64_t start = block_start(block);
+    const int64_t end = block_start(block + 1);
 
-  // transpose result for output
-  ConstEigenMatrixMapRowMajor<int64_t> non_zero_indices_matrix{
-      non_zero_indices_buffer.data(),
-      num_non_zero_values, coordinate_size};
+    // coordinate of the first entry in the block
+    TensorShapeVector coordinate(coordinate_size, 0);
+    for (int64_t idx = coordinate_size - 1, remaining = start; idx >= 0; --idx) {
+      coordinate[idx] = remaining % dims[idx];
+      remaining /= dims[idx];
+    }
 
-  Tensor* const Y = context->Output(0, {coordinate_size, num_non_zero_values});
-  ORT_ENFORCE(Y, "failed to get first output!");
+    for (int64_t i = start; i < end; ++i) {
+      if (data[i] != T{}) {
+        for (int64_t d = 0; d < coordinate_size; ++d) {
+          y_data[d * num_non_zero_values + output_idx] = coordinate[d];
+        }
+        ++output_idx;
+      }
 
-  EigenMatrixMapRowMajor<int64_t> y_matrix{
-      Y->MutableData<int64_t>(),
-      coordinate_size, num_non_zero_values};
-  y_matrix = non_zero_indices_matrix.transpose();
+      // as we iterate the entries, increment the coordinate for the current entry
+      // e.g. if shape is {2,2}, we start with 0,0 increment to 0,1 increment to 1,0 and finally 1,1
+      for (int64_t idx = coordinate_size - 1; idx >= 0; --idx) {
+        int64_t& cur_coord = coordinate[idx];
+        if (cur_coord != dims[idx] - 1) {
+          ++cur_coord;
+          break;
+        }
+        cur_coord = 0;
+      }
+    }
+  });
 
   return Status::OK();
 }
@@ -10,6 +10,7 @@
 #include "core/framework/element_type_lists.h"
 #include "core/framework/op_kernel.h"
 #include "core/framework/op_kernel_type_control_utils.h"
+#include "core/platform/threadpool.h"
 #include "core/providers/common.h"
 #include "core/providers/op_kernel_type_control.h"
 #if defined(ENABLE_TRAINING) || defined(ENABLE_TRAINING_OPS)
@@ -199,7 +200,7 @@ template <class Tdata, typename FuncT>
 Status ScatterData(
     const FuncT& func,
     const Tensor* data_input, const std::vector<int64_t>& indices_data, const Tensor* updates_input, int64_t axis,
-    Tensor* data_output) {
+    Tensor* data_output, concurrency::ThreadPool* tp = nullptr) {
   const TensorShape& input_data_shape = data_input->Shape();
 
   const auto input_elements = input_data_shape.Size();
@@ -229,29 +230,17 @@ Status ScatterData(
   const auto num_dims = input_data_shape.NumDimensions();
   assert(num_dims > 0);
 
-  // Allocate and zero out counts. The input/output is of the same rank as
-  // indices/updates but the actual dimensions of indices/updates must be less or equal
-  // than that of input/output because we can update no more elements than
-  // the input contains. As we walk through the indices/updates
-  // we maintain dimension count as we will need to use it
-  // to compute output offset but using input/output dim values.
-  // We treat the whole array as a number where each element having
-  // different cardinality according to the upd_shape dimensions.
-  // As each counter reaches its max (upd_shape) it resets to zero
-  // and we carry to the more significant dim (right to left)
-  std::vector<int64_t> dim_counters(num_dims);
-
   // This vector contains number of elements under the dimension.
   // For example, for the dimensions of [4, 2, 3] the vector
   // would contain [6, 3, 1] since for each count of dim 1 it
   // contains 3 elements of dim 2.
   // For each count of dim 0 we would have 2x3=6 elements.
   // The last value is always 1.
-  // We use it to compute output element offset. For a given value of
-  // counters we multiple each counter value per corresponding entry of dim_block_size value
-  // and add up resulting the output element offset. However, for dimensions
-  // that are equal to the specified axis value we take indices_data[index]
-  // instead of the counter value.
+  // We use it to compute output element offset. For a given position in the updates
+  // we multiple each coordinate per corresponding entry of dim_block_size value
+  // and add up resulting the output element offset. However, for the dimension
+  // that is equal to the specified axis value we take indices_data[index]
+  // instead of the coordinate.
   // E.g. for 3-dim and axis=0
   //    output[indices[i][j][k]][j][k] = updates[i][j][k]
   // for axis 1
@@ -268,58 +257,72 @@ Status ScatterData(
     }
   }
 
-  const auto* update_data = static_cast<const Tdata*>(updates_input->DataRaw());
-  // For every update we compute the destination offset and copy it there
-  for (int64_t index = 0; index < num_indices;) {
-    const auto axis_idx = indices_data[index];
-
-    // Compute the offset
-    // See comments above for dim_block_size
-    size_t dst_offset = 0;
-    for (size_t i = 0; i < num_dims; ++i) {
-      if (i == size_t(axis)) {
-        // replace the counter with the update index for this dim
-        dst_offset += axis_idx * dim_block_size[i];
-      } else {
-        dst_offset += dim_counters[i] * dim_block_size[i];
-      }
-    }
+  if (num_indices == 0) {
+    return Status::OK();
+  }
 
-    func(dst_base + dst_offset, update_data + index);
+  // Updates that differ in any coordinate other than 'axis' always write to different output elements.
+  // Split the updates into slices along 'axis' (one per combination of the other coordinates) and process
+  // the slices in parallel. The updates within a slice are applied in order by a single thread, so duplicate
+  // indices and the reductions behave exactly as in a serial loop.
+  const int64_t axis_dim = upd_shape[axis];
+  const int64_t upd_inner_size = upd_shape.SizeFromDimension(axis + 1);
+  const int64_t num_slices = num_indices / axis_dim;
+
+  const auto* update_data = static_cast<const Tdata*>(updates_input->DataRaw());
+  const int64_t axis_block_size = dim_block_size[axis];
+
+  concurrency::ThreadPool::TryParallelFor(
+      tp, static_cast<std::ptrdiff_t>(num_slices), static_cast<double>(axis_dim),
+      [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (int64_t slice = first; slice < last; ++slice) {
+          const int64_t outer = slice / upd_inner_size;
+          const int64_t inner = slice % upd_inner_size;
+
+          // Compute the offset of the slice using the update coordinates for all dims except 'axis'
+          // See comments above for dim_block_size
+          int64_t dst_offset = 0;
+          int64_t remaining = inner;
+          for (auto i = int64_t(num_dims - 1); i > axis; --i) {
+            dst_offset += (remaining % upd_shape[i]) * dim_block_size[i];
+            remaining /= upd_shape[i];
+          }
+
+          remaining = outer;
+          for (auto i = axis - 1; i >= 0; --i) {
+            dst_offset += (remaining % upd_shape[i]) * dim_block_size[i];
+            remaining /= upd_shape[i];
+          }
+
+          int64_t index = outer * axis_dim * upd_inner_size + inner;
+          for (int64_t a = 0; a < axis_dim; ++a, index += upd_inner_size) {
+            func(dst_base + dst_offset + indices_data[index] * axis_block_size, update_data + index);
+          }
+        }
+      });
 
-    if (++index == num_indices) {
-      break;
-    }
-    // Increment counters
-    // See comments for dim_counters above
-    for (auto i = int64_t(num_dims - 1); i >= 0; --i) {
-      auto v = ++dim_counters[i];
-      assert(v <= upd_shape[i]);
-      if (v < upd_shape[i]) {
-        // No carry, done
-        break;
-      }
-      // No carry for the most significant dim
-      assert(i > 0);
-      dim_counters[i] = 0;
-    }
-  }
   return Status::OK();
 }
 
 template <typename TData>
 struct ScatterDataDispatchTarget {
   Status operator()(const Tensor* data_input, const std::vector<int64_t>& indices_data, const Tensor* updates_input, int64_t axis,
-                    const std::string &reduction, Tensor* data_output) const {
+                    const std::string &reduction, Tensor* data_output, concurrency::ThreadPool* tp) const {
+    // the reductions that are not implemented for a type throw from Func_Add/Func_Mul, so run those on the
+    // calling thread to report the error instead of throwing from a thread pool worker
+    constexpr bool is_16bit_float = std::is_same<TData, MLFloat16>::value || std::is_same<TData, BFloat16>::value;
+    constexpr bool has_add = !is_16bit_float;
+    constexpr bool has_mul = !is_16bit_float && !std::is_same<TData, std::string>::value;
+
     if(reduction == "add")
       return ScatterData<TData>(
-          Func_Add<TData>(), data_input, indices_data, updates_input, axis, data_output);
+          Func_Add<TData>(), data_input, indices_data, updates_input, axis, data_output, has_add ? tp : nullptr);
     else if(reduction == "mul")
       return ScatterData<TData>(
-          Func_Mul<TData>(), data_input, indices_data, updates_input, axis, data_output);
+          Func_Mul<TData>(), data_input, indices_data, updates_input, axis, data_output, has_mul ? tp : nullptr);
     else // if (reduction == "none")
       return ScatterData<TData>(
-          Func_Assignment<TData>(), data_input, indices_data, updates_input, axis, data_output);
+          Func_Assignment<TData>(), data_input, indices_data, updates_input, axis, data_output, tp);
   }
 };
 
@@ -389,7 +392,8 @@ Status Scatter<EnabledDataTypes>::Compute(OpKernelContext* context) const {
 
   utils::MLTypeCallDispatcherFromTypeList<EnabledDataTypes> dispatcher{data_type};
   status = dispatcher.template InvokeRet<Status, ScatterDataDispatchTarget>(
-      data_input, indices_data, updates_input, axis, this->reduction_, data_output);
+      data_input, indices_data, updates_input, axis, this->reduction_, data_output,
+      context->GetOperatorThreadPool());
 
   return status;
 }
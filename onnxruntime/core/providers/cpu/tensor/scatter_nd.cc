@@ -3,6 +3,8 @@
 
 #include "core/providers/cpu/tensor/scatter_nd.h"
 
+#include <algorithm>
+
 #include "core/framework/element_type_lists.h"
 #include "core/framework/op_kernel_type_control_utils.h"
 #include "core/platform/threadpool.h"
@@ -269,39 +271,58 @@ struct ScatterNDDispatchTarget {
     Prepare<TData> prepare;
     ORT_RETURN_IF_ERROR(PrepareForCompute(context, prepare));
 
-    auto lambda = [&](int64_t i) {
+    // apply the update i to the elements [begin, begin + count) of its output slice
+    auto lambda = [&](int64_t i, int64_t begin, int64_t num_elements) {
+      const auto count = static_cast<uint64_t>(num_elements);
+      TData* output = prepare.output_base + prepare.element_offsets[i] + begin;
+      const TData* update = prepare.input_base + i * prepare.element_to_copy + begin;
       switch (reduction) {
         case ScatterND::Reduction::Add: {
           auto func = Func_Add_ND<TData>();
-          func(
-              prepare.output_base + prepare.element_offsets[i],
-              prepare.input_base + i * prepare.element_to_copy,
-              prepare.element_to_copy);
+          func(output, update, count);
         } break;
         case ScatterND::Reduction::Mul: {
           auto func = Func_Mul_ND<TData>();
-          func(
-              prepare.output_base + prepare.element_offsets[i],
-              prepare.input_base + i * prepare.element_to_copy,
-              prepare.element_to_copy);
+          func(output, update, count);
         } break;
         default:
         case ScatterND::Reduction::None: {
           auto func = Func_Copy_ND<TData>();
-          func(
-              prepare.output_base + prepare.element_offsets[i],
-              prepare.input_base + i * prepare.element_to_copy,
-              prepare.element_to_copy);
+          func(output, update, count);
         } break;
       }
     };
-    concurrency::ThreadPool::TryParallelFor(
-        tp, prepare.element_offsets.size(), static_cast<double>(prepare.element_to_copy),
-        [&lambda](ptrdiff_t first, ptrdiff_t last) {
-          for (int i = static_cast<int>(first), end = static_cast<int>(last); i < end; ++i) {
-            lambda(i);
-          }
-        });
+
+    const auto num_updates = static_cast<std::ptrdiff_t>(prepare.element_offsets.size());
+    const auto element_to_copy = static_cast<int64_t>(prepare.element_to_copy);
+
+    // With a reduction, updates that point to the same output slice must not be applied concurrently.
+    // In that case split the work by the elements of the slices instead, so that each output element is
+    // only touched by one thread and the updates are applied in order.
+    bool has_duplicate_offsets = false;
+    if (reduction != ScatterND::Reduction::None) {
+      std::vector<uint64_t> sorted_offsets(prepare.element_offsets.cbegin(), prepare.element_offsets.cend());
+      std::sort(sorted_offsets.begin(), sorted_offsets.end());
+      has_duplicate_offsets = std::adjacent_find(sorted_offsets.cbegin(), sorted_offsets.cend()) != sorted_offsets.cend();
+    }
+
+    if (has_duplicate_offsets) {
+      concurrency::ThreadPool::TryParallelFor(
+          tp, static_cast<std::ptrdiff_t>(element_to_copy), static_cast<double>(num_updates),
+          [&lambda, num_updates](std::ptrdiff_t first, std::ptrdiff_t last) {
+            for (std::ptrdiff_t i = 0; i < num_updates; ++i) {
+              lambda(i, first, last - first);
+            }
+          });
+    } else {
+      concurrency::ThreadPool::TryParallelFor(
+          tp, num_updates, static_cast<double>(element_to_copy),
+          [&lambda, element_to_copy](std::ptrdiff_t first, std::ptrdiff_t last) {
+            for (std::ptrdiff_t i = first; i < last; ++i) {
+              lambda(i, 0, element_to_copy);
+            }
+          });
+    }
     return Status::OK();
   }
 };
@@ -3,11 +3,15 @@
 
 #include "core/providers/cpu/tensor/transpose.h"
 
+#include <algorithm>
+#include <numeric>
+
 #include "core/framework/element_type_lists.h"
 #include "core/framework/utils.h"
 #include "core/framework/transpose_helper.h"
 #include "core/framework/op_kernel_type_control_utils.h"
 #include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
 #include "core/providers/op_kernel_type_control.h"
 #include "utils.h"
 
@@ -247,9 +251,220 @@ static void DoTransposeEltWise(int64_t num_axes, gsl::span<const int64_t> target
   }
 }
 
+// Transpose problem after dropping the axes of size 1 and merging input axes that stay adjacent and in
+// order in the output, e.g. shape (B, S, N, H) with perm (0, 2, 1, 3) and B == 1 becomes (S, N, H) with
+// perm (1, 0, 2).
+struct ReducedTranspose {
+  InlinedVector<int64_t> input_dims;
+  InlinedVector<size_t> perm;
+};
+
+static ReducedTranspose ReduceTranspose(const gsl::span<const size_t>& permutations,
+                                        gsl::span<const int64_t> input_dims) {
+  const size_t rank = input_dims.size();
+
+  // renumber the input axes that are not 1
+  InlinedVector<size_t> kept_axis(rank, 0);
+  size_t num_kept = 0;
+  for (size_t i = 0; i < rank; ++i) {
+    if (input_dims[i] != 1) {
+      kept_axis[i] = num_kept++;
+    }
+  }
+
+  // group consecutive output axes that are also consecutive input axes
+  InlinedVector<size_t> group_first;  // first (renumbered) input axis of each group, in output order
+  InlinedVector<int64_t> group_dim;
+  size_t prev = 0;
+  for (size_t j = 0; j < rank; ++j) {
+    const size_t axis = permutations[j];
+    if (input_dims[axis] == 1) {
+      continue;
+    }
+    if (!group_first.empty() && kept_axis[axis] == prev + 1) {
+      group_dim.back() *= input_dims[axis];
+    } else {
+      group_first.push_back(kept_axis[axis]);
+      group_dim.push_back(input_dims[axis]);
+    }
+    prev = kept_axis[axis];
+  }
+
+  // the groups sorted by their first input axis are the axes of the reduced input
+  const size_t num_groups = group_first.size();
+  InlinedVector<size_t> input_order(num_groups);
+  std::iota(input_order.begin(), input_order.end(), size_t{0});
+  std::sort(input_order.begin(), input_order.end(),
+            [&group_first](size_t lhs, size_t rhs) { return group_first[lhs] < group_first[rhs]; });
+
+  ReducedTranspose reduced;
+  reduced.input_dims.resize(num_groups);
+  reduced.perm.resize(num_groups);
+  for (size_t i = 0; i < num_groups; ++i) {
+    reduced.input_dims[i] = group_dim[input_order[i]];
+    reduced.perm[input_order[i]] = i;
+  }
+
+  return reduced;
+}
+
+// The transpose of the innermost plane is done in square tiles so that both the reads and the writes of a tile
+// stay within a few cache lines.
+constexpr int64_t kTransposeTileSize = 8;
+
+// target[x * target_stride + y] = source[y * source_stride + x]
+template <typename T>
+static inline void TransposeTile(const T* source, T* target, int64_t n_x, int64_t n_y,
+                                 int64_t source_stride, int64_t target_stride) {
+  if (n_x == kTransposeTileSize && n_y == kTransposeTileSize) {
+    // fixed trip counts so the compiler fully unrolls and vectorizes the full tiles
+    for (int64_t x = 0; x < kTransposeTileSize; ++x) {
+      for (int64_t y = 0; y < kTransposeTileSize; ++y) {
+        target[x * target_stride + y] = source[y * source_stride + x];
+      }
+    }
+  } else {
+    for (int64_t x = 0; x < n_x; ++x) {
+      for (int64_t y = 0; y < n_y; ++y) {
+        target[x * target_stride + y] = source[y * source_stride + x];
+      }
+    }
+  }
+}
+
+template <typename T>
+static void TypedBlockedTranspose(const ReducedTranspose& t, const T* source, T* target,
+                                  concurrency::ThreadPool* tp) {
+  const size_t rank = t.perm.size();
+
+  InlinedVector<int64_t> input_strides(rank, 1);
+  for (size_t i = rank - 1; i > 0; --i) {
+    input_strides[i - 1] = input_strides[i] * t.input_dims[i];
+  }
+
+  InlinedVector<int64_t> output_dims(rank);
+  InlinedVector<int64_t> output_strides(rank, 1);
+  for (size_t j = 0; j < rank; ++j) {
+    output_dims[j] = t.input_dims[t.perm[j]];
+  }
+  for (size_t j = rank - 1; j > 0; --j) {
+    output_strides[j - 1] = output_strides[j] * output_dims[j];
+  }
+
+  // the innermost output axis, and the output axis holding the innermost input axis
+  const size_t y_axis = rank - 1;
+  const size_t x_axis = static_cast<size_t>(std::find(t.perm.begin(), t.perm.end(), rank - 1) - t.perm.begin());
+
+  // every other output axis is iterated over as an outer loop
+  InlinedVector<int64_t> outer_dims;
+  InlinedVector<int64_t> outer_input_strides;
+  InlinedVector<int64_t> outer_output_strides;
+  int64_t num_outer = 1;
+  for (size_t j = 0; j < rank; ++j) {
+    if (j == y_axis || j == x_axis) {
+      continue;
+    }
+    outer_dims.push_back(output_dims[j]);
+    outer_input_strides.push_back(input_strides[t.perm[j]]);
+    outer_output_strides.push_back(output_strides[j]);
+    num_outer *= output_dims[j];
+  }
+
+  auto outer_offsets = [&](int64_t outer, int64_t& input_offset, int64_t& output_offset) {
+    input_offset = 0;
+    output_offset = 0;
+    for (size_t k = outer_dims.size(); k > 0; --k) {
+      const int64_t idx = outer % outer_dims[k - 1];
+      outer /= outer_dims[k - 1];
+      input_offset += idx * outer_input_strides[k - 1];
+      output_offset += idx * outer_output_strides[k - 1];
+    }
+  };
+
+  if (x_axis == y_axis) {
+    // the innermost axis is not moved: copy contiguous chunks
+    const int64_t chunk = output_dims[y_axis];
+    const double bytes = static_cast<double>(chunk * sizeof(T));
+    concurrency::ThreadPool::TryParallelFor(
+        tp, static_cast<std::ptrdiff_t>(num_outer), TensorOpCost{bytes, bytes, 0},
+        [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+          for (std::ptrdiff_t outer = first; outer < last; ++outer) {
+            int64_t input_offset, output_offset;
+            outer_offsets(outer, input_offset, output_offset);
+            memcpy(target + output_offset, source + input_offset, chunk * sizeof(T));
+          }
+        });
+    return;
+  }
+
+  // the plane of the innermost input axis (x) and the innermost output axis (y) is transposed in tiles.
+  // one unit of work is a row of tiles along y for one outer index.
+  const int64_t n_x = output_dims[x_axis];
+  const int64_t n_y = output_dims[y_axis];
+  const int64_t y_input_stride = input_strides[t.perm[y_axis]];
+  const int64_t x_output_stride = output_strides[x_axis];
+  const int64_t num_x_tiles = (n_x + kTransposeTileSize - 1) / kTransposeTileSize;
+  const double bytes = static_cast<double>(kTransposeTileSize * n_y * sizeof(T));
+
+  concurrency::ThreadPool::TryParallelFor(
+      tp, static_cast<std::ptrdiff_t>(num_outer * num_x_tiles), TensorOpCost{bytes, bytes, 0},
+      [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (std::ptrdiff_t unit = first; unit < last; ++unit) {
+          int64_t input_offset, output_offset;
+          outer_offsets(unit / num_x_tiles, input_offset, output_offset);
+
+          const int64_t x0 = (unit % num_x_tiles) * kTransposeTileSize;
+          const int64_t tile_x = std::min(kTransposeTileSize, n_x - x0);
+          const T* src = source + input_offset + x0;
+          T* dst = target + output_offset + x0 * x_output_stride;
+          for (int64_t y0 = 0; y0 < n_y; y0 += kTransposeTileSize) {
+            TransposeTile(src + y0 * y_input_stride, dst + y0, tile_x, std::min(kTransposeTileSize, n_y - y0),
+                          y_input_stride, x_output_stride);
+          }
+        }
+      });
+}
+
+template <typename T>
+static bool TryTypedBlockedTranspose(const ReducedTranspose& t, const uint8_t* source, uint8_t* target,
+                                     concurrency::ThreadPool* tp) {
+  constexpr bool enabled = utils::HasTypeWithSameSize<EnabledDataTypes, T>();
+
+  if (enabled) {
+    TypedBlockedTranspose(t, reinterpret_cast<const T*>(source), reinterpret_cast<T*>(target), tp);
+  }
+
+  return enabled;
+}
+
+// Cache blocked, multi-threaded transpose for any permutation of elements of 1, 2, 4 or 8 bytes.
+// Returns false if the element size is not handled and the caller should fall back to the element wise copy.
+static bool DoBlockedTranspose(const gsl::span<const size_t>& permutations, gsl::span<const int64_t> input_dims,
+                               const uint8_t* source, uint8_t* target, size_t element_size,
+                               concurrency::ThreadPool* tp) {
+  const ReducedTranspose reduced = ReduceTranspose(permutations, input_dims);
+  if (reduced.perm.empty()) {
+    return false;
+  }
+
+  switch (element_size) {
+    case sizeof(uint64_t):
+      return TryTypedBlockedTranspose<uint64_t>(reduced, source, target, tp);
+    case sizeof(uint32_t):
+      return TryTypedBlockedTranspose<uint32_t>(reduced, source, target, tp);
+    case sizeof(uint16_t):
+      return TryTypedBlockedTranspose<uint16_t>(reduced, source, target, tp);
+    case sizeof(uint8_t):
+      return TryTypedBlockedTranspose<uint8_t>(reduced, source, target, tp);
+    default:
+      return false;
+  }
+}
+
 //  `input_shape_override` overrides the shape of `input` for compute purposes.
 static Status DoUntypedTranspose(const gsl::span<const size_t>& permutations, const Tensor& input, Tensor& output,
-                                 const TensorShape* input_shape_override = nullptr) {
+                                 const TensorShape* input_shape_override = nullptr,
+                                 concurrency::ThreadPool* tp = nullptr) {
   const auto& input_shape = input_shape_override ? *input_shape_override : input.Shape();
   const auto& input_dims = input_shape.GetDims();
   auto rank = input_shape.NumDimensions();
@@ -309,6 +524,8 @@ static Status DoUntypedTranspose(const gsl::span<const size_t>& permutations, co
     auto* output_data = reinterpret_cast<uint8_t*>(output.MutableDataRaw());
     if (1 == prefix_blocksize) {
       DoTransposeSingleBlock(suffix_blocksize, input_data, output_data, element_size);
+    } else if (DoBlockedTranspose(permutations, input_dims, input_data, output_data, element_size, tp)) {
+      // done
     } else if (1 == suffix_blocksize) {
       // this may return a failed status if the data size is not supported in this build
       status = DoTransposeEltWise(num_axes_in_prefix, output.Shape().GetDims(), prefix_blocksize, stride,
@@ -339,7 +556,7 @@ bool IsTransposeReshape(const gsl::span<const size_t>& perm, gsl::span<const int
 
 //`input_shape_override` overrides the shape of `input` for compute purposes.
 Status TransposeBase::DoTranspose(const gsl::span<const size_t>& permutations, const Tensor& input, Tensor& output,
-                                  const TensorShape* input_shape_override) {
+                                  const TensorShape* input_shape_override, concurrency::ThreadPool* tp) {
   Status status = Status::OK();
 
   auto input_type = input.DataType();
@@ -364,7 +581,7 @@ Status TransposeBase::DoTranspose(const gsl::span<const size_t>& permutations, c
       SingleAxisTranspose(permutations, input, output, from, to, input_shape_override);
     } else {
       // fall back to default implementation
-      status = DoUntypedTranspose(permutations, input, output, input_shape_override);
+      status = DoUntypedTranspose(permutations, input, output, input_shape_override, tp);
     }
   }
 
@@ -406,7 +623,7 @@ Status Transpose::Compute(OpKernelContext* ctx) const {
     SingleAxisTranspose(*p_perm, X, Y, from, to);
   } else {
     // fall back to default implementation
-    status = DoUntypedTranspose(*p_perm, X, Y);
+    status = DoUntypedTranspose(*p_perm, X, Y, nullptr, ctx->GetOperatorThreadPool());
   }
 
   return status;
@@ -3,7 +3,8 @@
 
 #include "core/providers/cpu/tensor/unique.h"
 
-#include <map>
+#include <algorithm>
+#include <numeric>
 #include "gsl/gsl"
 #include "core/framework/op_kernel_type_control_utils.h"
 #include "core/providers/common.h"
@@ -105,56 +106,59 @@ Status Unique::Compute(OpKernelContext* context) const {
   return status;
 }
 
-// class to represent a subtensor along a given axis for a single entry on that axis
-template <typename T>
-class Subtensor {
- public:
-  // Create Subtensor for entry 'idx' on axis 'axis'
-  // n_axis is the number of entries for 'axis' is the original data.
-  //   e.g. if original shape was [4, 2] and axis is 1, n_axis == 2.
-  // subtensor_shape is the shape for the subtensor. the dimension value for the 'axis' dimension in it will be 1.
-  Subtensor(const gsl::span<const T>& data, const TensorShape& subtensor_shape,
-            int64_t axis, int64_t n_axis, int64_t idx) {
-    // rows and columns for the slice along axis, flattened to 2D by merging the dimensions before and after the axis
-    int64_t columns = subtensor_shape.SizeFromDimension(axis);
-    int64_t rows = subtensor_shape.SizeToDimension(axis);
-    items_.reserve(rows * columns);
-    size_t cur_data = idx * columns;  // offset into data for first row of slice
-
-    for (int r = 0; r < rows; ++r) {
-      for (int c = 0; c < columns; ++c) {
-        // TODO: could copy blocks instead of individual items for non std::string types
-        items_.push_back(data[cur_data + c]);
-      }
+// Entries grouped by value. 'order' holds the entry indices stably sorted by value so the first index of
+// each group is the first occurrence of that value in the input.
+struct UniqueGroups {
+  std::vector<int64_t> order;
+  std::vector<int64_t> group_starts;  // offset into 'order' for each group, plus a trailing order.size()
+  std::vector<int64_t> output_idx;    // position of each group in the output
+
+  int64_t NumUnique() const { return static_cast<int64_t>(group_starts.size()) - 1; }
+  int64_t FirstIndex(int64_t group) const { return order[group_starts[group]]; }
+};
 
-      cur_data += columns * n_axis;
+// Sort based de-duplication of 'num_entries' entries. 'less' compares two entries by index.
+// This replaces a std::map lookup per entry with a single sort over a contiguous index array.
+template <typename Less>
+static UniqueGroups GroupEntries(int64_t num_entries, const Less& less, bool sorted) {
+  UniqueGroups groups;
+  groups.order.resize(num_entries);
+  std::iota(groups.order.begin(), groups.order.end(), int64_t{0});
+  std::stable_sort(groups.order.begin(), groups.order.end(), less);
+
+  for (int64_t i = 0; i < num_entries; ++i) {
+    if (i == 0 || less(groups.order[i - 1], groups.order[i])) {
+      groups.group_starts.push_back(i);
     }
   }
 
-  bool operator<(const Subtensor& rhs) const {
-    return items_ < rhs.items_;
+  const int64_t num_unique = static_cast<int64_t>(groups.group_starts.size());
+  groups.group_starts.push_back(num_entries);
+
+  groups.output_idx.resize(num_unique);
+  std::iota(groups.output_idx.begin(), groups.output_idx.end(), int64_t{0});
+  if (!sorted) {
+    // order the groups by their first occurrence in the input
+    std::vector<int64_t> by_first_occurrence(num_unique);
+    std::iota(by_first_occurrence.begin(), by_first_occurrence.end(), int64_t{0});
+    std::sort(by_first_occurrence.begin(), by_first_occurrence.end(),
+              [&groups](int64_t lhs, int64_t rhs) { return groups.FirstIndex(lhs) < groups.FirstIndex(rhs); });
+    for (int64_t i = 0; i < num_unique; ++i) {
+      groups.output_idx[by_first_occurrence[i]] = i;
+    }
   }
 
-  const std::vector<T>& GetItems() const { return items_; }
-
- private:
-  // TODO: Simple copy for now. std::string would be better as std::reference_wrapper<std::string>
-  std::vector<T> items_;
-};
+  return groups;
+}
 
-template <typename T>
-static void CreateFlattenedOutput(OpKernelContext& context,
-                                  const std::map<const T, int64_t>& offsets,         // map sorted key to unsorted idx
-                                  const std::vector<std::vector<int64_t>>& indices,  // unsorted
-                                  const std::vector<int64_t>& inverse_index,         // unsorted
-                                  bool sorted) {
-  int64_t num_unique = static_cast<int64_t>(indices.size());
-  Tensor& Y = *context.Output(0, {num_unique});
+// Write the optional 'indices', 'inverse_indices' and 'counts' outputs
+static void CreateIndexOutputs(OpKernelContext& context, const UniqueGroups& groups) {
+  const int64_t num_unique = groups.NumUnique();
+  const int64_t num_entries = static_cast<int64_t>(groups.order.size());
   Tensor* indices_out = context.Output(1, {num_unique});
-  Tensor* inverse_indices = context.Output(2, {static_cast<int64_t>(inverse_index.size())});
+  Tensor* inverse_indices = context.Output(2, {num_entries});
   Tensor* counts = context.Output(3, {num_unique});
 
-  auto Y_data = Y.MutableDataAsSpan<T>();
   gsl::span<int64_t> indices_data = indices_out != nullptr ? indices_out->MutableDataAsSpan<int64_t>()
                                                            : gsl::span<int64_t>();
   gsl::span<int64_t> inverse_indices_data = inverse_indices != nullptr ? inverse_indices->MutableDataAsSpan<int64_t>()
@@ -162,138 +166,67 @@ static void CreateFlattenedOutput(OpKernelContext& context,
   gsl::span<int64_t> counts_data = counts != nullptr ? counts->MutableDataAsSpan<int64_t>()
                                                      : gsl::span<int64_t>();
 
-  // iterate using 'offsets' which is sorted, but contains the offset of the unsorted entry
-  auto offsets_iter = offsets.begin();
-  for (int64_t i = 0, end = num_unique; i < end; ++i, ++offsets_iter) {
-    // write sequentially if we want sorted output, use the unsorted_idx if not
-    auto unsorted_idx = offsets_iter->second;
-    auto output_idx = sorted ? i : unsorted_idx;
-
-    Y_data[output_idx] = offsets_iter->first;
+  for (int64_t g = 0; g < num_unique; ++g) {
+    const auto output_idx = groups.output_idx[g];
+    const auto start = groups.group_starts[g];
+    const auto end = groups.group_starts[g + 1];
 
     if (indices_out) {
-      indices_data[output_idx] = indices[unsorted_idx].front();
+      indices_data[output_idx] = groups.order[start];
     }
 
     if (counts) {
-      counts_data[output_idx] = indices[unsorted_idx].size();
+      counts_data[output_idx] = end - start;
     }
-  }
-
-  if (inverse_indices) {
-    if (sorted) {
-      // need to convert unsorted entries in the inverse index to their sorted values
-      std::vector<int64_t> unsorted_to_sorted;
-      unsorted_to_sorted.resize(num_unique);
-      int64_t sorted_idx = 0;
-      for (const auto& offset : offsets) {
-        unsorted_to_sorted[offset.second] = sorted_idx++;
-      }
 
-      for (size_t i = 0, end = inverse_index.size(); i < end; ++i) {
-        inverse_indices_data[i] = unsorted_to_sorted[inverse_index[i]];
-      }
-    } else {
-      for (size_t i = 0, end = inverse_index.size(); i < end; ++i) {
-        inverse_indices_data[i] = inverse_index[i];
+    if (inverse_indices) {
+      for (int64_t i = start; i < end; ++i) {
+        inverse_indices_data[groups.order[i]] = output_idx;
       }
     }
   }
 }
 
 template <typename T>
-static void CreateOutput(OpKernelContext& context,
-                         const TensorShape& subtensor_shape,
-                         int64_t axis,
-                         const std::map<const Subtensor<T>, int64_t>& offsets,  // map sorted key to unsorted idx
-                         const std::vector<std::vector<int64_t>>& indices,      // unsorted
-                         const std::vector<int64_t>& inverse_index,             // unsorted
-                         bool sorted) {
-  int64_t num_unique = static_cast<int64_t>(indices.size());
+static void CreateFlattenedOutput(OpKernelContext& context, const gsl::span<const T>& data,
+                                  const UniqueGroups& groups) {
+  const int64_t num_unique = groups.NumUnique();
+  Tensor& Y = *context.Output(0, {num_unique});
+  auto Y_data = Y.MutableDataAsSpan<T>();
 
-  // rows and columns for the slice along axis, flattened to 2D by merging the dimensions before and after the axis
-  int64_t num_cols = subtensor_shape.SizeFromDimension(axis);
-  int64_t num_rows = subtensor_shape.SizeToDimension(axis);
-
-  auto subtensor_dims = subtensor_shape.GetDims();
-  std::vector<int64_t> Y_dims;
-  Y_dims.reserve(subtensor_dims.size());
-  for (int64_t i = 0, end = subtensor_dims.size(); i < end; ++i) {
-    if (i == axis)
-      Y_dims.push_back(num_unique);
-    else
-      Y_dims.push_back(subtensor_dims[i]);
+  for (int64_t g = 0; g < num_unique; ++g) {
+    Y_data[groups.output_idx[g]] = data[groups.FirstIndex(g)];
   }
 
-  Tensor& Y = *context.Output(0, TensorShape(std::move(Y_dims)));
-  Tensor* indices_out = context.Output(1, {num_unique});
-  Tensor* inverse_indices = context.Output(2, {static_cast<int64_t>(inverse_index.size())});
-  Tensor* counts = context.Output(3, {num_unique});
-
-  auto Y_data = Y.MutableDataAsSpan<T>();
-  gsl::span<int64_t> indices_data = indices_out != nullptr ? indices_out->MutableDataAsSpan<int64_t>()
-                                                           : gsl::span<int64_t>();
-  gsl::span<int64_t> inverse_indices_data = inverse_indices != nullptr ? inverse_indices->MutableDataAsSpan<int64_t>()
-                                                                       : gsl::span<int64_t>();
-  gsl::span<int64_t> counts_data = counts != nullptr ? counts->MutableDataAsSpan<int64_t>()
-                                                     : gsl::span<int64_t>();
-
-  // iterate using 'offsets' which is sorted, but contains the offset of the unsorted entry
-  auto offsets_iter = offsets.begin();
+  CreateIndexOutputs(context, groups);
+}
 
-  for (int64_t i = 0, end = num_unique; i < end; ++i, ++offsets_iter) {
-    // write sequentially if we want sorted output, use the unsorted_idx if not
-    auto unsorted_idx = offsets_iter->second;
-    auto output_idx = (sorted ? i : unsorted_idx);
+template <typename T>
+static void CreateOutput(OpKernelContext& context, const gsl::span<const T>& data,
+                         const TensorShape& input_shape, int64_t axis, const UniqueGroups& groups) {
+  const int64_t num_unique = groups.NumUnique();
+  const int64_t n_axis = input_shape[axis];
 
-    const auto& items = offsets_iter->first.GetItems();
-    auto item = items.cbegin();
-    assert(static_cast<int64_t>(items.size()) == num_rows * num_cols);
+  // rows and columns for the slice along axis, flattened to 2D by merging the dimensions before and after the axis
+  const int64_t num_cols = input_shape.SizeFromDimension(axis + 1);
+  const int64_t num_rows = input_shape.SizeToDimension(axis);
 
-    int64_t out_offset = output_idx * num_cols;
+  TensorShapeVector Y_dims(input_shape.GetDims().begin(), input_shape.GetDims().end());
+  Y_dims[axis] = num_unique;
+  Tensor& Y = *context.Output(0, TensorShape(Y_dims));
+  auto Y_data = Y.MutableDataAsSpan<T>();
 
+  for (int64_t g = 0; g < num_unique; ++g) {
+    const T* in = data.data() + groups.FirstIndex(g) * num_cols;
+    T* out = Y_data.data() + groups.output_idx[g] * num_cols;
     for (int64_t row = 0; row < num_rows; ++row) {
-      // copy num_cols items from entries to output
-      if (std::is_same<T, std::string>::value) {
-        std::copy(item, item + num_cols, &Y_data[out_offset]);
-      } else {
-        std::copy_n(item, num_cols, &Y_data[out_offset]);
-      }
-
-      item += num_cols;
-      out_offset += num_unique * num_cols;
-    }
-
-    assert(item == items.cend());
-
-    if (indices_out) {
-      indices_data[output_idx] = indices[unsorted_idx].front();
-    }
-
-    if (counts) {
-      counts_data[output_idx] = indices[unsorted_idx].size();
+      std::copy_n(in, num_cols, out);
+      in += n_axis * num_cols;
+      out += num_unique * num_cols;
     }
   }
 
-  if (inverse_indices) {
-    if (sorted) {
-      // need to convert unsorted entries in the inverse index to their sorted values
-      std::vector<int64_t> unsorted_to_sorted;
-      unsorted_to_sorted.resize(num_unique);
-      int64_t sorted_idx = 0;
-      for (const auto& offset : offsets) {
-        unsorted_to_sorted[offset.second] = sorted_idx++;
-      }
-
-      for (size_t i = 0, end = inverse_index.size(); i < end; ++i) {
-        inverse_indices_data[i] = unsorted_to_sorted[inverse_index[i]];
-      }
-    } else {
-      for (size_t i = 0, end = inverse_index.size(); i < end; ++i) {
-        inverse_indices_data[i] = inverse_index[i];
-      }
-    }
-  }
+  CreateIndexOutputs(context, groups);
 }
 
 template <typename T>
@@ -306,70 +239,39 @@ Status Unique::ComputeImpl(OpKernelContext& context) const {
   auto data = input.DataAsSpan<T>();
 
   if (flatten_) {
-    std::map<const T, int64_t> offsets;  // offset of entry in indices. provides map between sorted and unsorted values
-    std::vector<std::vector<int64_t>> indices;
-    std::vector<int64_t> inverse_index;
-
-    indices.reserve(data.size() / 2);  // arbitrary value. at worst 1 realloc but could be too large
-    inverse_index.reserve(data.size());
-
-    int64_t num_unique = 0;
-
-    for (int64_t i = 0, end = input.Shape().Size(); i < end; ++i) {
-      auto entry = offsets.find(data[i]);
-      if (entry == offsets.end()) {
-        offsets[data[i]] = num_unique;
-        inverse_index.push_back({num_unique});
-        indices.push_back({i});
-        ++num_unique;
-      } else {
-        size_t indices_idx = entry->second;
-        indices[indices_idx].push_back(i);
-        inverse_index.push_back(indices_idx);
-      }
-    }
+    auto groups = GroupEntries(
+        input.Shape().Size(),
+        [&data](int64_t lhs, int64_t rhs) { return data[lhs] < data[rhs]; },
+        sort_);
 
-    CreateFlattenedOutput(context, offsets, indices, inverse_index, sort_);
+    CreateFlattenedOutput(context, data, groups);
   } else {
     const auto& input_shape = input.Shape();
     const int64_t input_dims = static_cast<int64_t>(input_shape.NumDimensions());
     const int64_t axis = HandleNegativeAxis(axis_, input_dims);
 
-    std::vector<int64_t> subtensor_dims;
-    subtensor_dims.reserve(input_dims);
-    for (int64_t i = 0; i < input_dims; ++i) {
-      subtensor_dims.push_back(i == axis ? 1 : input_shape[i]);
-    }
-
-    TensorShape subtensor_shape(std::move(subtensor_dims));
-
-    std::map<const Subtensor<T>, int64_t> offsets;
-    std::vector<std::vector<int64_t>> indices;
-    std::vector<int64_t> inverse_index;
-
-    indices.reserve(data.size() / 2);  // arbitrary value. at worst 1 realloc but could be too large
-    inverse_index.reserve(data.size());
-
-    int64_t num_unique = 0;
-    int64_t n_axis = input_shape[axis];
-
-    for (int64_t i = 0; i < n_axis; ++i) {
-      Subtensor<T> s(data, subtensor_shape, axis, n_axis, i);
-
-      auto entry = offsets.find(s);
-      if (entry == offsets.end()) {
-        offsets[std::move(s)] = num_unique;
-        inverse_index.push_back({num_unique});
-        indices.push_back({i});
-        ++num_unique;
-      } else {
-        size_t indices_idx = entry->second;
-        indices[indices_idx].push_back(i);
-        inverse_index.push_back(indices_idx);
+    const int64_t n_axis = input_shape[axis];
+    const int64_t num_cols = input_shape.SizeFromDimension(axis + 1);
+    const int64_t num_rows = input_shape.SizeToDimension(axis);
+
+    // lexicographical compare of the subtensors for two entries on 'axis', read in place from the input
+    auto less = [&data, n_axis, num_cols, num_rows](int64_t lhs, int64_t rhs) {
+      const T* l = data.data() + lhs * num_cols;
+      const T* r = data.data() + rhs * num_cols;
+      for (int64_t row = 0; row < num_rows; ++row) {
+        for (int64_t col = 0; col < num_cols; ++col) {
+          if (l[col] < r[col]) return true;
+          if (r[col] < l[col]) return false;
+        }
+        l += n_axis * num_cols;
+        r += n_axis * num_cols;
       }
-    }
+      return false;
+    };
+
+    auto groups = GroupEntries(n_axis, less, sort_);
 
-    CreateOutput(context, subtensor_shape, axis, offsets, indices, inverse_index, sort_);
+    CreateOutput(context, data, input_shape, axis, groups);
   }
 
   return Status::OK();
@@ -872,197 +872,172 @@ std::array<float, CubicModeGridLength> GetCubicCoeffs(float s, float cubic_coeff
   return coeffs;
 }
 
-// Get the tensor data at the requested coordinate
-template <typename T>
-T GetDataForCoordinate(const T* Xdata,
-                       int64_t x, int64_t y,
-                       int64_t input_height, int64_t input_width) {
-  x = std::max(static_cast<int64_t>(0), std::min(x, input_width - 1));
-  y = std::max(static_cast<int64_t>(0), std::min(y, input_height - 1));
-  return Xdata[y * input_width + x];
-}
+static void SetupCubicFilter(int64_t input_size,
+                             int64_t output_size,
+                             float scale,
+                             float roi_start,
+                             float roi_end,
+                             float cubic_coeff_a,
+                             bool use_extrapolation,
+                             bool exclude_outside,
+                             const GetOriginalCoordinateFunc& get_original_coordinate,
+                             CubicFilter& filter) {
+  filter.index.resize(output_size * CubicModeGridLength);
+  filter.weight.resize(output_size * CubicModeGridLength);
+  filter.extrapolate.assign(output_size, 0);
+
+  for (int64_t o = 0; o < output_size; ++o) {
+    float in = scale == 1 ? static_cast<float>(o)
+                          : get_original_coordinate(static_cast<float>(o), scale,
+                                                    static_cast<float>(output_size),
+                                                    static_cast<float>(input_size),
+                                                    roi_start, roi_end);
+
+    // when use_extrapolation is set and original index is out of the dim range
+    // then use extrapolation_value as the output value.
+    if (use_extrapolation && (in < 0 || in > static_cast<float>(input_size - 1))) {
+      filter.extrapolate[o] = 1;
+    }
 
-// Computes cubic convolution interpolation in 1D
-template <typename T>
-float CubicInterpolation1D(const T* Xdata,
-                           int64_t x,
-                           int64_t y,
-                           int64_t input_height,
-                           int64_t input_width,
-                           std::array<float, CubicModeGridLength>& coeff_array,
-                           float coeff_sum,
-                           std::unordered_map<int64_t, float>& cache) {
-  // When calculating cubic interpolation we move the 4*4 grid across the original data and therefore there is
-  // opportunity to cache the results for previously seen combinations.
-  // Check if the result is already available in the cache
-  auto grid_start_pos = (y)*input_width + (x - 1);
-  if (cache.find(grid_start_pos) != cache.end()) {
-    return cache[grid_start_pos];
+    const auto in_int = static_cast<int64_t>(std::floor(in));
+    auto coeffs = GetCubicCoeffs(in - std::floor(in), cubic_coeff_a);
+    float coeff_sum = 1;
+
+    if (exclude_outside) {
+      // When true, the weight of sampling locations outside the grid will be set to 0
+      // and the weight will be renormalized so that their sum is 1.0
+      coeff_sum = 0;
+      for (int64_t i = 0, val = in_int - 1; val <= in_int + 2; val++, i++) {
+        coeffs[i] = (val < 0 || val >= input_size) ? 0.0f : coeffs[i];
+        coeff_sum += coeffs[i];
+      }
+    }
+
+    // for 1D cubic interpolation 4 samples are used. 2 on the left and 2 on the right of the coordinate
+    for (int64_t i = 0, val = in_int - 1; val <= in_int + 2; val++, i++) {
+      filter.index[o * CubicModeGridLength + i] = std::max<int64_t>(0, std::min(val, input_size - 1));
+      filter.weight[o * CubicModeGridLength + i] = coeffs[i] / coeff_sum;
+    }
   }
+}
 
-  // get the neighbors in 1D and find interpolation for this dimension
-  // for 1D cubic interpolation 4 samples are used. 2 on the left and 2 on the right of x
-  float result = 0;
-  for (int i = 0, j = -1; i < static_cast<int>(CubicModeGridLength); i++, j++) {
-    auto orig_data = GetDataForCoordinate(Xdata, x + j, y, input_height, input_width);
-    result += coeff_array[i] / coeff_sum * orig_data;
+static BicubicParams SetupUpsampleBicubic(int64_t input_height,
+                                          int64_t input_width,
+                                          int64_t output_height,
+                                          int64_t output_width,
+                                          float height_scale,
+                                          float width_scale,
+                                          const std::array<float, 4>& roi,
+                                          float cubic_coeff_a,
+                                          bool use_extrapolation,
+                                          bool exclude_outside,
+                                          const GetOriginalCoordinateFunc& get_original_coordinate) {
+  BicubicParams p;
+  p.input_height = input_height;
+  p.input_width = input_width;
+  p.output_height = output_height;
+  p.output_width = output_width;
+  p.height_scale = height_scale;
+  p.width_scale = width_scale;
+  p.roi = roi;
+
+  SetupCubicFilter(input_height, output_height, height_scale, roi[0], roi[1], cubic_coeff_a,
+                   use_extrapolation, exclude_outside, get_original_coordinate, p.y_filter);
+  SetupCubicFilter(input_width, output_width, width_scale, roi[2], roi[3], cubic_coeff_a,
+                   use_extrapolation, exclude_outside, get_original_coordinate, p.x_filter);
+
+  p.input_row_used.assign(input_height, 0);
+  for (int64_t y = 0; y < output_height; ++y) {
+    if (p.y_filter.extrapolate[y]) {
+      continue;
+    }
+    for (size_t i = 0; i < CubicModeGridLength; ++i) {
+      p.input_row_used[p.y_filter.index[y * CubicModeGridLength + i]] = 1;
+    }
   }
-  cache[grid_start_pos] = result;
 
-  return result;
+  return p;
 }
-#if defined(_MSC_VER)
-#pragma warning(push)
-#pragma warning(disable : 6001)
-#endif
+
 template <typename T>
 void ResizeBiCubic(int64_t batch_size,
                    int64_t num_channels,
-                   int64_t input_height,
-                   int64_t input_width,
-                   int64_t output_height,
-                   int64_t output_width,
-                   float height_scale,
-                   float width_scale,
-                   float cubic_coeff_a,
-                   bool use_extrapolation,
+                   const BicubicParams& p,
                    float extrapolation_value,
-                   bool exclude_outside,
-                   const std::vector<float>& roi,
                    const T* Xdata,
                    T* Ydata,
-                   const GetOriginalCoordinateFunc& get_original_coordinate) {
-  std::vector<float> y_original;
-  y_original.reserve(output_height);
-
-  std::vector<float> x_original;
-  x_original.reserve(output_width);
-
-  std::unordered_map<float, std::array<float, CubicModeGridLength>> cubic_coeffs;
-  std::unordered_map<float, std::unordered_map<int64_t, float>> coeff_to_1Dinterpolation_map;
-  auto roi_y_start = roi.size() / 2 - 2;
-  auto roi_y_end = roi.size() - 2;
-  auto roi_x_start = roi.size() / 2 - 1;
-  auto roi_x_end = roi.size() - 1;
-
-  // generate coefficients in y direction
-  for (int64_t y = 0; y < output_height; ++y) {
-    float in_y = height_scale == 1 ? static_cast<float>(y)
-                                   : get_original_coordinate(static_cast<float>(y), height_scale,
-                                                             static_cast<float>(output_height),
-                                                             static_cast<float>(input_height),
-                                                             roi[roi_y_start], roi[roi_y_end]);
-    y_original.emplace_back(in_y);
-    auto s = y_original[y] - std::floor(y_original[y]);
-    if (cubic_coeffs.find(s) == cubic_coeffs.end()) {
-      cubic_coeffs[s] = GetCubicCoeffs(s, cubic_coeff_a);
-      coeff_to_1Dinterpolation_map[s] = {};
-    }
-  }
-
-  // generate coefficients in x direction
-  for (int64_t x = 0; x < output_width; ++x) {
-    float in_x = width_scale == 1 ? static_cast<float>(x)
-                                  : get_original_coordinate(static_cast<float>(x),
-                                                            width_scale,
-                                                            static_cast<float>(output_width),
-                                                            static_cast<float>(input_width),
-                                                            roi[roi_x_start], roi[roi_x_end]);
-    x_original.emplace_back(in_x);
-    auto s = x_original[x] - std::floor(x_original[x]);
-    if (cubic_coeffs.find(s) == cubic_coeffs.end()) {
-      cubic_coeffs[s] = GetCubicCoeffs(s, cubic_coeff_a);
-      coeff_to_1Dinterpolation_map[s] = {};
-    }
-  }
-
-  // setup up temp arrays to hold coefficients when exclude_outside is set to true
-  std::array<float, CubicModeGridLength> y_coeff_holder;
-  std::array<float, CubicModeGridLength> x_coeff_holder;
-  float y_coeff_sum = 1;
-  float x_coeff_sum = 1;
-
-  for (int64_t n = 0; n < batch_size; n++) {
-    for (int64_t c = 0; c < num_channels; c++) {
-      for (int64_t y = 0; y < output_height; ++y) {
-        auto in_y = y_original[y];
-
-        // when use_extrapolation is set and original index is out of the dim range
-        // then use extrapolation_value as the output value.
-        if (use_extrapolation && (in_y < 0 || in_y > static_cast<float>(input_height - 1))) {
-          for (int64_t x = 0; x < output_width; ++x) {
-            Ydata[y * output_width + x] = extrapolation_value;
-          }
-          continue;
-        }
-
-        auto y_int = static_cast<int64_t>(std::floor(in_y));
-        auto& coeff_y = exclude_outside ? y_coeff_holder : cubic_coeffs[in_y - y_int];
-        y_coeff_sum = 1;
-
-        if (exclude_outside) {
-          // When true, the weight of sampling locations outside the grid will be set to 0
-          // and the weight will be renormalized so that their sum is 1.0
-          y_coeff_sum = 0;
-          auto& orig_y_coeffs = cubic_coeffs[in_y - y_int];
-          for (int64_t i = 0, y_val = y_int - 1; y_val <= y_int + 2; y_val++, i++) {
-            y_coeff_holder[i] = (y_val < 0 || y_val >= static_cast<float>(input_height)) ? 0.0f : orig_y_coeffs[i];
-            y_coeff_sum += y_coeff_holder[i];
+                   concurrency::ThreadPool* tp) {
+  const int64_t input_height = p.input_height;
+  const int64_t input_width = p.input_width;
+  const int64_t output_height = p.output_height;
+  const int64_t output_width = p.output_width;
+  const int64_t* x_index = p.x_filter.index.data();
+  const float* x_weight = p.x_filter.weight.data();
+
+  // horizontal pass over every used input row plus vertical pass over every output row
+  const double cost = static_cast<double>((input_height + output_height) * output_width *
+                                          static_cast<int64_t>(CubicModeGridLength) * 2);
+
+  concurrency::ThreadPool::TryParallelFor(
+      tp, static_cast<std::ptrdiff_t>(batch_size * num_channels), cost,
+      [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        // result of the horizontal pass: input_height rows of output_width values
+        std::vector<float> rows(SafeInt<size_t>(input_height) * output_width);
+
+        for (std::ptrdiff_t nc = first; nc < last; ++nc) {
+          const T* X = Xdata + nc * input_height * input_width;
+          T* Y = Ydata + nc * output_height * output_width;
+
+          for (int64_t y = 0; y < input_height; ++y) {
+            if (!p.input_row_used[y]) {
+              continue;
+            }
+            const T* Xrow = X + y * input_width;
+            float* row = rows.data() + y * output_width;
+            for (int64_t x = 0; x < output_width; ++x) {
+              const int64_t* idx = x_index + x * CubicModeGridLength;
+              const float* w = x_weight + x * CubicModeGridLength;
+              float result = 0;
+              for (size_t i = 0; i < CubicModeGridLength; ++i) {
+                result += w[i] * Xrow[idx[i]];
+              }
+              row[x] = result;
+            }
           }
-        }
-
-        for (int64_t x = 0; x < output_width; ++x) {
-          auto in_x = x_original[x];
 
-          // when use_extrapolation is set and original index is out of the dim range
-          // then use extrapolation_value as the output value.
-          if (use_extrapolation && (in_x < 0 || in_x > static_cast<float>(input_width - 1))) {
-            Ydata[y * output_width + x] = extrapolation_value;
-            continue;
-          }
+          for (int64_t y = 0; y < output_height; ++y) {
+            T* Yrow = Y + y * output_width;
+            if (p.y_filter.extrapolate[y]) {
+              std::fill_n(Yrow, output_width, static_cast<T>(extrapolation_value));
+              continue;
+            }
 
-          auto x_int = static_cast<int64_t>(std::floor(in_x));
-          auto s_x = static_cast<float>(in_x - x_int);
-          auto& coeff_x = exclude_outside ? x_coeff_holder : cubic_coeffs[s_x];
-          x_coeff_sum = 1;
-
-          if (exclude_outside) {
-            // When true, the weight of sampling locations outside the grid will be set to 0
-            // and the weight will be renormalized so that their sum is 1.0
-            x_coeff_sum = 0;
-            auto& orig_x_coeff = cubic_coeffs[s_x];
-            for (int64_t i = 0, x_val = x_int - 1; x_val <= x_int + 2; x_val++, i++) {
-              x_coeff_holder[i] = (x_val < 0 || x_val >= static_cast<float>(input_width)) ? 0.0f : orig_x_coeff[i];
-              x_coeff_sum += x_coeff_holder[i];
+            const int64_t* idx = p.y_filter.index.data() + y * CubicModeGridLength;
+            const float* w = p.y_filter.weight.data() + y * CubicModeGridLength;
+            const float* row0 = rows.data() + idx[0] * output_width;
+            const float* row1 = rows.data() + idx[1] * output_width;
+            const float* row2 = rows.data() + idx[2] * output_width;
+            const float* row3 = rows.data() + idx[3] * output_width;
+            const float w0 = w[0], w1 = w[1], w2 = w[2], w3 = w[3];
+
+            // contiguous in x, so this loop is vectorized by the compiler
+            for (int64_t x = 0; x < output_width; ++x) {
+              float result = row0[x] * w0;
+              result += row1[x] * w1;
+              result += row2[x] * w2;
+              result += row3[x] * w3;
+              Yrow[x] = static_cast<T>(result);
             }
-          }
 
-          // Compute cubic interpolation in x dimension using the x coefficients.
-          // From the result of cubic interpolation in x dim, compute cubic interpolation in y dimension
-          auto& interpolation_result_cache = coeff_to_1Dinterpolation_map[s_x];
-          float result = 0;
-          for (int64_t y_val = y_int - 1, i = 0; y_val <= y_int + 2; y_val++, i++) {
-            auto x_interpolation_result = CubicInterpolation1D(Xdata, x_int, y_val,
-                                                               input_height, input_width, coeff_x, x_coeff_sum,
-                                                               interpolation_result_cache);
-            result += x_interpolation_result * coeff_y[i] / y_coeff_sum;
+            for (int64_t x = 0; x < output_width; ++x) {
+              if (p.x_filter.extrapolate[x]) {
+                Yrow[x] = static_cast<T>(extrapolation_value);
+              }
+            }
           }
-
-          Ydata[y * output_width + x] = static_cast<T>(result);
         }
-      }
-
-      Xdata += input_height * input_width;
-      Ydata += output_height * output_width;
-
-      // clear the cache when moving to the next channel
-      coeff_to_1Dinterpolation_map.clear();
-    }
-  }
+      });
 }
-#if defined(_MSC_VER)
-#pragma warning(pop)
-#endif
 
 template <typename T>
 Status Upsample<T>::BaseCompute(OpKernelContext* context,
@@ -1258,10 +1233,30 @@ Status Upsample<T>::BaseCompute(OpKernelContext* context,
       const int64_t output_height = is_2D ? output_dims[0] : output_dims[2];
       const int64_t output_width = is_2D ? output_dims[1] : output_dims[3];
 
-      ResizeBiCubic(batch_size, num_channels, input_height, input_width, output_height, output_width,
-                    is_2D ? scales[0] : scales[2], is_2D ? scales[1] : scales[3], cubic_coeff_a_, use_extrapolation_,
-                    extrapolation_value_, exclude_outside_, roi, X->Data<float>(),
-                    Y->MutableData<float>(), get_original_coordinate_);
+      const float height_scale = is_2D ? scales[0] : scales[2];
+      const float width_scale = is_2D ? scales[1] : scales[3];
+      const std::array<float, 4> cubic_roi{roi[roi.size() / 2 - 2], roi[roi.size() - 2],
+                                           roi[roi.size() / 2 - 1], roi[roi.size() - 1]};
+
+      std::shared_ptr<const BicubicParams> params;
+      {
+        std::lock_guard<std::mutex> lock(bicubic_params_mutex_);
+        params = bicubic_params_;
+      }
+      if (params == nullptr ||
+          !params->Matches(input_height, input_width, output_height, output_width,
+                           height_scale, width_scale, cubic_roi)) {
+        params = std::make_shared<const BicubicParams>(
+            SetupUpsampleBicubic(input_height, input_width, output_height, output_width,
+                                 height_scale, width_scale, cubic_roi, cubic_coeff_a_,
+                                 use_extrapolation_, exclude_outside_, get_original_coordinate_));
+        std::lock_guard<std::mutex> lock(bicubic_params_mutex_);
+        bicubic_params_ = params;
+      }
+
+      ResizeBiCubic(batch_size, num_channels, *params, extrapolation_value_, X->Data<float>(),
+                    Y->MutableData<float>(),
+                    output_height * output_width > 64 ? context->GetOperatorThreadPool() : nullptr);
       return Status::OK();
     }
     default:
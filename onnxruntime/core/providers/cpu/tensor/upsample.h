@@ -3,6 +3,9 @@
 
 #pragma once
 
+#include <array>
+#include <memory>
+#include <mutex>
 #include <vector>
 #ifndef SHARED_PROVIDER
 #include "core/framework/op_kernel.h"
@@ -58,6 +61,42 @@ struct BilinearParamsInteger {
   int32_t* dy2_scale_10{nullptr};
 };
 
+// Separable 1-D cubic filter along one axis. For every output coordinate it holds the 4 input taps
+// (already clamped to the input range) and their weights (already renormalized for exclude_outside).
+struct CubicFilter {
+  std::vector<int64_t> index;
+  std::vector<float> weight;
+
+  // set for output coordinates that map outside the input when extrapolation is used
+  std::vector<uint8_t> extrapolate;
+};
+
+// Bicubic resize is computed as a horizontal pass over the input rows followed by a vertical pass.
+// The filter tables only depend on the shapes, scales and roi so they are computed once and reused
+// for as long as those stay the same.
+struct BicubicParams {
+  int64_t input_height{0};
+  int64_t input_width{0};
+  int64_t output_height{0};
+  int64_t output_width{0};
+  float height_scale{0};
+  float width_scale{0};
+  std::array<float, 4> roi{};  // y start, y end, x start, x end
+
+  CubicFilter y_filter;
+  CubicFilter x_filter;
+
+  // input rows read by the vertical pass; the horizontal pass skips the others
+  std::vector<uint8_t> input_row_used;
+
+  bool Matches(int64_t in_height, int64_t in_width, int64_t out_height, int64_t out_width,
+               float h_scale, float w_scale, const std::array<float, 4>& roi_values) const {
+    return input_height == in_height && input_width == in_width &&
+           output_height == out_height && output_width == out_width &&
+           height_scale == h_scale && width_scale == w_scale && roi == roi_values;
+  }
+};
+
 template <typename T>
 class Upsample : public UpsampleBase, public OpKernel {
  public:
@@ -68,6 +107,11 @@ class Upsample : public UpsampleBase, public OpKernel {
 
   Status BaseCompute(OpKernelContext* context, const std::vector<float>& roi, const std::vector<float>& scales,
                      const gsl::span<const int64_t>& output_dims) const;
+
+ private:
+  // filter tables of the last bicubic resize, reused while the shapes/scales/roi don't change
+  mutable std::mutex bicubic_params_mutex_;
+  mutable std::shared_ptr<const BicubicParams> bicubic_params_;
 };
 
 BilinearParams SetupUpsampleBilinear(const int32_t input_height,
@@ -2,6 +2,9 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
+#include <cmath>
+
 #include "gtest/gtest.h"
 #include "test/common/tensor_op_test_utils.h"
 #include "test/common/cuda_op_test_utils.h"
@@ -822,6 +825,82 @@ TEST(AttentionTest, AttentionPastStateBatch1) {
                    use_past_state, past_sequence_length, &past_data, &present_data);
 }
 
+TEST(AttentionTest, AttentionPastStateBatch1_SharedBuffer) {
+  int batch_size = 1;
+  int sequence_length = 1;
+  int hidden_size = 4;
+  int number_of_heads = 2;
+  int head_size = hidden_size / number_of_heads;
+  int past_sequence_length = 3;
+  int max_sequence_length = 6;
+
+  // Same data as AttentionPastStateBatch1, with past and present stored in max_sequence_length buffers.
+  std::vector<float> input_data = {
+      -0.019333266f, -0.21813886f, 0.16212955f, -0.015626367f};
+
+  std::vector<float> weight_data = {
+      -0.4738484025001526f, -0.2613658607006073f, -0.0978037416934967f, -0.34988933801651f,
+      0.2243240624666214f, -0.0429205559194088f, 0.418695330619812f, 0.17441125214099884f,
+      -0.18825532495975494f, 0.18357256054878235f, -0.5806483626365662f, -0.02251487597823143f,
+      0.08742205798625946f, 0.14734269678592682f, 0.2387014478445053f, 0.2884027063846588f,
+      0.6490834355354309f, 0.16965825855731964f, -0.06346885114908218f, 0.4073973298072815f,
+      -0.03070945478975773f, 0.4110257923603058f, 0.07896808534860611f, 0.16783113777637482f,
+      0.0038893644232302904f, 0.06946629285812378f, 0.36680519580841064f, -0.07261059433221817f,
+      -0.14960581064224243f, 0.020944256335496902f, -0.09378612786531448f, -0.1336742341518402f,
+      0.06061394885182381f, 0.2205914407968521f, -0.03519909828901291f, -0.18405692279338837f,
+      0.22149960696697235f, -0.1884360909461975f, -0.014074507169425488f, 0.4252440333366394f,
+      0.24987126886844635f, -0.31396418809890747f, 0.14036843180656433f, 0.2854192554950714f,
+      0.09709841012954712f, 0.09935075044631958f, -0.012154420837759972f, 0.2575816512107849f};
+
+  std::vector<float> bias_data = {
+      0.4803391396999359f, -0.5254325866699219f, -0.42926454544067383f, -0.2059524953365326f,
+      -0.12773379683494568f, -0.09542735666036606f, -0.35286077857017517f, -0.07646317780017853f,
+      -0.04590314254164696f, -0.03752850368618965f, -0.013764488510787487f, -0.18478283286094666f};
+
+  std::vector<float> output_data = {
+      0.20141591f, 0.43005896f, 0.35745093f, 0.19957167f};
+
+  std::vector<float> past_data = {
+      0.55445826f, 0.10127074f, 0.71770734f, 0.15915526f, 0.13913247f, 0.77447522f, 0.66044068f, 0.27559045f, 0.35731629f, 0.62033528f, 0.24354559f, 0.22859341f,
+      0.45075402f, 0.85365993f, 0.097346395f, 0.28859729f, 0.26926181f, 0.65922296f, 0.8177433f, 0.4212271f, 0.34352475f, 0.059609573f, 0.46556228f, 0.7226882f};
+
+  std::vector<float> present_data = {
+      0.55445826f, 0.10127074f, 0.71770734f, 0.15915526f, 0.13913247f, 0.77447522f, -0.30182117f, -0.12330482f, 0.66044068f, 0.27559045f, 0.35731629f, 0.62033528f, 0.24354559f, 0.22859341f, -0.36450946f, -0.19483691f,
+      0.45075402f, 0.85365993f, 0.097346395f, 0.28859729f, 0.26926181f, 0.65922296f, -0.027254611f, -0.096526355f, 0.8177433f, 0.4212271f, 0.34352475f, 0.059609573f, 0.46556228f, 0.7226882f, -0.025281552f, -0.25482416f};
+
+  // Copy (2 x B x N) chunks of sequence_length x H into chunks of max_sequence_length x H padded with zeros.
+  auto pad_state = [&](const std::vector<float>& state, int state_sequence_length) {
+    std::vector<float> padded(static_cast<size_t>(2) * batch_size * number_of_heads * max_sequence_length * head_size,
+                              0.0f);
+    const size_t chunk_length = static_cast<size_t>(state_sequence_length) * head_size;
+    const size_t max_chunk_length = static_cast<size_t>(max_sequence_length) * head_size;
+    for (size_t i = 0; i < state.size() / chunk_length; i++) {
+      std::copy_n(state.data() + i * chunk_length, chunk_length, padded.data() + i * max_chunk_length);
+    }
+    return padded;
+  };
+
+  std::vector<int64_t> state_dims = {2, batch_size, number_of_heads, max_sequence_length, head_size};
+
+  OpTester tester("Attention", 1, onnxruntime::kMSDomain);
+  tester.AddAttribute<int64_t>("num_heads", static_cast<int64_t>(number_of_heads));
+  tester.AddAttribute<int64_t>("unidirectional", static_cast<int64_t>(1));
+  tester.AddAttribute<int64_t>("past_present_share_buffer", static_cast<int64_t>(1));
+  tester.AddInput<float>("input", {batch_size, sequence_length, hidden_size}, input_data);
+  tester.AddInput<float>("weight", {hidden_size, 3 * hidden_size}, weight_data);
+  tester.AddInput<float>("bias", {3 * hidden_size}, bias_data);
+  tester.AddOptionalInputEdge<int32_t>();
+  tester.AddInput<float>("past", state_dims, pad_state(past_data, past_sequence_length));
+  tester.AddOptionalInputEdge<float>();
+  tester.AddInput<int32_t>("past_sequence_length", {}, {past_sequence_length});
+  tester.AddOutput<float>("output", {batch_size, sequence_length, hidden_size}, output_data);
+  tester.AddOutput<float>("present", state_dims, pad_state(present_data, past_sequence_length + sequence_length));
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  tester.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+}
+
 TEST(AttentionTest, AttentionPastStateBatch2) {
   int batch_size = 2;
   int sequence_length = 1;
@@ -1863,6 +1942,241 @@ static void RunModelWithRandomInput(
   }
 }
 
+// Reference of sliding window attention, computed as dense attention over past and new keys where the scores of keys
+// outside the window of a query are replaced by the mask value. mask_index is empty, 1D of (B) end positions,
+// 1D of (2B) end and start positions, or 2D raw attention mask of (B, S*). Present state is returned in
+// present_data, with max_sequence_length positions per chunk when it is positive.
+static std::vector<float> ComputeWindowAttentionReference(const std::vector<float>& input_data,
+                                                          const std::vector<float>& weight_data,
+                                                          const std::vector<float>& bias_data,
+                                                          const std::vector<float>& past_data,
+                                                          const std::vector<int32_t>& mask_index_data,
+                                                          const std::vector<int64_t>& mask_index_dims,
+                                                          int batch_size, int sequence_length, int hidden_size,
+                                                          int number_of_heads, int past_sequence_length,
+                                                          int max_sequence_length, int window, int num_global_tokens,
+                                                          bool is_unidirectional, std::vector<float>& present_data) {
+  const int head_size = hidden_size / number_of_heads;
+  const int all_sequence_length = past_sequence_length + sequence_length;
+  const int state_length = max_sequence_length > 0 ? max_sequence_length : all_sequence_length;
+  const int past_state_length = max_sequence_length > 0 ? max_sequence_length : past_sequence_length;
+  auto project = [&](int b, int s, int column) {
+    float sum = bias_data[column];
+    for (int d = 0; d < hidden_size; d++) {
+      sum += input_data[(b * sequence_length + s) * hidden_size + d] * weight_data[d * 3 * hidden_size + column];
+    }
+    return sum;
+  };
+
+  // Present state (2, B, N, S*, H): past keys and values followed by new ones.
+  present_data.assign(static_cast<size_t>(2) * batch_size * number_of_heads * state_length * head_size, 0.0f);
+  for (int kv = 0; kv < 2; kv++) {
+    for (int b = 0; b < batch_size; b++) {
+      for (int n = 0; n < number_of_heads; n++) {
+        const int chunk = (kv * batch_size + b) * number_of_heads + n;
+        for (int m = 0; m < all_sequence_length; m++) {
+          for (int h = 0; h < head_size; h++) {
+            present_data[(chunk * state_length + m) * head_size + h] =
+                m < past_sequence_length
+                    ? past_data[(chunk * past_state_length + m) * head_size + h]
+                    : project(b, m - past_sequence_length, (kv + 1) * hidden_size + n * head_size + h);
+          }
+        }
+      }
+    }
+  }
+  auto state = [&](int kv, int b, int n, int m, int h) {
+    return present_data[(((kv * batch_size + b) * number_of_heads + n) * state_length + m) * head_size + h];
+  };
+
+  auto is_masked = [&](int b, int m) {
+    if (mask_index_data.empty()) {
+      return false;
+    }
+    if (mask_index_dims.size() == 2) {
+      return mask_index_data[b * all_sequence_length + m] == 0;
+    }
+    return m >= mask_index_data[b] ||
+           (static_cast<int>(mask_index_dims[0]) == 2 * batch_size && m < mask_index_data[batch_size + b]);
+  };
+
+  std::vector<float> output(static_cast<size_t>(batch_size) * sequence_length * hidden_size);
+  for (int b = 0; b < batch_size; b++) {
+    for (int n = 0; n < number_of_heads; n++) {
+      for (int s = 0; s < sequence_length; s++) {
+        const int position = past_sequence_length + s;
+        std::vector<float> scores(all_sequence_length);
+        for (int m = 0; m < all_sequence_length; m++) {
+          bool is_attended = (position < num_global_tokens || m < num_global_tokens ||
+                              std::abs(position - m) <= window) &&
+                             !(is_unidirectional && m > position);
+          if (!is_attended) {
+            scores[m] = -10000.0f;
+            continue;
+          }
+          float dot = 0.0f;
+          for (int h = 0; h < head_size; h++) {
+            dot += project(b, s, n * head_size + h) * state(0, b, n, m, h);
+          }
+          scores[m] = dot / std::sqrt(static_cast<float>(head_size)) + (is_masked(b, m) ? -10000.0f : 0.0f);
+        }
+
+        float max_score = *std::max_element(scores.begin(), scores.end());
+        float sum = 0.0f;
+        for (float& score : scores) {
+          score = std::exp(score - max_score);
+          sum += score;
+        }
+        for (int h = 0; h < head_size; h++) {
+          float value = 0.0f;
+          for (int m = 0; m < all_sequence_length; m++) {
+            value += scores[m] / sum * state(1, b, n, m, h);
+          }
+          output[(b * sequence_length + s) * hidden_size + n * head_size + h] = value;
+        }
+      }
+    }
+  }
+  return output;
+}
+
+// Run sliding window attention with past state of past_sequence_length tokens when it is positive, in past and
+// present buffers of max_sequence_length positions shared through the past_sequence_length input when that is
+// positive. The 1D mask_index has (B) or (2B) elements, and mask_index_dims is given for 2D mask_index.
+static void RunWindowAttentionTest(int batch_size, int sequence_length, int hidden_size, int number_of_heads,
+                                   int window, int num_global_tokens, bool is_unidirectional,
+                                   const std::vector<int32_t>& mask_index_data,
+                                   std::vector<int64_t> mask_index_dims = {},
+                                   int past_sequence_length = 0,
+                                   int max_sequence_length = 0) {
+  const int head_size = hidden_size / number_of_heads;
+  const int past_state_length = max_sequence_length > 0 ? max_sequence_length : past_sequence_length;
+  const int present_state_length = max_sequence_length > 0 ? max_sequence_length
+                                                           : past_sequence_length + sequence_length;
+  if (mask_index_dims.empty()) {
+    mask_index_dims.push_back(static_cast<int64_t>(mask_index_data.size()));
+  }
+
+  RandomValueGenerator random{};
+  const std::vector<float> input_data = random.Uniform<float>(
+      std::vector<int64_t>{batch_size, sequence_length, hidden_size}, -1.0f, 1.0f);
+  const std::vector<float> weight_data = random.Uniform<float>(
+      std::vector<int64_t>{hidden_size, 3 * hidden_size}, -0.5f, 0.5f);
+  const std::vector<float> bias_data = random.Uniform<float>(std::vector<int64_t>{3 * hidden_size}, -0.5f, 0.5f);
+  const std::vector<int64_t> past_dims{2, batch_size, number_of_heads, past_state_length, head_size};
+  const std::vector<int64_t> present_dims{2, batch_size, number_of_heads, present_state_length, head_size};
+  const bool has_past = past_sequence_length > 0 || max_sequence_length > 0;
+  std::vector<float> past_data;
+  if (has_past) {
+    past_data = random.Uniform<float>(past_dims, -1.0f, 1.0f);
+  }
+  std::vector<float> present_data;
+  const std::vector<float> output_data = ComputeWindowAttentionReference(
+      input_data, weight_data, bias_data, past_data, mask_index_data, mask_index_dims, batch_size, sequence_length,
+      hidden_size, number_of_heads, past_sequence_length, max_sequence_length, window, num_global_tokens,
+      is_unidirectional, present_data);
+
+  // Positions after the past state in shared buffers are not used, and they are not changed by the kernel.
+  if (max_sequence_length > 0) {
+    const size_t chunk_length = static_cast<size_t>(max_sequence_length) * head_size;
+    const size_t present_length = static_cast<size_t>(past_sequence_length + sequence_length) * head_size;
+    for (size_t i = 0; i < past_data.size(); i++) {
+      if (i % chunk_length >= present_length) {
+        present_data[i] = past_data[i];
+      }
+    }
+  }
+
+  OpTester tester("Attention", 1, onnxruntime::kMSDomain);
+  tester.AddAttribute<int64_t>("num_heads", static_cast<int64_t>(number_of_heads));
+  tester.AddAttribute<int64_t>("unidirectional", static_cast<int64_t>(is_unidirectional ? 1 : 0));
+  tester.AddAttribute<int64_t>("window", static_cast<int64_t>(window));
+  tester.AddAttribute<int64_t>("num_global_tokens", static_cast<int64_t>(num_global_tokens));
+  if (max_sequence_length > 0) {
+    tester.AddAttribute<int64_t>("past_present_share_buffer", static_cast<int64_t>(1));
+  }
+  tester.AddInput<float>("input", {batch_size, sequence_length, hidden_size}, input_data);
+  tester.AddInput<float>("weight", {hidden_size, 3 * hidden_size}, weight_data);
+  tester.AddInput<float>("bias", {3 * hidden_size}, bias_data);
+  if (mask_index_data.empty()) {
+    tester.AddOptionalInputEdge<int32_t>();
+  } else {
+    tester.AddInput<int32_t>("mask_index", mask_index_dims, mask_index_data);
+  }
+  if (has_past) {
+    tester.AddInput<float>("past", past_dims, past_data);
+  }
+  if (max_sequence_length > 0) {
+    tester.AddOptionalInputEdge<float>();
+    tester.AddInput<int32_t>("past_sequence_length", {}, {past_sequence_length});
+  }
+  tester.AddOutput<float>("output", {batch_size, sequence_length, hidden_size}, output_data, false, 0.0001f, 0.0001f);
+  if (has_past) {
+    tester.AddOutput<float>("present", present_dims, present_data, false, 0.0001f, 0.0001f);
+  }
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  tester.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+}
+
+// Global tokens, and query blocks whose key bands are clipped at both ends of the sequence.
+TEST(AttentionTest, AttentionSlidingWindow) {
+  RunWindowAttentionTest(2, 40, 8, 2, 3, 2, false, {40, 33});
+}
+
+TEST(AttentionTest, AttentionSlidingWindowUnidirectional) {
+  RunWindowAttentionTest(1, 37, 8, 2, 5, 0, true, {});
+  RunWindowAttentionTest(2, 70, 8, 2, 20, 1, true, {70, 52});
+}
+
+// Windows of new tokens cover keys of past state, and global tokens are in past state.
+TEST(AttentionTest, AttentionSlidingWindowPastState) {
+  RunWindowAttentionTest(2, 20, 8, 2, 4, 2, false, {30, 27}, {}, 10);
+  RunWindowAttentionTest(2, 20, 8, 2, 6, 1, true, {}, {}, 30);
+  RunWindowAttentionTest(2, 1, 8, 2, 6, 1, true, {}, {}, 40);
+}
+
+// Keys and values are appended to past state in place, and only past_sequence_length positions of the buffers are
+// attended.
+TEST(AttentionTest, AttentionSlidingWindowSharedBuffer) {
+  RunWindowAttentionTest(2, 20, 8, 2, 6, 1, true, {}, {}, 10, 48);
+  RunWindowAttentionTest(2, 1, 8, 2, 6, 1, true, {}, {}, 40, 48);
+  RunWindowAttentionTest(1, 24, 8, 2, 5, 0, true, {}, {}, 0, 32);
+}
+
+// Raw attention mask of 0 and 1 for past and new tokens. The first token is global and not masked, so every query
+// has a key to attend.
+TEST(AttentionTest, AttentionSlidingWindowMask2D) {
+  constexpr int batch_size = 2;
+  constexpr int sequence_length = 24;
+  auto get_mask = [&](int all_sequence_length) {
+    std::vector<int32_t> mask(batch_size * all_sequence_length);
+    for (int m = 0; m < all_sequence_length; m++) {
+      mask[m] = m < all_sequence_length - 6 ? 1 : 0;
+      mask[all_sequence_length + m] = m % 5 == 3 ? 0 : 1;
+    }
+    return mask;
+  };
+
+  RunWindowAttentionTest(batch_size, sequence_length, 8, 2, 4, 1, false, get_mask(sequence_length),
+                         {batch_size, sequence_length});
+  for (int max_sequence_length : {0, 40}) {
+    constexpr int past_sequence_length = 8;
+    constexpr int all_sequence_length = past_sequence_length + sequence_length;
+    RunWindowAttentionTest(batch_size, sequence_length, 8, 2, 4, 1, true, get_mask(all_sequence_length),
+                           {batch_size, all_sequence_length}, past_sequence_length, max_sequence_length);
+  }
+}
+
+// Mask index of (2B) with end positions followed by start positions, for sequences padded on the left. Queries of
+// padding attend to keys after the start position, or the start position is in past state.
+TEST(AttentionTest, AttentionSlidingWindowLeftPadding) {
+  RunWindowAttentionTest(2, 30, 8, 2, 5, 0, false, {30, 30, 0, 4});
+  RunWindowAttentionTest(2, 16, 8, 2, 5, 0, true, {24, 24, 0, 6}, {}, 8);
+  RunWindowAttentionTest(2, 16, 8, 2, 5, 0, true, {24, 24, 0, 6}, {}, 8, 32);
+}
+
 TEST(AttentionTest, Attention_Mask2D_Fp32_B2_S32) {
   constexpr int batch_size = 2;
   constexpr int sequence_length = 32;
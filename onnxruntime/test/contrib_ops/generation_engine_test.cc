@@ -0,0 +1,213 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "contrib_ops/cpu/transformers/generation_engine.h"
+#include "test/contrib_ops/tiny_gpt2_model.h"
+#include "test/framework/test_utils.h"
+#include "test/test_environment.h"
+#include "test/util/include/asserts.h"
+#include "test/util/include/inference_session_wrapper.h"
+
+namespace onnxruntime {
+namespace test {
+
+using contrib::transformers::GenerationEngine;
+using contrib::transformers::GenerationEngineOptions;
+using contrib::transformers::GenerationRequest;
+
+namespace {
+
+// Create a session of a GreedySearch model whose decoder is a tiny GPT-2. Prompts use tokens 1 to vocab_size - 1
+// so that none of them is padding.
+std::unique_ptr<InferenceSessionWrapper> CreateSession(const TinyGpt2Config& config, int eos_token_id) {
+  TinyGpt2GenerationConfig generation_config;
+  generation_config.eos_token_id = eos_token_id;
+  auto session = std::make_unique<InferenceSessionWrapper>(SessionOptions{}, GetEnvironment());
+  std::stringstream model_stream(CreateTinyGpt2GenerationModel(config, generation_config,
+                                                                DefaultLoggingManager().DefaultLogger()));
+  ORT_THROW_IF_ERROR(session->Load(model_stream));
+  ORT_THROW_IF_ERROR(session->Initialize());
+  return session;
+}
+
+const Node& GetGenerationNode(const InferenceSessionWrapper& session) {
+  for (const Node& node : session.GetGraph().Nodes()) {
+    if (node.Name() == "generation") {
+      return node;
+    }
+  }
+  ORT_THROW("generation node is not found");
+}
+
+// Run GreedySearch for one prompt, and return the generated tokens after the prompt.
+std::vector<int32_t> RunGreedySearch(InferenceSession& session, const std::vector<int32_t>& prompt,
+                                     int max_new_tokens) {
+  const int64_t sequence_length = static_cast<int64_t>(prompt.size());
+  const int32_t max_length = static_cast<int32_t>(prompt.size()) + max_new_tokens;
+  AllocatorPtr allocator = TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault);
+  std::vector<OrtValue> feeds(2);
+  CreateMLValue<int32_t>(allocator, {1, sequence_length}, prompt, &feeds[0]);
+  CreateMLValue<int32_t>(allocator, {1}, {max_length}, &feeds[1]);
+
+  std::vector<OrtValue> fetches;
+  ORT_THROW_IF_ERROR(session.Run(RunOptions{}, {"input_ids", "max_length"}, feeds, {"sequences"}, &fetches));
+  auto sequences = fetches[0].Get<Tensor>().DataAsSpan<int32_t>();
+  return std::vector<int32_t>(sequences.begin() + sequence_length, sequences.end());
+}
+
+struct StreamedTokens {
+  std::map<int64_t, std::vector<int32_t>> tokens;
+  std::map<int64_t, int> num_finished;  // number of tokens reported as finished
+
+  GenerationEngine::TokenCallback Callback() {
+    return [this](int64_t request_id, int32_t token, bool finished) {
+      tokens[request_id].push_back(token);
+      num_finished[request_id] += finished ? 1 : 0;
+      ASSERT_EQ(num_finished[request_id], finished ? 1 : 0) << "token after the last one of " << request_id;
+    };
+  }
+};
+
+std::vector<int32_t> GetPrompt(int length, int first, int vocab_size) {
+  std::vector<int32_t> prompt(static_cast<size_t>(length));
+  for (int i = 0; i < length; i++) {
+    prompt[i] = 1 + (first + i * 7) % (vocab_size - 1);
+  }
+  return prompt;
+}
+
+}  // namespace
+
+// Requests of different lengths join and leave the running batch at different steps. Each of them generates the
+// same tokens as GreedySearch with the same decoder.
+TEST(GenerationEngineTest, ContinuousBatchingMatchesGreedySearch) {
+  TinyGpt2Config config;
+  auto session = CreateSession(config, config.vocab_size);  // eos_token_id is never generated
+
+  StreamedTokens streamed;
+  GenerationEngineOptions options;
+  options.max_batch_size = 3;
+  GenerationEngine engine(session->GetSessionState(), GetGenerationNode(*session), options, streamed.Callback());
+
+  const int prompt_lengths[] = {3, 9, 5, 14, 1, 7, 11};
+  const int max_new_tokens[] = {6, 2, 12, 4, 9, 1, 5};
+  std::vector<std::vector<int32_t>> prompts;
+  std::vector<int64_t> request_ids;
+  for (int i = 0; i < 7; i++) {
+    GenerationRequest request;
+    request.input_ids = GetPrompt(prompt_lengths[i], i * 5, config.vocab_size);
+    request.max_new_tokens = max_new_tokens[i];
+    prompts.push_back(request.input_ids);
+    request_ids.push_back(engine.AddRequest(std::move(request)));
+
+    // Later requests are added while the batch is running.
+    if (i == 3) {
+      ASSERT_STATUS_OK(engine.Step());
+      ASSERT_STATUS_OK(engine.Step());
+      EXPECT_EQ(engine.NumRunning(), 3u);
+    }
+  }
+  ASSERT_STATUS_OK(engine.Run());
+  EXPECT_FALSE(engine.HasWork());
+  EXPECT_EQ(engine.NumRunning(), 0u);
+
+  for (int i = 0; i < 7; i++) {
+    SCOPED_TRACE("request " + std::to_string(i));
+    EXPECT_EQ(streamed.tokens[request_ids[i]], RunGreedySearch(*session, prompts[i], max_new_tokens[i]));
+    EXPECT_EQ(streamed.num_finished[request_ids[i]], 1);
+  }
+}
+
+// A prompt that extends a previous one starts from the past state in the prefix cache of the decoder.
+TEST(GenerationEngineTest, PrefixCacheAcrossRequests) {
+  TinyGpt2Config config;
+  auto session = CreateSession(config, config.vocab_size);
+
+  StreamedTokens streamed;
+  GenerationEngineOptions options;
+  options.prefix_cache_size = 1 << 20;
+  GenerationEngine engine(session->GetSessionState(), GetGenerationNode(*session), options, streamed.Callback());
+
+  std::vector<int32_t> first = GetPrompt(20, 0, config.vocab_size);
+  std::vector<int32_t> second = first;
+  second.insert(second.end(), {5, 6, 7});
+  for (const auto& prompt : {first, second}) {
+    GenerationRequest request;
+    request.input_ids = prompt;
+    request.max_new_tokens = 6;
+    int64_t request_id = engine.AddRequest(std::move(request));
+    ASSERT_STATUS_OK(engine.Run());
+    EXPECT_EQ(streamed.tokens[request_id], RunGreedySearch(*session, prompt, 6));
+  }
+
+  EXPECT_GT(engine.GetSubgraph().GetPrefixCache()->GetStats().hits, 0);
+}
+
+// A sequence finishes after generating eos_token_id, and leaves the batch while the others continue.
+TEST(GenerationEngineTest, StopAtEndToken) {
+  TinyGpt2Config config;
+  std::vector<int32_t> prompt = GetPrompt(6, 3, config.vocab_size);
+  std::vector<int32_t> expected;
+  {
+    auto session = CreateSession(config, config.vocab_size);
+    expected = RunGreedySearch(*session, prompt, 8);
+  }
+
+  // The third generated token is the end token.
+  auto session = CreateSession(config, expected[2]);
+  StreamedTokens streamed;
+  GenerationEngine engine(session->GetSessionState(), GetGenerationNode(*session), GenerationEngineOptions{},
+                          streamed.Callback());
+  GenerationRequest request;
+  request.input_ids = prompt;
+  request.max_new_tokens = 8;
+  int64_t stopped = engine.AddRequest(request);
+  request.input_ids = GetPrompt(4, 11, config.vocab_size);
+  request.max_new_tokens = 10;
+  int64_t other = engine.AddRequest(request);
+  ASSERT_STATUS_OK(engine.Run());
+
+  size_t length = static_cast<size_t>(std::find(expected.begin(), expected.end(), expected[2]) - expected.begin());
+  EXPECT_EQ(streamed.tokens[stopped], std::vector<int32_t>(expected.begin(), expected.begin() + length + 1));
+  EXPECT_EQ(streamed.num_finished[stopped], 1);
+  EXPECT_EQ(streamed.num_finished[other], 1);
+}
+
+// A cancelled request reports no more tokens, and does not change the tokens of the other requests. A queued
+// request is cancelled before it joins the batch.
+TEST(GenerationEngineTest, CancelRequest) {
+  TinyGpt2Config config;
+  auto session = CreateSession(config, config.vocab_size);
+  StreamedTokens streamed;
+  GenerationEngineOptions options;
+  options.max_batch_size = 2;
+  GenerationEngine engine(session->GetSessionState(), GetGenerationNode(*session), options, streamed.Callback());
+
+  GenerationRequest request;
+  request.max_new_tokens = 8;
+  request.input_ids = GetPrompt(5, 1, config.vocab_size);
+  int64_t cancelled = engine.AddRequest(request);
+  request.input_ids = GetPrompt(8, 2, config.vocab_size);
+  int64_t kept = engine.AddRequest(request);
+  int64_t queued = engine.AddRequest(request);
+
+  ASSERT_STATUS_OK(engine.Step());
+  engine.CancelRequest(cancelled);
+  engine.CancelRequest(queued);
+  ASSERT_STATUS_OK(engine.Run());
+
+  EXPECT_EQ(streamed.tokens[cancelled].size(), 2u);  // the first token from the prompt, and one more step
+  EXPECT_EQ(streamed.num_finished[cancelled], 0);
+  EXPECT_EQ(streamed.tokens.count(queued), 0u);
+  EXPECT_EQ(streamed.tokens[kept], RunGreedySearch(*session, request.input_ids, 8));
+}
+
+}  // namespace test
+}  // namespace onnxruntime
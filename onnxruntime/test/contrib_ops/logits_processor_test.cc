@@ -0,0 +1,154 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <unordered_set>
+#include <vector>
+#include "gtest/gtest.h"
+#include "contrib_ops/cpu/transformers/logits_processor.h"
+#include "contrib_ops/cpu/transformers/sequences.h"
+
+namespace onnxruntime {
+namespace contrib {
+namespace test {
+
+using namespace transformers;
+
+namespace {
+
+// Reference of logits processors, which scans the whole sequence in every step.
+void ProcessReference(const BeamSearchParameters& parameters, const Sequences& sequences,
+                      std::vector<float>& scores, int step) {
+  const int vocab_size = parameters.vocab_size;
+  const int ngram_size = parameters.no_repeat_ngram_size;
+  for (int i = 0; i < parameters.BatchBeamSize(); i++) {
+    gsl::span<const int32_t> sequence = sequences.GetSequence(i);
+    float* beam_scores = scores.data() + static_cast<size_t>(i) * vocab_size;
+
+    std::unordered_set<int32_t> unique_tokens(sequence.begin(), sequence.end());
+    for (int32_t token : unique_tokens) {
+      float score = beam_scores[token];
+      beam_scores[token] = score < 0 ? score * parameters.repetition_penalty : score / parameters.repetition_penalty;
+    }
+
+    const int length = static_cast<int>(sequence.size());
+    if (ngram_size > 0 && ngram_size <= length) {
+      const int prefix_length = ngram_size - 1;
+      for (int j = 0; j + ngram_size <= length; j++) {
+        if (std::equal(sequence.begin() + j, sequence.begin() + j + prefix_length,
+                       sequence.begin() + (length - prefix_length))) {
+          beam_scores[sequence[j + prefix_length]] = std::numeric_limits<float>::lowest();
+        }
+      }
+    }
+
+    for (int j = 0; j < vocab_size; j++) {
+      if (parameters.vocab_mask[j] == 0) {
+        beam_scores[j] = std::numeric_limits<float>::lowest();
+      }
+      if (step == 1 && parameters.prefix_vocab_mask[(i / parameters.num_beams) * vocab_size + j] == 0) {
+        beam_scores[j] = std::numeric_limits<float>::lowest();
+      }
+    }
+
+    if (length < parameters.min_length) {
+      beam_scores[parameters.eos_token_id] = std::numeric_limits<float>::lowest();
+    }
+  }
+}
+
+// Run beam search steps with random beam reordering, and compare processed scores with the reference.
+void RunLogitsProcessors(int ngram_size, int num_beams) {
+  constexpr int batch_size = 2;
+  constexpr int vocab_size = 40;
+  constexpr int num_frequent_tokens = 6;  // most tokens are from a small set, so that n-grams repeat
+  constexpr int sequence_length = 5;
+  constexpr int max_length = 40;
+
+  std::vector<int32_t> vocab_mask(vocab_size, 1);
+  vocab_mask[7] = 0;
+  vocab_mask[31] = 0;
+  std::vector<int32_t> prefix_vocab_mask(batch_size * vocab_size, 1);
+  prefix_vocab_mask[3] = 0;
+  prefix_vocab_mask[vocab_size + 20] = 0;
+
+  BeamSearchParameters parameters{};
+  parameters.batch_size = batch_size;
+  parameters.num_beams = num_beams;
+  parameters.vocab_size = vocab_size;
+  parameters.repetition_penalty = 1.5f;
+  parameters.no_repeat_ngram_size = ngram_size;
+  parameters.min_length = 12;
+  parameters.eos_token_id = 2;
+  parameters.vocab_mask = vocab_mask;
+  parameters.prefix_vocab_mask = prefix_vocab_mask;
+
+  const int batch_beam_size = parameters.BatchBeamSize();
+  std::vector<int32_t> sequences_space(2 * static_cast<size_t>(batch_beam_size) * max_length);
+  std::default_random_engine generator{static_cast<uint32_t>(ngram_size * 7 + num_beams)};
+  std::uniform_int_distribution<int32_t> frequent_token(0, num_frequent_tokens - 1);
+  std::uniform_int_distribution<int32_t> any_token(0, vocab_size - 1);
+  std::uniform_int_distribution<int32_t> beam(0, num_beams - 1);
+  std::uniform_real_distribution<float> score(-10.0f, -0.1f);
+  auto next_token = [&]() { return generator() % 4 == 0 ? any_token(generator) : frequent_token(generator); };
+
+  for (int i = 0; i < batch_beam_size; i++) {
+    for (int j = 0; j < sequence_length; j++) {
+      sequences_space[static_cast<size_t>(i) * max_length + j] = next_token();
+    }
+  }
+
+  Sequences sequences;
+  sequences.Init(sequences_space, batch_beam_size, sequence_length, max_length);
+
+  LogitsProcessorList processors;
+  processors.Init(parameters, nullptr);
+
+  for (int step = 1; step < max_length - sequence_length; step++) {
+    std::vector<float> scores(static_cast<size_t>(batch_beam_size) * vocab_size);
+    for (auto& value : scores) {
+      value = score(generator);
+    }
+    std::vector<float> expected = scores;
+    ProcessReference(parameters, sequences, expected, step);
+
+    gsl::span<float> next_token_scores(scores);
+    processors.Process(&sequences, next_token_scores, step);
+    ASSERT_EQ(scores, expected) << "step " << step;
+
+    // Greedy search appends tokens only, and beam search also reorders beams within each batch.
+    std::vector<int32_t> beam_indices(batch_beam_size);
+    std::vector<int32_t> tokens(batch_beam_size);
+    for (int i = 0; i < batch_beam_size; i++) {
+      beam_indices[i] = (i / num_beams) * num_beams + beam(generator);
+      tokens[i] = next_token();
+    }
+    gsl::span<int32_t> next_tokens(tokens);
+    if (num_beams == 1) {
+      sequences.AppendNextTokenToSequences(next_tokens);
+    } else {
+      gsl::span<int32_t> next_beam_indices(beam_indices);
+      sequences.AppendNextTokenToSequences(next_beam_indices, next_tokens);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(LogitsProcessorTest, IncrementalMatchesReferenceGreedy) {
+  for (int ngram_size : {0, 1, 2, 3}) {
+    RunLogitsProcessors(ngram_size, 1);
+  }
+}
+
+TEST(LogitsProcessorTest, IncrementalMatchesReferenceBeamSearch) {
+  for (int ngram_size : {0, 1, 2, 3}) {
+    RunLogitsProcessors(ngram_size, 4);
+  }
+}
+
+}  // namespace test
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -1,6 +1,9 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <random>
+
+#include "contrib_ops/cpu/maxpool_with_mask.h"
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
 
@@ -80,5 +83,55 @@ TEST(ContribOpTest, MaxPoolWithMask) {
   test.Run();
 }
 
+// Runs MaxpoolWithMask with masks that keep a prefix of every row, which are pooled by MLAS, or with random masks,
+// which are pooled by the tasks, and expects the results of MaxpoolWithMask2DTask.
+static void TestMaxPoolWithMaskMatchesTask(bool prefix_masks) {
+  const int64_t height = 6, width = 10;
+  const std::vector<int64_t> x_dims = {1, 2, height, width};
+  const TensorShapeVector kernel_shape{3, 3};
+  const TensorShapeVector pads{1, 1, 1, 1};
+  const int64_t stride_h = 1, stride_w = 2;
+  const int64_t pooled_height = (height + 2 - 3) / stride_h + 1;
+  const int64_t pooled_width = (width + 2 - 3) / stride_w + 1;
+
+  std::default_random_engine generator(prefix_masks ? 3 : 5);
+  std::uniform_int_distribution<int> value_distribution(-8, 8);
+  std::uniform_int_distribution<int> length_distribution(0, static_cast<int>(width));
+  std::vector<float> x_vals(static_cast<size_t>(2 * height * width));
+  std::vector<int32_t> m_vals(x_vals.size());
+  for (auto& x : x_vals) {
+    x = static_cast<float>(value_distribution(generator));
+  }
+  for (int64_t row = 0; row < 2 * height; ++row) {
+    const int length = length_distribution(generator);
+    for (int64_t w = 0; w < width; ++w) {
+      m_vals[row * width + w] = prefix_masks ? (w < length ? 1 : 0) : value_distribution(generator) > 0;
+    }
+  }
+
+  std::vector<float> expected_vals(static_cast<size_t>(2 * pooled_height * pooled_width));
+  contrib::MaxpoolWithMask2DTask<float>{x_vals.data(), m_vals.data(), expected_vals.data(), height * width,
+                                        pooled_height * pooled_width, pooled_height, pooled_width, stride_h,
+                                        stride_w, height, width, 2, kernel_shape, pads}(0, 2);
+
+  OpTester test("MaxpoolWithMask", 1, onnxruntime::kMSDomain);
+  test.AddAttribute("auto_pad", "");
+  test.AddAttribute("strides", std::vector<int64_t>{stride_h, stride_w});
+  test.AddAttribute("pads", std::vector<int64_t>{1, 1, 1, 1});
+  test.AddAttribute("kernel_shape", std::vector<int64_t>{3, 3});
+  test.AddInput<float>("X", x_dims, x_vals);
+  test.AddInput<int32_t>("M", x_dims, m_vals);
+  test.AddOutput<float>("Y", {1, 2, pooled_height, pooled_width}, expected_vals);
+  test.Run();
+}
+
+TEST(ContribOpTest, MaxPoolWithMaskPrefixMasks) {
+  TestMaxPoolWithMaskMatchesTask(true);
+}
+
+TEST(ContribOpTest, MaxPoolWithMaskRandomMasks) {
+  TestMaxPoolWithMaskMatchesTask(false);
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -258,5 +258,35 @@ TEST(NhwcMaxPoolContribOpTest, MaxPoolDilations_S8) {
   test.Run();
 }
 
+TEST(NhwcMaxPoolContribOpTest, MaxPool2D_F32) {
+  for (int64_t channels = 1; channels < 22; channels++) {
+    NhwcMaxPoolOpTester<float> test;
+    test.GenerateRandomInput({2, 15, 19, channels});
+    test.SetKernelShape({3, 5});
+    test.SetPads({1, 1, 1, 1});
+    test.Run();
+  }
+}
+
+TEST(NhwcMaxPoolContribOpTest, MaxPoolDilations_F32) {
+  NhwcMaxPoolOpTester<float> test;
+  test.GenerateRandomInput({4, 23, 19, 19});
+  test.SetKernelShape({3, 3});
+  test.SetPads({2, 1, 2, 1});
+  test.SetStrides({1, 2});
+  test.SetDilations({2, 3});
+  test.Run();
+}
+
+// Each image produces 37 * 29 = 1073 output pixels, so the work is split into three blocks of up to 512
+// outputs per image, the last of them partial.
+TEST(NhwcMaxPoolContribOpTest, MaxPoolMultipleOutputBlocks_F32) {
+  NhwcMaxPoolOpTester<float> test;
+  test.GenerateRandomInput({3, 37, 29, 7});
+  test.SetKernelShape({3, 3});
+  test.SetPads({1, 1, 1, 1});
+  test.Run();
+}
+
 }  // namespace test
 }  // namespace onnxruntime
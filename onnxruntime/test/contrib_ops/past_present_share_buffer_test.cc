@@ -0,0 +1,85 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <sstream>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "core/session/inference_session.h"
+#include "test/contrib_ops/tiny_gpt2_model.h"
+#include "test/framework/test_utils.h"
+#include "test/test_environment.h"
+#include "test/util/include/asserts.h"
+
+namespace onnxruntime {
+namespace test {
+
+namespace {
+
+constexpr int kPadTokenId = 0;
+constexpr int kBatchSize = 2;
+constexpr int kSequenceLength = 4;
+constexpr int kMaxLength = 20;
+
+// The first sequence is padded on the left.
+const std::vector<int32_t> kInputIds{kPadTokenId, kPadTokenId, 5, 9,
+                                     3, 17, 42, 8};
+
+// Run a BeamSearch or GreedySearch model, whose decoder has shared past and present buffers when
+// past_present_share_buffer is set, and return the output sequences. BeamSearch returns all the beams.
+std::vector<int32_t> RunGeneration(const std::string& op_type, bool past_present_share_buffer, int num_beams) {
+  TinyGpt2Config config;
+  config.num_layers = 3;
+  config.past_present_share_buffer = past_present_share_buffer;
+
+  TinyGpt2GenerationConfig generation_config;
+  generation_config.op_type = op_type;
+  generation_config.eos_token_id = config.vocab_size;  // never generated, so that all sequences have max_length tokens
+  generation_config.pad_token_id = kPadTokenId;
+
+  InferenceSession session{SessionOptions{}, GetEnvironment()};
+  std::stringstream model_stream(CreateTinyGpt2GenerationModel(config, generation_config,
+                                                                DefaultLoggingManager().DefaultLogger()));
+  ORT_THROW_IF_ERROR(session.Load(model_stream));
+  ORT_THROW_IF_ERROR(session.Initialize());
+
+  AllocatorPtr allocator = TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault);
+  std::vector<std::string> feed_names{"input_ids", "max_length"};
+  std::vector<OrtValue> feeds(2);
+  CreateMLValue<int32_t>(allocator, {kBatchSize, kSequenceLength}, kInputIds, &feeds[0]);
+  CreateMLValue<int32_t>(allocator, {1}, {kMaxLength}, &feeds[1]);
+  if (op_type == "BeamSearch") {
+    feeds.resize(4);
+    CreateMLValue<int32_t>(allocator, {1}, {num_beams}, &feeds[2]);
+    CreateMLValue<int32_t>(allocator, {1}, {num_beams}, &feeds[3]);
+    feed_names.insert(feed_names.end(), {"num_beams", "num_return_sequences"});
+  }
+
+  std::vector<OrtValue> fetches;
+  ORT_THROW_IF_ERROR(session.Run(RunOptions{}, feed_names, feeds, {"sequences"}, &fetches));
+  auto sequences = fetches[0].Get<Tensor>().DataAsSpan<int32_t>();
+  return std::vector<int32_t>(sequences.begin(), sequences.end());
+}
+
+}  // namespace
+
+// The new key and value are appended in place to max length past buffers, which are bound as present outputs.
+TEST(PastPresentShareBufferTest, GreedySearchMatchesCopy) {
+  const std::vector<int32_t> expected = RunGeneration("GreedySearch", false, 1);
+  ASSERT_EQ(expected.size(), static_cast<size_t>(kBatchSize * kMaxLength));
+
+  EXPECT_EQ(RunGeneration("GreedySearch", true, 1), expected);
+}
+
+// Beams that continue from another beam copy the valid part of its past state in place.
+TEST(PastPresentShareBufferTest, BeamSearchMatchesCopy) {
+  for (int num_beams : {2, 4}) {
+    const std::vector<int32_t> expected = RunGeneration("BeamSearch", false, num_beams);
+    ASSERT_EQ(expected.size(), static_cast<size_t>(kBatchSize * num_beams * kMaxLength));
+
+    EXPECT_EQ(RunGeneration("BeamSearch", true, num_beams), expected) << "num_beams=" << num_beams;
+  }
+}
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -0,0 +1,303 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <fstream>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "core/session/inference_session.h"
+#include "contrib_ops/cpu/transformers/prefix_cache.h"
+#include "test/contrib_ops/tiny_gpt2_model.h"
+#include "test/framework/test_utils.h"
+#include "test/test_environment.h"
+#include "test/util/include/asserts.h"
+
+namespace onnxruntime {
+namespace test {
+
+using contrib::transformers::PrefixCache;
+
+namespace {
+
+constexpr int kNumHeads = 2;
+constexpr int kHeadSize = 3;
+constexpr int kBlockSize = 4;
+
+// Past state of two layers for a batch of sequences, shape (2, batch_size, num_heads, max_length, head_size).
+struct PastState {
+  PastState(int batch_size, int max_length) : batch_size(batch_size), max_length(max_length) {
+    for (auto& layer : layers) {
+      layer.resize(static_cast<size_t>(2) * batch_size * kNumHeads * max_length * kHeadSize);
+    }
+  }
+
+  float& At(int layer, int kv, int batch_index, int head, int position, int i) {
+    size_t index = ((static_cast<size_t>(kv) * batch_size + batch_index) * kNumHeads + head) * max_length + position;
+    return layers[layer][index * kHeadSize + i];
+  }
+
+  std::vector<const float*> Data() const { return {layers[0].data(), layers[1].data()}; }
+  std::vector<float*> MutableData() { return {layers[0].data(), layers[1].data()}; }
+
+  int batch_size;
+  int max_length;
+  std::vector<float> layers[2];
+};
+
+// State of a token depends on the token and its position, like in a GPT model that runs the same prompt.
+float StateOf(int32_t token, int layer, int kv, int head, int position, int i) {
+  return static_cast<float>(token * 1000 + layer * 100 + kv * 50 + head * 10 + position) + 0.1f * i;
+}
+
+// Fill the state of the second sequence in a batch of 2 with the state of tokens.
+PastState CreatePastState(const std::vector<int32_t>& tokens, int max_length) {
+  PastState past(2, max_length);
+  for (int layer = 0; layer < 2; layer++) {
+    for (int kv = 0; kv < 2; kv++) {
+      for (int head = 0; head < kNumHeads; head++) {
+        for (int position = 0; position < static_cast<int>(tokens.size()); position++) {
+          for (int i = 0; i < kHeadSize; i++) {
+            past.At(layer, kv, 1, head, position, i) = StateOf(tokens[position], layer, kv, head, position, i);
+          }
+        }
+      }
+    }
+  }
+  return past;
+}
+
+std::vector<int32_t> GetTokens(int length, int32_t first) {
+  std::vector<int32_t> tokens(length);
+  std::iota(tokens.begin(), tokens.end(), first);
+  return tokens;
+}
+
+}  // namespace
+
+TEST(PrefixCacheTest, FindLongestPrefixOfFullBlocks) {
+  PrefixCache cache(1 << 20, kBlockSize);
+  const std::vector<int32_t> prompt = GetTokens(10, 1);
+  PastState past = CreatePastState(prompt, 12);
+  cache.Insert(prompt, past.Data(), 2, 1, kNumHeads, 12, kHeadSize);
+
+  // Two full blocks are cached. At most max_length tokens are reused.
+  std::shared_ptr<const PrefixCache::Entry> entry;
+  EXPECT_EQ(cache.Find(prompt, 9, entry), 8);
+  EXPECT_EQ(cache.Find(prompt, 7, entry), 4);
+
+  // Prompts that share the first block only, or nothing.
+  std::vector<int32_t> other = prompt;
+  other[6] = 60;
+  EXPECT_EQ(cache.Find(other, 9, entry), 4);
+  other[0] = 60;
+  EXPECT_EQ(cache.Find(other, 9, entry), 0);
+
+  auto stats = cache.GetStats();
+  EXPECT_EQ(stats.hits, 3);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.reused_tokens, 16);
+  EXPECT_EQ(stats.num_entries, 1u);
+
+  // Copy state of the first 8 tokens to the first sequence in a batch of 3, whose buffers have 16 positions.
+  ASSERT_EQ(cache.Find(prompt, 9, entry), 8);
+  PastState copied(3, 16);
+  entry->CopyTo(8, copied.MutableData(), 3, 0, 16);
+  for (int layer = 0; layer < 2; layer++) {
+    for (int kv = 0; kv < 2; kv++) {
+      for (int head = 0; head < kNumHeads; head++) {
+        for (int position = 0; position < 16; position++) {
+          for (int i = 0; i < kHeadSize; i++) {
+            float expected = position < 8 ? StateOf(prompt[position], layer, kv, head, position, i) : 0.0f;
+            ASSERT_EQ(copied.At(layer, kv, 0, head, position, i), expected);
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(PrefixCacheTest, EvictLeastRecentlyUsed) {
+  // Each entry has 4 tokens and state of 2 * 2 * 2 * 4 * 3 = 96 floats, so the budget holds two entries.
+  const size_t entry_bytes = (96 + 4) * sizeof(float);
+  PrefixCache cache(2 * entry_bytes + 1, kBlockSize);
+
+  const std::vector<int32_t> prompts[] = {GetTokens(5, 0), GetTokens(5, 100), GetTokens(5, 200)};
+  std::shared_ptr<const PrefixCache::Entry> entry;
+  for (int i = 0; i < 2; i++) {
+    PastState past = CreatePastState(prompts[i], 8);
+    cache.Insert(prompts[i], past.Data(), 2, 1, kNumHeads, 8, kHeadSize);
+  }
+  EXPECT_EQ(cache.GetStats().bytes, 2 * entry_bytes);
+
+  // The first prompt is used again, so the second one is evicted by the third one.
+  ASSERT_EQ(cache.Find(prompts[0], 4, entry), 4);
+  PastState past = CreatePastState(prompts[2], 8);
+  cache.Insert(prompts[2], past.Data(), 2, 1, kNumHeads, 8, kHeadSize);
+
+  EXPECT_EQ(cache.Find(prompts[0], 4, entry), 4);
+  EXPECT_EQ(cache.Find(prompts[1], 4, entry), 0);
+  EXPECT_EQ(cache.Find(prompts[2], 4, entry), 4);
+  auto stats = cache.GetStats();
+  EXPECT_EQ(stats.evictions, 1);
+  EXPECT_EQ(stats.num_entries, 2u);
+  EXPECT_EQ(stats.bytes, 2 * entry_bytes);
+
+  // An entry that does not fit in the budget is not added.
+  PrefixCache small_cache(entry_bytes - 1, kBlockSize);
+  small_cache.Insert(prompts[0], past.Data(), 2, 1, kNumHeads, 8, kHeadSize);
+  EXPECT_EQ(small_cache.GetStats().num_entries, 0u);
+}
+
+namespace {
+
+constexpr int kBatchSize = 2;
+constexpr int kSequenceLength = 20;
+constexpr int kMaxLength = 28;
+
+// Create a session of a BeamSearch or GreedySearch model, which keeps prompt prefixes in a cache of
+// prefix_cache_size bytes.
+std::unique_ptr<InferenceSession> CreateSession(const TinyGpt2Config& config,
+                                                TinyGpt2GenerationConfig generation_config,
+                                                int64_t prefix_cache_size,
+                                                const SessionOptions& session_options = SessionOptions{}) {
+  generation_config.eos_token_id = config.vocab_size;  // never generated
+  generation_config.prefix_cache_size = prefix_cache_size;
+  auto session = std::make_unique<InferenceSession>(session_options, GetEnvironment());
+  std::stringstream model_stream(CreateTinyGpt2GenerationModel(config, generation_config,
+                                                                DefaultLoggingManager().DefaultLogger()));
+  ORT_THROW_IF_ERROR(session->Load(model_stream));
+  ORT_THROW_IF_ERROR(session->Initialize());
+  return session;
+}
+
+// Run the session, and return the output sequences. BeamSearch returns all the beams.
+std::vector<int32_t> RunGeneration(InferenceSession& session, const std::vector<int32_t>& input_ids,
+                                   int num_beams = 1) {
+  AllocatorPtr allocator = TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault);
+  std::vector<std::string> feed_names{"input_ids", "max_length"};
+  std::vector<OrtValue> feeds(2);
+  CreateMLValue<int32_t>(allocator, {kBatchSize, kSequenceLength}, input_ids, &feeds[0]);
+  CreateMLValue<int32_t>(allocator, {1}, {kMaxLength}, &feeds[1]);
+  if (num_beams > 1) {
+    feeds.resize(4);
+    CreateMLValue<int32_t>(allocator, {1}, {num_beams}, &feeds[2]);
+    CreateMLValue<int32_t>(allocator, {1}, {num_beams}, &feeds[3]);
+    feed_names.insert(feed_names.end(), {"num_beams", "num_return_sequences"});
+  }
+
+  std::vector<OrtValue> fetches;
+  ORT_THROW_IF_ERROR(session.Run(RunOptions{}, feed_names, feeds, {"sequences"}, &fetches));
+  auto sequences = fetches[0].Get<Tensor>().DataAsSpan<int32_t>();
+  return std::vector<int32_t>(sequences.begin(), sequences.end());
+}
+
+// Prompts without padding. The second one shares the first 16 tokens (one block) with the first one, and the
+// third one is new.
+std::vector<std::vector<int32_t>> GetPrompts(int vocab_size) {
+  std::vector<int32_t> first(kBatchSize * kSequenceLength);
+  for (size_t i = 0; i < first.size(); i++) {
+    first[i] = static_cast<int32_t>(1 + (i * 7) % (vocab_size - 1));
+  }
+  std::vector<int32_t> second = first;
+  second[18] = 3;
+  second[kSequenceLength + 17] = 4;
+  std::vector<int32_t> third = first;
+  third[kSequenceLength] = 5;
+  return {first, first, second, third, third};
+}
+
+// Runs with prefix cache generate the same sequences as without the cache, including prompts that share only part
+// of a cached prompt.
+void RunWithAndWithoutCache(const TinyGpt2Config& config, const TinyGpt2GenerationConfig& generation_config,
+                            int num_beams = 1) {
+  auto session = CreateSession(config, generation_config, 0);
+  auto cached_session = CreateSession(config, generation_config, 1 << 20);
+  int run = 0;
+  for (const auto& prompt : GetPrompts(config.vocab_size)) {
+    EXPECT_EQ(RunGeneration(*cached_session, prompt, num_beams), RunGeneration(*session, prompt, num_beams))
+        << "run " << run++;
+  }
+}
+
+}  // namespace
+
+TEST(PrefixCacheTest, GreedySearchWithPrefixCache) {
+  RunWithAndWithoutCache(TinyGpt2Config{}, TinyGpt2GenerationConfig{});
+}
+
+// Cached state of a prompt is copied to all of its beams.
+TEST(PrefixCacheTest, BeamSearchWithPrefixCache) {
+  TinyGpt2GenerationConfig generation_config;
+  generation_config.op_type = "BeamSearch";
+  for (int num_beams : {2, 4}) {
+    SCOPED_TRACE("num_beams=" + std::to_string(num_beams));
+    RunWithAndWithoutCache(TinyGpt2Config{}, generation_config, num_beams);
+  }
+}
+
+// With shared past and present buffers, cached state is copied into the max length buffers, and
+// past_sequence_length starts from the prefix length.
+TEST(PrefixCacheTest, SharedBufferWithPrefixCache) {
+  TinyGpt2Config config;
+  config.past_present_share_buffer = true;
+  RunWithAndWithoutCache(config, TinyGpt2GenerationConfig{});
+
+  TinyGpt2GenerationConfig generation_config;
+  generation_config.op_type = "BeamSearch";
+  RunWithAndWithoutCache(config, generation_config, 2);
+}
+
+// The target model of speculative decoding starts from the cached prefix, and the draft model runs the whole prompt.
+TEST(PrefixCacheTest, SpeculativeDecodingWithPrefixCache) {
+  TinyGpt2Config draft_config;
+  draft_config.num_layers = 1;
+  TinyGpt2GenerationConfig generation_config;
+  generation_config.draft_config = &draft_config;
+  generation_config.num_speculative_tokens = 3;
+  for (bool past_present_share_buffer : {false, true}) {
+    SCOPED_TRACE("past_present_share_buffer=" + std::to_string(past_present_share_buffer));
+    TinyGpt2Config config;
+    config.num_layers = 3;
+    config.past_present_share_buffer = past_present_share_buffer;
+    RunWithAndWithoutCache(config, generation_config);
+  }
+}
+
+#if !defined(__wasm__)
+// Statistics of the cache are recorded in the profile for each run.
+TEST(PrefixCacheTest, StatisticsInProfile) {
+  SessionOptions so;
+  so.enable_profiling = true;
+  so.profile_file_prefix = ORT_TSTR("onnxprofile_prefix_cache_test");
+  TinyGpt2Config config;
+  auto session = CreateSession(config, TinyGpt2GenerationConfig{}, 1 << 20, so);
+  const auto prompts = GetPrompts(config.vocab_size);
+  RunGeneration(*session, prompts[0]);
+  RunGeneration(*session, prompts[1]);
+  std::string profile_file = session->EndProfiling();
+
+  std::ifstream profile(profile_file);
+  ASSERT_TRUE(profile);
+  std::vector<std::string> events;
+  std::string line;
+  while (std::getline(profile, line)) {
+    if (line.find("\"name\" :\"generation_prefix_cache\"") != std::string::npos) {
+      events.push_back(line);
+    }
+  }
+
+  // Nothing is cached in the first run. The second run reuses the first block of 16 tokens.
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_NE(events[0].find("\"reused_length\" : \"0\""), std::string::npos);
+  EXPECT_NE(events[0].find("\"misses\" : \"2\""), std::string::npos);
+  EXPECT_NE(events[1].find("\"reused_length\" : \"16\""), std::string::npos);
+  EXPECT_NE(events[1].find("\"hits\" : \"2\""), std::string::npos);
+  EXPECT_NE(events[1].find("\"num_entries\" : \"2\""), std::string::npos);
+}
+#endif
+
+}  // namespace test
+}  // namespace onnxruntime
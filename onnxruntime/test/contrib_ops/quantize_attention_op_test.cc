@@ -842,7 +842,8 @@ void TestQuantizedAttentionPastState(int64_t batch,
                                      int64_t head_size,
                                      const std::string& reference_model,
                                      bool is_weight_constant,
-                                     bool per_column = false) {
+                                     bool per_column = false,
+                                     bool quantize_attention = false) {
   // create rand inputs
   RandomValueGenerator random{};
 
@@ -883,6 +884,9 @@ void TestQuantizedAttentionPastState(int64_t batch,
   OpTester test("QAttention", 1, onnxruntime::kMSDomain);
   test.AddAttribute<int64_t>("num_heads", head_number);
   test.AddAttribute<int64_t>("unidirectional", 1);
+  if (quantize_attention) {
+    test.AddAttribute<int64_t>("quantize_attention", 1);
+  }
   test.AddInput<InputT>("input", input_dims, input_data);
   test.AddInput<WeightT>("weight", weight_dims, weight_data, is_weight_constant);
   test.AddInput<float>("bias", bias_dims, bias_data);
@@ -893,8 +897,16 @@ void TestQuantizedAttentionPastState(int64_t batch,
   test.AddInput<WeightT>("weight_zero_point", {weight_scale_zp_size}, weight_zero_point);
   test.AddInput<float>("past", past_dims, past_data);
 
-  test.AddReferenceOutputs(reference_model);
-  test.Run();
+  // Attention with 8 bit Q, K, V and probabilities is compared with the float reference within the error of
+  // their quantization.
+  test.AddReferenceOutputs(reference_model, quantize_attention ? 0.1f : 0.0f);
+  if (quantize_attention) {
+    std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+    execution_providers.push_back(DefaultCpuExecutionProvider());
+    test.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+  } else {
+    test.Run();
+  }
 }
 
 TEST(QAttentionTest, QAttentionPastState_u8u8) {
@@ -937,6 +949,96 @@ TEST(QAttentionTest, QAttentionPastState_u8s8) {
                                                    true /*per_column*/);
 }
 
+TEST(QAttentionTest, QAttentionPastState_QuantizedAttention) {
+  TestQuantizedAttentionPastState<uint8_t, uint8_t>(2, 5, 15, 768, 12, 64,
+                                                    "testdata/attention_past_state.u8u8.onnx",
+                                                    true /*is_weight_constant*/,
+                                                    false /*per_column*/,
+                                                    true /*quantize_attention*/);
+
+  TestQuantizedAttentionPastState<uint8_t, int8_t>(2, 5, 15, 768, 12, 64,
+                                                   "testdata/attention_past_state.u8s8.onnx",
+                                                   false /*is_weight_constant*/,
+                                                   true /*per_column*/,
+                                                   true /*quantize_attention*/);
+}
+
+// Run QAttention of BERT without past state, with the float attention and then with the 8 bit quantized attention,
+// whose output is compared with the float one within the error of quantization.
+template <typename InputT, typename WeightT>
+void TestQuantizedAttentionWithMask(int64_t batch,
+                                    int64_t seq_len,
+                                    int64_t hidden_size,
+                                    int64_t head_number,
+                                    const std::vector<int32_t>& mask_index_data,
+                                    const std::vector<int64_t>& mask_index_dims) {
+  RandomValueGenerator random{};
+
+  constexpr InputT input_min = std::numeric_limits<InputT>::min();
+  constexpr InputT input_max = std::numeric_limits<InputT>::max();
+  constexpr int32_t input_range = input_max - input_min;
+  InputT input_mean = (input_min + input_max) / 2 + 1;
+  std::vector<InputT> input_zero_point{input_mean};
+  std::vector<int64_t> input_dims{batch, seq_len, hidden_size};
+  std::vector<InputT> input_data = random.Gaussian<InputT>(input_dims, input_mean, static_cast<InputT>(input_range / 6), input_min, input_max);
+
+  constexpr WeightT weight_min = std::numeric_limits<WeightT>::min();
+  constexpr WeightT weight_max = std::numeric_limits<WeightT>::max();
+  constexpr int32_t weight_range = weight_max - weight_min;
+  WeightT weight_mean = (weight_min + weight_max) / 2 + 1;
+  std::vector<WeightT> weight_zero_point{weight_mean};
+  std::vector<int64_t> weight_dims{hidden_size, 3 * hidden_size};
+  std::vector<WeightT> weight_data = random.Gaussian<WeightT>(weight_dims, weight_mean, static_cast<WeightT>(weight_range / 6), weight_min, weight_max);
+
+  std::vector<int64_t> bias_dims{3 * hidden_size};
+  std::vector<float> bias_data = random.Gaussian<float>(bias_dims, 0.0f, 0.3f);
+  std::vector<float> input_scale{0.005f};
+  std::vector<float> weight_scale(random.Uniform<float>(std::vector<int64_t>{1}, 0.005f, 0.01f));
+
+  std::vector<int64_t> output_dims{batch, seq_len, hidden_size};
+  auto run = [&](bool quantize_attention, const std::vector<float>& expected_output) {
+    OpTester test("QAttention", 1, onnxruntime::kMSDomain, !expected_output.empty());
+    test.AddAttribute<int64_t>("num_heads", head_number);
+    if (quantize_attention) {
+      test.AddAttribute<int64_t>("quantize_attention", 1);
+    }
+    test.AddInput<InputT>("input", input_dims, input_data);
+    test.AddInput<WeightT>("weight", weight_dims, weight_data, true);
+    test.AddInput<float>("bias", bias_dims, bias_data);
+    test.AddInput<float>("input_scale", {1}, input_scale);
+    test.AddInput<float>("weight_scale", {1}, weight_scale);
+    test.AddInput<int32_t>("mask_index", mask_index_dims, mask_index_data);
+    test.AddInput<InputT>("input_zero_point", {1}, input_zero_point);
+    test.AddInput<WeightT>("weight_zero_point", {1}, weight_zero_point);
+    if (expected_output.empty()) {
+      test.AddOutput<float>("output", output_dims, std::vector<float>(static_cast<size_t>(batch * seq_len * hidden_size)));
+    } else {
+      test.AddOutput<float>("output", output_dims, expected_output, false, 0.0f, 0.1f);
+    }
+
+    std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+    execution_providers.push_back(DefaultCpuExecutionProvider());
+    test.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+
+    auto output = test.GetFetches()[0].Get<Tensor>().DataAsSpan<float>();
+    return std::vector<float>(output.begin(), output.end());
+  };
+
+  const std::vector<float> float_output = run(false, {});
+  run(true, float_output);
+}
+
+// Sequences of BERT padded on the right, with mask index of end positions, or raw attention mask.
+TEST(QAttentionTest, QAttentionMask_QuantizedAttention) {
+  constexpr int64_t batch = 2;
+  constexpr int64_t seq_len = 128;
+  TestQuantizedAttentionWithMask<uint8_t, int8_t>(batch, seq_len, 768, 12, {128, 77}, {batch});
+
+  std::vector<int32_t> raw_mask(batch * seq_len, 1);
+  std::fill(raw_mask.begin() + seq_len + 100, raw_mask.end(), 0);
+  TestQuantizedAttentionWithMask<uint8_t, uint8_t>(batch, seq_len, 768, 12, raw_mask, {batch, seq_len});
+}
+
 TEST(QAttentionTest, QAttentionPrunedModel) {
   int batch_size = 2;
   int sequence_length = 2;
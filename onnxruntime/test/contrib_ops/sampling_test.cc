@@ -0,0 +1,225 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "core/session/inference_session.h"
+#include "contrib_ops/cpu/transformers/sampling_cpu_helper.h"
+#include "test/contrib_ops/tiny_gpt2_model.h"
+#include "test/framework/test_utils.h"
+#include "test/providers/provider_test_utils.h"
+#include "test/test_environment.h"
+#include "test/util/include/asserts.h"
+
+namespace onnxruntime {
+namespace contrib {
+namespace test {
+
+using SamplingCpuHelper::SampleToken;
+
+// Scores of tokens 0..3 are the logarithm of probabilities {0.15, 0.5, 0.05, 0.3}.
+static std::vector<float> GetScores() {
+  return {std::log(0.15f), std::log(0.5f), std::log(0.05f), std::log(0.3f)};
+}
+
+TEST(SamplingTest, TopKOneIsArgmax) {
+  std::vector<float> scores = GetScores();
+  std::vector<float> probs(scores.size());
+  std::vector<int32_t> indices(scores.size());
+
+  for (float uniform : {0.0f, 0.3f, 0.6f, 0.99f}) {
+    EXPECT_EQ(SampleToken(scores, probs, indices, 1.0f, 1, 1.0f, 1, uniform), 1);
+  }
+}
+
+TEST(SamplingTest, TopPKeepsSmallestSet) {
+  std::vector<float> scores = GetScores();
+  std::vector<float> probs(scores.size());
+  std::vector<int32_t> indices(scores.size());
+
+  // top_p = 0.7 keeps token 1 (0.5) and token 3 (0.3). Renormalized, token 1 has probability 0.625.
+  EXPECT_EQ(SampleToken(scores, probs, indices, 1.0f, 0, 0.7f, 1, 0.0f), 1);
+  EXPECT_EQ(SampleToken(scores, probs, indices, 1.0f, 0, 0.7f, 1, 0.6f), 1);
+  EXPECT_EQ(SampleToken(scores, probs, indices, 1.0f, 0, 0.7f, 1, 0.65f), 3);
+  EXPECT_EQ(SampleToken(scores, probs, indices, 1.0f, 0, 0.7f, 1, 0.99f), 3);
+
+  // A small top_p keeps the best token only, unless more tokens are required by min_tokens_to_keep.
+  EXPECT_EQ(SampleToken(scores, probs, indices, 1.0f, 0, 0.1f, 1, 0.99f), 1);
+  EXPECT_EQ(SampleToken(scores, probs, indices, 1.0f, 0, 0.1f, 2, 0.99f), 3);
+
+  // Without filtering, tokens are sampled in vocabulary order: cumulative probabilities are 0.15, 0.65, 0.7, 1.0.
+  EXPECT_EQ(SampleToken(scores, probs, indices, 1.0f, 0, 1.0f, 1, 0.1f), 0);
+  EXPECT_EQ(SampleToken(scores, probs, indices, 1.0f, 0, 1.0f, 1, 0.68f), 2);
+  EXPECT_EQ(SampleToken(scores, probs, indices, 1.0f, 0, 1.0f, 1, 0.99f), 3);
+}
+
+TEST(SamplingTest, LowTemperatureIsArgmax) {
+  std::vector<float> scores = GetScores();
+  std::vector<float> probs(scores.size());
+  std::vector<int32_t> indices(scores.size());
+
+  for (float uniform : {0.0f, 0.5f, 0.99f}) {
+    EXPECT_EQ(SampleToken(scores, probs, indices, 0.01f, 0, 1.0f, 1, uniform), 1);
+  }
+}
+
+// Vocabulary is larger than the first block of sorted candidates, so top_p filtering sorts in several rounds.
+TEST(SamplingTest, TopPLargeVocabulary) {
+  constexpr int vocab_size = 1000;
+  std::vector<float> scores(vocab_size);
+  for (int i = 0; i < vocab_size; i++) {
+    scores[i] = -0.01f * static_cast<float>(i);
+  }
+  std::shuffle(scores.begin(), scores.end(), std::default_random_engine{123});
+
+  // Reference: rank of tokens by score, and number of tokens kept by top_p.
+  std::vector<int32_t> order(vocab_size);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&scores](int32_t a, int32_t b) { return scores[a] > scores[b]; });
+  std::vector<int> rank(vocab_size);
+  for (int i = 0; i < vocab_size; i++) {
+    rank[order[i]] = i;
+  }
+
+  constexpr float top_p = 0.9f;
+  double total = 0.0;
+  for (float score : scores) {
+    total += std::exp(static_cast<double>(score));
+  }
+  double cumulative = 0.0;
+  int kept = 0;
+  while (cumulative < top_p * total) {
+    cumulative += std::exp(static_cast<double>(scores[order[kept++]]));
+  }
+  ASSERT_GT(kept, 64);
+
+  std::vector<float> probs(vocab_size);
+  std::vector<int32_t> indices(vocab_size);
+  EXPECT_EQ(SampleToken(scores, probs, indices, 1.0f, 0, top_p, 1, 0.0f), order[0]);
+  for (float uniform : {0.25f, 0.5f, 0.75f, 0.999f}) {
+    int32_t token = SampleToken(scores, probs, indices, 1.0f, 0, top_p, 1, uniform);
+    EXPECT_LE(rank[token], kept);
+  }
+
+  // top_k limits the candidates even when top_p is not reached.
+  for (float uniform : {0.25f, 0.5f, 0.75f, 0.999f}) {
+    int32_t token = SampleToken(scores, probs, indices, 1.0f, 100, top_p, 1, uniform);
+    EXPECT_LT(rank[token], 100);
+  }
+}
+
+}  // namespace test
+}  // namespace contrib
+}  // namespace onnxruntime
+
+namespace onnxruntime {
+namespace test {
+
+namespace {
+
+constexpr int kBatchSize = 2;
+constexpr int kSequenceLength = 4;
+constexpr int kMaxLength = 16;
+
+// The first prompt is padded on the left.
+const std::vector<int32_t> kInputIds{0, 0, 5, 9,
+                                     3, 17, 42, 8};
+
+TinyGpt2GenerationConfig GetGenerationConfig(const std::string& op_type, float temperature, float top_p) {
+  TinyGpt2GenerationConfig generation_config;
+  generation_config.op_type = op_type;
+  generation_config.eos_token_id = TinyGpt2Config{}.vocab_size;  // never generated
+  generation_config.temperature = temperature;
+  generation_config.top_p = top_p;
+  return generation_config;
+}
+
+// Run a GreedySearch or Sampling model in a new session, and return the output sequences.
+std::vector<int32_t> RunGenerationModel(const TinyGpt2GenerationConfig& generation_config, int32_t seed) {
+  InferenceSession session{SessionOptions{}, GetEnvironment()};
+  std::stringstream model_stream(CreateTinyGpt2GenerationModel(TinyGpt2Config{}, generation_config,
+                                                                DefaultLoggingManager().DefaultLogger()));
+  ORT_THROW_IF_ERROR(session.Load(model_stream));
+  ORT_THROW_IF_ERROR(session.Initialize());
+
+  AllocatorPtr allocator = TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault);
+  std::vector<std::string> feed_names{"input_ids", "max_length"};
+  std::vector<OrtValue> feeds(2);
+  CreateMLValue<int32_t>(allocator, {kBatchSize, kSequenceLength}, kInputIds, &feeds[0]);
+  CreateMLValue<int32_t>(allocator, {1}, {kMaxLength}, &feeds[1]);
+  if (generation_config.op_type == "Sampling") {
+    feeds.emplace_back();
+    CreateMLValue<int32_t>(allocator, {1}, {seed}, &feeds.back());
+    feed_names.push_back("seed");
+  }
+
+  std::vector<OrtValue> fetches;
+  ORT_THROW_IF_ERROR(session.Run(RunOptions{}, feed_names, feeds, {"sequences"}, &fetches));
+  auto sequences = fetches[0].Get<Tensor>().DataAsSpan<int32_t>();
+  return std::vector<int32_t>(sequences.begin(), sequences.end());
+}
+
+// Run a Sampling node with OpTester, and check that it outputs expected_sequences.
+void RunSamplingOpTester(float temperature, float top_p, int32_t seed, const std::vector<int32_t>& expected_sequences) {
+  TinyGpt2Config config;
+  ONNX_NAMESPACE::ModelProto decoder;
+  ASSERT_TRUE(decoder.ParseFromString(CreateTinyGpt2Model(config, DefaultLoggingManager().DefaultLogger())));
+
+  OpTester test("Sampling", 1, kMSDomain);
+  test.AddAttribute<int64_t>("eos_token_id", config.vocab_size);
+  test.AddAttribute<int64_t>("pad_token_id", 0);
+  test.AddAttribute("temperature", temperature);
+  test.AddAttribute("top_p", top_p);
+  test.AddAttribute("decoder", decoder.graph());
+  test.AddInput<int32_t>("input_ids", {kBatchSize, kSequenceLength}, kInputIds);
+  test.AddInput<int32_t>("max_length", {1}, {kMaxLength});
+  test.AddOptionalInputEdge<int32_t>();  // min_length
+  test.AddOptionalInputEdge<float>();    // repetition_penalty
+  test.AddOptionalInputEdge<int32_t>();  // vocab_mask
+  test.AddOptionalInputEdge<int32_t>();  // prefix_vocab_mask
+  test.AddInput<int32_t>("seed", {1}, {seed});
+  test.AddOutput<int32_t>("sequences", {kBatchSize, kMaxLength}, expected_sequences);
+
+  // The decoder subgraph also has operators of the ONNX domain, which OpTester does not import by itself.
+  std::shared_ptr<Model> model = test.BuildGraph({{kOnnxDomain, 13}});
+  ASSERT_STATUS_OK(model->MainGraph().Resolve());
+  test.SetModelCache(model);
+  test.Run();
+}
+
+}  // namespace
+
+// With a small top_p only the most probable token is kept, so Sampling generates the sequences of GreedySearch for
+// any temperature and seed.
+TEST(SamplingOpTest, SmallTopPIsGreedy) {
+  const std::vector<int32_t> expected = RunGenerationModel(GetGenerationConfig("GreedySearch", 1.0f, 1.0f), 0);
+  ASSERT_EQ(expected.size(), static_cast<size_t>(kBatchSize * kMaxLength));
+  for (int b = 0; b < kBatchSize; b++) {
+    EXPECT_TRUE(std::equal(kInputIds.begin() + b * kSequenceLength, kInputIds.begin() + (b + 1) * kSequenceLength,
+                           expected.begin() + b * kMaxLength));
+  }
+
+  RunSamplingOpTester(0.5f, 0.001f, 1, expected);
+  RunSamplingOpTester(2.0f, 0.001f, 7, expected);
+}
+
+// The seed input gives the same sequences across sessions, including the session created by OpTester.
+TEST(SamplingOpTest, SameSeedSameSequences) {
+  const TinyGpt2GenerationConfig generation_config = GetGenerationConfig("Sampling", 1.5f, 0.9f);
+  for (int32_t seed : {3, 11}) {
+    const std::vector<int32_t> expected = RunGenerationModel(generation_config, seed);
+    ASSERT_EQ(expected.size(), static_cast<size_t>(kBatchSize * kMaxLength));
+    EXPECT_EQ(RunGenerationModel(generation_config, seed), expected);
+
+    RunSamplingOpTester(1.5f, 0.9f, seed, expected);
+  }
+}
+
+}  // namespace test
+}  // namespace onnxruntime
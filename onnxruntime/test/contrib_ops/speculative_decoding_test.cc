@@ -0,0 +1,121 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <sstream>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "core/session/inference_session.h"
+#include "test/contrib_ops/tiny_gpt2_model.h"
+#include "test/framework/test_utils.h"
+#include "test/test_environment.h"
+#include "test/util/include/asserts.h"
+
+namespace onnxruntime {
+namespace test {
+
+namespace {
+
+constexpr int kVocabSize = 64;
+constexpr int kPadTokenId = 0;
+constexpr int kEosTokenId = kVocabSize;  // never generated, so that all sequences have max_length tokens
+constexpr int kBatchSize = 2;
+constexpr int kSequenceLength = 4;
+constexpr int kMaxLength = 24;
+
+// The first sequence is padded on the left.
+const std::vector<int32_t> kInputIds{kPadTokenId, kPadTokenId, 5, 9,
+                                     3, 17, 42, 8};
+
+// Run a GreedySearch or Sampling model, and return the output sequences. The target decoder has shared past and
+// present buffers when past_present_share_buffer is set.
+std::vector<int32_t> RunGeneration(const std::string& op_type,
+                                   const TinyGpt2Config* draft_config,
+                                   int num_speculative_tokens,
+                                   bool past_present_share_buffer = false) {
+  TinyGpt2Config config;
+  config.num_layers = 3;
+  config.past_present_share_buffer = past_present_share_buffer;
+
+  TinyGpt2GenerationConfig generation_config;
+  generation_config.op_type = op_type;
+  generation_config.eos_token_id = kEosTokenId;
+  generation_config.pad_token_id = kPadTokenId;
+  generation_config.draft_config = draft_config;
+  generation_config.num_speculative_tokens = num_speculative_tokens;
+
+  InferenceSession session{SessionOptions{}, GetEnvironment()};
+  std::stringstream model_stream(CreateTinyGpt2GenerationModel(config, generation_config,
+                                                                DefaultLoggingManager().DefaultLogger()));
+  ORT_THROW_IF_ERROR(session.Load(model_stream));
+  ORT_THROW_IF_ERROR(session.Initialize());
+
+  AllocatorPtr allocator = TestCPUExecutionProvider()->GetAllocator(0, OrtMemTypeDefault);
+  std::vector<std::string> feed_names{"input_ids", "max_length"};
+  std::vector<OrtValue> feeds(2);
+  CreateMLValue<int32_t>(allocator, {kBatchSize, kSequenceLength}, kInputIds, &feeds[0]);
+  CreateMLValue<int32_t>(allocator, {1}, {kMaxLength}, &feeds[1]);
+  if (op_type == "Sampling") {
+    feeds.emplace_back();
+    CreateMLValue<int32_t>(allocator, {1}, {123}, &feeds.back());
+    feed_names.push_back("seed");
+  }
+
+  std::vector<OrtValue> fetches;
+  ORT_THROW_IF_ERROR(session.Run(RunOptions{}, feed_names, feeds, {"sequences"}, &fetches));
+  auto sequences = fetches[0].Get<Tensor>().DataAsSpan<int32_t>();
+  return std::vector<int32_t>(sequences.begin(), sequences.end());
+}
+
+}  // namespace
+
+// The draft model has the first layer of the target model, so some proposed tokens are accepted and some are not.
+TEST(SpeculativeDecodingTest, GreedySearchMatchesWithoutDraft) {
+  const std::vector<int32_t> expected = RunGeneration("GreedySearch", nullptr, 0);
+  ASSERT_EQ(expected.size(), static_cast<size_t>(kBatchSize * kMaxLength));
+
+  TinyGpt2Config draft_config;
+  draft_config.num_layers = 1;
+  for (int num_speculative_tokens : {1, 3, 8}) {
+    EXPECT_EQ(RunGeneration("GreedySearch", &draft_config, num_speculative_tokens), expected)
+        << "num_speculative_tokens=" << num_speculative_tokens;
+  }
+}
+
+// A draft model same as the target model proposes the generated tokens, so all of them are accepted.
+TEST(SpeculativeDecodingTest, GreedySearchWithSameDraft) {
+  const std::vector<int32_t> expected = RunGeneration("GreedySearch", nullptr, 0);
+
+  TinyGpt2Config draft_config;
+  draft_config.num_layers = 3;
+  EXPECT_EQ(RunGeneration("GreedySearch", &draft_config, 5), expected);
+}
+
+// With shared past and present buffers, past state of rejected tokens is discarded by a smaller
+// past_sequence_length instead of slicing the present tensors.
+TEST(SpeculativeDecodingTest, GreedySearchWithSharedBuffer) {
+  const std::vector<int32_t> expected = RunGeneration("GreedySearch", nullptr, 0);
+  ASSERT_EQ(RunGeneration("GreedySearch", nullptr, 0, true), expected);
+
+  TinyGpt2Config draft_config;
+  draft_config.num_layers = 1;
+  for (bool draft_share_buffer : {false, true}) {
+    draft_config.past_present_share_buffer = draft_share_buffer;
+    for (int num_speculative_tokens : {1, 3, 8}) {
+      EXPECT_EQ(RunGeneration("GreedySearch", &draft_config, num_speculative_tokens, true), expected)
+          << "draft_share_buffer=" << draft_share_buffer << ", num_speculative_tokens=" << num_speculative_tokens;
+    }
+  }
+}
+
+// Each token is sampled from logits of the target model with the same random numbers.
+TEST(SpeculativeDecodingTest, SamplingMatchesWithoutDraft) {
+  const std::vector<int32_t> expected = RunGeneration("Sampling", nullptr, 0);
+
+  TinyGpt2Config draft_config;
+  draft_config.num_layers = 1;
+  EXPECT_EQ(RunGeneration("Sampling", &draft_config, 4), expected);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -0,0 +1,265 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cctype>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "core/graph/constants.h"
+#include "core/graph/model.h"
+
+namespace onnxruntime {
+namespace test {
+
+struct TinyGpt2Config {
+  int num_layers = 2;
+  int num_heads = 2;
+  int head_size = 8;
+  int vocab_size = 64;
+  int max_positions = 256;
+  uint32_t seed = 1;  // seed of random weights
+  bool past_present_share_buffer = false;  // whether the decoder has a past_sequence_length input
+};
+
+// Create a tiny GPT-2 like decoder with random weights, and return the serialized model. It has the interface of
+// the GPT subgraph of BeamSearch and GreedySearch:
+//   inputs : input_ids (B, S), position_ids (B, S), attention_mask (B, P + S), past_i (2, B, N, P, H)
+//   outputs: logits (B, S, vocab_size), present_i (2, B, N, P + S, H)
+// With past_present_share_buffer, past_i and present_i are max length buffers (2, B, N, M, H) of which the first P
+// positions are valid, and a last input past_sequence_length (scalar) gives P.
+// Each layer is a unidirectional Attention with a residual connection. Each weight is generated from the seed and
+// its name, so models with the same seed and different number of layers share weights except the extra layers.
+inline std::string CreateTinyGpt2Model(const TinyGpt2Config& config, const logging::Logger& logger) {
+  using namespace ONNX_NAMESPACE;
+  const int64_t hidden_size = static_cast<int64_t>(config.num_heads) * config.head_size;
+
+  std::unordered_map<std::string, int> domain_to_version{{kOnnxDomain, 13}, {kMSDomain, 1}};
+  Model model("tiny_gpt2", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+              domain_to_version, {}, logger);
+  Graph& graph = model.MainGraph();
+
+  auto make_type = [](int32_t elem_type, const std::vector<std::string>& dims) {
+    TypeProto type;
+    type.mutable_tensor_type()->set_elem_type(elem_type);
+    auto* shape = type.mutable_tensor_type()->mutable_shape();
+    for (const auto& dim : dims) {
+      if (!dim.empty() && std::isdigit(static_cast<unsigned char>(dim[0]))) {
+        shape->add_dim()->set_dim_value(std::stoll(dim));
+      } else {
+        shape->add_dim()->set_dim_param(dim);
+      }
+    }
+    return type;
+  };
+
+  auto add_initializer = [&](const std::string& name, const std::vector<int64_t>& dims, float scale) -> NodeArg& {
+    std::vector<uint32_t> seed_data{config.seed};
+    seed_data.insert(seed_data.end(), name.begin(), name.end());
+    std::seed_seq seed(seed_data.begin(), seed_data.end());
+    std::default_random_engine generator(seed);
+
+    TensorProto tensor;
+    tensor.set_name(name);
+    tensor.set_data_type(TensorProto_DataType_FLOAT);
+    int64_t size = 1;
+    for (int64_t dim : dims) {
+      tensor.add_dims(dim);
+      size *= dim;
+    }
+    std::uniform_real_distribution<float> distribution(-scale, scale);
+    for (int64_t i = 0; i < size; i++) {
+      tensor.add_float_data(distribution(generator));
+    }
+    graph.AddInitializedTensor(tensor);
+
+    TypeProto type;
+    type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+    for (int64_t dim : dims) {
+      type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(dim);
+    }
+    return graph.GetOrCreateNodeArg(name, &type);
+  };
+
+  const std::string num_heads = std::to_string(config.num_heads);
+  const std::string head_size = std::to_string(config.head_size);
+  TypeProto ids_type = make_type(TensorProto_DataType_INT32, {"batch_size", "sequence_length"});
+  TypeProto mask_type = make_type(TensorProto_DataType_INT32, {"batch_size", "total_sequence_length"});
+  const bool share_buffer = config.past_present_share_buffer;
+  const std::string past_length = share_buffer ? "max_sequence_length" : "past_sequence_length";
+  const std::string present_length = share_buffer ? "max_sequence_length" : "total_sequence_length";
+  TypeProto past_type = make_type(TensorProto_DataType_FLOAT, {"2", "batch_size", num_heads, past_length, head_size});
+  TypeProto present_type = make_type(TensorProto_DataType_FLOAT,
+                                     {"2", "batch_size", num_heads, present_length, head_size});
+  TypeProto logits_type = make_type(TensorProto_DataType_FLOAT,
+                                    {"batch_size", "sequence_length", std::to_string(config.vocab_size)});
+
+  NodeArg& input_ids = graph.GetOrCreateNodeArg("input_ids", &ids_type);
+  NodeArg& position_ids = graph.GetOrCreateNodeArg("position_ids", &ids_type);
+  NodeArg& attention_mask = graph.GetOrCreateNodeArg("attention_mask", &mask_type);
+  std::vector<const NodeArg*> graph_inputs{&input_ids, &position_ids, &attention_mask};
+  std::vector<const NodeArg*> graph_outputs;
+
+  NodeArg& word_embedding = add_initializer("word_embedding", {config.vocab_size, hidden_size}, 1.0f);
+  NodeArg& position_embedding = add_initializer("position_embedding", {config.max_positions, hidden_size}, 1.0f);
+  NodeArg& words = graph.GetOrCreateNodeArg("words", nullptr);
+  NodeArg& positions = graph.GetOrCreateNodeArg("positions", nullptr);
+  graph.AddNode("gather_words", "Gather", "", {&word_embedding, &input_ids}, {&words});
+  graph.AddNode("gather_positions", "Gather", "", {&position_embedding, &position_ids}, {&positions});
+
+  NodeArg* hidden = &graph.GetOrCreateNodeArg("hidden_0", nullptr);
+  graph.AddNode("embedding", "Add", "", {&words, &positions}, {hidden});
+
+  NodeAttributes attention_attributes;
+  AttributeProto num_heads_attribute;
+  num_heads_attribute.set_name("num_heads");
+  num_heads_attribute.set_type(AttributeProto_AttributeType_INT);
+  num_heads_attribute.set_i(config.num_heads);
+  attention_attributes["num_heads"] = num_heads_attribute;
+  AttributeProto unidirectional_attribute;
+  unidirectional_attribute.set_name("unidirectional");
+  unidirectional_attribute.set_type(AttributeProto_AttributeType_INT);
+  unidirectional_attribute.set_i(1);
+  attention_attributes["unidirectional"] = unidirectional_attribute;
+
+  // The optional extra_add input is skipped before past_sequence_length.
+  std::vector<NodeArg*> past_inputs;
+  if (share_buffer) {
+    AttributeProto share_buffer_attribute;
+    share_buffer_attribute.set_name("past_present_share_buffer");
+    share_buffer_attribute.set_type(AttributeProto_AttributeType_INT);
+    share_buffer_attribute.set_i(1);
+    attention_attributes["past_present_share_buffer"] = share_buffer_attribute;
+
+    TypeProto past_sequence_length_type = make_type(TensorProto_DataType_INT32, {});
+    past_inputs.push_back(&graph.GetOrCreateNodeArg("", nullptr));
+    past_inputs.push_back(&graph.GetOrCreateNodeArg("past_sequence_length", &past_sequence_length_type));
+  }
+
+  std::vector<NodeArg*> presents;
+  for (int layer = 0; layer < config.num_layers; layer++) {
+    const std::string suffix = std::to_string(layer);
+    NodeArg& past = graph.GetOrCreateNodeArg("past_" + suffix, &past_type);
+    graph_inputs.push_back(&past);
+
+    NodeArg& weight = add_initializer("attention_weight_" + suffix, {hidden_size, 3 * hidden_size}, 0.3f);
+    NodeArg& bias = add_initializer("attention_bias_" + suffix, {3 * hidden_size}, 0.1f);
+    NodeArg& attention_output = graph.GetOrCreateNodeArg("attention_output_" + suffix, nullptr);
+    NodeArg& present = graph.GetOrCreateNodeArg("present_" + suffix, &present_type);
+    std::vector<NodeArg*> attention_inputs{hidden, &weight, &bias, &attention_mask, &past};
+    attention_inputs.insert(attention_inputs.end(), past_inputs.begin(), past_inputs.end());
+    graph.AddNode("attention_" + suffix, "Attention", "", attention_inputs, {&attention_output, &present},
+                  &attention_attributes, kMSDomain);
+    presents.push_back(&present);
+
+    NodeArg* next_hidden = &graph.GetOrCreateNodeArg("hidden_" + std::to_string(layer + 1), nullptr);
+    graph.AddNode("residual_" + suffix, "Add", "", {hidden, &attention_output}, {next_hidden});
+    hidden = next_hidden;
+  }
+
+  NodeArg& lm_head = add_initializer("lm_head", {hidden_size, config.vocab_size}, 1.0f);
+  NodeArg& logits = graph.GetOrCreateNodeArg("logits", &logits_type);
+  graph.AddNode("lm_head", "MatMul", "", {hidden, &lm_head}, {&logits});
+
+  if (share_buffer) {
+    graph_inputs.push_back(past_inputs.back());
+  }
+  graph_outputs.push_back(&logits);
+  graph_outputs.insert(graph_outputs.end(), presents.begin(), presents.end());
+  graph.SetInputs(graph_inputs);
+  graph.SetOutputs(graph_outputs);
+  ORT_THROW_IF_ERROR(graph.Resolve());
+
+  std::string model_data;
+  model.ToProto().SerializeToString(&model_data);
+  return model_data;
+}
+
+// Node of BeamSearch, GreedySearch or Sampling in the model created by CreateTinyGpt2GenerationModel.
+struct TinyGpt2GenerationConfig {
+  std::string op_type = "GreedySearch";
+  int eos_token_id = 0;
+  int pad_token_id = 0;
+  const TinyGpt2Config* draft_config = nullptr;  // draft_decoder of speculative decoding when it is not null
+  int num_speculative_tokens = 4;
+  int64_t prefix_cache_size = 0;
+  float temperature = 1.0f;  // attributes of Sampling
+  float top_p = 1.0f;
+};
+
+// Create a model with a BeamSearch, GreedySearch or Sampling node, whose decoder is a tiny GPT-2 of config.
+//   inputs : input_ids (B, S), max_length (1), num_beams (1) and num_return_sequences (1) for BeamSearch, and seed (1)
+//            for Sampling
+//   outputs: sequences (B, max_length), or (B, num_return_sequences, max_length) for BeamSearch
+inline std::string CreateTinyGpt2GenerationModel(const TinyGpt2Config& config,
+                                                 const TinyGpt2GenerationConfig& generation_config,
+                                                 const logging::Logger& logger) {
+  using namespace ONNX_NAMESPACE;
+  auto get_decoder = [&logger](const TinyGpt2Config& decoder_config) {
+    ModelProto decoder;
+    ORT_ENFORCE(decoder.ParseFromString(CreateTinyGpt2Model(decoder_config, logger)));
+    return decoder.graph();
+  };
+  const std::string& op_type = generation_config.op_type;
+
+  std::unordered_map<std::string, int> domain_to_version{{kOnnxDomain, 13}, {kMSDomain, 1}};
+  Model model("tiny_gpt2_generation", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+              domain_to_version, {}, logger);
+  Graph& graph = model.MainGraph();
+
+  TypeProto ids_type;
+  ids_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_INT32);
+  ids_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_param("batch_size");
+  ids_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_param("sequence_length");
+  TypeProto scalar_type;
+  scalar_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_INT32);
+  scalar_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+
+  NodeArg& input_ids = graph.GetOrCreateNodeArg("input_ids", &ids_type);
+  NodeArg& max_length = graph.GetOrCreateNodeArg("max_length", &scalar_type);
+  NodeArg& sequences = graph.GetOrCreateNodeArg("sequences", nullptr);
+  std::vector<NodeArg*> inputs{&input_ids, &max_length};
+  std::vector<const NodeArg*> graph_inputs{&input_ids, &max_length};
+  if (op_type == "BeamSearch") {
+    // Optional input min_length is skipped.
+    NodeArg& num_beams = graph.GetOrCreateNodeArg("num_beams", &scalar_type);
+    NodeArg& num_return_sequences = graph.GetOrCreateNodeArg("num_return_sequences", &scalar_type);
+    inputs.insert(inputs.end(), {&graph.GetOrCreateNodeArg("", nullptr), &num_beams, &num_return_sequences});
+    graph_inputs.insert(graph_inputs.end(), {&num_beams, &num_return_sequences});
+  } else if (op_type == "Sampling") {
+    // Optional inputs min_length, repetition_penalty, vocab_mask and prefix_vocab_mask are skipped.
+    NodeArg& seed = graph.GetOrCreateNodeArg("seed", &scalar_type);
+    NodeArg& missing = graph.GetOrCreateNodeArg("", nullptr);
+    inputs.insert(inputs.end(), {&missing, &missing, &missing, &missing, &seed});
+    graph_inputs.push_back(&seed);
+  }
+
+  Node& node = graph.AddNode("generation", op_type, "", inputs, {&sequences}, nullptr, kMSDomain);
+  node.AddAttribute("eos_token_id", static_cast<int64_t>(generation_config.eos_token_id));
+  node.AddAttribute("pad_token_id", static_cast<int64_t>(generation_config.pad_token_id));
+  node.AddAttribute("decoder", get_decoder(config));
+  if (generation_config.draft_config != nullptr) {
+    node.AddAttribute("draft_decoder", get_decoder(*generation_config.draft_config));
+    node.AddAttribute("num_speculative_tokens", static_cast<int64_t>(generation_config.num_speculative_tokens));
+  }
+  if (generation_config.prefix_cache_size > 0) {
+    node.AddAttribute("prefix_cache_size", generation_config.prefix_cache_size);
+  }
+  if (op_type == "Sampling") {
+    node.AddAttribute("temperature", generation_config.temperature);
+    node.AddAttribute("top_p", generation_config.top_p);
+  }
+
+  graph.SetInputs(graph_inputs);
+  graph.SetOutputs({&sequences});
+  ORT_THROW_IF_ERROR(graph.Resolve());
+
+  std::string model_data;
+  model.ToProto().SerializeToString(&model_data);
+  return model_data;
+}
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -0,0 +1,131 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "test_util.h"
+
+template <size_t BlockRows, size_t BlockColumns, bool Threaded>
+class MlasSparseGemmTest : public MlasTestBase {
+ private:
+  MatrixGuardBuffer<float> BufferA;
+  MatrixGuardBuffer<float> BufferB;
+  MatrixGuardBuffer<float> BufferC;
+  MatrixGuardBuffer<float> BufferCReference;
+  MLAS_THREADPOOL* threadpool_;
+
+  void
+  Test(size_t M, size_t N, size_t K, float alpha) {
+    const size_t BlockRowCount = (M + BlockRows - 1) / BlockRows;
+    const size_t ldb = N + 3;
+    const size_t ldc = N + 5;
+
+    float* A = BufferA.GetBuffer(BlockRowCount * BlockRows * K, true);
+    const float* B = BufferB.GetBuffer(K * ldb);
+    float* C = BufferC.GetBuffer(M * ldc);
+    float* CReference = BufferCReference.GetBuffer(M * ldc);
+
+    //
+    // Build matrix A from every third block, and pack it in block compressed
+    // sparse row format.
+    //
+
+    std::vector<int64_t> BlockRowStart{0};
+    std::vector<int64_t> BlockColumnIndex;
+    std::vector<float> BlockValues;
+
+    size_t BlockIndex = 0;
+
+    for (size_t br = 0; br < BlockRowCount; br++) {
+      for (size_t k = 0; k < K; k += BlockColumns, BlockIndex++) {
+        if (BlockIndex % 3 != 0) {
+          continue;
+        }
+        BlockColumnIndex.push_back(static_cast<int64_t>(k));
+        for (size_t r = 0; r < BlockRows; r++) {
+          for (size_t c = 0; c < BlockColumns; c++) {
+            float Value = static_cast<float>(static_cast<int>((br * BlockRows + r) * 7 + (k + c) * 3) % 11 - 5);
+            A[(br * BlockRows + r) * K + k + c] = Value;
+            BlockValues.push_back(Value);
+          }
+        }
+      }
+      BlockRowStart.push_back(static_cast<int64_t>(BlockColumnIndex.size()));
+    }
+
+    MLAS_SPARSE_MATRIX SparseA;
+    SparseA.BlockRows = BlockRows;
+    SparseA.BlockColumns = BlockColumns;
+    SparseA.BlockRowStart = BlockRowStart.data();
+    SparseA.BlockColumnIndex = BlockColumnIndex.data();
+    SparseA.BlockValues = BlockValues.data();
+
+    std::copy_n(C, M * ldc, CReference);
+
+    MlasSparseGemm(M, N, SparseA, alpha, B, ldb, C, ldc, threadpool_);
+    ReferenceGemm(M, N, K, alpha, A, B, ldb, CReference, ldc);
+
+    for (size_t m = 0; m < M; m++) {
+      for (size_t n = 0; n < ldc; n++) {
+        ASSERT_EQ(C[m * ldc + n], CReference[m * ldc + n])
+            << "@[" << m << "," << n << "], "
+            << "M=" << M << ", N=" << N << ", K=" << K << ", alpha=" << alpha;
+      }
+    }
+  }
+
+  void
+  ReferenceGemm(size_t M, size_t N, size_t K, float alpha, const float* A, const float* B, size_t ldb,
+                float* C, size_t ldc) {
+    for (size_t m = 0; m < M; m++) {
+      for (size_t n = 0; n < N; n++) {
+        float sum = 0.0f;
+        for (size_t k = 0; k < K; k++) {
+          sum += A[m * K + k] * B[k * ldb + n];
+        }
+        C[m * ldc + n] = sum * alpha;
+      }
+    }
+  }
+
+ public:
+  MlasSparseGemmTest() : threadpool_(Threaded ? GetMlasThreadPool() : nullptr) {}
+
+  static const char* GetTestSuiteName() {
+    static const std::string suite_name = std::string("SparseGemm_") + std::to_string(BlockRows) + "x" +
+                                          std::to_string(BlockColumns) + (Threaded ? "_Threaded" : "_SingleThread");
+    return suite_name.c_str();
+  }
+
+  void ExecuteShort(void) override {
+    for (size_t m = 1; m <= 20; m++) {
+      for (size_t n : {1, 3, 4, 15, 16, 17, 35, 300}) {
+        for (size_t k = BlockColumns; k <= 4 * BlockColumns; k += BlockColumns) {
+          Test(m, n, k, 1.0f);
+        }
+      }
+    }
+    Test(37, 531, 64, 0.5f);
+    Test(128, 1024, 256, -1.0f);
+  }
+};
+
+template <> MlasSparseGemmTest<1, 1, false>* MlasTestFixture<MlasSparseGemmTest<1, 1, false>>::mlas_tester(nullptr);
+template <> MlasSparseGemmTest<1, 4, false>* MlasTestFixture<MlasSparseGemmTest<1, 4, false>>::mlas_tester(nullptr);
+template <> MlasSparseGemmTest<4, 4, false>* MlasTestFixture<MlasSparseGemmTest<4, 4, false>>::mlas_tester(nullptr);
+template <> MlasSparseGemmTest<16, 1, false>* MlasTestFixture<MlasSparseGemmTest<16, 1, false>>::mlas_tester(nullptr);
+template <> MlasSparseGemmTest<1, 1, true>* MlasTestFixture<MlasSparseGemmTest<1, 1, true>>::mlas_tester(nullptr);
+template <> MlasSparseGemmTest<4, 4, true>* MlasTestFixture<MlasSparseGemmTest<4, 4, true>>::mlas_tester(nullptr);
+
+static UNUSED_VARIABLE bool added_to_main = AddTestRegister([](bool is_short_execute) {
+  size_t count = 0;
+  if (is_short_execute) {
+    count += MlasDirectShortExecuteTests<MlasSparseGemmTest<1, 1, false>>::RegisterShortExecute();
+    count += MlasDirectShortExecuteTests<MlasSparseGemmTest<1, 4, false>>::RegisterShortExecute();
+    count += MlasDirectShortExecuteTests<MlasSparseGemmTest<4, 4, false>>::RegisterShortExecute();
+    count += MlasDirectShortExecuteTests<MlasSparseGemmTest<16, 1, false>>::RegisterShortExecute();
+    if (GetMlasThreadPool() != nullptr) {
+      count += MlasDirectShortExecuteTests<MlasSparseGemmTest<1, 1, true>>::RegisterShortExecute();
+      count += MlasDirectShortExecuteTests<MlasSparseGemmTest<4, 4, true>>::RegisterShortExecute();
+    }
+  }
+  return count;
+});
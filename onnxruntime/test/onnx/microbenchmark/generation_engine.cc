@@ -0,0 +1,126 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "core/session/ort_env.h"
+#include "contrib_ops/cpu/transformers/generation_engine.h"
+#include "test/contrib_ops/tiny_gpt2_model.h"
+#include "test/util/include/inference_session_wrapper.h"
+
+using namespace onnxruntime;
+using contrib::transformers::GenerationEngine;
+using contrib::transformers::GenerationEngineOptions;
+using contrib::transformers::GenerationRequest;
+
+extern OrtEnv* env;
+
+static constexpr int kMaxBatchSize = 4;
+static constexpr int kNumRequests = 16;
+
+// Requests with prompts of 4 to 16 tokens. Most of them are short, and every fourth one generates 64 tokens.
+// Token 0 is the padding, so prompts do not use it.
+static std::vector<GenerationRequest> GetRequests(int vocab_size) {
+  std::vector<GenerationRequest> requests(kNumRequests);
+  for (int i = 0; i < kNumRequests; i++) {
+    requests[i].input_ids.resize(4 + (i * 5) % 13);
+    for (size_t j = 0; j < requests[i].input_ids.size(); j++) {
+      requests[i].input_ids[j] = static_cast<int32_t>(1 + (i + j) % (vocab_size - 1));
+    }
+    requests[i].max_new_tokens = i % 4 == 0 ? 64 : 8;
+  }
+  return requests;
+}
+
+// Tokens/s of the requests with continuous batching (state.range(0) == 1) or static batching (state.range(0) == 0)
+// of the decoder of a GreedySearch node. Static batching runs groups of kMaxBatchSize requests, and every group runs
+// until its longest request finishes.
+static void BM_GenerationEngine(benchmark::State& state) {
+  const bool continuous = state.range(0) != 0;
+
+  test::TinyGpt2Config config;
+  config.num_layers = 4;
+  config.num_heads = 4;
+  config.head_size = 32;
+  config.vocab_size = 256;
+  test::TinyGpt2GenerationConfig generation_config;
+  generation_config.eos_token_id = config.vocab_size;  // never generated
+
+  auto logger = env->GetLoggingManager()->CreateLogger("test");
+  SessionOptions so;
+  test::InferenceSessionWrapper session{so, env->GetEnvironment()};
+  std::stringstream model_stream(test::CreateTinyGpt2GenerationModel(config, generation_config, *logger));
+  Status status = session.Load(model_stream);
+  if (status.IsOK()) {
+    status = session.Initialize();
+  }
+  if (!status.IsOK()) {
+    state.SkipWithError(status.ErrorMessage().c_str());
+    return;
+  }
+
+  const Node* node = nullptr;
+  for (const Node& n : session.GetGraph().Nodes()) {
+    if (n.Name() == "generation") {
+      node = &n;
+    }
+  }
+  if (node == nullptr) {
+    state.SkipWithError("generation node is not found");
+    return;
+  }
+
+  GenerationEngineOptions options;
+  options.max_batch_size = kMaxBatchSize;
+
+  std::vector<GenerationRequest> requests = GetRequests(config.vocab_size);
+  int64_t num_tokens = 0;
+  for (const auto& request : requests) {
+    num_tokens += request.max_new_tokens;
+  }
+
+  for (auto _ : state) {
+    if (continuous) {
+      GenerationEngine engine(session.GetSessionState(), *node, options, nullptr);
+      for (const auto& request : requests) {
+        engine.AddRequest(request);
+      }
+      status = engine.Run();
+    } else {
+      for (int i = 0; i < kNumRequests && status.IsOK(); i += kMaxBatchSize) {
+        GenerationEngine engine(session.GetSessionState(), *node, options, nullptr);
+        int group_tokens = 0;
+        for (int j = i; j < std::min(i + kMaxBatchSize, kNumRequests); j++) {
+          group_tokens = std::max(group_tokens, requests[j].max_new_tokens);
+        }
+        for (int j = i; j < std::min(i + kMaxBatchSize, kNumRequests); j++) {
+          GenerationRequest request = requests[j];
+          request.max_new_tokens = group_tokens;
+          engine.AddRequest(request);
+        }
+        status = engine.Run();
+      }
+    }
+
+    if (!status.IsOK()) {
+      state.SkipWithError(status.ErrorMessage().c_str());
+      break;
+    }
+  }
+
+  // Only the tokens that requests asked for are counted.
+  state.counters["tokens/s"] = benchmark::Counter(static_cast<double>(num_tokens) *
+                                                      static_cast<double>(state.iterations()),
+                                                  benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_GenerationEngine)
+    ->ArgName("continuous")
+    ->Arg(0)
+    ->Arg(1)
+    ->UseRealTime()
+    ->Unit(benchmark::TimeUnit::kMillisecond);
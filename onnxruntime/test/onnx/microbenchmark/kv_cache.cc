@@ -0,0 +1,94 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <benchmark/benchmark.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "core/session/inference_session.h"
+#include "core/session/ort_env.h"
+#include "test/contrib_ops/tiny_gpt2_model.h"
+
+using namespace onnxruntime;
+
+extern OrtEnv* env;
+
+static constexpr int kBatchSize = 1;
+static constexpr int kNumBeams = 4;
+static constexpr int kPromptLength = 8;
+
+// Tokens/s of BeamSearch over a GPT decoder that generates up to state.range(1) tokens. With state.range(0) == 0,
+// each decoder run concatenates past with the new key and value into a new present tensor, and beams are gathered
+// into new past tensors. With state.range(0) == 1, the decoder has a past_sequence_length input so that past and
+// present share max length buffers, which are appended in place and reordered for the beams that changed parent.
+static void BM_KVCache_BeamSearch(benchmark::State& state) {
+  const bool past_present_share_buffer = state.range(0) != 0;
+  const int max_length = static_cast<int>(state.range(1));
+
+  test::TinyGpt2Config config;
+  config.num_layers = 4;
+  config.num_heads = 12;
+  config.head_size = 64;
+  config.vocab_size = 512;
+  config.max_positions = max_length;
+  config.past_present_share_buffer = past_present_share_buffer;
+
+  test::TinyGpt2GenerationConfig generation_config;
+  generation_config.op_type = "BeamSearch";
+  generation_config.eos_token_id = config.vocab_size;  // never generated
+
+  auto logger = env->GetLoggingManager()->CreateLogger("test");
+  SessionOptions so;
+  InferenceSession session{so, env->GetEnvironment()};
+  std::stringstream model_stream(test::CreateTinyGpt2GenerationModel(config, generation_config, *logger));
+  Status status = session.Load(model_stream);
+  if (status.IsOK()) {
+    status = session.Initialize();
+  }
+  if (!status.IsOK()) {
+    state.SkipWithError(status.ErrorMessage().c_str());
+    return;
+  }
+
+  AllocatorPtr allocator = std::make_shared<CPUAllocator>();
+  auto int32_type = DataTypeImpl::GetType<int32_t>();
+  std::vector<OrtValue> feeds(4);
+  Tensor::InitOrtValue(int32_type, TensorShape({kBatchSize, kPromptLength}), allocator, feeds[0]);
+  for (size_t i = 1; i < feeds.size(); i++) {
+    Tensor::InitOrtValue(int32_type, TensorShape({1}), allocator, feeds[i]);
+  }
+  int32_t* input_ids = feeds[0].GetMutable<Tensor>()->MutableData<int32_t>();
+  for (int i = 0; i < kBatchSize * kPromptLength; i++) {
+    input_ids[i] = 1 + (i * 7) % (config.vocab_size - 1);
+  }
+  *feeds[1].GetMutable<Tensor>()->MutableData<int32_t>() = max_length;
+  *feeds[2].GetMutable<Tensor>()->MutableData<int32_t>() = kNumBeams;
+  *feeds[3].GetMutable<Tensor>()->MutableData<int32_t>() = 1;
+
+  std::vector<std::string> feed_names{"input_ids", "max_length", "num_beams", "num_return_sequences"};
+  std::vector<std::string> output_names{"sequences"};
+  for (auto _ : state) {
+    std::vector<OrtValue> fetches;
+    status = session.Run(RunOptions{}, feed_names, feeds, output_names, &fetches);
+    if (!status.IsOK()) {
+      state.SkipWithError(status.ErrorMessage().c_str());
+      break;
+    }
+  }
+
+  state.counters["tokens/s"] = benchmark::Counter(static_cast<double>(kBatchSize * (max_length - kPromptLength)) *
+                                                      static_cast<double>(state.iterations()),
+                                                  benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_KVCache_BeamSearch)
+    ->ArgNames({"share_buffer", "max_length"})
+    ->Args({0, 64})
+    ->Args({1, 64})
+    ->Args({0, 256})
+    ->Args({1, 256})
+    ->Args({0, 1024})
+    ->Args({1, 1024})
+    ->UseRealTime()
+    ->Unit(benchmark::TimeUnit::kMillisecond);
@@ -0,0 +1,150 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <benchmark/benchmark.h>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/graph/constants.h"
+#include "core/graph/model.h"
+#include "core/session/inference_session.h"
+#include "core/session/ort_env.h"
+
+using namespace onnxruntime;
+
+extern OrtEnv* env;
+
+static constexpr int kBatchSize = 1;
+static constexpr int kHiddenSize = 768;
+static constexpr int kNumHeads = 12;
+
+// A model of one QAttention node of BERT base with uint8 input, int8 weight and mask index of end positions.
+static std::string CreateQAttentionModel(bool quantize_attention, const logging::Logger& logger) {
+  using namespace ONNX_NAMESPACE;
+  std::unordered_map<std::string, int> domain_to_version{{kOnnxDomain, 13}, {kMSDomain, 1}};
+  Model model("qattention", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+              domain_to_version, {}, logger);
+  Graph& graph = model.MainGraph();
+
+  std::default_random_engine generator(42);
+  auto add_initializer = [&](const std::string& name, TensorProto_DataType data_type, std::vector<int64_t> dims,
+                             int min_value, int max_value, float scale) {
+    TensorProto tensor;
+    tensor.set_name(name);
+    tensor.set_data_type(data_type);
+    int64_t size = 1;
+    for (int64_t dim : dims) {
+      tensor.add_dims(dim);
+      size *= dim;
+    }
+    std::uniform_int_distribution<int> distribution(min_value, max_value);
+    for (int64_t i = 0; i < size; i++) {
+      if (data_type == TensorProto_DataType_FLOAT) {
+        tensor.add_float_data(distribution(generator) * scale);
+      } else {
+        tensor.add_int32_data(distribution(generator));
+      }
+    }
+    graph.AddInitializedTensor(tensor);
+
+    TypeProto type;
+    type.mutable_tensor_type()->set_elem_type(data_type);
+    for (int64_t dim : dims) {
+      type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(dim);
+    }
+    return &graph.GetOrCreateNodeArg(name, &type);
+  };
+
+  TypeProto input_type;
+  input_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_UINT8);
+  input_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_param("batch_size");
+  input_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_param("sequence_length");
+  input_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(kHiddenSize);
+  TypeProto mask_type;
+  mask_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_INT32);
+  mask_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_param("batch_size");
+
+  NodeArg& input = graph.GetOrCreateNodeArg("input", &input_type);
+  NodeArg& mask_index = graph.GetOrCreateNodeArg("mask_index", &mask_type);
+  NodeArg& output = graph.GetOrCreateNodeArg("output", nullptr);
+  std::vector<NodeArg*> inputs{
+      &input,
+      add_initializer("weight", TensorProto_DataType_INT8, {kHiddenSize, 3 * kHiddenSize}, -127, 127, 1.0f),
+      add_initializer("bias", TensorProto_DataType_FLOAT, {3 * kHiddenSize}, -100, 100, 0.003f),
+      add_initializer("input_scale", TensorProto_DataType_FLOAT, {1}, 5, 5, 0.001f),
+      add_initializer("weight_scale", TensorProto_DataType_FLOAT, {1}, 5, 5, 0.001f),
+      &mask_index,
+      add_initializer("input_zero_point", TensorProto_DataType_UINT8, {1}, 128, 128, 1.0f),
+      add_initializer("weight_zero_point", TensorProto_DataType_INT8, {1}, 0, 0, 1.0f)};
+
+  Node& node = graph.AddNode("qattention", "QAttention", "", inputs, {&output}, nullptr, kMSDomain);
+  node.AddAttribute("num_heads", static_cast<int64_t>(kNumHeads));
+  node.AddAttribute("quantize_attention", static_cast<int64_t>(quantize_attention ? 1 : 0));
+
+  graph.SetInputs({&input, &mask_index});
+  graph.SetOutputs({&output});
+  ORT_THROW_IF_ERROR(graph.Resolve());
+
+  std::string model_data;
+  model.ToProto().SerializeToString(&model_data);
+  return model_data;
+}
+
+// QAttention of BERT base over state.range(1) tokens. With state.range(0) == 0, the attention runs in float after
+// the QKV projection. With state.range(0) == 1, Q x K' and probabilities x V run as 8 bit integer GEMMs.
+static void BM_QAttention(benchmark::State& state) {
+  const bool quantize_attention = state.range(0) != 0;
+  const int64_t sequence_length = state.range(1);
+
+  auto logger = env->GetLoggingManager()->CreateLogger("test");
+  SessionOptions so;
+  InferenceSession session{so, env->GetEnvironment()};
+  std::stringstream model_stream(CreateQAttentionModel(quantize_attention, *logger));
+  Status status = session.Load(model_stream);
+  if (status.IsOK()) {
+    status = session.Initialize();
+  }
+  if (!status.IsOK()) {
+    state.SkipWithError(status.ErrorMessage().c_str());
+    return;
+  }
+
+  AllocatorPtr allocator = std::make_shared<CPUAllocator>();
+  std::vector<OrtValue> feeds(2);
+  Tensor::InitOrtValue(DataTypeImpl::GetType<uint8_t>(), TensorShape({kBatchSize, sequence_length, kHiddenSize}),
+                       allocator, feeds[0]);
+  Tensor::InitOrtValue(DataTypeImpl::GetType<int32_t>(), TensorShape({kBatchSize}), allocator, feeds[1]);
+  uint8_t* input = feeds[0].GetMutable<Tensor>()->MutableData<uint8_t>();
+  std::default_random_engine generator(7);
+  std::uniform_int_distribution<int> distribution(64, 192);
+  for (int64_t i = 0; i < kBatchSize * sequence_length * kHiddenSize; i++) {
+    input[i] = static_cast<uint8_t>(distribution(generator));
+  }
+  int32_t* mask_index = feeds[1].GetMutable<Tensor>()->MutableData<int32_t>();
+  for (int i = 0; i < kBatchSize; i++) {
+    mask_index[i] = static_cast<int32_t>(sequence_length);
+  }
+
+  std::vector<std::string> feed_names{"input", "mask_index"};
+  std::vector<std::string> output_names{"output"};
+  for (auto _ : state) {
+    std::vector<OrtValue> fetches;
+    status = session.Run(RunOptions{}, feed_names, feeds, output_names, &fetches);
+    if (!status.IsOK()) {
+      state.SkipWithError(status.ErrorMessage().c_str());
+      break;
+    }
+  }
+}
+
+BENCHMARK(BM_QAttention)
+    ->ArgNames({"quantize_attention", "sequence_length"})
+    ->Args({0, 128})
+    ->Args({1, 128})
+    ->Args({0, 384})
+    ->Args({1, 384})
+    ->UseRealTime()
+    ->Unit(benchmark::TimeUnit::kMillisecond);
@@ -0,0 +1,86 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <benchmark/benchmark.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "core/session/inference_session.h"
+#include "core/session/ort_env.h"
+#include "test/contrib_ops/tiny_gpt2_model.h"
+
+using namespace onnxruntime;
+
+extern OrtEnv* env;
+
+static constexpr int kBatchSize = 1;
+static constexpr int kPromptLength = 8;
+static constexpr int kMaxLength = 72;
+
+// Tokens/s of GreedySearch with state.range(0) speculative tokens proposed by a one layer draft model.
+// state.range(0) == 0 runs without draft model.
+static void BM_SpeculativeDecoding(benchmark::State& state) {
+  const int num_speculative_tokens = static_cast<int>(state.range(0));
+
+  test::TinyGpt2Config config;
+  config.num_layers = 8;
+  config.num_heads = 8;
+  config.head_size = 64;
+  config.vocab_size = 512;
+  test::TinyGpt2Config draft_config = config;
+  draft_config.num_layers = 1;
+
+  test::TinyGpt2GenerationConfig generation_config;
+  generation_config.eos_token_id = config.vocab_size;  // never generated
+  generation_config.draft_config = num_speculative_tokens > 0 ? &draft_config : nullptr;
+  generation_config.num_speculative_tokens = num_speculative_tokens;
+
+  auto logger = env->GetLoggingManager()->CreateLogger("test");
+  SessionOptions so;
+  InferenceSession session{so, env->GetEnvironment()};
+  std::stringstream model_stream(test::CreateTinyGpt2GenerationModel(config, generation_config, *logger));
+  Status status = session.Load(model_stream);
+  if (status.IsOK()) {
+    status = session.Initialize();
+  }
+  if (!status.IsOK()) {
+    state.SkipWithError(status.ErrorMessage().c_str());
+    return;
+  }
+
+  AllocatorPtr allocator = std::make_shared<CPUAllocator>();
+  auto int32_type = DataTypeImpl::GetType<int32_t>();
+  std::vector<OrtValue> feeds(2);
+  Tensor::InitOrtValue(int32_type, TensorShape({kBatchSize, kPromptLength}), allocator, feeds[0]);
+  Tensor::InitOrtValue(int32_type, TensorShape({1}), allocator, feeds[1]);
+  int32_t* input_ids = feeds[0].GetMutable<Tensor>()->MutableData<int32_t>();
+  for (int i = 0; i < kBatchSize * kPromptLength; i++) {
+    input_ids[i] = 1 + (i * 7) % (config.vocab_size - 1);
+  }
+  *feeds[1].GetMutable<Tensor>()->MutableData<int32_t>() = kMaxLength;
+
+  std::vector<std::string> feed_names{"input_ids", "max_length"};
+  std::vector<std::string> output_names{"sequences"};
+  for (auto _ : state) {
+    std::vector<OrtValue> fetches;
+    status = session.Run(RunOptions{}, feed_names, feeds, output_names, &fetches);
+    if (!status.IsOK()) {
+      state.SkipWithError(status.ErrorMessage().c_str());
+      break;
+    }
+  }
+
+  state.counters["tokens/s"] = benchmark::Counter(static_cast<double>(kBatchSize * (kMaxLength - kPromptLength)) *
+                                                      static_cast<double>(state.iterations()),
+                                                  benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_SpeculativeDecoding)
+    ->ArgName("speculative_tokens")
+    ->Arg(0)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->UseRealTime()
+    ->Unit(benchmark::TimeUnit::kMillisecond);
@@ -0,0 +1,162 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "common.h"
+
+#include <benchmark/benchmark.h>
+#include <onnx/defs/attr_proto_util.h>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "core/graph/constants.h"
+#include "core/graph/model.h"
+#include "core/session/inference_session.h"
+#include "core/session/ort_env.h"
+
+using namespace onnxruntime;
+using namespace ONNX_NAMESPACE;
+
+extern OrtEnv* env;
+
+// Synthetic RBF SVMs like the ones converted from scikit-learn: state.range(0) support vectors of kNumFeatures
+// features split over kNumClasses classes, evaluated on state.range(1) rows.
+static constexpr int64_t kNumFeatures = 32;
+static constexpr int64_t kNumClasses = 3;
+
+static std::vector<float> RandomValues(size_t count, std::mt19937& generator) {
+  std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+  std::vector<float> values(count);
+  for (auto& value : values) {
+    value = distribution(generator);
+  }
+  return values;
+}
+
+// Returns the serialized model of a single SVMClassifier (classifier == true) or SVMRegressor node.
+static std::string CreateSVMModel(bool classifier, int64_t n_supports, const logging::Logger& logger) {
+  std::mt19937 generator(static_cast<unsigned>(n_supports));
+  std::unordered_map<std::string, int> domain_to_version{{kOnnxDomain, 13}, {kMLDomain, 1}};
+  Model model("svm", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+              domain_to_version, {}, logger);
+  Graph& graph = model.MainGraph();
+
+  NodeAttributes attributes;
+  auto add_attribute = [&attributes](AttributeProto attribute) {
+    attributes[attribute.name()] = std::move(attribute);
+  };
+  add_attribute(MakeAttribute("kernel_type", std::string("RBF")));
+  add_attribute(MakeAttribute("kernel_params", std::vector<float>{1.0f / kNumFeatures, 0.0f, 3.0f}));
+  add_attribute(MakeAttribute("support_vectors",
+                              RandomValues(static_cast<size_t>(n_supports * kNumFeatures), generator)));
+
+  TypeProto x_type;
+  x_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  x_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_param("N");
+  x_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(kNumFeatures);
+  std::vector<NodeArg*> outputs;
+
+  if (classifier) {
+    std::vector<int64_t> vectors_per_class(kNumClasses, n_supports / kNumClasses);
+    vectors_per_class[0] += n_supports % kNumClasses;
+    add_attribute(MakeAttribute("vectors_per_class", vectors_per_class));
+    add_attribute(MakeAttribute("coefficients",
+                                RandomValues(static_cast<size_t>((kNumClasses - 1) * n_supports), generator)));
+    add_attribute(MakeAttribute("rho",
+                                RandomValues(static_cast<size_t>(kNumClasses * (kNumClasses - 1) / 2), generator)));
+    add_attribute(MakeAttribute("classlabels_ints", std::vector<int64_t>{0, 1, 2}));
+
+    TypeProto y_type;
+    y_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_INT64);
+    TypeProto z_type;
+    z_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+    outputs.push_back(&graph.GetOrCreateNodeArg("Y", &y_type));
+    outputs.push_back(&graph.GetOrCreateNodeArg("Z", &z_type));
+  } else {
+    add_attribute(MakeAttribute("n_supports", n_supports));
+    add_attribute(MakeAttribute("coefficients", RandomValues(static_cast<size_t>(n_supports), generator)));
+    add_attribute(MakeAttribute("rho", std::vector<float>{0.5f}));
+
+    TypeProto y_type;
+    y_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+    outputs.push_back(&graph.GetOrCreateNodeArg("Y", &y_type));
+  }
+
+  NodeArg& x = graph.GetOrCreateNodeArg("X", &x_type);
+  graph.AddNode("svm", classifier ? "SVMClassifier" : "SVMRegressor", "", {&x}, outputs, &attributes, kMLDomain);
+  graph.SetInputs({&x});
+  graph.SetOutputs(outputs);
+  ORT_THROW_IF_ERROR(graph.Resolve());
+
+  std::string model_data;
+  model.ToProto().SerializeToString(&model_data);
+  return model_data;
+}
+
+static void RunSVM(benchmark::State& state, bool classifier) {
+  const int64_t n_supports = state.range(0);
+  const int64_t n_rows = state.range(1);
+
+  auto logger = env->GetLoggingManager()->CreateLogger("test");
+  SessionOptions so;
+  InferenceSession session{so, env->GetEnvironment()};
+  std::stringstream model_stream(CreateSVMModel(classifier, n_supports, *logger));
+  Status status = session.Load(model_stream);
+  if (status.IsOK()) {
+    status = session.Initialize();
+  }
+  if (!status.IsOK()) {
+    state.SkipWithError(status.ErrorMessage().c_str());
+    return;
+  }
+
+  float* x_data = GenerateArrayWithRandomValue<float>(static_cast<size_t>(n_rows * kNumFeatures), -1, 1);
+  std::vector<OrtValue> feeds(1);
+  OrtMemoryInfo info("cpu", OrtDeviceAllocator);
+  Tensor::InitOrtValue(DataTypeImpl::GetType<float>(), TensorShape({n_rows, kNumFeatures}), x_data, info, feeds[0]);
+  const std::vector<std::string> feed_names{"X"};
+  const std::vector<std::string> output_names = classifier ? std::vector<std::string>{"Y", "Z"}
+                                                           : std::vector<std::string>{"Y"};
+
+  for (auto _ : state) {
+    std::vector<OrtValue> fetches;
+    status = session.Run(RunOptions{}, feed_names, feeds, output_names, &fetches);
+    if (!status.IsOK()) {
+      state.SkipWithError(status.ErrorMessage().c_str());
+      break;
+    }
+  }
+
+  state.counters["rows/s"] = benchmark::Counter(static_cast<double>(n_rows),
+                                                benchmark::Counter::kIsIterationInvariantRate);
+  aligned_free(x_data);
+}
+
+static void BM_SVMClassifierRBF(benchmark::State& state) {
+  RunSVM(state, true);
+}
+
+static void BM_SVMRegressorRBF(benchmark::State& state) {
+  RunSVM(state, false);
+}
+
+BENCHMARK(BM_SVMClassifierRBF)
+    ->UseRealTime()
+    ->Unit(benchmark::TimeUnit::kMicrosecond)
+    ->Args({1000, 1})
+    ->Args({1000, 128})
+    ->Args({1000, 1024})
+    ->Args({5000, 1})
+    ->Args({5000, 128})
+    ->Args({5000, 1024});
+
+BENCHMARK(BM_SVMRegressorRBF)
+    ->UseRealTime()
+    ->Unit(benchmark::TimeUnit::kMicrosecond)
+    ->Args({1000, 1})
+    ->Args({1000, 128})
+    ->Args({1000, 1024})
+    ->Args({5000, 1})
+    ->Args({5000, 128})
+    ->Args({5000, 1024});
@@ -0,0 +1,144 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "common.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+#include "core/framework/tensor.h"
+#include "core/providers/cpu/ml/tree_ensemble_common.h"
+#include "core/util/thread_utils.h"
+
+using namespace onnxruntime;
+using namespace onnxruntime::ml::detail;
+
+// Synthetic GBDT ensembles: state.range(0) complete trees of depth state.range(1) over kNumFeatures features,
+// evaluated on state.range(2) rows. Node ids follow a depth-first numbering like the converters produce.
+// With state.range(3) == 1, every other branch is BRANCH_LT instead of BRANCH_LEQ: the trees are neither compiled
+// nor quantized, and are evaluated with QuickScorer bitvectors or walked on raw values.
+static constexpr int64_t kNumFeatures = 100;
+
+class TreeEnsembleBenchmark : public TreeEnsembleCommon<float, float, float> {
+ public:
+  using TreeEnsembleCommon<float, float, float>::ComputeAgg;
+
+  TreeEnsembleBenchmark(int64_t n_trees, int64_t depth, bool mixed_modes) {
+    std::mt19937 generator(static_cast<unsigned>(n_trees * 31 + depth));
+    std::uniform_int_distribution<int64_t> feature_distribution(0, kNumFeatures - 1);
+    std::uniform_real_distribution<float> value_distribution(-1.0f, 1.0f);
+
+    std::vector<int64_t> falsenodeids, featureids, nodeids, treeids, truenodeids;
+    std::vector<std::string> modes;
+    std::vector<float> values;
+    std::vector<int64_t> target_ids, target_nodeids, target_treeids;
+    std::vector<float> target_weights;
+
+    for (int64_t tree = 0; tree < n_trees; ++tree) {
+      int64_t next_id = 0;
+      AddNode(tree, depth, next_id, generator, feature_distribution, value_distribution,
+              falsenodeids, featureids, nodeids, treeids, truenodeids, modes, values,
+              target_ids, target_nodeids, target_treeids, target_weights);
+    }
+
+    if (mixed_modes) {
+      for (size_t i = 0; i < modes.size(); i += 2) {
+        if (modes[i] == "BRANCH_LEQ") {
+          modes[i] = "BRANCH_LT";
+        }
+      }
+    }
+
+    ORT_THROW_IF_ERROR(Init(80, 50, "SUM", {}, {}, 1, falsenodeids, featureids, {}, {}, {}, modes, nodeids,
+                            treeids, truenodeids, values, {}, "NONE", target_ids, target_nodeids, target_treeids,
+                            target_weights, {}));
+  }
+
+  size_t NumTrees() const { return roots_.size(); }
+
+ private:
+  static int64_t AddNode(int64_t tree, int64_t depth, int64_t& next_id, std::mt19937& generator,
+                         std::uniform_int_distribution<int64_t>& feature_distribution,
+                         std::uniform_real_distribution<float>& value_distribution,
+                         std::vector<int64_t>& falsenodeids, std::vector<int64_t>& featureids,
+                         std::vector<int64_t>& nodeids, std::vector<int64_t>& treeids,
+                         std::vector<int64_t>& truenodeids, std::vector<std::string>& modes,
+                         std::vector<float>& values, std::vector<int64_t>& target_ids,
+                         std::vector<int64_t>& target_nodeids, std::vector<int64_t>& target_treeids,
+                         std::vector<float>& target_weights) {
+    const int64_t id = next_id++;
+    const size_t index = nodeids.size();
+    nodeids.push_back(id);
+    treeids.push_back(tree);
+    falsenodeids.push_back(0);
+    truenodeids.push_back(0);
+    featureids.push_back(0);
+    values.push_back(0);
+    if (depth == 0) {
+      modes.push_back("LEAF");
+      target_ids.push_back(0);
+      target_nodeids.push_back(id);
+      target_treeids.push_back(tree);
+      target_weights.push_back(value_distribution(generator));
+      return id;
+    }
+    modes.push_back("BRANCH_LEQ");
+    featureids[index] = feature_distribution(generator);
+    values[index] = value_distribution(generator);
+    truenodeids[index] = AddNode(tree, depth - 1, next_id, generator, feature_distribution, value_distribution,
+                                 falsenodeids, featureids, nodeids, treeids, truenodeids, modes, values,
+                                 target_ids, target_nodeids, target_treeids, target_weights);
+    falsenodeids[index] = AddNode(tree, depth - 1, next_id, generator, feature_distribution, value_distribution,
+                                  falsenodeids, featureids, nodeids, treeids, truenodeids, modes, values,
+                                  target_ids, target_nodeids, target_treeids, target_weights);
+    return id;
+  }
+};
+
+static void BM_TreeEnsembleRegressor(benchmark::State& state) {
+  const int64_t n_trees = state.range(0);
+  const int64_t depth = state.range(1);
+  const int64_t n_rows = state.range(2);
+  const bool mixed_modes = state.range(3) != 0;
+
+  TreeEnsembleBenchmark ensemble(n_trees, depth, mixed_modes);
+  float* x_data = GenerateArrayWithRandomValue<float>(static_cast<size_t>(n_rows * kNumFeatures), -1, 1);
+  std::vector<float> y_data(static_cast<size_t>(n_rows));
+
+  OrtMemoryInfo info("cpu", OrtDeviceAllocator);
+  Tensor X(DataTypeImpl::GetType<float>(), TensorShape({n_rows, kNumFeatures}), x_data, info);
+  Tensor Y(DataTypeImpl::GetType<float>(), TensorShape({n_rows, 1}), y_data.data(), info);
+
+  OrtThreadPoolParams tpo;
+  tpo.auto_set_affinity = true;
+  std::unique_ptr<concurrency::ThreadPool> tp(
+      concurrency::CreateThreadPool(&onnxruntime::Env::Default(), tpo, concurrency::ThreadPoolType::INTRA_OP));
+  const std::vector<float> base_values;
+
+  for (auto _ : state) {
+    ensemble.ComputeAgg(tp.get(), &X, &Y, nullptr,
+                        TreeAggregatorSum<float, float, float>(ensemble.NumTrees(), 1, POST_EVAL_TRANSFORM::NONE,
+                                                               base_values));
+    benchmark::DoNotOptimize(y_data.data());
+  }
+
+  state.counters["rows/s"] = benchmark::Counter(static_cast<double>(n_rows),
+                                                benchmark::Counter::kIsIterationInvariantRate);
+  aligned_free(x_data);
+}
+
+BENCHMARK(BM_TreeEnsembleRegressor)
+    ->UseRealTime()
+    ->Unit(benchmark::TimeUnit::kMicrosecond)
+    ->ArgNames({"n_trees", "depth", "n_rows", "mixed_modes"})
+    ->Args({1000, 6, 1, 0})
+    ->Args({1000, 6, 128, 0})
+    ->Args({1000, 6, 4096, 0})
+    ->Args({1000, 10, 1, 0})
+    ->Args({1000, 10, 128, 0})
+    ->Args({1000, 10, 4096, 0})
+    ->Args({1000, 4, 128, 1})
+    ->Args({1000, 4, 4096, 1})
+    ->Args({1000, 6, 128, 1})
+    ->Args({1000, 6, 4096, 1});
@@ -209,6 +209,32 @@ TEST(Einsum, ExplicitEinsumAsMatmul_Multi_Input) {
   test.Run();
 }
 
+// The cheapest contraction order contracts y and z first
+TEST(Einsum, ExplicitEinsumAsMatmul_Multi_Input_Reordered) {
+  OpTester test("Einsum", 12, onnxruntime::kOnnxDomain);
+  test.AddAttribute<std::string>("equation", "ij,jk,k->i");
+  test.AddInput<float>("x", {2, 3}, {1.f, 2.f, 3.f, 4.f, 5.f, 6.f});
+  test.AddInput<float>("y", {3, 4}, {1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f, 9.f, 10.f, 11.f, 12.f});
+  test.AddInput<float>("z", {4}, {1.f, -1.f, 2.f, 0.5f});
+  test.AddOutput<float>("o", {2}, {122.f, 275.f});
+  test.Run();
+}
+
+// Exceeds the number of inputs for which all contraction orders are searched exhaustively
+TEST(Einsum, ExplicitEinsumAsMatmul_Multi_Input_Reordered_Greedy) {
+  OpTester test("Einsum", 12, onnxruntime::kOnnxDomain);
+  test.AddAttribute<std::string>("equation", "ab,bc,cd,de,ef,fg,g->a");
+  test.AddInput<float>("x1", {2, 2}, {1.f, 2.f, 3.f, 4.f});
+  test.AddInput<float>("x2", {2, 2}, {1.f, 2.f, 3.f, 4.f});
+  test.AddInput<float>("x3", {2, 2}, {1.f, 2.f, 3.f, 4.f});
+  test.AddInput<float>("x4", {2, 2}, {1.f, 2.f, 3.f, 4.f});
+  test.AddInput<float>("x5", {2, 2}, {1.f, 2.f, 3.f, 4.f});
+  test.AddInput<float>("x6", {2, 2}, {1.f, 2.f, 3.f, 4.f});
+  test.AddInput<float>("x7", {2}, {1.f, -1.f});
+  test.AddOutput<float>("o", {2}, {-2627.f, -5743.f});
+  test.Run();
+}
+
 TEST(Einsum, ExplicitEinsumAsBatchedMatmul) {
   OpTester test("Einsum", 12, onnxruntime::kOnnxDomain);
   test.AddAttribute<std::string>("equation", "bij,bjk->bik");
@@ -246,6 +246,54 @@ TEST(MathOpTest, MatMul_BFloat16) {
 }
 #endif
 
+// B initializers with few non-zero elements are prepacked as sparse matrices of 1 x 1 or 4 x 4 blocks.
+TEST(MathOpTest, MatMulSparseInitializer) {
+  constexpr int64_t K = 32;
+  constexpr int64_t N = 20;
+
+  std::vector<float> scattered_b(K * N, 0.0f);
+  for (int64_t i = 0; i < K * N; i += 17) {
+    scattered_b[i] = static_cast<float>(i % 7) - 3.0f;
+  }
+  std::vector<float> blocked_b(K * N, 0.0f);
+  for (int64_t k = 8; k < 12; k++) {
+    for (int64_t n = 4; n < 8; n++) {
+      blocked_b[k * N + n] = static_cast<float>(k - n);
+      blocked_b[(k + 16) * N + n + 12] = static_cast<float>(k + n);
+    }
+  }
+
+  for (const auto* b_values : {&scattered_b, &blocked_b}) {
+    for (const std::vector<int64_t>& a_dims : {std::vector<int64_t>{1, K}, std::vector<int64_t>{7, K},
+                                               std::vector<int64_t>{2, 3, K}}) {
+      const int64_t M = a_dims.size() == 2 ? a_dims[0] : a_dims[0] * a_dims[1];
+      std::vector<float> a_values(M * K);
+      for (size_t i = 0; i < a_values.size(); i++) {
+        a_values[i] = static_cast<float>(static_cast<int64_t>(i % 11) - 5);
+      }
+
+      std::vector<float> expected(M * N, 0.0f);
+      for (int64_t m = 0; m < M; m++) {
+        for (int64_t n = 0; n < N; n++) {
+          for (int64_t k = 0; k < K; k++) {
+            expected[m * N + n] += a_values[m * K + k] * (*b_values)[k * N + n];
+          }
+        }
+      }
+      std::vector<int64_t> y_dims = a_dims;
+      y_dims.back() = N;
+
+      OpTester test("MatMul", 13);
+      test.AddInput<float>("A", a_dims, a_values);
+      test.AddInput<float>("B", {K, N}, *b_values, true);
+      test.AddOutput<float>("Y", y_dims, expected);
+      std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+      execution_providers.push_back(DefaultCpuExecutionProvider());
+      test.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+    }
+  }
+}
+
 #ifndef ENABLE_TRAINING  // Prepacking is enabled only on non-training builds
 TEST(MathOpTest, MatMulSharedPrepackedWeights) {
   OpTester test("MatMul");
@@ -1,6 +1,10 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
+#include <cmath>
+#include <random>
+
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
 
@@ -263,5 +267,93 @@ TEST(MLOpTest, SVMClassifierLinear) {
   test.Run();
 }
 
+// Unscaled features around 1e2 have squared norms around 3e5 while the rows are only a few units away from their
+// closest support vector, so |x|^2 + |s|^2 - 2 x.s cancels most of its bits. The kernels must still match the
+// distances computed from the differences of the features.
+TEST(MLOpTest, SVMClassifierRBFUnscaledFeatures) {
+  constexpr int64_t class_count = 3;
+  constexpr int64_t vectors_per_class_count = 4;
+  constexpr int64_t vector_count = class_count * vectors_per_class_count;
+  constexpr int64_t feature_count = 32;
+  constexpr int64_t row_count = 24;
+  constexpr int64_t classifier_count = class_count * (class_count - 1) / 2;
+  constexpr float gamma = 0.02f;
+
+  std::default_random_engine generator(1234);
+  std::uniform_real_distribution<float> feature_distribution(50.f, 150.f);
+  std::uniform_real_distribution<float> offset_distribution(-2.f, 2.f);
+  std::uniform_real_distribution<float> coefficient_distribution(-1.f, 1.f);
+  std::uniform_int_distribution<int64_t> vector_distribution(0, vector_count - 1);
+
+  std::vector<float> support_vectors(vector_count * feature_count);
+  for (auto& value : support_vectors) {
+    value = feature_distribution(generator);
+  }
+  std::vector<float> coefficients((class_count - 1) * vector_count);
+  for (auto& value : coefficients) {
+    value = coefficient_distribution(generator);
+  }
+  std::vector<float> rho(classifier_count);
+  for (auto& value : rho) {
+    value = 0.1f * coefficient_distribution(generator);
+  }
+
+  // every row is close to a random support vector
+  std::vector<float> X(row_count * feature_count);
+  for (int64_t row = 0; row < row_count; ++row) {
+    const int64_t support_vector = vector_distribution(generator);
+    for (int64_t feature = 0; feature < feature_count; ++feature) {
+      X[row * feature_count + feature] =
+          support_vectors[support_vector * feature_count + feature] + offset_distribution(generator);
+    }
+  }
+
+  std::vector<int64_t> predictions(row_count);
+  std::vector<float> scores(row_count * classifier_count);
+  for (int64_t row = 0; row < row_count; ++row) {
+    std::vector<float> kernels(vector_count);
+    for (int64_t support_vector = 0; support_vector < vector_count; ++support_vector) {
+      float sum = 0.f;
+      for (int64_t feature = 0; feature < feature_count; ++feature) {
+        float val = X[row * feature_count + feature] - support_vectors[support_vector * feature_count + feature];
+        sum += val * val;
+      }
+      kernels[support_vector] = std::exp(-gamma * sum);
+    }
+
+    std::vector<int64_t> votes(class_count, 0);
+    int64_t classifier = 0;
+    for (int64_t i = 0; i < class_count - 1; ++i) {
+      for (int64_t j = i + 1; j < class_count; ++j, ++classifier) {
+        double sum = rho[classifier];
+        for (int64_t m = 0; m < vectors_per_class_count; ++m) {
+          sum += coefficients[(j - 1) * vector_count + i * vectors_per_class_count + m] *
+                 kernels[i * vectors_per_class_count + m];
+          sum += coefficients[i * vector_count + j * vectors_per_class_count + m] *
+                 kernels[j * vectors_per_class_count + m];
+        }
+        scores[row * classifier_count + classifier] = static_cast<float>(sum);
+        ++votes[sum > 0 ? i : j];
+      }
+    }
+    predictions[row] = std::distance(votes.begin(), std::max_element(votes.begin(), votes.end()));
+  }
+
+  OpTester test("SVMClassifier", 1, onnxruntime::kMLDomain);
+  test.AddAttribute("kernel_type", std::string("RBF"));
+  test.AddAttribute("coefficients", coefficients);
+  test.AddAttribute("support_vectors", support_vectors);
+  test.AddAttribute("vectors_per_class", std::vector<int64_t>(class_count, vectors_per_class_count));
+  test.AddAttribute("rho", rho);
+  test.AddAttribute("kernel_params", std::vector<float>{gamma, 0.f, 3.f});
+  test.AddAttribute("classlabels_ints", std::vector<int64_t>{0, 1, 2});
+
+  test.AddInput<float>("X", {row_count, feature_count}, X);
+  test.AddOutput<int64_t>("Y", {row_count}, predictions);
+  test.AddOutput<float>("Z", {row_count, classifier_count}, scores, false, 1e-4f, 1e-4f);
+
+  test.Run();
+}
+
 }  // namespace test
 }  // namespace onnxruntime
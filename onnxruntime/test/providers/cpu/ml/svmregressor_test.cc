@@ -1,6 +1,9 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <cmath>
+#include <random>
+
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
 
@@ -136,5 +139,66 @@ TEST(MLOpTest, SVMRegressorLinear) {
   test.Run();
 }
 
+// Unscaled features around 1e2 with rows a few units away from a support vector, see
+// SVMClassifierRBFUnscaledFeatures.
+TEST(MLOpTest, SVMRegressorRBFUnscaledFeatures) {
+  constexpr int64_t vector_count = 10;
+  constexpr int64_t feature_count = 32;
+  constexpr int64_t row_count = 24;
+  constexpr float gamma = 0.02f;
+
+  std::default_random_engine generator(4321);
+  std::uniform_real_distribution<float> feature_distribution(50.f, 150.f);
+  std::uniform_real_distribution<float> offset_distribution(-2.f, 2.f);
+  std::uniform_real_distribution<float> coefficient_distribution(-1.f, 1.f);
+  std::uniform_int_distribution<int64_t> vector_distribution(0, vector_count - 1);
+
+  std::vector<float> support_vectors(vector_count * feature_count);
+  for (auto& value : support_vectors) {
+    value = feature_distribution(generator);
+  }
+  std::vector<float> coefficients(vector_count);
+  for (auto& value : coefficients) {
+    value = coefficient_distribution(generator);
+  }
+  std::vector<float> rho = {0.25f};
+
+  std::vector<float> X(row_count * feature_count);
+  for (int64_t row = 0; row < row_count; ++row) {
+    const int64_t support_vector = vector_distribution(generator);
+    for (int64_t feature = 0; feature < feature_count; ++feature) {
+      X[row * feature_count + feature] =
+          support_vectors[support_vector * feature_count + feature] + offset_distribution(generator);
+    }
+  }
+
+  std::vector<float> predictions(row_count);
+  for (int64_t row = 0; row < row_count; ++row) {
+    float prediction = rho[0];
+    for (int64_t support_vector = 0; support_vector < vector_count; ++support_vector) {
+      float sum = 0.f;
+      for (int64_t feature = 0; feature < feature_count; ++feature) {
+        float val = X[row * feature_count + feature] - support_vectors[support_vector * feature_count + feature];
+        sum += val * val;
+      }
+      prediction += coefficients[support_vector] * std::exp(-gamma * sum);
+    }
+    predictions[row] = prediction;
+  }
+
+  OpTester test("SVMRegressor", 1, onnxruntime::kMLDomain);
+  test.AddAttribute("kernel_type", std::string("RBF"));
+  test.AddAttribute("coefficients", coefficients);
+  test.AddAttribute("support_vectors", support_vectors);
+  test.AddAttribute("rho", rho);
+  test.AddAttribute("kernel_params", std::vector<float>{gamma, 0.f, 3.f});
+  test.AddAttribute("n_supports", vector_count);
+
+  test.AddInput<float>("X", {row_count, feature_count}, X);
+  test.AddOutput<float>("Y", {row_count, 1}, predictions, false, 1e-4f, 1e-4f);
+
+  test.Run();
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -1,6 +1,8 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <random>
+
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
 
@@ -676,5 +678,391 @@ TEST(MLOpTest, TreeRegressorSingleTargetSum_as_tensor_precision) {
   GenTreeAndRunTest1_as_tensor_precision(3);
 }
 
+// A chain of depth branches over feature 0 with integer values: branch k sends x == k to leaf k of weight k, and
+// other values to the next branch (or the last leaf of weight depth). Branches take their mode from branch_modes
+// in turn, so that Y = min(X, depth) whatever path evaluates the tree.
+void GenChainTreeAndRunTest(int64_t depth, const std::vector<std::string>& branch_modes,
+                            const std::vector<int64_t>& n_obs_list) {
+  std::vector<int64_t> lefts, rights, treeids, nodeids, featureids;
+  std::vector<float> thresholds;
+  std::vector<std::string> modes;
+  std::vector<int64_t> target_treeids, target_nodeids, target_classids;
+  std::vector<float> target_weights;
+  for (int64_t k = 0; k < depth; ++k) {
+    // branch 2k goes to leaf 2k + 1 or to branch 2k + 2, x >= k on this branch
+    const std::string& mode = branch_modes[k % branch_modes.size()];
+    const bool leaf_is_true = mode != "BRANCH_GT" && mode != "BRANCH_GTE" && mode != "BRANCH_NEQ";
+    float threshold = static_cast<float>(k) + 0.5f;
+    if (mode == "BRANCH_LT" || mode == "BRANCH_GTE") {
+      threshold = static_cast<float>(k + 1);
+    } else if (mode == "BRANCH_EQ" || mode == "BRANCH_NEQ") {
+      threshold = static_cast<float>(k);
+    }
+    nodeids.insert(nodeids.end(), {2 * k, 2 * k + 1});
+    lefts.insert(lefts.end(), {leaf_is_true ? 2 * k + 1 : 2 * k + 2, 0});
+    rights.insert(rights.end(), {leaf_is_true ? 2 * k + 2 : 2 * k + 1, 0});
+    featureids.insert(featureids.end(), {0, 0});
+    thresholds.insert(thresholds.end(), {threshold, 0.f});
+    modes.insert(modes.end(), {mode, "LEAF"});
+    target_nodeids.push_back(2 * k + 1);
+    target_weights.push_back(static_cast<float>(k));
+  }
+  nodeids.push_back(2 * depth);
+  lefts.push_back(0);
+  rights.push_back(0);
+  featureids.push_back(0);
+  thresholds.push_back(0.f);
+  modes.push_back("LEAF");
+  target_nodeids.push_back(2 * depth);
+  target_weights.push_back(static_cast<float>(depth));
+  treeids.resize(nodeids.size(), 0);
+  target_treeids.resize(target_nodeids.size(), 0);
+  target_classids.resize(target_nodeids.size(), 0);
+
+  for (int64_t n_obs : n_obs_list) {
+    OpTester test("TreeEnsembleRegressor", 3, onnxruntime::kMLDomain);
+    test.AddAttribute("nodes_truenodeids", lefts);
+    test.AddAttribute("nodes_falsenodeids", rights);
+    test.AddAttribute("nodes_treeids", treeids);
+    test.AddAttribute("nodes_nodeids", nodeids);
+    test.AddAttribute("nodes_featureids", featureids);
+    test.AddAttribute("nodes_values", thresholds);
+    test.AddAttribute("nodes_modes", modes);
+    test.AddAttribute("target_treeids", target_treeids);
+    test.AddAttribute("target_nodeids", target_nodeids);
+    test.AddAttribute("target_ids", target_classids);
+    test.AddAttribute("target_weights", target_weights);
+    test.AddAttribute("n_targets", (int64_t)1);
+
+    std::vector<float> X(n_obs), Y(n_obs);
+    for (int64_t i = 0; i < n_obs; ++i) {
+      X[i] = static_cast<float>(i % 11);
+      Y[i] = static_cast<float>(std::min(i % 11, depth));
+    }
+    test.AddInput<float>("X", {n_obs, 1}, X);
+    test.AddOutput<float>("Y", {n_obs, 1}, Y);
+    test.Run();
+  }
+}
+
+TEST(MLOpTest, TreeRegressorSingleTargetDeepTreeBatch) {
+  // A chain of 8 branches is deeper than the trees evaluated with bitvectors and too sparse
+  // to be compiled, its thresholds are quantized and the rows walk the quantized nodes in lockstep.
+  GenChainTreeAndRunTest(8, {"BRANCH_LEQ"}, {13, 101});
+}
+
+TEST(MLOpTest, TreeRegressorSingleTargetShallowTreeMixedModesBatch) {
+  // A chain of 5 branches with different modes is neither compiled nor quantized, blocks of 4 rows
+  // and more are evaluated with QuickScorer bitvectors.
+  GenChainTreeAndRunTest(5, {"BRANCH_GT", "BRANCH_EQ", "BRANCH_LEQ"}, {4, 13, 101});
+}
+
+TEST(MLOpTest, TreeRegressorSingleTargetDeepTreeMixedModesBatch) {
+  // A chain of 8 branches with different modes is too deep for bitvectors and not quantized,
+  // the rows walk the nodes in lockstep comparing raw values.
+  GenChainTreeAndRunTest(8, {"BRANCH_LT", "BRANCH_NEQ", "BRANCH_GTE", "BRANCH_EQ"}, {4, 13, 101});
+}
+
+TEST(MLOpTest, TreeRegressorSingleTargetMissingTracks) {
+  // Missing values go to the true branch of node 0 and to the false branch of node 1.
+  std::vector<int64_t> lefts = {1, 3, 0, 0, 0};
+  std::vector<int64_t> rights = {2, 4, 0, 0, 0};
+  std::vector<int64_t> treeids = {0, 0, 0, 0, 0};
+  std::vector<int64_t> nodeids = {0, 1, 2, 3, 4};
+  std::vector<int64_t> featureids = {0, 1, 0, 0, 0};
+  std::vector<float> thresholds = {0.5f, 0.5f, 0.f, 0.f, 0.f};
+  std::vector<std::string> modes = {"BRANCH_LEQ", "BRANCH_LEQ", "LEAF", "LEAF", "LEAF"};
+  std::vector<int64_t> missing_tracks = {1, 0, 0, 0, 0};
+  std::vector<int64_t> target_treeids = {0, 0, 0};
+  std::vector<int64_t> target_nodeids = {2, 3, 4};
+  std::vector<int64_t> target_classids = {0, 0, 0};
+  std::vector<float> target_weights = {3.f, 1.f, 2.f};
+
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  std::vector<float> X = {0.f, 0.f, 0.f, 1.f, 1.f, 0.f, nan, 0.f, nan, nan, 1.f, nan};
+  std::vector<float> Y = {1.f, 2.f, 3.f, 1.f, 2.f, 3.f};
+
+  for (int64_t n_obs : {1, 6}) {
+    OpTester test("TreeEnsembleRegressor", 3, onnxruntime::kMLDomain);
+    test.AddAttribute("nodes_truenodeids", lefts);
+    test.AddAttribute("nodes_falsenodeids", rights);
+    test.AddAttribute("nodes_treeids", treeids);
+    test.AddAttribute("nodes_nodeids", nodeids);
+    test.AddAttribute("nodes_featureids", featureids);
+    test.AddAttribute("nodes_values", thresholds);
+    test.AddAttribute("nodes_modes", modes);
+    test.AddAttribute("nodes_missing_value_tracks_true", missing_tracks);
+    test.AddAttribute("target_treeids", target_treeids);
+    test.AddAttribute("target_nodeids", target_nodeids);
+    test.AddAttribute("target_ids", target_classids);
+    test.AddAttribute("target_weights", target_weights);
+    test.AddAttribute("n_targets", (int64_t)1);
+
+    test.AddInput<float>("X", {n_obs, 2}, std::vector<float>(X.begin(), X.begin() + n_obs * 2));
+    test.AddOutput<float>("Y", {n_obs, 1}, std::vector<float>(Y.begin(), Y.begin() + n_obs));
+    test.Run();
+  }
+}
+
+TEST(MLOpTest, TreeRegressorSingleTargetCycleOrSharedSubtree) {
+  // Two branches whose children are each other form a cycle, and a leaf which is the child of
+  // two branches is a shared subtree. Both are rejected when the model is loaded.
+  const std::vector<std::vector<int64_t>> all_lefts = {{1, 0}, {1, 3, 0, 0}};
+  const std::vector<std::vector<int64_t>> all_rights = {{1, 0}, {2, 3, 0, 0}};
+  const std::vector<std::vector<std::string>> all_modes = {{"BRANCH_LEQ", "BRANCH_LEQ"},
+                                                           {"BRANCH_LEQ", "BRANCH_LEQ", "LEAF", "LEAF"}};
+  for (size_t t = 0; t < all_lefts.size(); ++t) {
+    const size_t n_nodes = all_lefts[t].size();
+    std::vector<int64_t> nodeids(n_nodes);
+    for (size_t k = 0; k < n_nodes; ++k) {
+      nodeids[k] = static_cast<int64_t>(k);
+    }
+
+    OpTester test("TreeEnsembleRegressor", 3, onnxruntime::kMLDomain);
+    test.AddAttribute("nodes_truenodeids", all_lefts[t]);
+    test.AddAttribute("nodes_falsenodeids", all_rights[t]);
+    test.AddAttribute("nodes_treeids", std::vector<int64_t>(n_nodes, 0));
+    test.AddAttribute("nodes_nodeids", nodeids);
+    test.AddAttribute("nodes_featureids", std::vector<int64_t>(n_nodes, 0));
+    test.AddAttribute("nodes_values", std::vector<float>(n_nodes, 0.5f));
+    test.AddAttribute("nodes_modes", all_modes[t]);
+    test.AddAttribute("target_treeids", std::vector<int64_t>{0});
+    test.AddAttribute("target_nodeids", std::vector<int64_t>{static_cast<int64_t>(n_nodes) - 1});
+    test.AddAttribute("target_ids", std::vector<int64_t>{0});
+    test.AddAttribute("target_weights", std::vector<float>{1.f});
+    test.AddAttribute("n_targets", (int64_t)1);
+
+    test.AddInput<float>("X", {2, 1}, {0.f, 1.f});
+    test.AddOutput<float>("Y", {2, 1}, {1.f, 1.f});
+    test.Run(OpTester::ExpectResult::kExpectFailure, "is reached more than once");
+  }
+}
+
+TEST(MLOpTest, TreeRegressorSingleTargetQuantizedThresholds) {
+  // A chain of 8 BRANCH_LT nodes alternating between two features, the rows are walked through it
+  // on thresholds quantized per feature. Inputs fall on, between and outside the thresholds.
+  const int64_t depth = 8;
+  std::vector<int64_t> lefts, rights, treeids, nodeids, featureids, missing_tracks;
+  std::vector<float> thresholds;
+  std::vector<std::string> modes;
+  std::vector<int64_t> target_treeids, target_nodeids, target_classids;
+  std::vector<float> target_weights;
+  for (int64_t k = 0; k < depth; ++k) {
+    // branch 2k: x[k % 2] < k / 2 goes to leaf 2k + 1 of weight k, else to branch 2k + 2 (or the last leaf)
+    nodeids.insert(nodeids.end(), {2 * k, 2 * k + 1});
+    lefts.insert(lefts.end(), {2 * k + 1, 0});
+    rights.insert(rights.end(), {2 * k + 2, 0});
+    featureids.insert(featureids.end(), {k % 2, 0});
+    thresholds.insert(thresholds.end(), {static_cast<float>(k) * 0.5f, 0.f});
+    modes.insert(modes.end(), {"BRANCH_LT", "LEAF"});
+    missing_tracks.insert(missing_tracks.end(), {k % 2 == 0 ? 1 : 0, 0});
+    target_nodeids.push_back(2 * k + 1);
+    target_weights.push_back(static_cast<float>(k));
+  }
+  nodeids.push_back(2 * depth);
+  lefts.push_back(0);
+  rights.push_back(0);
+  featureids.push_back(0);
+  thresholds.push_back(0.f);
+  modes.push_back("LEAF");
+  missing_tracks.push_back(0);
+  target_nodeids.push_back(2 * depth);
+  target_weights.push_back(static_cast<float>(depth));
+  treeids.resize(nodeids.size(), 0);
+  target_treeids.resize(target_nodeids.size(), 0);
+  target_classids.resize(target_nodeids.size(), 0);
+
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  for (int64_t n_obs : {1, 7, 64}) {
+    OpTester test("TreeEnsembleRegressor", 3, onnxruntime::kMLDomain);
+    test.AddAttribute("nodes_truenodeids", lefts);
+    test.AddAttribute("nodes_falsenodeids", rights);
+    test.AddAttribute("nodes_treeids", treeids);
+    test.AddAttribute("nodes_nodeids", nodeids);
+    test.AddAttribute("nodes_featureids", featureids);
+    test.AddAttribute("nodes_values", thresholds);
+    test.AddAttribute("nodes_modes", modes);
+    test.AddAttribute("nodes_missing_value_tracks_true", missing_tracks);
+    test.AddAttribute("target_treeids", target_treeids);
+    test.AddAttribute("target_nodeids", target_nodeids);
+    test.AddAttribute("target_ids", target_classids);
+    test.AddAttribute("target_weights", target_weights);
+    test.AddAttribute("n_targets", (int64_t)1);
+
+    std::vector<float> X(n_obs * 2), Y(n_obs);
+    for (int64_t i = 0; i < n_obs; ++i) {
+      X[i * 2] = (i % 13 == 12) ? nan : static_cast<float>(i % 13) * 0.25f - 0.25f;
+      X[i * 2 + 1] = (i % 7 == 6) ? nan : static_cast<float>(i % 7) * 0.75f - 0.5f;
+      Y[i] = static_cast<float>(depth);
+      for (int64_t k = 0; k < depth; ++k) {
+        const float v = X[i * 2 + k % 2];
+        if (std::isnan(v) ? missing_tracks[2 * k] != 0 : v < thresholds[2 * k]) {
+          Y[i] = static_cast<float>(k);
+          break;
+        }
+      }
+    }
+    test.AddInput<float>("X", {n_obs, 2}, X);
+    test.AddOutput<float>("Y", {n_obs, 1}, Y);
+    test.Run();
+  }
+}
+
+// Random trees whose branches all use mode, at least one deeper than kCompiledMaxDepth so that the ensemble is
+// quantized, the shallower trees are compiled or evaluated with QuickScorer bitvectors. Inputs fall on the
+// thresholds, between them, outside them, and are missing for floating point types. The outputs must be equal
+// to the outputs of the same ensemble with one more tree of a different mode and zero weights: the mixed modes
+// disable compiled trees and quantized thresholds, and every tree is walked comparing raw values.
+// TreeEnsembleRegressor has no int64 kernel, int64 inputs go through TreeEnsembleClassifier with 3 classes.
+template <typename T>
+void GenRandomTreesAndCompareWithRawPath(const std::string& mode) {
+  constexpr bool classifier = std::is_same<T, int64_t>::value;
+  constexpr int64_t n_trees = 12;
+  constexpr int64_t n_features = 5;
+  constexpr int64_t n_classes = classifier ? 3 : 1;
+  const std::string prefix = classifier ? "class_" : "target_";
+  const std::vector<float> threshold_values = {-2.f, -1.5f, -1.f, 0.f, 0.5f, 1.f, 2.f, 2.5f, 3.f};
+  const std::vector<float> input_values = {-3.f, -2.f, -1.5f, -1.f, -0.5f, 0.f, 0.5f, 1.f, 1.5f, 2.f, 2.5f, 3.f, 4.f};
+
+  std::default_random_engine generator(17);
+  std::bernoulli_distribution branch_distribution(0.7);
+  std::bernoulli_distribution missing_distribution(0.3);
+  std::uniform_int_distribution<int64_t> feature_distribution(0, n_features - 1);
+  std::uniform_int_distribution<size_t> threshold_distribution(0, threshold_values.size() - 1);
+  std::uniform_int_distribution<int64_t> class_distribution(0, n_classes - 1);
+  std::uniform_int_distribution<int> weight_distribution(-8, 8);
+
+  std::vector<int64_t> lefts, rights, treeids, nodeids, featureids, missing_tracks;
+  std::vector<float> thresholds;
+  std::vector<std::string> modes;
+  std::vector<int64_t> target_treeids, target_nodeids, target_classids;
+  std::vector<float> target_weights;
+  auto add_leaf = [&](int64_t tree, int64_t node, float weight) {
+    lefts.push_back(0);
+    rights.push_back(0);
+    featureids.push_back(0);
+    thresholds.push_back(0.f);
+    modes.push_back("LEAF");
+    missing_tracks.push_back(0);
+    target_treeids.push_back(tree);
+    target_nodeids.push_back(node);
+    target_classids.push_back(class_distribution(generator));
+    target_weights.push_back(weight);
+  };
+
+  for (int64_t tree = 0; tree < n_trees; ++tree) {
+    // the nodes of the leftmost path are branches down to max_depth, every third tree is deeper than the
+    // compiled trees, the others have depths from 3 to 10
+    const int64_t max_depth = tree % 3 == 0 ? 14 : 3 + tree % 8;
+    std::vector<std::pair<int64_t, bool>> pending = {{0, true}};  // depth, on the leftmost path
+    for (size_t node = 0; node < pending.size(); ++node) {
+      const int64_t depth = pending[node].first;
+      const bool leftmost = pending[node].second;
+      treeids.push_back(tree);
+      nodeids.push_back(static_cast<int64_t>(node));
+      if (depth < max_depth && (leftmost || branch_distribution(generator))) {
+        lefts.push_back(static_cast<int64_t>(pending.size()));
+        pending.push_back({depth + 1, leftmost});
+        rights.push_back(static_cast<int64_t>(pending.size()));
+        pending.push_back({depth + 1, false});
+        featureids.push_back(feature_distribution(generator));
+        thresholds.push_back(threshold_values[threshold_distribution(generator)]);
+        modes.push_back(mode);
+        missing_tracks.push_back(missing_distribution(generator) ? 1 : 0);
+      } else {
+        add_leaf(tree, static_cast<int64_t>(node), static_cast<float>(weight_distribution(generator)) * 0.25f);
+      }
+    }
+  }
+
+  std::vector<T> X;
+  for (int64_t i = 0; i < 100 * n_features; ++i) {
+    const size_t value = static_cast<size_t>(i * 7 + i / 11) % (input_values.size() + 1);
+    if (value < input_values.size()) {
+      X.push_back(static_cast<T>(input_values[value]));
+    } else {
+      X.push_back(std::numeric_limits<T>::has_quiet_NaN ? std::numeric_limits<T>::quiet_NaN() : T(0));
+    }
+  }
+
+  auto run = [&](bool raw, int64_t n_obs, const std::vector<OrtValue>& expected) {
+    auto tree_lefts = lefts, tree_rights = rights, tree_treeids = treeids, tree_nodeids = nodeids;
+    auto tree_featureids = featureids, tree_missing_tracks = missing_tracks;
+    auto tree_thresholds = thresholds;
+    auto tree_modes = modes;
+    auto tree_target_treeids = target_treeids, tree_target_nodeids = target_nodeids,
+         tree_target_classids = target_classids;
+    auto tree_target_weights = target_weights;
+    if (raw) {
+      // one more tree: a branch of another mode and two leaves of weight 0
+      tree_treeids.insert(tree_treeids.end(), {n_trees, n_trees, n_trees});
+      tree_nodeids.insert(tree_nodeids.end(), {0, 1, 2});
+      tree_lefts.insert(tree_lefts.end(), {1, 0, 0});
+      tree_rights.insert(tree_rights.end(), {2, 0, 0});
+      tree_featureids.insert(tree_featureids.end(), {0, 0, 0});
+      tree_thresholds.insert(tree_thresholds.end(), {0.f, 0.f, 0.f});
+      tree_modes.insert(tree_modes.end(), {mode == "BRANCH_LT" ? "BRANCH_LEQ" : "BRANCH_LT", "LEAF", "LEAF"});
+      tree_missing_tracks.insert(tree_missing_tracks.end(), {0, 0, 0});
+      tree_target_treeids.insert(tree_target_treeids.end(), {n_trees, n_trees});
+      tree_target_nodeids.insert(tree_target_nodeids.end(), {1, 2});
+      tree_target_classids.insert(tree_target_classids.end(), {0, 0});
+      tree_target_weights.insert(tree_target_weights.end(), {0.f, 0.f});
+    }
+
+    OpTester test(classifier ? "TreeEnsembleClassifier" : "TreeEnsembleRegressor", 3, onnxruntime::kMLDomain, !raw);
+    test.AddAttribute("nodes_truenodeids", tree_lefts);
+    test.AddAttribute("nodes_falsenodeids", tree_rights);
+    test.AddAttribute("nodes_treeids", tree_treeids);
+    test.AddAttribute("nodes_nodeids", tree_nodeids);
+    test.AddAttribute("nodes_featureids", tree_featureids);
+    test.AddAttribute("nodes_values", tree_thresholds);
+    test.AddAttribute("nodes_modes", tree_modes);
+    test.AddAttribute("nodes_missing_value_tracks_true", tree_missing_tracks);
+    test.AddAttribute(prefix + "treeids", tree_target_treeids);
+    test.AddAttribute(prefix + "nodeids", tree_target_nodeids);
+    test.AddAttribute(prefix + "ids", tree_target_classids);
+    test.AddAttribute(prefix + "weights", tree_target_weights);
+    if (classifier) {
+      test.AddAttribute("classlabels_int64s", std::vector<int64_t>{0, 1, 2});
+    } else {
+      test.AddAttribute("n_targets", n_classes);
+    }
+
+    test.AddInput<T>("X", {n_obs, n_features}, std::vector<T>(X.begin(), X.begin() + n_obs * n_features));
+    std::vector<int64_t> labels(n_obs);
+    std::vector<float> scores(n_obs * n_classes);
+    if (!raw) {
+      const auto expected_scores = expected[classifier ? 1 : 0].Get<Tensor>().DataAsSpan<float>();
+      scores.assign(expected_scores.begin(), expected_scores.end());
+      if (classifier) {
+        const auto expected_labels = expected[0].Get<Tensor>().DataAsSpan<int64_t>();
+        labels.assign(expected_labels.begin(), expected_labels.end());
+      }
+    }
+    if (classifier) {
+      test.AddOutput<int64_t>("Y", {n_obs}, labels);
+    }
+    test.AddOutput<float>(classifier ? "Z" : "Y", {n_obs, n_classes}, scores);
+    test.Run();
+    return test.GetFetches();
+  };
+
+  for (int64_t n_obs : {1, 13, 100}) {
+    run(false, n_obs, run(true, n_obs, {}));
+  }
+}
+
+TEST(MLOpTest, TreeRegressorRandomTreesQuantizedLeqMatchesRawPath) {
+  GenRandomTreesAndCompareWithRawPath<float>("BRANCH_LEQ");
+  GenRandomTreesAndCompareWithRawPath<double>("BRANCH_LEQ");
+  GenRandomTreesAndCompareWithRawPath<int64_t>("BRANCH_LEQ");
+}
+
+TEST(MLOpTest, TreeRegressorRandomTreesQuantizedLtMatchesRawPath) {
+  GenRandomTreesAndCompareWithRawPath<float>("BRANCH_LT");
+  GenRandomTreesAndCompareWithRawPath<double>("BRANCH_LT");
+  GenRandomTreesAndCompareWithRawPath<int64_t>("BRANCH_LT");
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -1,6 +1,8 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <random>
+
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
 #include "default_providers.h"
@@ -217,6 +219,115 @@ TEST(ConvTransposeTest, ConvTranspose_2D_Bias_2) {
   TestConvTransposeOp(attrs, {X, W, B}, {X_shape, W_shape, B_shape}, expected_vals, Y_shape);
 }
 
+// 1x1 kernel with unit strides and no padding. The output is written directly by the GEMM without a column buffer.
+TEST(ConvTransposeTest, ConvTranspose_2D_Pointwise_Group_Bias) {
+  ConvTransposeOpAttributes attrs = {
+      vector<int64_t>{1, 1},        // kernel_shape
+      {},                           // output_padding
+      {},                           // output_shape
+      vector<int64_t>{0, 0, 0, 0},  // pads
+      vector<int64_t>{1, 1},        // strides
+      vector<int64_t>{1, 1},        // dilations
+      2,                            // group
+      "NOTSET"                      // auto_pad
+  };
+  vector<float> X = {0.0f, 1.0f, 2.0f, 3.0f,
+                     4.0f, 5.0f, 6.0f, 7.0f,
+                     8.0f, 9.0f, 10.0f, 11.0f,
+                     12.0f, 13.0f, 14.0f, 15.0f};
+  vector<int64_t> X_shape = {1, 4, 2, 2};
+  vector<float> W = {1.0f, 0.0f, 2.0f, 1.0f, -1.0f, 1.0f, 0.5f, 0.0f};
+  vector<int64_t> W_shape = {4, 2, 1, 1};
+  vector<float> B = {1.0f, -1.0f, 0.5f, 0.0f};
+  vector<int64_t> B_shape = {4};
+  vector<int64_t> Y_shape = {1, 4, 2, 2};
+  auto expected_vals = {9.0f, 12.0f, 15.0f, 18.0f,
+                        3.0f, 4.0f, 5.0f, 6.0f,
+                        -1.5f, -2.0f, -2.5f, -3.0f,
+                        8.0f, 9.0f, 10.0f, 11.0f};
+  TestConvTransposeOp(attrs, {X, W, B}, {X_shape, W_shape, B_shape}, expected_vals, Y_shape);
+}
+
+// Runs a 2D ConvTranspose with bias on random data and compares it with a direct scatter of every input pixel.
+// Strided kernels at least as large as the stride run one convolution per output phase.
+static void TestConvTransposeMatchesScatter(const vector<int64_t>& kernel_shape, const vector<int64_t>& strides,
+                                            const vector<int64_t>& pads, const vector<int64_t>& output_padding,
+                                            int64_t group) {
+  const int64_t N = 2, C = 4, H = 5, W = 6, M = 3 * group;
+  const int64_t C_group = C / group, M_group = M / group;
+  const int64_t OH = (H - 1) * strides[0] - pads[0] - pads[2] + kernel_shape[0] + output_padding[0];
+  const int64_t OW = (W - 1) * strides[1] - pads[1] - pads[3] + kernel_shape[1] + output_padding[1];
+
+  std::default_random_engine generator(static_cast<unsigned>(OH * 31 + OW));
+  std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+  auto random_vector = [&](int64_t size) {
+    vector<float> v(static_cast<size_t>(size));
+    for (auto& x : v) {
+      x = distribution(generator);
+    }
+    return v;
+  };
+  const vector<float> X = random_vector(N * C * H * W);
+  const vector<float> F = random_vector(C * M_group * kernel_shape[0] * kernel_shape[1]);
+  const vector<float> B = random_vector(M);
+
+  vector<float> Y(static_cast<size_t>(N * M * OH * OW));
+  for (int64_t n = 0; n < N; ++n) {
+    for (int64_t m = 0; m < M; ++m) {
+      for (int64_t i = 0; i < OH * OW; ++i) {
+        Y[(n * M + m) * OH * OW + i] = B[m];
+      }
+    }
+    for (int64_t c = 0; c < C; ++c) {
+      const int64_t g = c / C_group;
+      for (int64_t oc = 0; oc < M_group; ++oc) {
+        for (int64_t ih = 0; ih < H; ++ih) {
+          for (int64_t iw = 0; iw < W; ++iw) {
+            for (int64_t kh = 0; kh < kernel_shape[0]; ++kh) {
+              for (int64_t kw = 0; kw < kernel_shape[1]; ++kw) {
+                const int64_t oh = ih * strides[0] - pads[0] + kh;
+                const int64_t ow = iw * strides[1] - pads[1] + kw;
+                if (oh >= 0 && oh < OH && ow >= 0 && ow < OW) {
+                  Y[((n * M + g * M_group + oc) * OH + oh) * OW + ow] +=
+                      X[((n * C + c) * H + ih) * W + iw] *
+                      F[((c * M_group + oc) * kernel_shape[0] + kh) * kernel_shape[1] + kw];
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  for (bool is_filter_initializer : {false, true}) {
+    OpTester test("ConvTranspose", 11);
+    test.AddAttribute("kernel_shape", kernel_shape);
+    test.AddAttribute("group", group);
+    test.AddAttribute("pads", pads);
+    test.AddAttribute("strides", strides);
+    test.AddAttribute("output_padding", output_padding);
+    test.AddInput<float>("X", {N, C, H, W}, X);
+    test.AddInput<float>("W", {C, M_group, kernel_shape[0], kernel_shape[1]}, F, is_filter_initializer);
+    test.AddInput<float>("B", {M}, B);
+    test.AddOutput<float>("Y", {N, M, OH, OW}, Y);
+    test.SetOutputAbsErr("Y", 1e-4f);
+    test.Run(OpTester::ExpectResult::kExpectSuccess, "",
+             {kTensorrtExecutionProvider, kOpenVINOExecutionProvider});
+  }
+}
+
+TEST(ConvTransposeTest, ConvTranspose_2D_Strided_MatchesScatter) {
+  TestConvTransposeMatchesScatter({4, 4}, {2, 2}, {1, 1, 1, 1}, {0, 0}, 1);
+  TestConvTransposeMatchesScatter({3, 3}, {2, 2}, {1, 1, 1, 1}, {1, 1}, 2);
+  TestConvTransposeMatchesScatter({2, 2}, {2, 2}, {0, 0, 0, 0}, {0, 0}, 1);
+  TestConvTransposeMatchesScatter({3, 5}, {2, 3}, {0, 2, 0, 2}, {1, 0}, 1);
+  TestConvTransposeMatchesScatter({5, 3}, {2, 2}, {2, 1, 2, 1}, {1, 1}, 1);
+  // These fall back to the column buffer: a phase would crop the input, or has no kernel taps.
+  TestConvTransposeMatchesScatter({3, 3}, {3, 3}, {1, 1, 1, 1}, {0, 2}, 2);
+  TestConvTransposeMatchesScatter({2, 2}, {3, 3}, {0, 0, 0, 0}, {0, 0}, 1);
+}
+
 TEST(ConvTransposeTest, ConvTranspose_2D_OutputShape_1) {
   ConvTransposeOpAttributes attrs = {
       vector<int64_t>{3, 3},        // kernel_shape
@@ -1,7 +1,10 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <random>
+
 #include "core/providers/cpu/nn/pool.h"
+#include "core/providers/cpu/nn/pool_functors.h"
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
 #include "test/common/cuda_op_test_utils.h"
@@ -478,6 +481,40 @@ TEST(PoolTest, MaxPool_10_DilationPadding_2d) {
            {kCudaExecutionProvider, kTensorrtExecutionProvider, kRocmExecutionProvider});
 }
 
+TEST(PoolTest, MaxPool_10_DilationPadding_2d_WithIndex) {
+  OpTester test("MaxPool", 10);
+
+  test.AddAttribute("auto_pad", "");
+  test.AddAttribute("strides", std::vector<int64_t>{1, 1});
+  test.AddAttribute("pads", vector<int64_t>{1, 1, 1, 1});
+  test.AddAttribute("kernel_shape", vector<int64_t>{2, 2});
+  test.AddAttribute("dilations", vector<int64_t>{2, 2});
+
+  std::vector<float> x_vals = {
+      1, 3, 2, 4, -1,
+      5, 7, 6, 8, -2,
+      9, 11, 10, 12, -3,
+      13, 15, 14, 16, -4};
+  std::vector<int64_t> x_dims = {1, 1, 4, 5};
+  std::vector<int64_t> expected_dims = {1, 1, 4, 5};
+  std::vector<float> expected_vals = {
+      7, 6, 8, 6, 8,
+      11, 10, 12, 10, 12,
+      15, 14, 16, 14, 16,
+      11, 10, 12, 10, 12};
+  std::vector<int64_t> expected_indices = {
+      6, 7, 8, 7, 8,
+      11, 12, 13, 12, 13,
+      16, 17, 18, 17, 18,
+      11, 12, 13, 12, 13};
+
+  test.AddInput<float>("X", x_dims, x_vals);
+  test.AddOutput<float>("Y", expected_dims, expected_vals);
+  test.AddOutput<int64_t>("Indices", expected_dims, expected_indices);
+  test.Run(OpTester::ExpectResult::kExpectSuccess, "",
+           {kCudaExecutionProvider, kTensorrtExecutionProvider, kRocmExecutionProvider, kAclExecutionProvider});
+}
+
 TEST(PoolTest, MaxPool_10_Dilation_Ceil0_2d) {
   OpTester test("MaxPool", 10);
 
@@ -1538,5 +1575,90 @@ TEST(PoolTest, MaxPoolDimWithZeroForN) {
   test.Run(OpTester::ExpectResult::kExpectSuccess, "", {kTensorrtExecutionProvider});
 }
 
+// Runs MlasMaximumPoolWithIndices and the MaxPool tasks on random values with ties and NaNs, and expects the same
+// maximums and indices.
+static void TestMaxPoolWithIndicesMatchesTasks(const std::vector<int64_t>& x_dims,
+                                               const std::vector<int64_t>& kernel_shape,
+                                               const std::vector<int64_t>& dilations,
+                                               const std::vector<int64_t>& pads,
+                                               const std::vector<int64_t>& strides, int64_t storage_order) {
+  const size_t dims = kernel_shape.size();
+  std::vector<int64_t> y_dims{x_dims[0], x_dims[1]};
+  for (size_t i = 0; i < dims; ++i) {
+    y_dims.push_back((x_dims[i + 2] + pads[i] + pads[i + dims] - ((kernel_shape[i] - 1) * dilations[i] + 1)) /
+                         strides[i] +
+                     1);
+  }
+  const int64_t total_channels = x_dims[0] * x_dims[1];
+  const int64_t x_step = TensorShape(x_dims).SizeFromDimension(2);
+  const int64_t y_step = TensorShape(y_dims).SizeFromDimension(2);
+
+  std::default_random_engine generator(static_cast<unsigned>(x_step * 7 + y_step));
+  std::uniform_int_distribution<int> distribution(-4, 4);
+  std::vector<float> x(static_cast<size_t>(total_channels * x_step));
+  for (size_t i = 0; i < x.size(); ++i) {
+    x[i] = i % 13 == 5 ? std::numeric_limits<float>::quiet_NaN() : static_cast<float>(distribution(generator));
+  }
+
+  const size_t y_size = static_cast<size_t>(total_channels * y_step);
+  std::vector<float> y(y_size), expected_y(y_size);
+  std::vector<int64_t> indices(y_size), expected_indices(y_size);
+
+  MlasMaximumPoolWithIndices(dims, x_dims.data(), kernel_shape.data(), dilations.data(), pads.data(), strides.data(),
+                             y_dims.data(), storage_order == 1, x.data(), y.data(), indices.data(), nullptr);
+
+  const int64_t height = x_dims[2];
+  const int64_t width = dims > 1 ? x_dims[3] : 1;
+  const int64_t depth = dims > 2 ? x_dims[4] : 1;
+  switch (dims) {
+    case 1:
+      MaxPool1DTask<float>{x.data(), expected_y.data(), expected_indices.data(), x_step, y_step, dilations[0],
+                           y_dims[2], strides[0], height, kernel_shape, pads}(0, total_channels);
+      break;
+    case 2:
+      MaxPool2DTask<float>{x.data(), expected_y.data(), expected_indices.data(), x_step, y_step, dilations[0],
+                           dilations[1], y_dims[2], y_dims[3], strides[0], strides[1], height, width, kernel_shape,
+                           pads, storage_order}(0, total_channels);
+      break;
+    default:
+      MaxPool3DTask<float>{x.data(), expected_y.data(), expected_indices.data(), x_step, y_step, dilations[0],
+                           dilations[1], dilations[2], y_dims[2], y_dims[3], y_dims[4], strides[0], strides[1],
+                           strides[2], height, width, depth, kernel_shape, pads, storage_order}(0, total_channels);
+      break;
+  }
+
+  for (size_t i = 0; i < y_size; ++i) {
+    ASSERT_EQ(y[i], expected_y[i]) << "output " << i;
+    ASSERT_EQ(indices[i], expected_indices[i]) << "output " << i;
+  }
+}
+
+TEST(PoolTest, MlasMaxPoolWithIndices1D) {
+  TestMaxPoolWithIndicesMatchesTasks({2, 3, 37}, {3}, {1}, {1, 1}, {1}, 0);
+  TestMaxPoolWithIndicesMatchesTasks({2, 3, 37}, {3}, {2}, {2, 1}, {1}, 0);
+  TestMaxPoolWithIndicesMatchesTasks({2, 3, 37}, {4}, {1}, {1, 2}, {2}, 0);
+  TestMaxPoolWithIndicesMatchesTasks({2, 3, 37}, {1}, {1}, {0, 0}, {1}, 0);
+}
+
+TEST(PoolTest, MlasMaxPoolWithIndices2D) {
+  for (int64_t storage_order : {0, 1}) {
+    TestMaxPoolWithIndicesMatchesTasks({2, 3, 9, 11}, {3, 3}, {1, 1}, {1, 1, 1, 1}, {1, 1}, storage_order);
+    TestMaxPoolWithIndicesMatchesTasks({2, 3, 9, 11}, {2, 3}, {2, 2}, {1, 2, 0, 1}, {1, 1}, storage_order);
+    TestMaxPoolWithIndicesMatchesTasks({2, 3, 9, 11}, {3, 2}, {1, 1}, {1, 0, 1, 1}, {2, 2}, storage_order);
+    TestMaxPoolWithIndicesMatchesTasks({2, 3, 9, 11}, {1, 1}, {1, 1}, {0, 0, 0, 0}, {1, 1}, storage_order);
+  }
+}
+
+TEST(PoolTest, MlasMaxPoolWithIndices3D) {
+  for (int64_t storage_order : {0, 1}) {
+    TestMaxPoolWithIndicesMatchesTasks({1, 2, 5, 6, 13}, {2, 2, 3}, {1, 1, 1}, {1, 0, 1, 1, 1, 1}, {1, 1, 1},
+                                       storage_order);
+    TestMaxPoolWithIndicesMatchesTasks({1, 2, 5, 6, 13}, {2, 2, 2}, {2, 1, 2}, {0, 1, 1, 1, 0, 1}, {1, 2, 1},
+                                       storage_order);
+    TestMaxPoolWithIndicesMatchesTasks({1, 2, 5, 6, 13}, {2, 3, 3}, {1, 1, 1}, {1, 1, 1, 0, 0, 0}, {2, 1, 2},
+                                       storage_order);
+  }
+}
+
 }  // namespace test
 }  // namespace onnxruntime
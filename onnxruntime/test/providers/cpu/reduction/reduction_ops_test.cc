@@ -2059,6 +2059,34 @@ TEST(ReductionOpTest, ReduceProd) {
   test.Run();
 }
 
+// the reduced values of each output are contiguous
+TEST(ReductionOpTest, ReduceProd_last_axis) {
+  OpTester test("ReduceProd");
+  test.AddAttribute("axes", std::vector<int64_t>{2});
+  test.AddAttribute("keepdims", (int64_t)0);
+  test.AddInput<float>("data", {2, 2, 3},
+                       {1.0f, 2.0f, 3.0f,
+                        4.0f, 5.0f, 6.0f,
+
+                        7.0f, 8.0f, 9.0f,
+                        10.0f, 11.0f, 12.0f});
+  test.AddOutput<float>("reduced", {2, 2}, {6.f, 120.f, 504.f, 1320.f});
+  test.Run();
+}
+
+TEST(ReductionOpTest, ReduceL2_last_axes) {
+  OpTester test("ReduceL2");
+  test.AddAttribute("axes", std::vector<int64_t>{1, 2});
+  test.AddInput<float>("data", {2, 2, 2},
+                       {1.0f, 2.0f,
+                        3.0f, 4.0f,
+
+                        5.0f, 6.0f,
+                        7.0f, 8.0f});
+  test.AddOutput<float>("reduced", {2, 1, 1}, {5.477225575f, 13.190905958f});
+  test.Run();
+}
+
 TEST(ReductionOpTest, ReduceProd_int32) {
   OpTester test("ReduceProd");
   test.AddAttribute("axes", std::vector<int64_t>{0, 2});
@@ -246,7 +246,9 @@ TEST(GRUTest, BidirectionalDefaultActivationsSimpleWeightsNoBiasLinearBeforeRese
 void DefaultActivationsSimpleWeightsWithBias(std::string direction,
                                              const std::vector<float>& Y_data,
                                              bool linear_before_reset = false,
-                                             bool one_row = false) {
+                                             bool one_row = false,
+                                             float clip = 999.f,
+                                             bool use_bias = true) {
   int64_t seq_length = 2;
   int batch_size = one_row ? 1 : 2;  // if 2 take batch_parallel_ path. if 1, don't.
   int64_t input_size = 1;
@@ -288,7 +290,8 @@ void DefaultActivationsSimpleWeightsWithBias(std::string direction,
   std::vector<float> R_data(num_directions * 3 * hidden_size * hidden_size, 0.1f);
 
   RunGruTest(X_data, W_data, R_data, Y_data, {}, input_size, batch_size, hidden_size, seq_length,
-             &B_data, nullptr, nullptr, direction, 999.f, /* output_sequence*/ true, linear_before_reset);
+             use_bias ? &B_data : nullptr, nullptr, nullptr, direction, clip, /* output_sequence*/ true,
+             linear_before_reset);
 }
 
 TEST(GRUTest, ForwardDefaultActivationsSimpleWeightsWithBiasBatchParallel) {
@@ -326,6 +329,55 @@ TEST(GRUTest, ReverseDefaultActivationsSimpleWeightsWithBiasBatchParallelLinearB
   DefaultActivationsSimpleWeightsWithBias("reverse", Y_data, linear_before_reset);
 }
 
+// the zr and h gates are clipped after the bias was added to the input projection of all the steps
+TEST(GRUTest, ForwardDefaultActivationsSimpleWeightsWithBiasClip) {
+  std::vector<float> Y_data{
+      0.14929696f, -0.12397026f, 0.10229722f,
+      0.14711282f, -0.12397026f, 0.13527877f,
+
+      0.21635221f, -0.19518405f, 0.12755989f,
+      0.21864162f, -0.1874877f, 0.21945503f};
+
+  DefaultActivationsSimpleWeightsWithBias("forward", Y_data, /* linear_before_reset */ false, /* one_row */ false,
+                                          /* clip */ 0.3f);
+}
+
+TEST(GRUTest, ForwardDefaultActivationsSimpleWeightsWithBiasClipLinearBeforeReset) {
+  std::vector<float> Y_data{
+      0.14929696f, -0.12397026f, -0.018822762f,
+      0.14711282f, -0.12114741f, 0.015633187f,
+
+      0.19469176f, -0.19518405f, -0.050184506f,
+      0.21906275f, -0.18217422f, 0.046575793f};
+
+  DefaultActivationsSimpleWeightsWithBias("forward", Y_data, /* linear_before_reset */ true, /* one_row */ false,
+                                          /* clip */ 0.3f);
+}
+
+TEST(GRUTest, ForwardDefaultActivationsSimpleWeightsNoBiasClip) {
+  std::vector<float> Y_data{
+      -0.015070479f, -0.00504983f, -0.010148636f,
+      0.029664421f, 0.0097987202f, 0.01938984f,
+
+      -0.053771562f, -0.018670508f, -0.036961364f,
+      0.074989063f, 0.025702593f, 0.049134215f};
+
+  DefaultActivationsSimpleWeightsWithBias("forward", Y_data, /* linear_before_reset */ false, /* one_row */ false,
+                                          /* clip */ 0.3f, /* use_bias */ false);
+}
+
+TEST(GRUTest, ForwardDefaultActivationsSimpleWeightsNoBiasClipLinearBeforeReset) {
+  std::vector<float> Y_data{
+      -0.015070479f, -0.00504983f, -0.010148636f,
+      0.029664421f, 0.0097987202f, 0.01938984f,
+
+      -0.053769634f, -0.018656858f, -0.036971196f,
+      0.074993681f, 0.025735209f, 0.049111324f};
+
+  DefaultActivationsSimpleWeightsWithBias("forward", Y_data, /* linear_before_reset */ true, /* one_row */ false,
+                                          /* clip */ 0.3f, /* use_bias */ false);
+}
+
 // test forward !batch_parallel_ path with linear_before_reset
 TEST(GRUTest, ForwardDefaultActivationsSimpleWeightsWithBiasLinearBeforeReset) {
   std::vector<float> Y_data{
@@ -750,6 +750,41 @@ TEST(LSTMTest, ONNXRuntime_TestLSTMForwardClip) {
                   use_bias, use_peepholes, clip);
 }
 
+// without peepholes or input_forget the 4 gates are clipped together after the bias was added to the
+// input projection of all the steps
+TEST(LSTMTest, ONNXRuntime_TestLSTMForwardClipNoPeepholes) {
+  constexpr int seq_len = 3, batch_size = 2;
+
+  bool use_peepholes = false;
+  float clip = 0.2f;
+
+  std::vector<float> X_data = {-0.455351f, -0.276391f, 0.351f, -0.192f,
+                               -0.185934f, -0.269585f, 0.087f, 0.413f,
+                               0.612f, -0.518f, -0.302f, 0.255f};
+
+  LstmOpContext2x1x2x2 context("forward");
+  {
+    bool use_bias = true;
+    std::vector<float> Y_data = {-0.022636777f, 0.048836389f, -0.048563081f, -0.01050199f,
+                                 -0.032357845f, 0.049717414f, -0.080719241f, 0.047416983f,
+                                 -0.026696518f, -0.017040389f, -0.088211965f, 0.085116524f};
+    std::vector<float> Y_h_data = {-0.026696518f, -0.017040389f, -0.088211965f, 0.085116524f};
+    std::vector<float> Y_c_data = {-0.059373388f, -0.035386257f, -0.17932417f, 0.15605872f};
+    context.RunTest(X_data, batch_size, seq_len, nullptr, nullptr, Y_data, Y_h_data, Y_c_data, nullptr,
+                    use_bias, use_peepholes, clip);
+  }
+  {
+    bool use_bias = false;
+    std::vector<float> Y_data = {0.040484088f, 0.01956941f, 0.011024381f, -0.028059867f,
+                                 0.050538971f, 0.0031705863f, -0.047575376f, 0.0037149708f,
+                                 0.055730367f, -0.038378038f, -0.040400841f, 0.048448737f};
+    std::vector<float> Y_h_data = {0.055730367f, -0.038378038f, -0.040400841f, 0.048448737f};
+    std::vector<float> Y_c_data = {0.12443794f, -0.085460526f, -0.075691965f, 0.088344326f};
+    context.RunTest(X_data, batch_size, seq_len, nullptr, nullptr, Y_data, Y_h_data, Y_c_data, nullptr,
+                    use_bias, use_peepholes, clip);
+  }
+}
+
 TEST(LSTMTest, ONNXRuntime_TestLSTMBackward) {
   constexpr int seq_len = 2, batch_size = 1;
 
@@ -58,6 +58,37 @@ TEST(CompressTest, Compress_3dims) {
   test.Run();
 }
 
+TEST(CompressTest, Compress_3dims_runs) {
+  OpTester test("Compress", 9);
+
+  test.AddAttribute("axis", int64_t(1));
+
+  test.AddInput<float>("input", {2, 5, 2}, {
+      1.0f, 2.0f,
+      3.0f, 4.0f,
+      5.0f, 6.0f,
+      7.0f, 8.0f,
+      9.0f, 10.0f,
+
+      11.0f, 12.0f,
+      13.0f, 14.0f,
+      15.0f, 16.0f,
+      17.0f, 18.0f,
+      19.0f, 20.0f});
+  test.AddInput<bool>("condition", {5}, {1, 1, 0, 1, 1});
+  test.AddOutput<float>("output", {2, 4, 2}, {
+      1.0f, 2.0f,
+      3.0f, 4.0f,
+      7.0f, 8.0f,
+      9.0f, 10.0f,
+
+      11.0f, 12.0f,
+      13.0f, 14.0f,
+      17.0f, 18.0f,
+      19.0f, 20.0f});
+  test.Run();
+}
+
 TEST(CompressTest, Compress_condition_all_false) {
   OpTester test("Compress", 9);
 
@@ -313,6 +313,28 @@ TEST(GatherElementsOpTest, BigIndices) {
   test1.Run();
 }
 
+// runs of consecutive indices along the innermost axis, and of equal indices along an outer axis, are copied
+// as a single block. runs are broken by a change of value and by the end of the row.
+TEST(GatherElementsOpTest, IndexRuns) {
+  {
+    OpTester test("GatherElements", 13);
+    test.AddAttribute<int64_t>("axis", 1LL);
+    test.AddInput<float>("data", {2, 5}, {0.f, 1.f, 2.f, 3.f, 4.f, 10.f, 11.f, 12.f, 13.f, 14.f});
+    test.AddInput<int64_t>("indices", {2, 4}, {1, 2, 3, 0, -3, -2, -1, 4});
+    test.AddOutput<float>("output", {2, 4}, {1.f, 2.f, 3.f, 0.f, 12.f, 13.f, 14.f, 14.f});
+    test.Run();
+  }
+  {
+    OpTester test("GatherElements", 13);
+    test.AddAttribute<int64_t>("axis", 0LL);
+    test.AddInput<std::string>("data", {3, 4}, {"a0", "a1", "a2", "a3", "b0", "b1", "b2", "b3",
+                                                "c0", "c1", "c2", "c3"});
+    test.AddInput<int32_t>("indices", {2, 3}, {2, 2, 0, 1, -2, 1});
+    test.AddOutput<std::string>("output", {2, 3}, {"c0", "c1", "a2", "b0", "b1", "b2"});
+    test.Run();
+  }
+}
+
 #if defined(ENABLE_TRAINING) && (defined(USE_CUDA) || defined(USE_ROCM))
 TEST(GatherElementsOpTest, Strided_float) { RunKernelComputeTestWrapper<float>(); }
 
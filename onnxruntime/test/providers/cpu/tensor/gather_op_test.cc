@@ -389,6 +389,22 @@ TEST(GatherOpTest, Gather_axis1_indices2d_bool) {
 #endif
 }
 
+// runs of consecutive indices (including negative ones) are copied as a single block
+TEST(GatherOpTest, Gather_axis1_consecutive_indices) {
+  OpTester test("Gather");
+  test.AddAttribute<int64_t>("axis", 1LL);
+  test.AddInput<float>("data", {2, 5, 2},
+                       {0.0f, 0.1f, 1.0f, 1.1f, 2.0f, 2.1f, 3.0f, 3.1f, 4.0f, 4.1f,
+                        10.0f, 10.1f, 11.0f, 11.1f, 12.0f, 12.1f, 13.0f, 13.1f, 14.0f, 14.1f});
+  test.AddInput<int64_t>("indices", {2, 3}, {0LL, 1LL, 2LL, -2LL, -1LL, 1LL});
+  test.AddOutput<float>("output", {2, 2, 3, 2},
+                        {0.0f, 0.1f, 1.0f, 1.1f, 2.0f, 2.1f,
+                         3.0f, 3.1f, 4.0f, 4.1f, 1.0f, 1.1f,
+                         10.0f, 10.1f, 11.0f, 11.1f, 12.0f, 12.1f,
+                         13.0f, 13.1f, 14.0f, 14.1f, 11.0f, 11.1f});
+  test.Run();
+}
+
 TEST(GatherOpTest, Gather_perf) {
   OpTester test("Gather");
   test.AddAttribute<int64_t>("axis", 0LL);
@@ -68,6 +68,28 @@ TEST(NonZeroOpTest, ThreeDims) {
   test.Run();
 }
 
+TEST(NonZeroOpTest, LargeInput) {
+  // large enough to be split into several blocks when a thread pool is available
+  constexpr int64_t rows = 64, cols = 1024;
+  std::vector<float> X(rows * cols, 0.0f);
+  std::vector<int64_t> Y_rows, Y_cols;
+  for (int64_t r = 0; r < rows; ++r) {
+    for (int64_t c = (r * 7) % 13; c < cols; c += 97) {
+      X[r * cols + c] = 1.0f;
+      Y_rows.push_back(r);
+      Y_cols.push_back(c);
+    }
+  }
+
+  std::vector<int64_t> Y(Y_rows);
+  Y.insert(Y.end(), Y_cols.begin(), Y_cols.end());
+
+  OpTester test{kOpName, kOpVersion};
+  test.AddInput<float>("X", {rows, cols}, X);
+  test.AddOutput<int64_t>("Y", {2, static_cast<int64_t>(Y_rows.size())}, Y);
+  test.Run();
+}
+
 TEST(NonZeroOpTest, Scalar) {
   // TODO: ONNX shape inference disagrees about the output shape.
   // ONNX spec is ambiguous: https://github.com/onnx/onnx/issues/2428.
@@ -1306,6 +1306,34 @@ TEST(ResizeOpTest, ResizeOpCubicDownSampleTest_with_roi) {
   test.Run();
 }
 
+TEST(ResizeOpTest, ResizeOpCubicTest_with_roi_extrapolation) {
+  OpTester test("Resize", 13);
+  std::vector<float> scales{1.0f, 1.0f, 0.8f, 1.25f};
+  std::vector<float> roi{0.0f, 0.0f, 0.1f, -0.2f, 1.0f, 1.0f, 1.2f, 0.8f};
+
+  test.AddAttribute("mode", "cubic");
+  test.AddAttribute("coordinate_transformation_mode", "tf_crop_and_resize");
+  test.AddAttribute("extrapolation_value", 10.0f);
+
+  constexpr int64_t N = 1, C = 1, H = 4, W = 4;
+  std::vector<float> X = {
+      1.0f, 2.0f, 3.0f, 4.0f,
+      5.0f, 6.0f, 7.0f, 8.0f,
+      9.0f, 10.0f, 11.0f, 12.0f,
+      13.0f, 14.0f, 15.0f, 16.0f};
+
+  test.AddInput<float>("X", {N, C, H, W}, X);
+  test.AddInput<float>("roi", {8}, roi);
+  test.AddInput<float>("scales", {4}, scales);
+
+  std::vector<float> Y = {10.0f, 2.04034f, 2.78425f, 3.54288f, 4.423f,
+                          10.0f, 8.82784f, 9.57175f, 10.33038f, 11.2105f,
+                          10.0f, 10.0f, 10.0f, 10.0f, 10.0f};
+
+  test.AddOutput<float>("Y", {N, C, 3, 5}, Y);
+  test.Run();
+}
+
 TEST(ResizeOpTest, ResizeOpCubicDownSampleTest_asymmetric) {
   OpTester test("Resize", 13);
   std::vector<float> scales{1.0f, 1.0f, 0.8f, 0.8f};
@@ -180,5 +180,15 @@ TEST(ScatterNDOpTest, ScatterND_batched_3tensor_int64) {
   test3.Run();
 }
 
+TEST(ScatterNDOpTest, ScatterND_reduction_add_duplicate_indices) {
+  OpTester test("ScatterND", 16);
+  test.AddAttribute<std::string>("reduction", "add");
+  test.AddInput<float>("data", {4, 2}, {1.f, 1.f, 2.f, 2.f, 3.f, 3.f, 4.f, 4.f});
+  test.AddInput<int64_t>("indices", {3, 1}, {1LL, 3LL, 1LL});
+  test.AddInput<float>("updates", {3, 2}, {10.f, 20.f, 30.f, 40.f, 5.f, 6.f});
+  test.AddOutput<float>("output", {4, 2}, {1.f, 1.f, 17.f, 28.f, 3.f, 3.f, 34.f, 44.f});
+  test.Run();
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -214,5 +214,25 @@ TEST(Scatter, BoolInputWithAxis) {
   scatter_bool_with_axis_tests("ScatterElements", 11);
 }
 
+TEST(Scatter, ReductionWithAxisAndDuplicateIndices) {
+  OpTester test_add("ScatterElements", 16);
+  test_add.AddAttribute<int64_t>("axis", 1);
+  test_add.AddAttribute<std::string>("reduction", "add");
+  test_add.AddInput<float>("data", {2, 3}, {1.f, 2.f, 3.f, 4.f, 5.f, 6.f});
+  test_add.AddInput<int64_t>("indices", {2, 3}, {0, 0, 2, 1, 1, 1});
+  test_add.AddInput<float>("updates", {2, 3}, {1.f, 2.f, 3.f, 10.f, 20.f, 30.f});
+  test_add.AddOutput<float>("y", {2, 3}, {4.f, 2.f, 6.f, 4.f, 65.f, 6.f});
+  test_add.Run();
+
+  OpTester test_mul("ScatterElements", 16);
+  test_mul.AddAttribute<int64_t>("axis", 1);
+  test_mul.AddAttribute<std::string>("reduction", "mul");
+  test_mul.AddInput<float>("data", {2, 3}, {1.f, 2.f, 3.f, 4.f, 5.f, 6.f});
+  test_mul.AddInput<int64_t>("indices", {2, 3}, {0, 0, 2, 1, 1, 1});
+  test_mul.AddInput<float>("updates", {2, 3}, {1.f, 2.f, 3.f, 10.f, 20.f, 30.f});
+  test_mul.AddOutput<float>("y", {2, 3}, {2.f, 2.f, 9.f, 4.f, 30000.f, 6.f});
+  test_mul.Run();
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -1,6 +1,8 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <numeric>
+
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
 #include "test/providers/compare_provider_test_utils.h"
@@ -515,6 +517,34 @@ TEST(TransposeOpTest, NDim) {
   TransposeTest(input_shape, input_vals, &perm, input_shape, expected_vals2);
 }
 
+// General permutation with partial tiles and mergeable axes, checked against a naive element wise transpose
+TEST(TransposeOpTest, NDimBlocked_int64) {
+  const std::vector<int64_t> input_shape{3, 1, 10, 4, 13};
+  const std::vector<int64_t> perm{4, 2, 3, 1, 0};
+  const std::vector<int64_t> output_shape{13, 10, 4, 1, 3};
+
+  std::vector<int64_t> input_vals(3 * 10 * 4 * 13);
+  std::iota(input_vals.begin(), input_vals.end(), int64_t{0});
+
+  const std::vector<int64_t> input_strides{520, 520, 52, 13, 1};
+  std::vector<int64_t> expected_vals;
+  expected_vals.reserve(input_vals.size());
+  for (int64_t i0 = 0; i0 < output_shape[0]; ++i0)
+    for (int64_t i1 = 0; i1 < output_shape[1]; ++i1)
+      for (int64_t i2 = 0; i2 < output_shape[2]; ++i2)
+        for (int64_t i3 = 0; i3 < output_shape[3]; ++i3)
+          for (int64_t i4 = 0; i4 < output_shape[4]; ++i4)
+            expected_vals.push_back(input_vals[i0 * input_strides[perm[0]] + i1 * input_strides[perm[1]] +
+                                               i2 * input_strides[perm[2]] + i3 * input_strides[perm[3]] +
+                                               i4 * input_strides[perm[4]]]);
+
+  OpTester test("Transpose");
+  test.AddAttribute("perm", perm);
+  test.AddInput<int64_t>("X", input_shape, input_vals);
+  test.AddOutput<int64_t>("Y", output_shape, expected_vals);
+  test.Run();
+}
+
 TEST(TransposeOpTest, DoTransposeImpl) {
   std::vector<int64_t> input_shape({5, 2, 1, 3});
   std::vector<float> input_vals(30);